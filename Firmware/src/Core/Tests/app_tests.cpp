@@ -0,0 +1,459 @@
+#include <gtest/gtest.h>
+
+#include "app.h"
+
+class AppFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        app_init(&state);
+        state.config.target_temperature = 4;
+        state.config.current_threshold  = 500;
+
+        inputs.time.seconds          = 1;
+        inputs.time.milliseconds     = 0;
+        inputs.temperature           = 4;
+        inputs.temperature_slope     = 0;
+        inputs.temperature_curvature = 0;
+        inputs.current_rms           = 0;
+        inputs.time_of_day           = APP_TIME_OF_DAY_UNKNOWN;
+        inputs.gestures              = &gestures;
+        gesture_queue_init(&gestures);
+    }
+
+    void step_at(const uint32_t seconds)
+    {
+        inputs.time.seconds = seconds;
+        inputs.temperature_q8 = PID_TO_Q8(inputs.temperature);
+        app_step(&state, &inputs, &outputs);
+    }
+
+    app_state_t     state;
+    app_inputs_t    inputs;
+    gesture_queue_t gestures;
+    app_outputs_t outputs;
+};
+
+TEST_F(AppFixture, hysteresis_start_stop_test)
+{
+    // Within the hysteresis window : nothing happens
+    step_at(1);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_EQ(outputs.events, 0U);
+
+    // First start after boot bypasses the restart wait
+    inputs.temperature = 4 + TEMP_HYSTERESIS_HIGH + 1;
+    step_at(2);
+    ASSERT_TRUE(outputs.motor_on);
+    ASSERT_TRUE(outputs.events & APP_EVENT_MOTOR_STARTED);
+    ASSERT_TRUE(outputs.led.set_io);
+    ASSERT_EQ(outputs.led.io_state, 1U);
+
+    // Still running while temperature goes down within the window
+    inputs.temperature = 4 - TEMP_HYSTERESIS_LOW;
+    inputs.current_rms = 500;
+    step_at(30);
+    ASSERT_TRUE(outputs.motor_on);
+    ASSERT_EQ(outputs.events, 0U);
+
+    inputs.temperature = 4 - TEMP_HYSTERESIS_LOW - 1;
+    step_at(31);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_TRUE(outputs.events & APP_EVENT_MOTOR_STOPPED);
+}
+
+TEST_F(AppFixture, restart_wait_test)
+{
+    inputs.temperature = 10;
+    step_at(2);
+    ASSERT_TRUE(outputs.motor_on);
+
+    inputs.temperature = 0;
+    step_at(100);
+    ASSERT_FALSE(outputs.motor_on);
+
+    // Too early to restart : waits and reports ETA
+    inputs.temperature = 10;
+    step_at(110);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_EQ(state.mode, APP_MODE_WAITING_START_MOTOR);
+    ASSERT_TRUE(outputs.led.set_pattern);
+    ASSERT_EQ(outputs.led.pattern, LED_BLINK_BREATHING);
+    ASSERT_TRUE(outputs.events & APP_EVENT_RESTART_PENDING);
+    ASSERT_EQ(outputs.restart_eta_s, STALLED_MOTOR_WAIT_SECONDS - 10U);
+
+    // ETA is only reported periodically
+    step_at(111);
+    ASSERT_FALSE(outputs.events & APP_EVENT_RESTART_PENDING);
+    ASSERT_FALSE(outputs.led.set_pattern);
+
+    step_at(100 + STALLED_MOTOR_WAIT_SECONDS);
+    ASSERT_TRUE(outputs.motor_on);
+    ASSERT_TRUE(outputs.events & APP_EVENT_MOTOR_STARTED);
+}
+
+TEST_F(AppFixture, current_learning_test)
+{
+    state.config.current_threshold = 0;
+    inputs.temperature             = 10;
+    inputs.current_rms             = 420;
+    step_at(2);
+    ASSERT_TRUE(outputs.motor_on);
+
+    // Motor did not run long enough yet
+    step_at(2 + STEADY_MOTOR_RUNTIME);
+    ASSERT_FALSE(outputs.events & APP_EVENT_CURRENT_LEARNT);
+    ASSERT_EQ(state.config.current_threshold, 0U);
+
+    step_at(3 + STEADY_MOTOR_RUNTIME);
+    ASSERT_TRUE(outputs.events & APP_EVENT_CURRENT_LEARNT);
+    ASSERT_TRUE(outputs.config_changed);
+    ASSERT_EQ(state.config.current_threshold, 420U);
+    ASSERT_EQ(outputs.led.pattern, LED_BLINK_ACCEPT);
+    ASSERT_EQ(outputs.led.next_event.kind, LED_NEXT_EVENT_IO_STATE);
+
+    // Learnt only once
+    step_at(4 + STEADY_MOTOR_RUNTIME);
+    ASSERT_FALSE(outputs.config_changed);
+}
+
+TEST_F(AppFixture, current_refinement_test)
+{
+    state.params.adaptive_hysteresis = 0U;
+
+    // Runs one compressor cycle at a steady current, starting at start_time
+    auto run_cycle = [this](const uint32_t start_time, const int16_t rms)
+    {
+        inputs.temperature = 10;
+        inputs.current_rms = rms;
+        for (uint32_t time = start_time; time <= start_time + 120U; time++)
+        {
+            step_at(time);
+        }
+        inputs.temperature = 1;
+        step_at(start_time + 121U);
+        ASSERT_FALSE(outputs.motor_on);
+    };
+
+    // Seed reading is refined by the first full run, saved right away
+    run_cycle(2U, 480);
+    ASSERT_TRUE(outputs.events & APP_EVENT_CURRENT_REFINED);
+    ASSERT_TRUE(outputs.config_changed);
+    ASSERT_EQ(state.config.current_threshold, 480U);
+    ASSERT_EQ(state.config.current_runs, 1U);
+
+    // Widest margin until enough runs were learnt
+    ASSERT_EQ(app_get_stall_threshold(&state), (480U * (100U + STALLED_CURRENT_MULTIPLIER_PERCENT)) / 100U);
+
+    uint32_t start_time = 2U;
+    for (uint8_t runs = 2U; runs <= CURRENT_LEARNER_MIN_RUNS; runs++)
+    {
+        start_time += 121U + STALLED_MOTOR_WAIT_SECONDS;
+        run_cycle(start_time, 480);
+        ASSERT_EQ(state.config.current_runs, runs);
+    }
+
+    // Steady current : tightest margin
+    ASSERT_EQ(state.config.current_sigma, 0U);
+    ASSERT_EQ(app_get_stall_threshold(&state), (480U * (100U + CURRENT_LEARNER_MIN_MARGIN_PERCENT)) / 100U);
+
+    // Past the first runs, statistics are saved every few runs only
+    start_time += 121U + STALLED_MOTOR_WAIT_SECONDS;
+    run_cycle(start_time, 480);
+    ASSERT_TRUE(outputs.events & APP_EVENT_CURRENT_REFINED);
+    ASSERT_FALSE(outputs.config_changed);
+}
+
+TEST_F(AppFixture, stall_detection_test)
+{
+    inputs.temperature = 10;
+    step_at(20);
+    ASSERT_TRUE(outputs.motor_on);
+
+    // Inrush current is ignored right after a (re)start
+    inputs.current_rms = 1000;
+    step_at(20 + STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART - 1);
+    ASSERT_TRUE(outputs.motor_on);
+
+    // Just below the overcurrent threshold
+    inputs.current_rms = (500 * (100 + STALLED_CURRENT_MULTIPLIER_PERCENT)) / 100;
+    step_at(20 + STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART);
+    ASSERT_TRUE(outputs.motor_on);
+
+    const uint32_t stall_time = 21 + STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART;
+    inputs.current_rms += 1;
+    step_at(stall_time);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_EQ(state.mode, APP_MODE_MOTOR_STALLED);
+    ASSERT_TRUE(outputs.events & APP_EVENT_STALL_DETECTED);
+    ASSERT_EQ(outputs.led.pattern, LED_BLINK_WARNING);
+
+    inputs.current_rms = 0;
+    step_at(stall_time + STALLED_MOTOR_WAIT_SECONDS - 1);
+    ASSERT_EQ(state.mode, APP_MODE_MOTOR_STALLED);
+    ASSERT_FALSE(outputs.motor_on);
+
+    step_at(stall_time + STALLED_MOTOR_WAIT_SECONDS);
+    ASSERT_EQ(state.mode, APP_MODE_NORMAL);
+    ASSERT_TRUE(outputs.events & APP_EVENT_STALL_TIMEOUT);
+
+    step_at(stall_time + STALLED_MOTOR_WAIT_SECONDS + 1);
+    ASSERT_TRUE(outputs.motor_on);
+}
+
+TEST_F(AppFixture, adaptive_hysteresis_test)
+{
+    state.params.adaptive_cycle_minutes = 60U;
+
+    // Boot start : the pull down is not a regular cycle, it is not measured
+    inputs.temperature = 10;
+    step_at(2);
+    ASSERT_TRUE(outputs.motor_on);
+    inputs.temperature = 1;
+    step_at(1000);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_FALSE(outputs.events & APP_EVENT_RATE_LEARNT);
+
+    // Warm-up from 1°C to 7°C in one hour
+    inputs.temperature = 7;
+    step_at(4600);
+    ASSERT_TRUE(outputs.motor_on);
+    ASSERT_TRUE(outputs.events & APP_EVENT_RATE_LEARNT);
+    ASSERT_EQ(state.config.warming_rate, 6U * 256U);
+    ASSERT_FALSE(outputs.config_changed);
+
+    // Cool-down from 7°C to 1°C in 30 minutes : both rates are known, bands are adapted and saved
+    inputs.temperature = 1;
+    step_at(6400);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_EQ(state.config.cooling_rate, 12U * 256U);
+    ASSERT_TRUE(outputs.config_changed);
+
+    // 4°C/h combined over 1 hour : 4°C span, 1°C band. The compressor now starts at 6°C instead of 7°C
+    inputs.temperature = 5;
+    step_at(8000);
+    ASSERT_FALSE(outputs.motor_on);
+    inputs.temperature = 6;
+    step_at(9400);
+    ASSERT_TRUE(outputs.motor_on);
+    ASSERT_EQ(state.config.warming_rate, 6U * 256U);
+
+    // Phases interrupted by a stall or a relearn are not measured
+    state.learner.switch_valid = false;
+    const uint16_t cooling_rate = state.config.cooling_rate;
+    inputs.temperature = 2;
+    step_at(10000);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_FALSE(outputs.events & APP_EVENT_RATE_LEARNT);
+    ASSERT_EQ(state.config.cooling_rate, cooling_rate);
+}
+
+TEST_F(AppFixture, pid_control_test)
+{
+    state.params.control_mode = APP_CONTROL_PID;
+
+    // At the target : no duty, no start
+    inputs.temperature = 4;
+    step_at(2);
+    ASSERT_FALSE(outputs.motor_on);
+
+    // 4°C above : 4 x PID_KP permille of the window, longer than the minimum run time (1 minute later, next PID sample)
+    inputs.temperature = 8;
+    step_at(62);
+    ASSERT_TRUE(outputs.motor_on);
+    ASSERT_TRUE(outputs.events & APP_EVENT_MOTOR_STARTED);
+    ASSERT_GT(state.pid.output, 0);
+
+    // Cold again : output drops to 0 but the compressor runs for the minimum run time
+    inputs.temperature = 2;
+    step_at(122);
+    ASSERT_EQ(state.pid.output, 0);
+    ASSERT_TRUE(outputs.motor_on);
+    step_at(61 + MIN_MOTOR_RUNTIME_SECONDS);
+    ASSERT_TRUE(outputs.motor_on);
+    step_at(62 + MIN_MOTOR_RUNTIME_SECONDS);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_TRUE(outputs.events & APP_EVENT_MOTOR_STOPPED);
+
+    // Very warm : no start until the restart protection is over, and no waiting state either
+    const uint32_t stop_time = 62 + MIN_MOTOR_RUNTIME_SECONDS;
+    inputs.temperature = 12;
+    step_at(stop_time + 60);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_NE(state.mode, APP_MODE_WAITING_START_MOTOR);
+    ASSERT_FALSE(outputs.events & APP_EVENT_RESTART_PENDING);
+
+    // Once the window is over, a partial demand waits for the rest, a saturated output only for the restart protection
+    inputs.temperature = 8;
+    step_at(2 + PID_WINDOW_SECONDS);
+    ASSERT_LT(state.pid.output, 1000);
+    ASSERT_FALSE(outputs.motor_on);
+    inputs.temperature = 12;
+    step_at(62 + PID_WINDOW_SECONDS);
+    ASSERT_EQ(state.pid.output, 1000);
+    ASSERT_TRUE(outputs.motor_on);
+}
+
+TEST_F(AppFixture, door_opening_test)
+{
+    inputs.temperature = 10;
+    step_at(2);
+    ASSERT_TRUE(outputs.motor_on);
+    inputs.temperature = 1;
+    step_at(1000);
+    ASSERT_FALSE(outputs.motor_on);
+
+    // Door opened : the reading crosses the start threshold with a slope building up fast, the start is held
+    inputs.temperature           = 4 + TEMP_HYSTERESIS_HIGH + 1;
+    inputs.temperature_slope     = 30 * 256;
+    inputs.temperature_curvature = 20 * 256;
+    step_at(2000);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_TRUE(outputs.events & APP_EVENT_START_HELD);
+    ASSERT_NE(state.mode, APP_MODE_WAITING_START_MOTOR);
+    step_at(2001);
+    ASSERT_FALSE(outputs.events & APP_EVENT_START_HELD);
+
+    // Door closed : the reading goes back down on its own, that start is avoided
+    inputs.temperature_curvature = -10 * 256;
+    step_at(2100);
+    ASSERT_FALSE(outputs.motor_on);
+    inputs.temperature           = 5;
+    inputs.temperature_slope     = -10 * 256;
+    inputs.temperature_curvature = 0;
+    step_at(2400);
+    ASSERT_FALSE(outputs.motor_on);
+    ASSERT_EQ(state.transient.avoided, 1U);
+
+    // Detection disabled : the same spike starts the compressor right away
+    state.params.transient_detection = 0U;
+    inputs.temperature               = 4 + TEMP_HYSTERESIS_HIGH + 1;
+    inputs.temperature_slope         = 30 * 256;
+    inputs.temperature_curvature     = 20 * 256;
+    step_at(3000);
+    ASSERT_TRUE(outputs.motor_on);
+}
+
+TEST_F(AppFixture, schedule_test)
+{
+    state.config.target_temperature  = 5;
+    state.params.adaptive_hysteresis = 0U;
+    state.params.transient_detection = 0U;
+    state.params.schedule.peak_start_minute = 17U * 60U;
+    state.params.schedule.peak_end_minute   = 21U * 60U;
+    state.params.schedule.precool_minutes   = 120U;
+    state.params.schedule.precool_offset    = 2U;
+    state.params.schedule.peak_band_extra   = 2U;
+    state.params.schedule.min_temperature   = 1;
+    state.params.schedule.max_temperature   = 8;
+
+    // No wall clock : regular thresholds (3°C to 7°C)
+    inputs.time_of_day = APP_TIME_OF_DAY_UNKNOWN;
+    inputs.temperature = 6;
+    step_at(2);
+    ASSERT_EQ(app_get_setpoint(&state), 5);
+    ASSERT_EQ(state.schedule, SCHEDULE_NONE);
+    ASSERT_FALSE(outputs.motor_on);
+
+    // Pre-cooling : the compressor starts and stops 2°C lower (1°C to 5°C)
+    inputs.time_of_day = 16U * 60U;
+    step_at(3);
+    ASSERT_TRUE(outputs.events & APP_EVENT_SCHEDULE_CHANGED);
+    ASSERT_EQ(state.schedule, SCHEDULE_PRECOOL);
+    ASSERT_EQ(app_get_setpoint(&state), 3);
+    ASSERT_TRUE(outputs.motor_on);
+    inputs.current_rms = 500;
+    inputs.temperature = 2;
+    step_at(30);
+    ASSERT_TRUE(outputs.motor_on);
+    inputs.temperature = 0;
+    step_at(600);
+    ASSERT_FALSE(outputs.motor_on);
+
+    // Peak hours : the regular start threshold no longer starts it, the band is clamped at 8°C (3°C to 8°C)
+    inputs.current_rms = 0;
+    inputs.time_of_day = 18U * 60U;
+    inputs.temperature = 8;
+    step_at(2000);
+    ASSERT_EQ(state.schedule, SCHEDULE_PEAK);
+    ASSERT_FALSE(outputs.motor_on);
+    uint8_t high = 0;
+    uint8_t low  = 0;
+    app_get_hysteresis_band(&state, &high, &low);
+    ASSERT_EQ(high, 3U);
+
+    // Scheduling disabled : back to the regular thresholds
+    state.params.scheduling = 0U;
+    step_at(2001);
+    ASSERT_TRUE(outputs.events & APP_EVENT_SCHEDULE_CHANGED);
+    ASSERT_EQ(state.schedule, SCHEDULE_NONE);
+    ASSERT_TRUE(outputs.motor_on);
+}
+
+TEST_F(AppFixture, buttons_test)
+{
+    // No gesture : nothing changes
+    step_at(1);
+    ASSERT_FALSE(outputs.config_changed);
+
+    // Click on +
+    gesture_queue_push(&gestures, BUTTON_PLUS, GESTURE_CLICK);
+    step_at(1);
+    ASSERT_TRUE(outputs.config_changed);
+    ASSERT_TRUE(outputs.events & APP_EVENT_TARGET_INCREASED);
+    ASSERT_EQ(state.config.target_temperature, 5);
+    ASSERT_EQ(gestures.count, 0U);
+
+    // Double click counts twice, long press and auto-repeat once per gesture
+    gesture_queue_push(&gestures, BUTTON_MINUS, GESTURE_DOUBLE_CLICK);
+    step_at(2);
+    ASSERT_TRUE(outputs.events & APP_EVENT_TARGET_DECREASED);
+    ASSERT_EQ(state.config.target_temperature, 3);
+    gesture_queue_push(&gestures, BUTTON_PLUS, GESTURE_LONG_PRESS);
+    gesture_queue_push(&gestures, BUTTON_PLUS, GESTURE_REPEAT);
+    gesture_queue_push(&gestures, BUTTON_PLUS, GESTURE_REPEAT);
+    step_at(2);
+    ASSERT_EQ(state.config.target_temperature, 6);
+
+    // Clamped to the NTC curve maximum, all the queued gestures are handled within a single step
+    state.config.target_temperature = state.params.max_target_temperature;
+    gesture_queue_push(&gestures, BUTTON_PLUS, GESTURE_CLICK);
+    gesture_queue_push(&gestures, BUTTON_PLUS, GESTURE_REPEAT);
+    step_at(2);
+    ASSERT_EQ(state.config.target_temperature, state.params.max_target_temperature);
+    gesture_queue_push(&gestures, BUTTON_MINUS, GESTURE_CLICK);
+    gesture_queue_push(&gestures, BUTTON_MINUS, GESTURE_CLICK);
+    step_at(2);
+    ASSERT_EQ(state.config.target_temperature, state.params.max_target_temperature - 2);
+
+    // Both buttons held request a new learning
+    state.config.target_temperature = 4;
+    state.config.current_sigma      = 32U;
+    state.config.current_runs       = 5U;
+    gesture_queue_push(&gestures, GESTURE_ALL_BUTTONS, GESTURE_CHORD);
+    step_at(3);
+    ASSERT_TRUE(outputs.events & APP_EVENT_RELEARN_REQUESTED);
+    ASSERT_FALSE(outputs.events & (APP_EVENT_TARGET_INCREASED | APP_EVENT_TARGET_DECREASED));
+    ASSERT_EQ(state.config.target_temperature, 4);
+    ASSERT_EQ(state.config.current_threshold, 0U);
+    ASSERT_EQ(state.config.current_sigma, 0U);
+    ASSERT_EQ(state.config.current_runs, 0U);
+    ASSERT_EQ(outputs.led.pattern, LED_BLINK_ACCEPT);
+    ASSERT_EQ(outputs.led.next_event.data.pattern, LED_BLINK_BREATHING);
+
+    // Relearn is only requested once per chord
+    step_at(4);
+    ASSERT_FALSE(outputs.events & APP_EVENT_RELEARN_REQUESTED);
+
+    // Without buttons
+    inputs.gestures = nullptr;
+    step_at(7);
+    ASSERT_FALSE(outputs.config_changed);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
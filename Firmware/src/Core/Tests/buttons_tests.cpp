@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "buttons.h"
+
+class ButtonsFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        button_init(&button);
+        time_default(&now);
+    }
+
+    // Feeds the button at a given time (milliseconds since boot), returns true on an edge
+    bool feed_at(const uint32_t ms, const bool pressed)
+    {
+        now.seconds      = ms / 1000U;
+        now.milliseconds = (uint16_t)(ms % 1000U);
+        return button_update(&button, pressed, &now);
+    }
+
+    button_t   button;
+    mcu_time_t now;
+};
+
+TEST_F(ButtonsFixture, bouncing_test)
+{
+    mcu_time_t deadline;
+    ASSERT_FALSE(button_get_deadline(&button, &deadline));
+
+    // Contact bounces : each edge restarts the debouncing timer
+    ASSERT_FALSE(feed_at(1000, true));
+    ASSERT_FALSE(feed_at(1003, false));
+    ASSERT_FALSE(feed_at(1005, true));
+    ASSERT_TRUE(button_get_deadline(&button, &deadline));
+    ASSERT_EQ(deadline.seconds, 1U);
+    ASSERT_EQ(deadline.milliseconds, 5U + BUTTON_DEBOUNCE_MS);
+    ASSERT_FALSE(feed_at(1004 + BUTTON_DEBOUNCE_MS, true));
+    ASSERT_FALSE(button.pressed);
+    ASSERT_TRUE(feed_at(1005 + BUTTON_DEBOUNCE_MS, true));
+    ASSERT_TRUE(button.pressed);
+    ASSERT_FALSE(button_get_deadline(&button, &deadline));
+
+    // Held : no more edges
+    ASSERT_FALSE(feed_at(5000, true));
+
+    // Release, with bounces too : a single edge
+    ASSERT_FALSE(feed_at(6000, false));
+    ASSERT_FALSE(feed_at(6001, true));
+    ASSERT_FALSE(feed_at(6002, false));
+    ASSERT_TRUE(feed_at(6002 + BUTTON_DEBOUNCE_MS, false));
+    ASSERT_FALSE(button.pressed);
+    ASSERT_FALSE(feed_at(6100, false));
+    ASSERT_FALSE(button_get_deadline(&button, &deadline));
+}
+
+TEST_F(ButtonsFixture, glitch_test)
+{
+    // Shorter than the debouncing delay : ignored
+    ASSERT_FALSE(feed_at(500, true));
+    ASSERT_FALSE(feed_at(500 + BUTTON_DEBOUNCE_MS - 1U, false));
+    ASSERT_FALSE(feed_at(600, false));
+    ASSERT_FALSE(button.pressed);
+
+    mcu_time_t deadline;
+    ASSERT_FALSE(button_get_deadline(&button, &deadline));
+}
+
+TEST_F(ButtonsFixture, late_feed_test)
+{
+    // Fed long after the deadline (MCU busy) : accepted on the next feed
+    ASSERT_FALSE(feed_at(1000, true));
+    ASSERT_TRUE(feed_at(4000, true));
+    ASSERT_TRUE(button.pressed);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
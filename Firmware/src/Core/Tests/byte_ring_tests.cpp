@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <string>
+
+#include "byte_ring.h"
+#include "flash.h"
+
+class ByteRingFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        byte_ring_init(&ring, storage, sizeof(storage));
+    }
+
+    bool write_text(const char *text)
+    {
+        return byte_ring_write(&ring, (uint8_t const *)text, (uint16_t)strlen(text));
+    }
+
+    uint8_t storage[16];
+    byte_ring_t ring;
+};
+
+TEST_F(ByteRingFixture, fifo_test)
+{
+    uint8_t byte = 0xAAU;
+    ASSERT_FALSE(byte_ring_read(&ring, &byte));
+    ASSERT_EQ(byte, 0xAAU);
+    ASSERT_EQ(byte_ring_free(&ring), 16U);
+
+    ASSERT_TRUE(write_text("abc"));
+    ASSERT_TRUE(write_text("de"));
+    ASSERT_EQ(byte_ring_count(&ring), 5U);
+
+    for (const char expected : std::string("abcde"))
+    {
+        ASSERT_TRUE(byte_ring_read(&ring, &byte));
+        ASSERT_EQ(byte, (uint8_t)expected);
+    }
+    ASSERT_FALSE(byte_ring_read(&ring, &byte));
+    ASSERT_EQ(byte_ring_count(&ring), 0U);
+}
+
+TEST_F(ByteRingFixture, full_test)
+{
+    // Fills the whole storage : a full ring is not mistaken for an empty one
+    ASSERT_TRUE(write_text("0123456789"));
+    ASSERT_TRUE(write_text("ABCDEF"));
+    ASSERT_EQ(byte_ring_count(&ring), 16U);
+    ASSERT_EQ(byte_ring_free(&ring), 0U);
+
+    // Messages that don't fit are dropped whole, nothing is truncated
+    ASSERT_FALSE(write_text("x"));
+    uint8_t byte;
+    ASSERT_TRUE(byte_ring_read(&ring, &byte));
+    ASSERT_TRUE(byte_ring_read(&ring, &byte));
+    ASSERT_FALSE(write_text("xyz"));
+    ASSERT_TRUE(write_text("yz"));
+    ASSERT_EQ(ring.dropped_writes, 2U);
+    ASSERT_EQ(ring.dropped_bytes, 4U);
+
+    // Data wraps around the storage end
+    std::string read;
+    while (byte_ring_read(&ring, &byte))
+    {
+        read += (char)byte;
+    }
+    ASSERT_EQ(read, "23456789ABCDEFyz");
+}
+
+TEST_F(ByteRingFixture, flash_test)
+{
+    // Messages kept in flash follow the same rules : whole messages, drops counted
+    static const uint8_t message[] FLASH_STORAGE = {'f', 'l', 'a', 's', 'h'};
+    ASSERT_TRUE(write_text("0123456789"));
+    ASSERT_TRUE(byte_ring_write_flash(&ring, message, sizeof(message)));
+    ASSERT_FALSE(byte_ring_write_flash(&ring, message, sizeof(message)));
+    ASSERT_EQ(ring.dropped_writes, 1U);
+    ASSERT_EQ(ring.dropped_bytes, sizeof(message));
+
+    std::string read;
+    uint8_t byte;
+    while (byte_ring_read(&ring, &byte))
+    {
+        read += (char)byte;
+    }
+    ASSERT_EQ(read, "0123456789flash");
+}
+
+TEST_F(ByteRingFixture, counters_test)
+{
+    // Free running indices wrap around 16 bits
+    for (uint16_t i = 0; i < 30000U; i++)
+    {
+        ASSERT_TRUE(write_text("ab"));
+        uint8_t byte;
+        ASSERT_TRUE(byte_ring_read(&ring, &byte));
+        ASSERT_TRUE(byte_ring_read(&ring, &byte));
+        ASSERT_EQ(byte, 'b');
+    }
+    ASSERT_EQ(byte_ring_count(&ring), 0U);
+
+    // Drop counters saturate
+    uint8_t large[32] = {0};
+    ring.dropped_bytes = UINT16_MAX - 10U;
+    ring.dropped_writes = UINT16_MAX;
+    ASSERT_FALSE(byte_ring_write(&ring, large, sizeof(large)));
+    ASSERT_EQ(ring.dropped_bytes, UINT16_MAX);
+    ASSERT_EQ(ring.dropped_writes, UINT16_MAX);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
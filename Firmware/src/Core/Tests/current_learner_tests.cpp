@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "current_learner.h"
+
+class CurrentLearnerFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        current_learner_params_default(&params);
+        params.min_samples = 3U;
+        current_run_init(&run);
+        baseline = {.mean = 500U, .sigma = 0U, .runs = 0U};
+    }
+
+    void run_constant(const int16_t rms)
+    {
+        current_run_init(&run);
+        for (uint32_t second = 10U; second < 13U; second++)
+        {
+            current_run_sample(&run, rms, second);
+        }
+    }
+
+    current_learner_params_t params;
+    current_run_t run;
+    current_baseline_t baseline;
+};
+
+TEST_F(CurrentLearnerFixture, run_sample_test)
+{
+    current_run_sample(&run, 400, 10U);
+    current_run_sample(&run, 420, 11U);
+
+    // Once per second at most
+    current_run_sample(&run, 900, 11U);
+    current_run_sample(&run, 410, 12U);
+    ASSERT_EQ(run.count, 3U);
+    ASSERT_EQ(run.reference, 400);
+    ASSERT_EQ(run.sum, 30);
+    ASSERT_EQ(run.square_sum, 500U);
+
+    // Runs longer than the counters are cut short
+    current_run_sample(&run, 410, 0x10000UL);
+    ASSERT_EQ(run.count, 3U);
+}
+
+TEST_F(CurrentLearnerFixture, learn_test)
+{
+    // Too short runs are dropped
+    current_run_sample(&run, 400, 10U);
+    current_run_sample(&run, 420, 11U);
+    ASSERT_FALSE(current_baseline_learn(&params, &baseline, &run));
+    ASSERT_EQ(baseline.runs, 0U);
+
+    // First run replaces the seed reading : mean 410 mA, variance 66 mA²
+    current_run_sample(&run, 410, 12U);
+    ASSERT_TRUE(current_baseline_learn(&params, &baseline, &run));
+    ASSERT_EQ(baseline.mean, 410U);
+    ASSERT_EQ(baseline.sigma, 129U);
+    ASSERT_EQ(baseline.runs, 1U);
+
+    // Spread in between runs adds up to the variance : 65 + (200 - 65) / 2 (variance is stored as a Q4 standard deviation)
+    run_constant(430);
+    ASSERT_TRUE(current_baseline_learn(&params, &baseline, &run));
+    ASSERT_EQ(baseline.mean, 420U);
+    ASSERT_EQ(baseline.sigma, 183U);
+    ASSERT_EQ(baseline.runs, 2U);
+
+    run_constant(420);
+    ASSERT_TRUE(current_baseline_learn(&params, &baseline, &run));
+    ASSERT_EQ(baseline.mean, 420U);
+    ASSERT_EQ(baseline.sigma, 149U);
+    ASSERT_EQ(baseline.runs, 3U);
+}
+
+TEST_F(CurrentLearnerFixture, forgetting_test)
+{
+    // Past the first 2^shift runs, each new run counts for 1 / 2^shift
+    params.forget_shift = 2U;
+    baseline = {.mean = 400U, .sigma = 0U, .runs = 10U};
+    run_constant(480);
+    ASSERT_TRUE(current_baseline_learn(&params, &baseline, &run));
+    ASSERT_EQ(baseline.mean, 420U);
+    ASSERT_EQ(baseline.sigma, 554U);
+    ASSERT_EQ(baseline.runs, 11U);
+
+    // Runs counter saturates
+    baseline.runs = CURRENT_LEARNER_RUNS_MAX;
+    ASSERT_TRUE(current_baseline_learn(&params, &baseline, &run));
+    ASSERT_EQ(baseline.runs, CURRENT_LEARNER_RUNS_MAX);
+}
+
+TEST_F(CurrentLearnerFixture, threshold_test)
+{
+    // Widest margin until enough runs were learnt
+    baseline = {.mean = 420U, .sigma = 150U, .runs = 2U};
+    ASSERT_EQ(current_baseline_threshold(&params, &baseline, 20U), 504U);
+
+    // mean + 5 sigma
+    baseline.runs = 3U;
+    ASSERT_EQ(current_baseline_threshold(&params, &baseline, 20U), 466U);
+
+    // Margin clamped to [6%, 20%] of the mean
+    baseline.sigma = 0U;
+    ASSERT_EQ(current_baseline_threshold(&params, &baseline, 20U), 445U);
+    baseline.sigma = 1000U;
+    ASSERT_EQ(current_baseline_threshold(&params, &baseline, 20U), 504U);
+
+    // Not learnt
+    baseline.mean = 0U;
+    ASSERT_EQ(current_baseline_threshold(&params, &baseline, 20U), 0U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
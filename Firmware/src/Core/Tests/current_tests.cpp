@@ -55,6 +55,35 @@ TEST_F(CurrentFixture, current_compute_rms_sine_test)
 
 }
 
+TEST_F(CurrentFixture, current_rms_window_test)
+{
+    // Two windows fed with different waveforms don't interfere with each other
+    current_rms_window_t small;
+    current_rms_window_t large;
+    current_rms_window_init(&small);
+    current_rms_window_init(&large);
+
+    int16_t small_out = 0;
+    int16_t large_out = 0;
+    for(unsigned int i = 0; i < CURRENT_MEASURE_SAMPLES_PER_SINE ; i++)
+    {
+        double theta = 2 * M_PI * i / CURRENT_MEASURE_SAMPLES_PER_SINE;
+        int16_t small_ma = (int16_t) (sin(theta) * 100);
+        int16_t large_ma = (int16_t) (sin(theta) * 1000);
+        current_rms_window_compute_sine(&small, &small_ma, &small_out);
+        current_rms_window_compute_sine(&large, &large_ma, &large_out);
+    }
+
+    ASSERT_NEAR(small_out, (int16_t)(100 / sqrt(2)), 5);
+    ASSERT_NEAR(large_out, (int16_t)(1000 / sqrt(2)), 10);
+
+    // Reset window starts from scratch
+    current_rms_window_init(&large);
+    int16_t current_ma = 0;
+    current_rms_window_compute_sine(&large, &current_ma, &large_out);
+    ASSERT_EQ(large_out, 0);
+}
+
 #if CURRENT_RMS_ARBITRARY_FCT
 TEST_F(CurrentFixture, current_compute_rms_arbitrary_test)
 {
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "gesture.h"
+
+class GestureFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        gesture_params_default(&params);
+        gesture_init(&recognizer);
+        gesture_queue_init(&queue);
+    }
+
+    static mcu_time_t at(const uint32_t ms)
+    {
+        return mcu_time_t{.seconds = ms / 1000U, .milliseconds = (uint16_t)(ms % 1000U)};
+    }
+
+    void edge(const uint32_t ms, const uint8_t button, const bool pressed)
+    {
+        const mcu_time_t time = at(ms);
+        gesture_edge(&params, &recognizer, button, pressed, &time, &queue);
+    }
+
+    void process(const uint32_t ms)
+    {
+        const mcu_time_t time = at(ms);
+        gesture_process(&params, &recognizer, &time, &queue);
+    }
+
+    // Drains the queue : (button, gesture) pairs
+    std::vector<std::pair<uint8_t, uint8_t>> drain()
+    {
+        std::vector<std::pair<uint8_t, uint8_t>> gestures;
+        gesture_event_t event;
+        while (gesture_queue_pop(&queue, &event))
+        {
+            gestures.emplace_back(event.button, event.kind);
+        }
+        return gestures;
+    }
+
+    using gestures_t = std::vector<std::pair<uint8_t, uint8_t>>;
+
+    gesture_params_t     params;
+    gesture_recognizer_t recognizer;
+    gesture_queue_t      queue;
+};
+
+TEST_F(GestureFixture, queue_test)
+{
+    gesture_event_t event = {.button = 42U, .kind = 42U};
+    ASSERT_FALSE(gesture_queue_pop(&queue, &event));
+    ASSERT_EQ(event.button, 42U);
+
+    // Wraps around, keeps the oldest gestures and counts the dropped ones
+    for (uint8_t round = 0; round < 3U; round++)
+    {
+        for (uint8_t i = 0; i < GESTURE_QUEUE_SIZE; i++)
+        {
+            ASSERT_TRUE(gesture_queue_push(&queue, i, GESTURE_CLICK));
+        }
+        ASSERT_FALSE(gesture_queue_push(&queue, 0xFFU, GESTURE_CHORD));
+        for (uint8_t i = 0; i < GESTURE_QUEUE_SIZE; i++)
+        {
+            ASSERT_TRUE(gesture_queue_pop(&queue, &event));
+            ASSERT_EQ(event.button, i);
+        }
+        ASSERT_FALSE(gesture_queue_pop(&queue, &event));
+        ASSERT_TRUE(gesture_queue_push(&queue, 0U, GESTURE_CLICK));
+        ASSERT_TRUE(gesture_queue_pop(&queue, &event));
+    }
+    ASSERT_EQ(queue.dropped, 3U);
+}
+
+TEST_F(GestureFixture, click_test)
+{
+    mcu_time_t deadline;
+    ASSERT_FALSE(gesture_get_deadline(&recognizer, &deadline));
+
+    edge(1000, BUTTON_PLUS, true);
+    edge(1100, BUTTON_PLUS, false);
+    ASSERT_TRUE(drain().empty());
+
+    // Raised once the double click delay is over
+    ASSERT_TRUE(gesture_get_deadline(&recognizer, &deadline));
+    const mcu_time_t expected = at(1100U + GESTURE_DOUBLE_CLICK_MS);
+    ASSERT_EQ(time_compare(&deadline, &expected), 0);
+    process(1100U + GESTURE_DOUBLE_CLICK_MS - 1U);
+    ASSERT_TRUE(drain().empty());
+    process(1100U + GESTURE_DOUBLE_CLICK_MS);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_PLUS, GESTURE_CLICK}}));
+    ASSERT_FALSE(gesture_get_deadline(&recognizer, &deadline));
+    ASSERT_EQ(recognizer.state, GESTURE_STATE_IDLE);
+}
+
+TEST_F(GestureFixture, double_click_test)
+{
+    edge(1000, BUTTON_MINUS, true);
+    edge(1080, BUTTON_MINUS, false);
+    edge(1080U + GESTURE_DOUBLE_CLICK_MS - 1U, BUTTON_MINUS, true);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_MINUS, GESTURE_DOUBLE_CLICK}}));
+
+    // Holding the second press does not auto-repeat
+    process(10000);
+    edge(10000, BUTTON_MINUS, false);
+    process(20000);
+    ASSERT_TRUE(drain().empty());
+    ASSERT_EQ(recognizer.state, GESTURE_STATE_IDLE);
+}
+
+TEST_F(GestureFixture, other_button_test)
+{
+    // A press of the other button ends the pending click right away
+    edge(1000, BUTTON_PLUS, true);
+    edge(1050, BUTTON_PLUS, false);
+    edge(1100, BUTTON_MINUS, true);
+    edge(1150, BUTTON_MINUS, false);
+    process(5000);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_PLUS, GESTURE_CLICK}, {BUTTON_MINUS, GESTURE_CLICK}}));
+}
+
+TEST_F(GestureFixture, auto_repeat_test)
+{
+    edge(1000, BUTTON_PLUS, true);
+    process(1000U + GESTURE_LONG_PRESS_MS - 1U);
+    ASSERT_TRUE(drain().empty());
+    process(1000U + GESTURE_LONG_PRESS_MS);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_PLUS, GESTURE_LONG_PRESS}}));
+
+    // Repeats are timed from the long press, late calls catch up
+    process(1000U + GESTURE_LONG_PRESS_MS + 3U * GESTURE_REPEAT_MS + 10U);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_PLUS, GESTURE_REPEAT}, {BUTTON_PLUS, GESTURE_REPEAT}, {BUTTON_PLUS, GESTURE_REPEAT}}));
+
+    // Release stops them, without a click
+    edge(1000U + GESTURE_LONG_PRESS_MS + 3U * GESTURE_REPEAT_MS + 20U, BUTTON_PLUS, false);
+    process(60000);
+    ASSERT_TRUE(drain().empty());
+    ASSERT_EQ(recognizer.state, GESTURE_STATE_IDLE);
+
+    // A release edge coming after a missed deadline still gets the gestures that expired before it
+    edge(70000, BUTTON_MINUS, true);
+    edge(70000U + GESTURE_LONG_PRESS_MS + GESTURE_REPEAT_MS / 2U, BUTTON_MINUS, false);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_MINUS, GESTURE_LONG_PRESS}}));
+}
+
+TEST_F(GestureFixture, chord_test)
+{
+    // Both held : the single button gestures are dropped
+    edge(1000, BUTTON_MINUS, true);
+    process(1000U + GESTURE_LONG_PRESS_MS);
+    edge(1000U + GESTURE_LONG_PRESS_MS + 50U, BUTTON_PLUS, true);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_MINUS, GESTURE_LONG_PRESS}}));
+    process(1000U + GESTURE_LONG_PRESS_MS + 50U + GESTURE_CHORD_MS - 1U);
+    ASSERT_TRUE(drain().empty());
+    process(1000U + GESTURE_LONG_PRESS_MS + 50U + GESTURE_CHORD_MS);
+    ASSERT_EQ(drain(), (gestures_t{{GESTURE_ALL_BUTTONS, GESTURE_CHORD}}));
+
+    // Nothing else until all the buttons are released, then back to normal
+    edge(10000, BUTTON_PLUS, false);
+    edge(10100, BUTTON_PLUS, true);
+    edge(10200, BUTTON_PLUS, false);
+    process(30000);
+    ASSERT_TRUE(drain().empty());
+    edge(31000, BUTTON_MINUS, false);
+    ASSERT_EQ(recognizer.state, GESTURE_STATE_IDLE);
+    edge(32000, BUTTON_PLUS, true);
+    edge(32100, BUTTON_PLUS, false);
+    process(40000);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_PLUS, GESTURE_CLICK}}));
+
+    // Released before the chord delay : nothing
+    edge(50000, BUTTON_PLUS, true);
+    edge(50010, BUTTON_MINUS, true);
+    edge(50500, BUTTON_MINUS, false);
+    edge(50600, BUTTON_PLUS, false);
+    process(60000);
+    ASSERT_TRUE(drain().empty());
+}
+
+TEST_F(GestureFixture, timings_test)
+{
+    // No double click : clicks are raised on release, no auto-repeat : a single long press
+    params.double_click_ms = 0U;
+    params.repeat_ms       = 0U;
+    edge(1000, BUTTON_PLUS, true);
+    edge(1100, BUTTON_PLUS, false);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_PLUS, GESTURE_CLICK}}));
+
+    edge(2000, BUTTON_PLUS, true);
+    process(20000);
+    ASSERT_EQ(drain(), (gestures_t{{BUTTON_PLUS, GESTURE_LONG_PRESS}}));
+    mcu_time_t deadline;
+    ASSERT_FALSE(gesture_get_deadline(&recognizer, &deadline));
+
+    // Duplicated edges are ignored
+    edge(21000, BUTTON_PLUS, true);
+    edge(22000, BUTTON_MINUS, false);
+    ASSERT_EQ(recognizer.state, GESTURE_STATE_REPEATING);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "idle.h"
+#include "mcu_time.h"
+
+class IdleFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        time_default(&now);
+        idle_init(&now);
+    }
+
+    static mcu_time_t make_time(const uint32_t seconds, const uint16_t milliseconds)
+    {
+        return mcu_time_t{.seconds = seconds, .milliseconds = milliseconds};
+    }
+
+    mcu_time_t now;
+};
+
+TEST_F(IdleFixture, time_helpers_test)
+{
+    mcu_time_t time = make_time(1, 900);
+    time_add_ms(&time, 150);
+    ASSERT_EQ(time.seconds, 2U);
+    ASSERT_EQ(time.milliseconds, 50U);
+
+    time_add_ms(&time, 2950);
+    ASSERT_EQ(time.seconds, 5U);
+    ASSERT_EQ(time.milliseconds, 0U);
+
+    mcu_time_t a = make_time(3, 999);
+    mcu_time_t b = make_time(4, 1);
+    ASSERT_EQ(time_compare(&a, &b), -1);
+    ASSERT_EQ(time_compare(&b, &a), 1);
+    ASSERT_EQ(time_compare(&a, &a), 0);
+
+    ASSERT_EQ(time_elapsed_ms(&a, &b), 2U);
+    ASSERT_EQ(time_elapsed_ms(&b, &a), 0U);
+}
+
+TEST_F(IdleFixture, no_deadline_test)
+{
+    mcu_time_t deadline = make_time(42, 42);
+    ASSERT_FALSE(idle_get_next_deadline(&deadline));
+    ASSERT_EQ(deadline.seconds, 42U);
+    ASSERT_EQ(idle_get_sleep_budget_ms(&now), IDLE_MAX_SLEEP_MS);
+}
+
+TEST_F(IdleFixture, earliest_deadline_test)
+{
+    mcu_time_t temperature = make_time(1, 0);
+    mcu_time_t buttons = make_time(0, 10);
+    mcu_time_t led = make_time(0, 1);
+
+    idle_set_deadline(IDLE_USER_TEMPERATURE, &temperature);
+    ASSERT_EQ(idle_get_sleep_budget_ms(&now), IDLE_MAX_SLEEP_MS);
+
+    idle_set_deadline(IDLE_USER_BUTTONS, &buttons);
+    ASSERT_EQ(idle_get_sleep_budget_ms(&now), 10U);
+
+    idle_set_deadline(IDLE_USER_LED, &led);
+    mcu_time_t deadline;
+    ASSERT_TRUE(idle_get_next_deadline(&deadline));
+    ASSERT_EQ(time_compare(&deadline, &led), 0);
+    ASSERT_EQ(idle_get_sleep_budget_ms(&now), 1U);
+
+    // Late deadline prevents any sleep
+    now = make_time(0, 5);
+    ASSERT_EQ(idle_get_sleep_budget_ms(&now), 0U);
+
+    idle_clear_deadline(IDLE_USER_LED);
+    ASSERT_EQ(idle_get_sleep_budget_ms(&now), 5U);
+
+    // Out of range users are ignored
+    idle_set_deadline(IDLE_USER_COUNT, &led);
+    ASSERT_EQ(idle_get_sleep_budget_ms(&now), 5U);
+}
+
+TEST_F(IdleFixture, stats_test)
+{
+    idle_account_sleep(600000U);
+    mcu_time_t later = make_time(1, 0);
+
+    idle_stats_t stats;
+    idle_get_stats(&later, &stats);
+    ASSERT_EQ(stats.window_ms, 1000U);
+    ASSERT_EQ(stats.asleep_ms, 600U);
+    ASSERT_EQ(stats.asleep_permille, 600U);
+
+    // Asleep time can't exceed the window
+    idle_account_sleep(600000U);
+    idle_get_stats(&later, &stats);
+    ASSERT_EQ(stats.asleep_permille, 1000U);
+
+    idle_reset_stats(&later);
+    idle_get_stats(&later, &stats);
+    ASSERT_EQ(stats.window_ms, 0U);
+    ASSERT_EQ(stats.asleep_permille, 0U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "kalman.h"
+
+class KalmanFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        kalman_params_default(&params);
+        kalman_init(&state);
+    }
+
+    // Small deterministic noise source, uniform in [-amplitude, amplitude]
+    int16_t noise(const int16_t amplitude)
+    {
+        seed = seed * 1103515245U + 12345U;
+        return (int16_t)((int32_t)((seed >> 16U) % (2U * amplitude + 1U)) - amplitude);
+    }
+
+    kalman_params_t params;
+    kalman_state_t state;
+    uint32_t seed = 1U;
+};
+
+TEST_F(KalmanFixture, first_sample_test)
+{
+    kalman_update(&params, &state, 4 * 256 + 100);
+    ASSERT_TRUE(state.started);
+    ASSERT_EQ(kalman_temperature(&state), 4 * 256 + 100);
+    ASSERT_EQ(kalman_slope(&params, &state), 0);
+
+    // Constant readings : nothing moves, the variance shrinks below the measurement one
+    for (uint16_t i = 0; i < 600U; i++)
+    {
+        kalman_update(&params, &state, 4 * 256 + 100);
+    }
+    ASSERT_EQ(kalman_temperature(&state), 4 * 256 + 100);
+    ASSERT_EQ(kalman_slope(&params, &state), 0);
+    ASSERT_LT(state.p00, (int32_t)params.measurement_noise << 8);
+    ASSERT_GE(state.p11, 0);
+}
+
+TEST_F(KalmanFixture, ramp_test)
+{
+    // Warming up at 3°C/h, then cooling down at 12°C/h : the slope is tracked and the temperature does not lag behind
+    double temperature = 2.0;
+    for (uint32_t i = 0; i < 3600U; i++)
+    {
+        temperature += 3.0 / 3600.0;
+        kalman_update(&params, &state, (int16_t)std::lround(temperature * 256.0));
+    }
+    ASSERT_NEAR(kalman_slope(&params, &state), 3 * 256, 26);
+    ASSERT_NEAR(kalman_temperature(&state), temperature * 256.0, 4.0);
+
+    for (uint32_t i = 0; i < 1200U; i++)
+    {
+        temperature -= 12.0 / 3600.0;
+        kalman_update(&params, &state, (int16_t)std::lround(temperature * 256.0));
+    }
+    ASSERT_NEAR(kalman_slope(&params, &state), -12 * 256, 26);
+    ASSERT_NEAR(kalman_temperature(&state), temperature * 256.0, 4.0);
+}
+
+TEST_F(KalmanFixture, noise_test)
+{
+    // ±0.3°C of reading noise on a steady temperature is brought down to a few hundredths of a degree
+    for (uint32_t i = 0; i < 1800U; i++)
+    {
+        kalman_update(&params, &state, (int16_t)(5 * 256 + noise(77)));
+    }
+
+    int16_t lowest = INT16_MAX;
+    int16_t highest = INT16_MIN;
+    int16_t steepest = 0;
+    for (uint32_t i = 0; i < 3600U; i++)
+    {
+        kalman_update(&params, &state, (int16_t)(5 * 256 + noise(77)));
+        lowest = std::min(lowest, kalman_temperature(&state));
+        highest = std::max(highest, kalman_temperature(&state));
+        steepest = std::max(steepest, (int16_t)std::abs(kalman_slope(&params, &state)));
+    }
+    ASSERT_GT(lowest, 5 * 256 - 13);
+    ASSERT_LT(highest, 5 * 256 + 13);
+    ASSERT_LT(steepest, 256);
+}
+
+TEST_F(KalmanFixture, spike_test)
+{
+    for (uint32_t i = 0; i < 1800U; i++)
+    {
+        kalman_update(&params, &state, 5 * 256);
+    }
+
+    // A single 3°C spurious reading barely moves the estimate
+    kalman_update(&params, &state, 8 * 256);
+    ASSERT_LT(kalman_temperature(&state), 5 * 256 + 26);
+    for (uint32_t i = 0; i < 600U; i++)
+    {
+        kalman_update(&params, &state, 5 * 256);
+    }
+    ASSERT_NEAR(kalman_temperature(&state), 5 * 256, 1);
+}
+
+TEST_F(KalmanFixture, skip_test)
+{
+    // Nothing to predict from before the first sample
+    kalman_skip(&state);
+    ASSERT_FALSE(state.started);
+
+    double temperature = 2.0;
+    for (uint32_t i = 0; i < 3600U; i++)
+    {
+        temperature += 3.0 / 3600.0;
+        kalman_update(&params, &state, (int16_t)std::lround(temperature * 256.0));
+    }
+
+    // Skipped samples move the estimate along the slope, the confidence in it is kept as is
+    const kalman_state_t before = state;
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        temperature += 3.0 / 3600.0;
+        kalman_skip(&state);
+    }
+    ASSERT_EQ(state.temperature, before.temperature + 3 * (before.slope >> 8));
+    ASSERT_EQ(state.slope, before.slope);
+    ASSERT_EQ(state.p00, before.p00);
+    ASSERT_EQ(state.p01, before.p01);
+    ASSERT_EQ(state.p11, before.p11);
+
+    // The next reading is right where it was expected
+    temperature += 3.0 / 3600.0;
+    kalman_update(&params, &state, (int16_t)std::lround(temperature * 256.0));
+    ASSERT_NEAR(kalman_temperature(&state), temperature * 256.0, 4.0);
+    ASSERT_NEAR(kalman_slope(&params, &state), 3 * 256, 26);
+}
+
+TEST_F(KalmanFixture, slope_scaling_test)
+{
+    // 1°C per 256 samples : 14.0625°C/h at 1 Hz, half of it with 2 seconds in between samples
+    state.slope = 65536;
+    ASSERT_EQ(kalman_slope(&params, &state), 3600);
+    params.sample_period_ms = 2000U;
+    ASSERT_EQ(kalman_slope(&params, &state), 1800);
+
+    // Clamped to the int16_t range
+    state.slope = INT32_MIN;
+    ASSERT_EQ(kalman_slope(&params, &state), INT16_MIN);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
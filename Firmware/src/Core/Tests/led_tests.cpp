@@ -4,6 +4,13 @@
 #include <gtest/gtest.h>
 #include <vector>
 
+// Hardware PWM backend stub : records every duty cycle written
+static std::vector<uint8_t> duties;
+static void record_duty(const uint8_t duty)
+{
+    duties.push_back(duty);
+}
+
 class LedFixture : public ::testing::Test
 {
 protected:
@@ -13,11 +20,14 @@ protected:
         leds[0] = led_io_t{
             .port = &port,
             .pin = 3,
+            .set_duty = nullptr,
         };
         leds[1] = led_io_t{
             .port = &port,
             .pin = 5,
+            .set_duty = nullptr,
         };
+        duties.clear();
 
         time.milliseconds = 0;
         time.seconds = 0;
@@ -220,6 +230,27 @@ TEST_F(LedFixture, led_breathing_get_duty_sawtooth_test)
     ASSERT_EQ(duties[0], 0U);
 }
 
+TEST_F(LedFixture, led_breathing_get_duty_test)
+{
+    // Generated table : off, fully on at half the period, symmetric
+    ASSERT_EQ(LED_BLINK_BREATHING_STEPS % 2U, 0U);
+    ASSERT_EQ(led_breathing_get_duty(0U), 0U);
+    ASSERT_EQ(led_breathing_get_duty(LED_BLINK_BREATHING_STEPS / 2U), 100U);
+    for (uint16_t step = 1U; step < LED_BLINK_BREATHING_STEPS / 2U; step++)
+    {
+        ASSERT_GE(led_breathing_get_duty(step), led_breathing_get_duty(step - 1U));
+        ASSERT_EQ(led_breathing_get_duty(step), led_breathing_get_duty(LED_BLINK_BREATHING_STEPS - step));
+    }
+
+    // Gamma correction : halfway through the ramp looks half as bright with a much lower duty cycle
+    ASSERT_LT(led_breathing_get_duty(LED_BLINK_BREATHING_STEPS / 4U), 30U);
+
+    // Out of range steps are off, they don't wrap around
+    ASSERT_EQ(led_breathing_get_duty(LED_BLINK_BREATHING_STEPS), 0U);
+    ASSERT_EQ(led_breathing_get_duty(LED_BLINK_BREATHING_STEPS + LED_BLINK_BREATHING_STEPS / 2U), 0U);
+    ASSERT_EQ(led_breathing_get_duty(UINT16_MAX), 0U);
+}
+
 TEST_F(LedFixture, led_get_on_time_ticks_test)
 {
     constexpr uint8_t resolution = 5U;  // Milliseconds, what we'd get with a 200 Hz frequency
@@ -239,6 +270,317 @@ TEST_F(LedFixture, led_get_on_time_ticks_test)
     ASSERT_EQ(duty_on_time_map.size(), 101);
 }
 
+TEST_F(LedFixture, led_hardware_pwm_test)
+{
+    leds[0].set_duty = record_duty;
+    led_init(leds, 1U);
+
+    // Blinking and solid states go through the PWM backend as well, the port is left alone
+    led_set_blink_pattern(0U, LED_BLINK_WARNING);
+    led_process(&time);
+    ASSERT_EQ(duties.back(), 100U);
+    time.seconds = LED_BLINK_WARNING_HALF_P;
+    led_process(&time);
+    ASSERT_EQ(duties.back(), 0U);
+
+    led_blink_none_set_io(0U, 1U);
+    led_set_blink_pattern(0U, LED_BLINK_NONE);
+    led_process(&time);
+    ASSERT_EQ(duties.back(), 100U);
+    ASSERT_TRUE(_led_is_off(0));
+
+    mcu_time_t deadline;
+    led_process(&time);
+    ASSERT_FALSE(led_get_next_deadline(&time, &deadline));
+
+    // Breathing only writes the duty cycle when it changes, at most once per step
+    duties.clear();
+    time.seconds = 0;
+    time.milliseconds = 10;
+    led_set_blink_pattern(0U, LED_BLINK_BREATHING);
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), 0U);
+
+    std::vector<uint8_t> expected;
+    uint8_t previous = 100U;
+    for (uint16_t step = 0; step < LED_BLINK_BREATHING_HALF_CYCLE_STEPS; step++)
+    {
+        if (led_breathing_get_duty(step) != previous)
+        {
+            previous = led_breathing_get_duty(step);
+            expected.push_back(previous);
+        }
+    }
+
+    for (uint16_t ms = 10; ms < 10 + (LED_BLINK_BREATHING_HALF_CYCLE_STEPS * LED_BLINK_BREATHING_RESOLUTION_MS); ms++)
+    {
+        time.seconds = ms / 1000U;
+        time.milliseconds = ms % 1000U;
+        led_process(&time);
+    }
+    ASSERT_EQ(duties, expected);
+    ASSERT_EQ(duties[0], 0U);
+
+    // Driver sleeps until the next step
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), 1U);
+    time_add_ms(&time, 1U);
+    led_process(&time);
+    ASSERT_EQ(duties.back(), 100U);
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), LED_BLINK_BREATHING_RESOLUTION_MS);
+
+    // A stalled loop does not slow the breathing down : missed steps are skipped
+    time_add_ms(&time, LED_BLINK_BREATHING_RESOLUTION_MS * (LED_BLINK_BREATHING_HALF_CYCLE_STEPS / 2U));
+    led_process(&time);
+    ASSERT_EQ(duties.back(), led_breathing_get_duty(LED_BLINK_BREATHING_HALF_CYCLE_STEPS * 3U / 2U));
+    ASSERT_TRUE(_led_is_off(0));
+}
+
+TEST_F(LedFixture, led_custom_program_test)
+{
+    // Two fading flashes, then the warning pattern
+    static const uint8_t program[] FLASH_STORAGE = {
+        LED_KF_LEVEL(100U, 50U),
+        LED_KF_RAMP(0U, 100U),
+        LED_KF_REPEAT(0U, 1U),
+        LED_KF_NEXT(LED_BLINK_WARNING),
+    };
+
+    leds[0].set_duty = record_duty;
+    led_init(leds, 1U);
+    led_run_program(0U, program);
+
+    const std::vector<std::pair<uint16_t, uint8_t>> expected = {
+        {0U, 100U},   {49U, 100U},  {50U, 100U},  {100U, 50U},  {125U, 25U}, {150U, 100U}, {200U, 100U},
+        {250U, 50U},  {299U, 1U},   {300U, 100U}, {1299U, 100U}, {1300U, 0U}, {2300U, 100U},
+    };
+    for (auto const &[ms, duty] : expected)
+    {
+        time.seconds = ms / 1000U;
+        time.milliseconds = ms % 1000U;
+        led_process(&time);
+        ASSERT_EQ(duties.back(), duty) << "at " << ms << " ms";
+    }
+
+    // Keyframes are chained on an exact schedule, however late they are processed
+    duties.clear();
+    time.seconds = 0;
+    time.milliseconds = 0;
+    led_run_program(0U, program);
+    led_process(&time);
+    time.milliseconds = 240U;
+    led_process(&time);
+    ASSERT_EQ(duties, std::vector<uint8_t>{60U});
+}
+
+TEST_F(LedFixture, led_next_event_test)
+{
+    led_init(leds, 1U);
+
+    // Accept pattern, then back to a solid IO state
+    led_set_blink_pattern(0U, LED_BLINK_ACCEPT);
+    led_next_event_t event = {.kind = LED_NEXT_EVENT_IO_STATE, .data = {.io_state = 1U}};
+    led_set_next_event(0U, &event);
+    for (uint16_t ms = 0; ms < LED_BLINK_ACCEPT_PERIOD_MS - 1U; ms++)
+    {
+        time.milliseconds = ms;
+        led_process(&time);
+    }
+    ASSERT_TRUE(_led_is_off(0));
+    time.milliseconds = LED_BLINK_ACCEPT_PERIOD_MS - 1U;
+    led_process(&time);
+    ASSERT_TRUE(_led_is_on(0));
+
+    mcu_time_t deadline;
+    ASSERT_FALSE(led_get_next_deadline(&time, &deadline));
+
+    // Solid LEDs follow their IO state right away, running patterns are not interrupted
+    led_blink_none_set_io(0U, 0U);
+    led_process(&time);
+    ASSERT_TRUE(_led_is_off(0));
+
+    led_set_blink_pattern(0U, LED_BLINK_WARNING);
+    led_process(&time);
+    led_blink_none_set_io(0U, 0U);
+    led_process(&time);
+    ASSERT_TRUE(_led_is_on(0));
+
+    // Accept pattern chained with the breathing pattern
+    leds[0].set_duty = record_duty;
+    led_init(leds, 1U);
+    time.seconds = 0;
+    time.milliseconds = 0;
+    led_set_blink_pattern(0U, LED_BLINK_ACCEPT);
+    event = {.kind = LED_NEXT_EVENT_PATTERN, .data = {.pattern = LED_BLINK_BREATHING}};
+    led_set_next_event(0U, &event);
+    led_process(&time);
+    ASSERT_EQ(duties.back(), 100U);
+
+    time.milliseconds = LED_BLINK_ACCEPT_PERIOD_MS - 1U;
+    led_process(&time);
+    ASSERT_EQ(duties.back(), led_breathing_get_duty(0U));
+    time_add_ms(&time, LED_BLINK_BREATHING_RESOLUTION_MS * (LED_BLINK_BREATHING_HALF_CYCLE_STEPS / 2U));
+    led_process(&time);
+    ASSERT_EQ(duties.back(), led_breathing_get_duty(LED_BLINK_BREATHING_HALF_CYCLE_STEPS / 2U));
+
+    // Event is consumed : a new accept pattern settles on the solid IO state
+    led_set_blink_pattern(0U, LED_BLINK_ACCEPT);
+    led_process(&time);
+    time_add_ms(&time, LED_BLINK_ACCEPT_PERIOD_MS);
+    led_process(&time);
+    ASSERT_FALSE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(duties.back(), 0U);
+}
+
+TEST_F(LedFixture, led_deadline_test)
+{
+    led_init(leds, 1U);
+    mcu_time_t deadline;
+
+    // Started programs are due right away, settled LEDs have no deadline
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), 0U);
+    led_process(&time);
+    ASSERT_FALSE(led_get_next_deadline(&time, &deadline));
+
+    // Warning pattern : nothing to do until the next edge
+    led_set_blink_pattern(0U, LED_BLINK_WARNING);
+    led_process(&time);
+    ASSERT_TRUE(_led_is_on(0));
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), LED_BLINK_WARNING_HALF_P * 1000U);
+
+    // Processing before the deadline is skipped altogether (the port is left alone)
+    port = 0;
+    time.milliseconds = 500U;
+    led_process(&time);
+    ASSERT_TRUE(_led_is_off(0));
+    time.seconds = LED_BLINK_WARNING_HALF_P;
+    time.milliseconds = 0U;
+    led_process(&time);
+    ASSERT_TRUE(_led_is_off(0));
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), (LED_BLINK_WARNING_PERIOD_S - LED_BLINK_WARNING_HALF_P) * 1000U);
+
+    // Software PWM : next edge is the end of the on time, then the end of the window
+    static const uint8_t half[] FLASH_STORAGE = {LED_KF_LEVEL(50U, 0U)};
+    led_run_program(0U, half);
+    led_process(&time);
+    const uint8_t on_ticks = led_get_on_time_ticks(50U, LED_BLINK_BREATHING_RESOLUTION_MS, LED_BLINK_BREATHING_DUTY_INCREMENT_PER_RESOLUTION_POINT);
+    ASSERT_TRUE(_led_is_on(0));
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), on_ticks);
+    time = deadline;
+    led_process(&time);
+    ASSERT_TRUE(_led_is_off(0));
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), LED_BLINK_BREATHING_RESOLUTION_MS - on_ticks);
+
+    // Hardware PWM : a level held forever needs no processing, ramps are due on every duty cycle unit
+    static const uint8_t fade[] FLASH_STORAGE = {LED_KF_RAMP(100U, 1000U), LED_KF_LEVEL(100U, 0U)};
+    leds[0].set_duty = record_duty;
+    led_init(leds, 1U);
+    time.seconds = 0;
+    time.milliseconds = 0;
+    led_run_program(0U, fade);
+    led_process(&time);
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), 10U);
+    while (led_get_next_deadline(&time, &deadline))
+    {
+        time = deadline;
+        led_process(&time);
+    }
+    ASSERT_EQ(duties.size(), 101U);
+    ASSERT_EQ(duties.back(), 100U);
+    ASSERT_EQ(time.milliseconds, 0U);
+    ASSERT_EQ(time.seconds, 1U);
+}
+
+TEST_F(LedFixture, led_multiple_leds_test)
+{
+    ASSERT_GE(MAX_LED_COUNT, 3U);
+
+    // Two LEDs share a port with an unrelated output, the third one has its own port
+    volatile uint8_t other_port = 0;
+    port = (1U << 7U);
+    const led_io_t ios[3U] = {
+        {.port = &port, .pin = 3, .set_duty = nullptr},
+        {.port = &port, .pin = 5, .set_duty = nullptr},
+        {.port = &other_port, .pin = 0, .set_duty = nullptr},
+    };
+    led_init(ios, 3U);
+
+    led_set_blink_pattern(0U, LED_BLINK_WARNING);
+    led_set_blink_pattern(1U, LED_BLINK_ACCEPT);
+    led_blink_none_set_io(2U, 1U);
+    led_process(&time);
+    ASSERT_EQ(port, (1U << 7U) | (1U << 3U) | (1U << 5U));
+    ASSERT_EQ(other_port, 1U);
+
+    // Each LED follows its own schedule, the other bits of the port are left alone
+    time.milliseconds = LED_BLINK_ACCEPT_ON_TIME_MS;
+    led_process(&time);
+    ASSERT_EQ(port, (1U << 7U) | (1U << 3U));
+
+    mcu_time_t deadline;
+    ASSERT_TRUE(led_get_next_deadline(&time, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&time, &deadline), LED_BLINK_ACCEPT_CYCLE_PERIOD_MS - LED_BLINK_ACCEPT_ON_TIME_MS);
+
+    time.seconds = LED_BLINK_WARNING_HALF_P;
+    time.milliseconds = 0;
+    led_process(&time);
+    ASSERT_EQ(port, (1U << 7U));
+    ASSERT_EQ(other_port, 1U);
+
+    led_blink_none_set_io(2U, 0U);
+    led_process(&time);
+    ASSERT_EQ(other_port, 0U);
+    ASSERT_EQ(port, (1U << 7U));
+}
+
+TEST_F(LedFixture, led_pulse_stuffing_test)
+{
+    if (LED_PWM_PULSE_STUFFING != 1)
+    {
+        GTEST_SKIP() << "Pulse stuffing is disabled";
+    }
+
+    // 37 % is not a whole number of ticks per window : 7 and 8 ticks windows alternate, the average is exact
+    static const uint8_t level[] FLASH_STORAGE = {LED_KF_LEVEL(37U, 0U)};
+    led_init(leds, 1U);
+    led_run_program(0U, level);
+
+    uint32_t on_ms = 0;
+    std::vector<uint8_t> windows;
+    uint8_t window_on = 0;
+    for (uint32_t ms = 0; ms < 100U * LED_BLINK_BREATHING_RESOLUTION_MS; ms++)
+    {
+        time.seconds = ms / 1000U;
+        time.milliseconds = ms % 1000U;
+        led_process(&time);
+        on_ms += _read_pin(0);
+        window_on += _read_pin(0);
+        if ((ms % LED_BLINK_BREATHING_RESOLUTION_MS) == LED_BLINK_BREATHING_RESOLUTION_MS - 1U)
+        {
+            windows.push_back(window_on);
+            window_on = 0;
+        }
+    }
+    ASSERT_EQ(on_ms, 37U * LED_BLINK_BREATHING_RESOLUTION_MS);
+
+    // Every 5 windows hold the exact duty cycle
+    for (size_t i = 0; i < windows.size(); i++)
+    {
+        ASSERT_TRUE(windows[i] == 7U || windows[i] == 8U);
+        if ((i % 5U) == 4U)
+        {
+            ASSERT_EQ(windows[i] + windows[i - 1U] + windows[i - 2U] + windows[i - 3U] + windows[i - 4U], 37U);
+        }
+    }
+}
+
 TEST_F(LedFixture, led_process_pattern_breathing_test)
 {
     GTEST_SKIP() << "Test skipped as led breathing pattern test is not trivial to write (...)";
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include "pid.h"
+
+class PidFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        params.kp = 100;
+        params.ki = 0;
+        params.kd = 0;
+        params.derivative_shift = 0;
+        params.sample_period_s = 60;
+        params.output_min = 0;
+        params.output_max = 1000;
+        pid_init(&state);
+
+        window_params.window_s = 3600;
+        window_params.min_on_s = 600;
+        window_params.min_off_s = 300;
+        window_params.min_idle_s = 0;
+        pid_window_init(&window);
+    }
+
+    pid_params_t params;
+    pid_state_t state;
+    pid_window_params_t window_params;
+    pid_window_t window;
+};
+
+TEST_F(PidFixture, proportional_test)
+{
+    // 2°C above the setpoint : 2 x 100 permille
+    ASSERT_TRUE(pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(6), 0, 0));
+    ASSERT_EQ(state.output, 200);
+
+    // Sample period not elapsed yet
+    ASSERT_FALSE(pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(8), 0, 59));
+    ASSERT_EQ(state.output, 200);
+
+    // Half a degree below the setpoint : output is clamped to the minimum
+    ASSERT_TRUE(pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(4) - PID_Q8_ONE / 2, 0, 60));
+    ASSERT_EQ(state.output, 0);
+
+    // Saturates to the maximum, huge errors do not overflow
+    ASSERT_TRUE(pid_update(&params, &state, PID_TO_Q8(-40), PID_TO_Q8(80), 0, 120));
+    ASSERT_EQ(state.output, 1000);
+}
+
+TEST_F(PidFixture, integral_test)
+{
+    params.kp = 0;
+    params.ki = 2 * PID_Q8_ONE;
+
+    // 1°C above the setpoint : +2 permille per sample
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(5), 0, i * 60);
+    }
+    ASSERT_EQ(state.output, 20);
+
+    // Fractional gains accumulate : 1/4 permille per sample
+    pid_init(&state);
+    params.ki = PID_Q8_ONE / 4;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(5), 0, i * 60);
+    }
+    ASSERT_EQ(state.output, 2);
+}
+
+TEST_F(PidFixture, anti_windup_test)
+{
+    params.kp = 100;
+    params.ki = 50 * PID_Q8_ONE;
+
+    // Long saturation : the integral stops growing once the output saturates (500 from P, 500 from I)
+    uint32_t now = 0;
+    for (; now < 100 * 60; now += 60)
+    {
+        pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(9), 0, now);
+    }
+    ASSERT_EQ(state.output, 1000);
+    ASSERT_EQ(state.integral, (int32_t)500 << 16);
+
+    // Back below the setpoint : the output leaves saturation right away
+    pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(3), 0, now);
+    ASSERT_LT(state.output, 1000);
+    ASSERT_GT(state.output, 0);
+
+    // The integral drains until the proportional term alone saturates the output low, then keeps its duty estimate
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        now += 60;
+        pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(2), 0, now);
+    }
+    ASSERT_EQ(state.output, 0);
+    ASSERT_EQ(state.integral, (int32_t)150 << 16);
+}
+
+TEST_F(PidFixture, derivative_test)
+{
+    params.kp = 0;
+    params.kd = 100;
+    params.derivative_shift = 2;
+
+    // Steady temperature : no derivative, whatever the setpoint
+    pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(6), 0, 0);
+    ASSERT_EQ(state.output, 0);
+
+    // Warming up by 2°C/h : filtered step towards 2 x 100 permille, 1/4 of it first
+    pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(6), PID_TO_Q8(2), 60);
+    ASSERT_EQ(state.output, 50);
+    pid_update(&params, &state, PID_TO_Q8(4), PID_TO_Q8(6), PID_TO_Q8(2), 120);
+    ASSERT_EQ(state.output, 87);
+
+    // No kick when the setpoint changes
+    pid_update(&params, &state, PID_TO_Q8(0), PID_TO_Q8(6), PID_TO_Q8(2), 180);
+    ASSERT_EQ(state.output, 115);
+
+    // Settles on the raw term
+    for (uint32_t i = 4; i < 40; i++)
+    {
+        pid_update(&params, &state, PID_TO_Q8(0), PID_TO_Q8(6), PID_TO_Q8(2), i * 60);
+    }
+    ASSERT_NEAR(state.output, 200, 1);
+
+    // Cooling down : derivative decays and then pulls the output down
+    pid_update(&params, &state, PID_TO_Q8(0), PID_TO_Q8(6), -PID_TO_Q8(2), 40 * 60);
+    ASSERT_LT(state.output, 199);
+}
+
+TEST_F(PidFixture, window_duty_test)
+{
+    // 25% duty : runs for the first quarter of the window
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 250, false, 0, 1000));
+    ASSERT_EQ(window.on_s, 900U);
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 250, true, 1000, 1899));
+
+    // Output changes are followed while running
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 600, true, 1000, 1900));
+    ASSERT_EQ(window.on_s, 2160U);
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 600, true, 1000, 3159));
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 600, true, 1000, 3160));
+
+    // A rising output after the stop restarts within the window once the restart protection is over
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 900, false, 3160, 3459));
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 900, false, 3160, 3460));
+
+    // Next window
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 500, false, 3160, 4600));
+    ASSERT_EQ(window.start, 4600U);
+}
+
+TEST_F(PidFixture, window_min_on_off_test)
+{
+    // 10% duty (360 s) is too short to be worth a start
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 100, false, 0, 0));
+    ASSERT_EQ(window.on_s, 360U);
+
+    // Remaining on time is too short as well
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 300, false, 0, 480));
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 300, false, 0, 481));
+
+    // 95% duty leaves less than the restart protection off : runs through the whole window
+    pid_window_init(&window);
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 950, false, 0, 0));
+    ASSERT_EQ(window.on_s, 3600U);
+
+    // The next window waits for the restart protection
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 500, false, 3500, 3700));
+    ASSERT_EQ(window.start, 0U);
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 500, false, 3500, 3800));
+    ASSERT_EQ(window.start, 3800U);
+
+    // A running compressor honors the minimum run time even if the on time is shorter
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 0, true, 7300, 7400));
+    ASSERT_EQ(window.on_s, 0U);
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 0, true, 7300, 7899));
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 0, true, 7300, 7900));
+}
+
+TEST_F(PidFixture, window_min_idle_test)
+{
+    window_params.min_idle_s = 7200;
+
+    // Half duty : runs for the first half of the window
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 500, false, 0, 0));
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 500, true, 0, 1800));
+
+    // The next window waits for the rest, even if the output rises
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 900, false, 1800, 3600));
+    ASSERT_EQ(window.start, 0U);
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 900, false, 1800, 8999));
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 900, false, 1800, 9000));
+    ASSERT_EQ(window.start, 9000U);
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 900, true, 9000, 12240));
+
+    // A saturated output only waits for the restart protection
+    ASSERT_FALSE(pid_window_demand(&window_params, &window, 990, false, 12240, 12600));
+    ASSERT_EQ(window.start, 9000U);
+    ASSERT_TRUE(pid_window_demand(&window_params, &window, 1000, false, 12240, 12600));
+    ASSERT_EQ(window.start, 12600U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "pipeline.h"
+#include "thermistor_ntc_100k_3950K.h"
+
+class PipelineFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        pipeline_init(&pipeline, &sensors, &thermistor_ntc_100k_3950K_data);
+        pipeline.app.config.target_temperature = 4;
+        pipeline.app.config.current_threshold  = 500;
+    }
+
+    // ADC code whose reading is the closest to a temperature
+    uint16_t code_for(const int16_t temperature_q8) const
+    {
+        const auto error = [&](const uint16_t code)
+        { return std::abs(sensors_temperature_q8_from_adc(&sensors, &thermistor_ntc_100k_3950K_data, code) - temperature_q8); };
+
+        uint16_t best = 0U;
+        for (uint16_t code = 1U; code < 1024U; code++)
+        {
+            best = (error(code) < error(best)) ? code : best;
+        }
+        return best;
+    }
+
+    static mcu_time_t make_time(const uint32_t seconds, const uint16_t milliseconds)
+    {
+        return mcu_time_t{.seconds = seconds, .milliseconds = milliseconds};
+    }
+
+    const sensors_config_t sensors = {.vcc_mv = 5000U, .upper_resistance = 330U, .current_dc_bias_mv = 2390};
+    pipeline_t pipeline;
+    app_outputs_t outputs;
+};
+
+TEST_F(PipelineFixture, conversions_test)
+{
+    // Filtered : the first sample starts the filter at the finer reading, rounded up to the degree like the raw reading
+    pipeline_sample_temperature(&pipeline, 386U);
+    const int16_t reading_q8 = sensors_temperature_q8_from_adc(&sensors, &thermistor_ntc_100k_3950K_data, 386U);
+    ASSERT_EQ(pipeline.temperature_q8, reading_q8);
+    ASSERT_EQ(pipeline.temperature, (reading_q8 + 255) / 256);
+    ASSERT_EQ(pipeline.temperature, sensors_temperature_from_adc(&sensors, &thermistor_ntc_100k_3950K_data, 386U));
+    ASSERT_EQ(pipeline.temperature_slope, 0);
+
+    // Unfiltered : raw readings, 1°C resolution
+    pipeline.temperature_filter = false;
+    pipeline_sample_temperature(&pipeline, 300U);
+    ASSERT_EQ(pipeline.temperature, sensors_temperature_from_adc(&sensors, &thermistor_ntc_100k_3950K_data, 300U));
+    ASSERT_EQ(pipeline.temperature_q8, pipeline.temperature * 256);
+
+    // Same RMS reading as the Core current pipeline fed by hand
+    current_rms_window_t window;
+    current_rms_window_init(&window);
+    int16_t expected_rms = 0;
+    for (uint16_t i = 0; i < CURRENT_MEASURE_SAMPLES_PER_SINE; i++)
+    {
+        const uint16_t raw = (uint16_t)(400U + 10U * i);
+        const int16_t current_ma = sensors_current_from_adc(&sensors, raw);
+        current_rms_window_compute_sine(&window, &current_ma, &expected_rms);
+        pipeline_sample_current(&pipeline, raw);
+        ASSERT_EQ(pipeline.current_ma, current_ma);
+    }
+    ASSERT_EQ(pipeline.current_rms, expected_rms);
+}
+
+TEST_F(PipelineFixture, temperature_filter_test)
+{
+    // Readings flickering over 3 ADC codes (≈ 0.25°C) : the filtered reading stays within the codes and does not flicker to the degree
+    const uint16_t codes[] = {385U, 386U, 387U, 386U};
+    const int16_t low_q8 = sensors_temperature_q8_from_adc(&sensors, &thermistor_ntc_100k_3950K_data, 387U);
+    const int16_t high_q8 = sensors_temperature_q8_from_adc(&sensors, &thermistor_ntc_100k_3950K_data, 385U);
+    for (uint16_t i = 0; i < 600U; i++)
+    {
+        pipeline_sample_temperature(&pipeline, codes[i % 4U]);
+    }
+
+    const int8_t settled = pipeline.temperature;
+    for (uint16_t i = 0; i < 600U; i++)
+    {
+        pipeline_sample_temperature(&pipeline, codes[i % 4U]);
+        ASSERT_GE(pipeline.temperature_q8, low_q8);
+        ASSERT_LE(pipeline.temperature_q8, high_q8);
+        ASSERT_EQ(pipeline.temperature, settled);
+    }
+
+    // No trend either : less than 0.25°C/h
+    ASSERT_LT(std::abs(pipeline.temperature_slope), 64);
+}
+
+TEST_F(PipelineFixture, adaptive_sampling_test)
+{
+    // Steady at 2°C, 4°C below the start threshold (target + 2°C) : longest period
+    const uint16_t cold = code_for(2 * 256);
+    pipeline_sample_temperature(&pipeline, cold);
+    ASSERT_EQ(pipeline.temperature_period, SAMPLING_MAX_PERIOD);
+    ASSERT_EQ(pipeline_temperature_period_ms(&pipeline), SAMPLING_MAX_PERIOD * KALMAN_SAMPLE_PERIOD_MS);
+
+    // Skipped readings are predicted over : a steady temperature stays put
+    for (uint16_t i = 0; i < 100U; i++)
+    {
+        pipeline_sample_temperature(&pipeline, cold);
+    }
+    ASSERT_EQ(pipeline.temperature_q8, sensors_temperature_q8_from_adc(&sensors, &thermistor_ntc_100k_3950K_data, cold));
+    ASSERT_EQ(pipeline.temperature_slope, 0);
+
+    // Compressor running : the stop threshold (0.25°C away) is the one that matters now
+    pipeline_init(&pipeline, &sensors, &thermistor_ntc_100k_3950K_data);
+    pipeline.app.config.target_temperature = 4;
+    pipeline.app.motor_on = true;
+    pipeline_sample_temperature(&pipeline, code_for(2 * 256 - 192));
+    ASSERT_EQ(pipeline.temperature_period, 1U);
+
+    // A door opening going on : every reading counts
+    pipeline.app.motor_on = false;
+    pipeline.app.transient.phase = TRANSIENT_SPIKE;
+    pipeline_sample_temperature(&pipeline, cold);
+    ASSERT_EQ(pipeline.temperature_period, 1U);
+
+    // Fixed rate, and raw readings have no slope to rely on
+    pipeline.app.transient.phase = TRANSIENT_NONE;
+    pipeline.adaptive_sampling = false;
+    pipeline_sample_temperature(&pipeline, cold);
+    ASSERT_EQ(pipeline.temperature_period, 1U);
+    pipeline.adaptive_sampling = true;
+    pipeline.temperature_filter = false;
+    pipeline_sample_temperature(&pipeline, cold);
+    ASSERT_EQ(pipeline.temperature_period, 1U);
+}
+
+TEST_F(PipelineFixture, buttons_and_step_test)
+{
+    // Buttons are active low : released, plus pressed, then released
+    const mcu_time_t idle = make_time(0, 990);
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_PLUS | PIPELINE_BUTTON_MINUS, &idle);
+    pipeline_step(&pipeline, &idle, &outputs);
+
+    mcu_time_t deadline;
+    ASSERT_FALSE(pipeline_buttons_deadline(&pipeline, &deadline));
+
+    // Press is only accepted once the level stayed stable for the debouncing delay
+    const mcu_time_t pressed = make_time(1, 0);
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_MINUS, &pressed);
+    ASSERT_TRUE(pipeline_buttons_deadline(&pipeline, &deadline));
+    ASSERT_EQ(deadline.milliseconds, BUTTON_DEBOUNCE_MS);
+    const mcu_time_t accepted = deadline;
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_MINUS, &accepted);
+    ASSERT_TRUE(pipeline.buttons[BUTTON_PLUS].pressed);
+    ASSERT_FALSE(pipeline.buttons[BUTTON_MINUS].pressed);
+    pipeline_step(&pipeline, &accepted, &outputs);
+    ASSERT_FALSE(outputs.events & APP_EVENT_TARGET_INCREASED);
+
+    // Next deadline is the long press, from the accepted press
+    ASSERT_TRUE(pipeline_buttons_deadline(&pipeline, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&accepted, &deadline), GESTURE_LONG_PRESS_MS);
+
+    const mcu_time_t released = make_time(1, 100);
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_PLUS | PIPELINE_BUTTON_MINUS, &released);
+    pipeline_step(&pipeline, &released, &outputs);
+    const mcu_time_t settled = make_time(1, 100 + BUTTON_DEBOUNCE_MS);
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_PLUS | PIPELINE_BUTTON_MINUS, &settled);
+    pipeline_step(&pipeline, &settled, &outputs);
+    ASSERT_FALSE(outputs.events & APP_EVENT_TARGET_INCREASED);
+
+    // Click is raised once no second press came within the double click delay
+    ASSERT_TRUE(pipeline_buttons_deadline(&pipeline, &deadline));
+    ASSERT_EQ(time_elapsed_ms(&settled, &deadline), GESTURE_DOUBLE_CLICK_MS);
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_PLUS | PIPELINE_BUTTON_MINUS, &deadline);
+    pipeline_step(&pipeline, &deadline, &outputs);
+    ASSERT_TRUE(outputs.events & APP_EVENT_TARGET_INCREASED);
+    ASSERT_EQ(pipeline.app.config.target_temperature, 5);
+    ASSERT_EQ(pipeline.gesture_events.count, 0U);
+    ASSERT_FALSE(pipeline_buttons_deadline(&pipeline, &deadline));
+}
+
+TEST_F(PipelineFixture, wall_clock_test)
+{
+    const mcu_time_t boot = make_time(10, 0);
+    pipeline_step(&pipeline, &boot, &outputs);
+    ASSERT_EQ(pipeline.time_of_day, APP_TIME_OF_DAY_UNKNOWN);
+
+    // Host sends 2025-01-01 16:30 : pre-cooling right away
+    pipeline_sync_clock(&pipeline, &boot, 1735689600UL + 16U * 3600U + 30U * 60U);
+    const mcu_time_t synced = make_time(10, 1);
+    pipeline_step(&pipeline, &synced, &outputs);
+    ASSERT_EQ(pipeline.time_of_day, 16U * 60U + 30U);
+    ASSERT_TRUE(outputs.events & APP_EVENT_SCHEDULE_CHANGED);
+    ASSERT_EQ(pipeline.app.schedule, SCHEDULE_PRECOOL);
+
+    // Time of day follows the MCU time, then wraps at midnight
+    const mcu_time_t later = make_time(10 + 3600, 0);
+    pipeline_step(&pipeline, &later, &outputs);
+    ASSERT_EQ(pipeline.time_of_day, 17U * 60U + 30U);
+    ASSERT_EQ(pipeline.app.schedule, SCHEDULE_PEAK);
+    const mcu_time_t next_day = make_time(10 + 8 * 3600, 0);
+    pipeline_step(&pipeline, &next_day, &outputs);
+    ASSERT_EQ(pipeline.time_of_day, 30U);
+    ASSERT_EQ(pipeline.app.schedule, SCHEDULE_NONE);
+
+    // Clock survives a snapshot
+    uint8_t snapshot[PIPELINE_SNAPSHOT_SIZE];
+    pipeline_snapshot_write(&pipeline, snapshot);
+    pipeline_t restored;
+    pipeline_init(&restored, &sensors, &thermistor_ntc_100k_3950K_data);
+    ASSERT_TRUE(pipeline_snapshot_read(&restored, snapshot));
+    pipeline_step(&restored, &next_day, &outputs);
+    ASSERT_EQ(restored.time_of_day, 30U);
+}
+
+TEST_F(PipelineFixture, snapshot_test)
+{
+    pipeline_sample_temperature(&pipeline, 300U);
+    for (uint16_t i = 0; i < 7U; i++)
+    {
+        pipeline_sample_current(&pipeline, (uint16_t)(300U + 50U * i));
+    }
+    const mcu_time_t idle = make_time(42, 490);
+    const mcu_time_t now = make_time(42, 500);
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_PLUS | PIPELINE_BUTTON_MINUS, &idle);
+    pipeline_sample_buttons(&pipeline, PIPELINE_BUTTON_PLUS, &now);
+    pipeline_step(&pipeline, &now, &outputs);
+
+    uint8_t snapshot[PIPELINE_SNAPSHOT_SIZE];
+    pipeline_snapshot_write(&pipeline, snapshot);
+
+    pipeline_t restored;
+    pipeline_init(&restored, &sensors, &thermistor_ntc_100k_3950K_data);
+    ASSERT_TRUE(pipeline_snapshot_read(&restored, snapshot));
+
+    uint8_t again[PIPELINE_SNAPSHOT_SIZE];
+    pipeline_snapshot_write(&restored, again);
+    ASSERT_EQ(memcmp(snapshot, again, PIPELINE_SNAPSHOT_SIZE), 0);
+    ASSERT_EQ(restored.app.mode, pipeline.app.mode);
+    ASSERT_EQ(restored.app.config.current_threshold, 500U);
+    ASSERT_TRUE(restored.buttons[BUTTON_MINUS].level);
+    ASSERT_EQ(restored.buttons[BUTTON_MINUS].changed.milliseconds, 500U);
+    ASSERT_EQ(restored.current_window.capacity, 7U);
+    ASSERT_EQ(restored.current_rms, pipeline.current_rms);
+
+    // Both pipelines now behave the same
+    app_outputs_t restored_outputs;
+    const mcu_time_t later = make_time(60, 0);
+    pipeline_sample_temperature(&pipeline, 200U);
+    pipeline_sample_temperature(&restored, 200U);
+    pipeline_step(&pipeline, &later, &outputs);
+    pipeline_step(&restored, &later, &restored_outputs);
+    ASSERT_EQ(outputs.motor_on, restored_outputs.motor_on);
+    ASSERT_EQ(outputs.events, restored_outputs.events);
+
+    // Out of range values are rejected (application mode follows the 63 bytes of parameters)
+    snapshot[63] = 0xFF;
+    ASSERT_FALSE(pipeline_snapshot_read(&restored, snapshot));
+    ASSERT_EQ(restored.app.mode, pipeline.app.mode);
+
+    // So are queued gestures naming an unknown button
+    pipeline.gesture_events.events[0].button = GESTURE_ALL_BUTTONS + 1U;
+    pipeline.gesture_events.count = 1U;
+    pipeline_snapshot_write(&pipeline, snapshot);
+    ASSERT_FALSE(pipeline_snapshot_read(&restored, snapshot));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
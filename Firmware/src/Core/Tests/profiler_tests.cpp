@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "profiler.h"
+
+static uint32_t fake_clock_value = 0;
+static uint32_t fake_clock(void)
+{
+    return fake_clock_value;
+}
+
+class ProfilerFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_clock_value = 0;
+        profiler_init(fake_clock);
+    }
+
+    void TearDown() override
+    {
+        profiler_init(NULL);
+    }
+};
+
+TEST_F(ProfilerFixture, bucket_index_test)
+{
+    ASSERT_EQ(profiler_bucket_index(0), 0U);
+    ASSERT_EQ(profiler_bucket_index(1), 1U);
+    ASSERT_EQ(profiler_bucket_index(2), 2U);
+    ASSERT_EQ(profiler_bucket_index(3), 2U);
+    ASSERT_EQ(profiler_bucket_index(4), 3U);
+    ASSERT_EQ(profiler_bucket_index(1000), 10U);
+
+    // Long durations saturate in the last bucket
+    ASSERT_EQ(profiler_bucket_index(UINT32_MAX), PROFILER_BUCKET_COUNT - 1U);
+}
+
+TEST_F(ProfilerFixture, enter_exit_test)
+{
+    fake_clock_value = 100;
+    profiler_enter(PROFILER_STAGE_LED);
+    fake_clock_value = 150;
+    profiler_exit(PROFILER_STAGE_LED);
+
+    profiler_histogram_t const* histogram = profiler_get_histogram(PROFILER_STAGE_LED);
+    ASSERT_NE(histogram, nullptr);
+    ASSERT_EQ(histogram->buckets[profiler_bucket_index(50)], 1U);
+    ASSERT_EQ(histogram->max, 50U);
+
+    // Clock wrapping around is handled
+    fake_clock_value = UINT32_MAX - 9U;
+    profiler_enter(PROFILER_STAGE_LED);
+    fake_clock_value = 10;
+    profiler_exit(PROFILER_STAGE_LED);
+    ASSERT_EQ(histogram->buckets[profiler_bucket_index(20)], 1U);
+    ASSERT_EQ(histogram->max, 50U);
+
+    // Other stages are left untouched
+    profiler_histogram_t const* other = profiler_get_histogram(PROFILER_STAGE_CURRENT);
+    for (uint8_t i = 0; i < PROFILER_BUCKET_COUNT; i++)
+    {
+        ASSERT_EQ(other->buckets[i], 0U);
+    }
+
+    profiler_reset();
+    ASSERT_EQ(histogram->max, 0U);
+    ASSERT_EQ(histogram->buckets[profiler_bucket_index(50)], 0U);
+}
+
+TEST_F(ProfilerFixture, saturation_and_bounds_test)
+{
+    for (uint32_t i = 0; i < UINT16_MAX + 10U; i++)
+    {
+        profiler_record(PROFILER_STAGE_LOOP, 3);
+    }
+    ASSERT_EQ(profiler_get_histogram(PROFILER_STAGE_LOOP)->buckets[2], UINT16_MAX);
+
+    ASSERT_EQ(profiler_get_histogram(PROFILER_STAGE_COUNT), nullptr);
+    ASSERT_STREQ(profiler_stage_name(PROFILER_STAGE_EEPROM), "eeprom");
+    ASSERT_STREQ(profiler_stage_name(PROFILER_STAGE_COUNT), "unknown");
+
+    // No clock : nothing recorded
+    profiler_init(NULL);
+    profiler_enter(PROFILER_STAGE_LED);
+    profiler_exit(PROFILER_STAGE_LED);
+    ASSERT_EQ(profiler_get_histogram(PROFILER_STAGE_LED)->buckets[0], 0U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
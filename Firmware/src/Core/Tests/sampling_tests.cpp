@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "sampling.h"
+
+class SamplingFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        sampling_params_default(&params);
+    }
+
+    uint8_t next(const int16_t distance, const int16_t slope, const int16_t curvature)
+    {
+        return sampling_next_period(&params, distance, slope, curvature, 1000U);
+    }
+
+    sampling_params_t params;
+};
+
+TEST_F(SamplingFixture, edges_test)
+{
+    // Far away from the threshold and flat : longest period
+    ASSERT_EQ(next(4 * 256, 0, 0), SAMPLING_MAX_PERIOD);
+
+    // Within the margin, or past the threshold : every base period
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN, 0, 0), 1U);
+    ASSERT_EQ(next(-256, 0, 0), 1U);
+
+    // Just outside the margin : (10 / 256)°C at 30°C/h is reached in 4.7 s
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN + 10, 0, 0), 4U);
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN + 5, 0, 0), 2U);
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN + 1, 0, 0), 1U);
+}
+
+TEST_F(SamplingFixture, dynamics_test)
+{
+    // A steep slope brings the threshold closer, either way
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN + 20, 0, 0), 4U);
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN + 20, 90 * 256, 0), 2U);
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN + 20, -90 * 256, 0), 2U);
+    ASSERT_EQ(next(SAMPLING_EDGE_MARGIN + 20, INT16_MAX, 0), 1U);
+
+    // Slope changing fast : every base period, wherever the temperature is
+    ASSERT_EQ(next(INT16_MAX, 0, SAMPLING_FAST_CURVATURE), 1U);
+    ASSERT_EQ(next(INT16_MAX, 0, -SAMPLING_FAST_CURVATURE), 1U);
+    ASSERT_EQ(next(INT16_MAX, INT16_MIN, SAMPLING_FAST_CURVATURE - 1), SAMPLING_MAX_PERIOD);
+}
+
+TEST_F(SamplingFixture, params_test)
+{
+    // Fixed rate
+    params.max_period = 1U;
+    ASSERT_EQ(next(INT16_MAX, 0, 0), 1U);
+
+    // Longer periods, still powers of two
+    params.max_period = 16U;
+    ASSERT_EQ(next(INT16_MAX, 0, 0), 16U);
+    params.max_period = 12U;
+    ASSERT_EQ(next(INT16_MAX, 0, 0), 8U);
+
+    // The period is counted in base periods
+    ASSERT_EQ(sampling_next_period(&params, SAMPLING_EDGE_MARGIN + 10, 0, 0, 2000U), 2U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
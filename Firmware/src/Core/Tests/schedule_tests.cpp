@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "schedule.h"
+
+class ScheduleFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        schedule_params_default(&params);
+        params.peak_start_minute = 17U * 60U;
+        params.peak_end_minute = 21U * 60U;
+        params.precool_minutes = 120U;
+        params.precool_offset = 2U;
+        params.peak_band_extra = 2U;
+        params.min_temperature = 1;
+        params.max_temperature = 8;
+    }
+
+    schedule_params_t params;
+};
+
+TEST_F(ScheduleFixture, phase_test)
+{
+    ASSERT_EQ(schedule_phase(&params, 0U), SCHEDULE_NONE);
+    ASSERT_EQ(schedule_phase(&params, 14U * 60U + 59U), SCHEDULE_NONE);
+    ASSERT_EQ(schedule_phase(&params, 15U * 60U), SCHEDULE_PRECOOL);
+    ASSERT_EQ(schedule_phase(&params, 16U * 60U + 59U), SCHEDULE_PRECOOL);
+    ASSERT_EQ(schedule_phase(&params, 17U * 60U), SCHEDULE_PEAK);
+    ASSERT_EQ(schedule_phase(&params, 20U * 60U + 59U), SCHEDULE_PEAK);
+    ASSERT_EQ(schedule_phase(&params, 21U * 60U), SCHEDULE_NONE);
+
+    // Unknown time of day, no peak hours
+    ASSERT_EQ(schedule_phase(&params, SCHEDULE_MINUTES_PER_DAY), SCHEDULE_NONE);
+    params.peak_end_minute = params.peak_start_minute;
+    ASSERT_EQ(schedule_phase(&params, 18U * 60U), SCHEDULE_NONE);
+}
+
+TEST_F(ScheduleFixture, midnight_test)
+{
+    // Peak hours spanning midnight, pre-cooling before it
+    params.peak_start_minute = 23U * 60U;
+    params.peak_end_minute = 2U * 60U;
+    ASSERT_EQ(schedule_phase(&params, 23U * 60U + 30U), SCHEDULE_PEAK);
+    ASSERT_EQ(schedule_phase(&params, 60U), SCHEDULE_PEAK);
+    ASSERT_EQ(schedule_phase(&params, 2U * 60U), SCHEDULE_NONE);
+    ASSERT_EQ(schedule_phase(&params, 22U * 60U), SCHEDULE_PRECOOL);
+
+    // Pre-cooling spanning midnight
+    params.peak_start_minute = 60U;
+    params.peak_end_minute = 3U * 60U;
+    ASSERT_EQ(schedule_phase(&params, 23U * 60U + 30U), SCHEDULE_PRECOOL);
+    ASSERT_EQ(schedule_phase(&params, 22U * 60U + 59U), SCHEDULE_NONE);
+
+    // Pre-cooling longer than the off-peak hours never covers the peak hours
+    params.precool_minutes = SCHEDULE_MINUTES_PER_DAY;
+    ASSERT_EQ(schedule_phase(&params, 2U * 60U), SCHEDULE_PEAK);
+    ASSERT_EQ(schedule_phase(&params, 4U * 60U), SCHEDULE_PRECOOL);
+}
+
+TEST_F(ScheduleFixture, apply_test)
+{
+    int8_t setpoint = 0;
+    uint8_t high = 1U;
+
+    schedule_apply(&params, SCHEDULE_NONE, 4, &setpoint, &high, 1U);
+    ASSERT_EQ(setpoint, 4);
+    ASSERT_EQ(high, 1U);
+
+    schedule_apply(&params, SCHEDULE_PRECOOL, 4, &setpoint, &high, 1U);
+    ASSERT_EQ(setpoint, 2);
+    ASSERT_EQ(high, 1U);
+
+    schedule_apply(&params, SCHEDULE_PEAK, 4, &setpoint, &high, 1U);
+    ASSERT_EQ(setpoint, 4);
+    ASSERT_EQ(high, 3U);
+}
+
+TEST_F(ScheduleFixture, safety_limits_test)
+{
+    int8_t setpoint = 0;
+    uint8_t high = 2U;
+
+    // Stop threshold can't go below the minimum : 3 - 1 - 1 leaves 1°C of pre-cooling
+    schedule_apply(&params, SCHEDULE_PRECOOL, 3, &setpoint, &high, 1U);
+    ASSERT_EQ(setpoint, 2);
+    schedule_apply(&params, SCHEDULE_PRECOOL, 1, &setpoint, &high, 1U);
+    ASSERT_EQ(setpoint, 1);
+
+    // Start threshold can't go above the maximum : 5 + 2 leaves 1°C of extra band
+    schedule_apply(&params, SCHEDULE_PEAK, 5, &setpoint, &high, 1U);
+    ASSERT_EQ(high, 3U);
+    high = 4U;
+    schedule_apply(&params, SCHEDULE_PEAK, 6, &setpoint, &high, 1U);
+    ASSERT_EQ(high, 4U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
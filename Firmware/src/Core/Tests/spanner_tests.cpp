@@ -1,4 +1,6 @@
+#include <cmath>
 #include <gtest/gtest.h>
+#include <string>
 
 #include "memory.h"
 #include "spanner.h"
@@ -145,6 +147,130 @@ TEST_F(SpannerFixture, check_span_even_corner_cases)
 }
 
 
+// Every run of length calls holds the exact counts, and no prefix drifts by a whole value from the ideal share
+static void check_span_next(const uint8_t a_cnt, const uint8_t b_cnt)
+{
+    const uint16_t length = a_cnt + b_cnt;
+    if(length == 0U)
+    {
+        return;
+    }
+
+    const span_data_t data = {.a_val = 3, .b_val = 4, .a_cnt = a_cnt, .b_cnt = b_cnt, .kind = SPAN_EVEN};
+    uint16_t error = 0;
+    uint16_t b_seen = 0;
+    for(uint16_t call = 1 ; call <= length * 3U ; call++)
+    {
+        const uint8_t value = span_next(&data, &error);
+        ASSERT_TRUE(value == data.a_val || value == data.b_val);
+        b_seen += (value == data.b_val) ? 1U : 0U;
+        ASSERT_LT(error, length);
+        ASSERT_LT(std::fabs(b_seen - (double)call * b_cnt / length), 1.0) << (int)a_cnt << "/" << (int)b_cnt << " call " << call;
+        if(call % length == 0U)
+        {
+            ASSERT_EQ(b_seen, (call / length) * b_cnt) << (int)a_cnt << "/" << (int)b_cnt;
+        }
+    }
+}
+
+TEST_F(SpannerFixture, check_span_next_exact_counts)
+{
+    for(uint8_t a_cnt = 0 ; a_cnt <= 40U ; a_cnt++)
+    {
+        for(uint8_t b_cnt = 0 ; b_cnt <= 40U ; b_cnt++)
+        {
+            check_span_next(a_cnt, b_cnt);
+        }
+    }
+
+    // Sequences longer than 256 : the error accumulator goes past a byte
+    const uint8_t long_counts[][2] = {{150, 250}, {250, 150}, {255, 255}, {1, 255}, {255, 1}, {128, 129}, {200, 57}, {17, 243}};
+    for(const auto &counts : long_counts)
+    {
+        check_span_next(counts[0], counts[1]);
+    }
+    for(uint16_t a_cnt = 0 ; a_cnt <= UINT8_MAX ; a_cnt += 15U)
+    {
+        for(uint16_t b_cnt = 0 ; b_cnt <= UINT8_MAX ; b_cnt += 17U)
+        {
+            check_span_next((uint8_t)a_cnt, (uint8_t)b_cnt);
+        }
+    }
+}
+
+TEST_F(SpannerFixture, check_span_stream_exact_counts)
+{
+    const uint8_t values[SPAN_STREAM_MAX_LEVELS] = {10, 20, 30, 40};
+    for(uint8_t levels = 2 ; levels <= SPAN_STREAM_MAX_LEVELS ; levels++)
+    {
+        for(uint16_t combination = 0 ; combination < std::pow(7, levels) ; combination++)
+        {
+            uint8_t counts[SPAN_STREAM_MAX_LEVELS] = {0};
+            uint16_t digits = combination;
+            for(uint8_t i = 0 ; i < levels ; i++)
+            {
+                counts[i] = digits % 7U;
+                digits /= 7U;
+            }
+
+            span_stream_t stream;
+            if(!span_stream_init(&stream, values, counts, levels))
+            {
+                continue;
+            }
+
+            const uint16_t length = stream.length;
+            uint16_t seen[SPAN_STREAM_MAX_LEVELS] = {0};
+            for(uint16_t call = 1 ; call <= length * 3U ; call++)
+            {
+                const uint8_t value = span_stream_next(&stream);
+                ASSERT_TRUE(value % 10U == 0U && value >= 10U && value <= levels * 10U);
+                seen[value / 10U - 1U]++;
+                for(uint8_t i = 0 ; i < levels ; i++)
+                {
+                    ASSERT_LT(std::fabs(seen[i] - (double)call * counts[i] / length), 1.0);
+                    if(call % length == 0U)
+                    {
+                        ASSERT_EQ(seen[i], (call / length) * counts[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Uniform spread : 1 B in between every 2 A values
+    const uint8_t counts[2] = {6, 3};
+    span_stream_t stream;
+    ASSERT_TRUE(span_stream_init(&stream, values, counts, 2U));
+    std::string sequence;
+    for(uint8_t i = 0 ; i < 9U ; i++)
+    {
+        sequence += (span_stream_next(&stream) == values[0]) ? 'A' : 'B';
+    }
+    ASSERT_EQ(sequence, "ABAABAABA");
+}
+
+TEST_F(SpannerFixture, check_span_stream_invalid)
+{
+    const uint8_t values[SPAN_STREAM_MAX_LEVELS + 1U] = {1, 2, 3, 4, 5};
+    const uint8_t counts[SPAN_STREAM_MAX_LEVELS + 1U] = {200, 100, 1, 1, 1};
+    const uint8_t none[SPAN_STREAM_MAX_LEVELS] = {0};
+    span_stream_t stream = {};
+
+    ASSERT_FALSE(span_stream_init(&stream, values, counts, 0U));
+    ASSERT_FALSE(span_stream_init(&stream, values, counts, SPAN_STREAM_MAX_LEVELS + 1U));
+    ASSERT_FALSE(span_stream_init(&stream, values, none, 2U));
+    ASSERT_FALSE(span_stream_init(&stream, values, counts, 2U));
+    ASSERT_EQ(stream.length, 0U);
+
+    // A single level is a constant
+    ASSERT_TRUE(span_stream_init(&stream, values, counts, 1U));
+    for(uint8_t i = 0 ; i < 10U ; i++)
+    {
+        ASSERT_EQ(span_stream_next(&stream), values[0]);
+    }
+}
+
 
 int main(int argc, char **argv)
 {
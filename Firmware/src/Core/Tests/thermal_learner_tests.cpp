@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "thermal_learner.h"
+
+TEST(ThermalLearner, rate_measure_test)
+{
+    // 3°C in 1 hour, Q8
+    ASSERT_EQ(thermal_rate_measure(3, 3600U), 3U * 256U);
+    ASSERT_EQ(thermal_rate_measure(-3, 3600U), 3U * 256U);
+
+    // 6°C in 30 minutes
+    ASSERT_EQ(thermal_rate_measure(-6, 1800U), 12U * 256U);
+
+    // Degenerate cases
+    ASSERT_EQ(thermal_rate_measure(3, 0U), (uint16_t)THERMAL_RATE_UNKNOWN);
+    ASSERT_EQ(thermal_rate_measure(100, 1U), (uint16_t)THERMAL_RATE_MAX);
+    ASSERT_EQ(thermal_rate_measure(0, 600U), 0U);
+}
+
+TEST(ThermalLearner, rate_learn_test)
+{
+    // First measurement is taken as is
+    uint16_t rate = THERMAL_RATE_UNKNOWN;
+    thermal_rate_learn(&rate, 800U);
+    ASSERT_EQ(rate, 800U);
+
+    // Then moves by 1 / 2^THERMAL_RATE_FILTER_SHIFT of the difference
+    thermal_rate_learn(&rate, 1600U);
+    ASSERT_EQ(rate, 800U + (800U >> THERMAL_RATE_FILTER_SHIFT));
+
+    // Converges, never goes back to unknown
+    for (uint8_t i = 0; i < 200U; i++)
+    {
+        thermal_rate_learn(&rate, 0U);
+    }
+    ASSERT_GT(rate, (uint16_t)THERMAL_RATE_UNKNOWN);
+    ASSERT_LT(rate, 1U << THERMAL_RATE_FILTER_SHIFT);
+}
+
+TEST(ThermalLearner, band_for_cycle_test)
+{
+    // 4°C/h warm-up, 12°C/h cool-down : 3°C/h combined
+    const uint16_t warming = 4U * 256U;
+    const uint16_t cooling = 12U * 256U;
+
+    // 2 hours cycle : 6°C span, 2°C band
+    ASSERT_EQ(thermal_band_for_cycle(warming, cooling, 7200U, 1U, 5U), 2U);
+
+    // Faster warm-up (summer, empty fridge) : wider band for the same cycle, and the other way around
+    ASSERT_EQ(thermal_band_for_cycle(2U * warming, cooling, 7200U, 1U, 5U), 4U);
+    ASSERT_EQ(thermal_band_for_cycle(warming / 2U, cooling, 7200U, 1U, 5U), 1U);
+
+    // Clamped to the limits
+    ASSERT_EQ(thermal_band_for_cycle(warming, cooling, 60U, 1U, 5U), 1U);
+    ASSERT_EQ(thermal_band_for_cycle(warming, cooling, 86400U, 1U, 5U), 5U);
+
+    // Unknown rates
+    ASSERT_EQ(thermal_band_for_cycle(THERMAL_RATE_UNKNOWN, cooling, 7200U, 1U, 5U), 1U);
+
+    // Largest rates do not overflow : 128°C/h combined, 256°C span
+    ASSERT_EQ(thermal_band_for_cycle(THERMAL_RATE_MAX, THERMAL_RATE_MAX, 7200U, 1U, 200U), 127U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "trace.h"
+
+static void write_to_vector(uint8_t const *data, const uint8_t length, void *context)
+{
+    std::vector<uint8_t> *const output = static_cast<std::vector<uint8_t> *>(context);
+    output->insert(output->end(), data, data + length);
+}
+
+class TraceFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        trace_encoder_init(&encoder, write_to_vector, &output);
+        trace_decoder_init(&decoder);
+    }
+
+    static mcu_time_t make_time(const uint32_t seconds, const uint16_t milliseconds)
+    {
+        return mcu_time_t{.seconds = seconds, .milliseconds = milliseconds};
+    }
+
+    std::vector<uint8_t> output;
+    trace_encoder_t encoder;
+    trace_decoder_t decoder;
+};
+
+TEST_F(TraceFixture, round_trip_test)
+{
+    const uint8_t snapshot[3] = {1, 2, 3};
+    mcu_time_t time = make_time(100, 999);
+
+    // Dropped : no sync record yet
+    trace_write_record(&encoder, TRACE_RECORD_CURRENT, &time, 512U);
+    ASSERT_TRUE(output.empty());
+
+    trace_write_sync(&encoder, &time, snapshot, sizeof(snapshot));
+    ASSERT_EQ(output.size(), TRACE_SYNC_HEADER_SIZE + sizeof(snapshot));
+
+    struct expected_t
+    {
+        trace_record_type_t type;
+        uint32_t delta_ms;
+        uint32_t value;
+    };
+    const expected_t expected[] = {
+        {TRACE_RECORD_CURRENT, 0U, 512U},      {TRACE_RECORD_CURRENT, 1U, 530U},     {TRACE_RECORD_TEMPERATURE, 0U, 386U},
+        {TRACE_RECORD_CURRENT, 1U, 0U},        {TRACE_RECORD_CURRENT, 30U, 1023U},   {TRACE_RECORD_BUTTONS, 31U, 3U},
+        {TRACE_RECORD_MOTOR, 70000U, 1U},      {TRACE_RECORD_EVENTS, 0U, 0x8001U},   {TRACE_RECORD_TEMPERATURE, 1000U, 385U},
+        {TRACE_RECORD_CLOCK, 0U, 1735689600U},
+    };
+
+    size_t sizes[sizeof(expected) / sizeof(expected[0])];
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        const size_t before = output.size();
+        time_add_ms(&time, expected[i].delta_ms);
+        trace_write_record(&encoder, expected[i].type, &time, expected[i].value);
+        sizes[i] = output.size() - before;
+    }
+
+    // Small time deltas fit in the tag, small ADC differences in a single byte
+    ASSERT_EQ(sizes[1], 2U);
+    ASSERT_EQ(sizes[2], 3U);
+    ASSERT_EQ(sizes[8], 4U);
+    ASSERT_EQ(sizes[9], 6U);
+
+    trace_record_t record;
+    size_t offset = trace_decode(&decoder, output.data(), output.size(), &record);
+    ASSERT_EQ(offset, TRACE_SYNC_HEADER_SIZE + sizeof(snapshot));
+    ASSERT_EQ(record.type, TRACE_RECORD_SYNC);
+    ASSERT_EQ(record.time.seconds, 100U);
+    ASSERT_EQ(record.time.milliseconds, 999U);
+    ASSERT_EQ(record.snapshot_size, sizeof(snapshot));
+    ASSERT_EQ(record.snapshot[2], 3U);
+
+    mcu_time_t expected_time = make_time(100, 999);
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        const size_t consumed = trace_decode(&decoder, &output[offset], output.size() - offset, &record);
+        ASSERT_EQ(consumed, sizes[i]);
+        offset += consumed;
+
+        time_add_ms(&expected_time, expected[i].delta_ms);
+        ASSERT_EQ(record.type, expected[i].type);
+        ASSERT_EQ(record.value, expected[i].value);
+        ASSERT_EQ(time_compare(&record.time, &expected_time), 0);
+    }
+    ASSERT_EQ(offset, output.size());
+}
+
+TEST_F(TraceFixture, invalid_data_test)
+{
+    const mcu_time_t time = make_time(5, 0);
+    const uint8_t snapshot[4] = {0};
+    trace_write_sync(&encoder, &time, snapshot, sizeof(snapshot));
+    trace_write_record(&encoder, TRACE_RECORD_TEMPERATURE, &time, 600U);
+
+    trace_record_t record;
+
+    // Samples can't be decoded before a sync record
+    const size_t sync_size = TRACE_SYNC_HEADER_SIZE + sizeof(snapshot);
+    ASSERT_EQ(trace_decode(&decoder, &output[sync_size], output.size() - sync_size, &record), 0U);
+
+    // Truncated records
+    ASSERT_EQ(trace_decode(&decoder, output.data(), sync_size - 1U, &record), 0U);
+    ASSERT_EQ(trace_decode(&decoder, output.data(), sync_size, &record), sync_size);
+    ASSERT_EQ(trace_decode(&decoder, &output[sync_size], 1U, &record), 0U);
+
+    // Unknown record type
+    const uint8_t unknown[2] = {6U << 5U, 0U};
+    ASSERT_EQ(trace_decode(&decoder, unknown, sizeof(unknown), &record), 0U);
+
+    // Only wall clock records hold values beyond 16 bits
+    const uint8_t too_large[4] = {TRACE_RECORD_MOTOR << 5U, 0x80U, 0x80U, 0x04U};
+    ASSERT_EQ(trace_decode(&decoder, too_large, sizeof(too_large), &record), 0U);
+
+    // Resynchronization on a capture started mid-stream
+    std::vector<uint8_t> capture = {0x12, 0x7F, 0xE0, 0x4E};
+    capture.insert(capture.end(), output.begin(), output.end());
+    const size_t sync = trace_find_sync(capture.data(), capture.size());
+    ASSERT_EQ(sync, 4U);
+    ASSERT_EQ(trace_find_sync(capture.data(), 3U), 3U);
+
+    trace_decoder_init(&decoder);
+    ASSERT_EQ(trace_decode(&decoder, &capture[sync], capture.size() - sync, &record), sync_size);
+    ASSERT_EQ(trace_decode(&decoder, &capture[sync + sync_size], capture.size() - sync - sync_size, &record), 3U);
+    ASSERT_EQ(record.value, 600U);
+}
+
+TEST_F(TraceFixture, large_snapshot_test)
+{
+    // Snapshots beyond 255 bytes are written in several chunks
+    const mcu_time_t time = make_time(7, 250);
+    std::vector<uint8_t> snapshot(300U);
+    for (size_t i = 0; i < snapshot.size(); i++)
+    {
+        snapshot[i] = (uint8_t)i;
+    }
+    trace_write_sync(&encoder, &time, snapshot.data(), (uint16_t)snapshot.size());
+    ASSERT_EQ(output.size(), TRACE_SYNC_HEADER_SIZE + snapshot.size());
+
+    trace_record_t record;
+    ASSERT_EQ(trace_decode(&decoder, output.data(), output.size(), &record), output.size());
+    ASSERT_EQ(record.type, TRACE_RECORD_SYNC);
+    ASSERT_EQ(record.snapshot_size, snapshot.size());
+    ASSERT_EQ(memcmp(record.snapshot, snapshot.data(), snapshot.size()), 0);
+
+    // Truncated to the largest snapshot
+    output.clear();
+    snapshot.resize(TRACE_SNAPSHOT_MAX_SIZE + 1U);
+    trace_write_sync(&encoder, &time, snapshot.data(), (uint16_t)snapshot.size());
+    ASSERT_EQ(output.size(), TRACE_RECORD_MAX_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
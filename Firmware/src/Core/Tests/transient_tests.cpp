@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "transient.h"
+
+class TransientFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        transient_params_default(&params);
+        transient_init(&state);
+    }
+
+    bool filter(const int16_t slope, const int16_t curvature, const int16_t excess, const bool demand, const uint32_t now)
+    {
+        return transient_filter_start(&params, &state, slope, curvature, excess, demand, now);
+    }
+
+    transient_params_t params;
+    transient_state_t state;
+};
+
+TEST_F(TransientFixture, curvature_test)
+{
+    // Slope rising by 0.1°C/h every second : about 6°C/h per minute once the moving average settled
+    int16_t curvature = 0;
+    int16_t slope = 0;
+    for (uint16_t i = 0; i < 60U; i++)
+    {
+        transient_curvature_update(&curvature, slope, (int16_t)(slope + 26), 1000U);
+        slope = (int16_t)(slope + 26);
+    }
+    ASSERT_NEAR(curvature, 26 * 60, 8);
+
+    // Twice less per minute with 2 seconds in between samples
+    for (uint16_t i = 0; i < 60U; i++)
+    {
+        transient_curvature_update(&curvature, slope, (int16_t)(slope + 26), 2000U);
+        slope = (int16_t)(slope + 26);
+    }
+    ASSERT_NEAR(curvature, 26 * 30, 8);
+
+    // Huge slope jumps are clamped
+    curvature = 0;
+    transient_curvature_update(&curvature, INT16_MIN, INT16_MAX, 1000U);
+    ASSERT_EQ(curvature, (INT16_MAX * 1000) / TRANSIENT_CURVATURE_TIME_CONSTANT_MS);
+}
+
+TEST_F(TransientFixture, door_opening_test)
+{
+    // Calm : nothing held
+    ASSERT_TRUE(filter(2 * 256, 0, 10, true, 100));
+    ASSERT_EQ(state.phase, TRANSIENT_NONE);
+
+    // Door opened : the slope builds up fast, the threshold is crossed a few seconds later
+    ASSERT_FALSE(filter(4 * 256, 10 * 256, -100, false, 200));
+    ASSERT_EQ(state.phase, TRANSIENT_SPIKE);
+    ASSERT_FALSE(filter(11 * 256, 20 * 256, 20, true, 213));
+    ASSERT_TRUE(state.holding);
+    ASSERT_EQ(state.suppressed, 1U);
+
+    // Level based : stepping again changes nothing
+    ASSERT_FALSE(filter(11 * 256, 20 * 256, 20, true, 213));
+    ASSERT_EQ(state.suppressed, 1U);
+
+    // Door closed : the spike turns around, the reading stays above the threshold for a while
+    ASSERT_FALSE(filter(30 * 256, -8 * 256, 200, true, 320));
+    ASSERT_EQ(state.phase, TRANSIENT_RECOVERING);
+    ASSERT_FALSE(filter(-5 * 256, -2 * 256, 50, true, 600));
+
+    // Back below the threshold : that start was avoided
+    ASSERT_FALSE(filter(-5 * 256, 0, -10, false, 700));
+    ASSERT_FALSE(state.holding);
+    ASSERT_EQ(state.avoided, 1U);
+    ASSERT_EQ(state.released, 0U);
+    ASSERT_EQ(state.phase, TRANSIENT_NONE);
+}
+
+TEST_F(TransientFixture, sustained_load_test)
+{
+    // Fast warm-up that does not turn around : released once confirmed
+    ASSERT_FALSE(filter(25 * 256, 2 * 256, 10, true, 1000));
+    ASSERT_EQ(state.suppressed, 1U);
+    ASSERT_FALSE(filter(25 * 256, 1 * 256, 100, true, 1000 + TRANSIENT_CONFIRM_SECONDS - 1U));
+    ASSERT_TRUE(filter(25 * 256, 1 * 256, 100, true, 1000 + TRANSIENT_CONFIRM_SECONDS));
+    ASSERT_EQ(state.phase, TRANSIENT_SUSTAINED);
+    ASSERT_EQ(state.released, 1U);
+
+    // Not held again until the slope calmed down
+    ASSERT_TRUE(filter(25 * 256, -4 * 256, 100, true, 2000));
+    ASSERT_EQ(state.suppressed, 1U);
+    filter(5 * 256, 0, 100, false, 2100);
+    ASSERT_EQ(state.phase, TRANSIENT_NONE);
+
+    // A slow build-up (food load) is not a spike at all
+    ASSERT_TRUE(filter(13 * 256, 1 * 256, 10, true, 3000));
+    ASSERT_EQ(state.phase, TRANSIENT_NONE);
+}
+
+TEST_F(TransientFixture, hold_limits_test)
+{
+    // Too far above the threshold : released right away
+    ASSERT_FALSE(filter(30 * 256, 10 * 256, 100, true, 100));
+    ASSERT_TRUE(filter(30 * 256, -10 * 256, TRANSIENT_HARD_LIMIT * 256, true, 110));
+    ASSERT_EQ(state.released, 1U);
+
+    // Recovering too slowly : released after the longest hold
+    transient_init(&state);
+    ASSERT_FALSE(filter(30 * 256, 10 * 256, 100, true, 100));
+    ASSERT_FALSE(filter(10 * 256, -10 * 256, 100, true, 200));
+    ASSERT_FALSE(filter(0, 0, 100, true, 100 + TRANSIENT_HOLD_MAX_SECONDS - 1U));
+    ASSERT_TRUE(filter(0, 0, 100, true, 100 + TRANSIENT_HOLD_MAX_SECONDS));
+    ASSERT_EQ(state.phase, TRANSIENT_SUSTAINED);
+    ASSERT_EQ(state.released, 1U);
+    ASSERT_EQ(state.avoided, 0U);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "wall_clock.h"
+
+class WallClockFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        wall_clock_init(&clock);
+        wall_clock_parser_init(&parser);
+    }
+
+    static mcu_time_t make_time(const uint32_t seconds)
+    {
+        return mcu_time_t{.seconds = seconds, .milliseconds = 0};
+    }
+
+    uint32_t now(const uint32_t mcu_s)
+    {
+        const mcu_time_t time = make_time(mcu_s);
+        uint32_t wall_s = 0;
+        EXPECT_TRUE(wall_clock_now(&clock, &time, &wall_s));
+        return wall_s;
+    }
+
+    void sync(const uint32_t mcu_s, const uint32_t wall_s)
+    {
+        const mcu_time_t time = make_time(mcu_s);
+        wall_clock_sync(&clock, &time, wall_s);
+    }
+
+    bool parse(std::string const &input, uint32_t *const wall_s)
+    {
+        bool complete = false;
+        for (const char c : input)
+        {
+            complete = wall_clock_parse(&parser, c, wall_s);
+        }
+        return complete;
+    }
+
+    wall_clock_t clock;
+    wall_clock_parser_t parser;
+    static constexpr uint32_t epoch = 1735689600UL;
+};
+
+TEST_F(WallClockFixture, parser_test)
+{
+    uint32_t wall_s = 0;
+    ASSERT_TRUE(parse("T1735689600\n", &wall_s));
+    ASSERT_EQ(wall_s, epoch);
+
+    // Carriage return works as well, other commands around are ignored
+    ASSERT_TRUE(parse("pT42\r", &wall_s));
+    ASSERT_EQ(wall_s, 42U);
+
+    // Missing digits, garbage and overflow drop the command
+    wall_s = 0;
+    ASSERT_FALSE(parse("T\n", &wall_s));
+    ASSERT_FALSE(parse("T12x34\n", &wall_s));
+    ASSERT_FALSE(parse("T4294967296\n", &wall_s));
+    ASSERT_FALSE(parse("1234\n", &wall_s));
+    ASSERT_EQ(wall_s, 0U);
+
+    // Largest value still fits
+    ASSERT_TRUE(parse("T4294967295\n", &wall_s));
+    ASSERT_EQ(wall_s, UINT32_MAX);
+}
+
+TEST_F(WallClockFixture, drift_test)
+{
+    const mcu_time_t time = make_time(10);
+    uint32_t wall_s = 0;
+    ASSERT_FALSE(wall_clock_now(&clock, &time, &wall_s));
+
+    // MCU clock running 1000 ppm fast : 86486.4 MCU seconds per day
+    sync(10, epoch);
+    ASSERT_EQ(now(10 + 3600), epoch + 3600U);
+    sync(10 + 86486, epoch + 86400U);
+    ASSERT_TRUE(clock.drift_known);
+    ASSERT_NEAR(clock.drift_ppm, 1000, 15);
+
+    // Compensated from then on : within a second after a day
+    ASSERT_NEAR((double)now(10 + 2 * 86486), (double)(epoch + 2U * 86400U), 1.0);
+
+    // Further measurements are averaged
+    sync(10 + 2 * 86486, epoch + 2U * 86400U);
+    ASSERT_NEAR(clock.drift_ppm, 1000, 15);
+    sync(10 + 3 * 86486, epoch + 3U * 86400U + 60U);
+    ASSERT_LT(clock.drift_ppm, 1000);
+    ASSERT_GT(clock.drift_ppm, 700);
+}
+
+TEST_F(WallClockFixture, offset_test)
+{
+    sync(0, epoch);
+
+    // Daylight saving change a few hours later : applied right away, the drift is not measured
+    sync(7200, epoch + 7200U + 3600U);
+    ASSERT_FALSE(clock.drift_known);
+    ASSERT_EQ(now(7300), epoch + 7300U + 3600U);
+    ASSERT_EQ(clock.mcu_s, 0U);
+
+    // Drift measured across the jump is out of range : dropped, but the time is re-anchored
+    sync(86400, epoch + 86400U + 3600U);
+    ASSERT_FALSE(clock.drift_known);
+    ASSERT_EQ(now(86400 + 100), epoch + 86400U + 3600U + 100U);
+
+    // Clock no longer trusted once the anchor is too old
+    const mcu_time_t late = make_time(86400 + WALL_CLOCK_VALIDITY_S + 1U);
+    uint32_t wall_s = 0;
+    ASSERT_FALSE(wall_clock_now(&clock, &late, &wall_s));
+}
+
+TEST_F(WallClockFixture, slow_clock_test)
+{
+    // Ceramic resonator running 3000 ppm slow, synchronized every 12 hours
+    uint32_t mcu_s = 100;
+    sync(mcu_s, epoch);
+    for (uint32_t i = 1; i <= 6; i++)
+    {
+        mcu_s += 43070U;
+        sync(mcu_s, epoch + i * 43200U);
+    }
+    ASSERT_NEAR(clock.drift_ppm, -3009, 15);
+    ASSERT_NEAR((double)now(mcu_s + 43070U), (double)(epoch + 7U * 43200U), 1.0);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,515 @@
+#include "app.h"
+#include "thermistor_ntc_100k_3950K.h"
+
+#include <string.h>
+
+static bool handle_buttons(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs);
+static void handle_normal_operation_loop(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs,
+                                         const bool relearn);
+static bool compute_motor_demand(app_state_t *const state, app_inputs_t const *const inputs);
+static bool hold_transient_start(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs, const bool demand);
+static bool get_adaptive_band(app_state_t const *const state, uint8_t *const band);
+static void get_control_point(app_state_t const *const state, int8_t *const setpoint, uint8_t *const high, uint8_t *const low);
+static void follow_schedule(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs);
+static void learn_thermal_rates(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs, const bool regular);
+static void learn_running_current(app_state_t *const state, app_outputs_t *const outputs);
+static void get_current_baseline(persistent_config_t const *const config, current_baseline_t *const baseline);
+static void set_motor_output(app_state_t *const state, const bool on);
+static void set_led_pattern(app_outputs_t *const outputs, const led_blink_pattern_t pattern);
+static void set_led_next_event(app_outputs_t *const outputs, led_next_event_t const *const event);
+
+#ifndef NO_CURRENT_MONITORING
+static app_mode_t handle_motor_stalled_loop(app_state_t const *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs);
+#endif
+
+void app_params_default(app_params_t *params)
+{
+    params->temp_hysteresis_high = TEMP_HYSTERESIS_HIGH;
+    params->temp_hysteresis_low = TEMP_HYSTERESIS_LOW;
+    params->stalled_current_multiplier_percent = STALLED_CURRENT_MULTIPLIER_PERCENT;
+    params->steady_motor_runtime = STEADY_MOTOR_RUNTIME;
+    params->stalled_motor_immune_period = STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART;
+    params->stalled_motor_wait_seconds = STALLED_MOTOR_WAIT_SECONDS;
+
+    // Target temperature is clamped to the NTC curve boundaries
+    params->min_target_temperature = thermistor_ntc_100k_3950K_data.data[0U].temperature;
+    params->max_target_temperature = thermistor_ntc_100k_3950K_data.data[thermistor_ntc_100k_3950K_data.sample_count - 1U].temperature;
+
+    params->adaptive_hysteresis = ADAPTIVE_HYSTERESIS;
+    params->adaptive_cycle_minutes = ADAPTIVE_CYCLE_MINUTES;
+    params->adaptive_band_min = ADAPTIVE_BAND_MIN;
+    params->adaptive_band_max = ADAPTIVE_BAND_MAX;
+
+    params->control_mode = APP_CONTROL_MODE;
+    params->pid.kp = PID_KP;
+    params->pid.ki = PID_KI;
+    params->pid.kd = PID_KD;
+    params->pid.derivative_shift = PID_DERIVATIVE_FILTER_SHIFT;
+    params->pid.sample_period_s = PID_SAMPLE_PERIOD_S;
+    params->pid.output_min = 0;
+    params->pid.output_max = 1000;
+    params->pid_window_seconds = PID_WINDOW_SECONDS;
+    params->min_motor_runtime_seconds = MIN_MOTOR_RUNTIME_SECONDS;
+    params->pid_min_idle_seconds = PID_MIN_IDLE_SECONDS;
+
+    params->transient_detection = TRANSIENT_DETECTION;
+    transient_params_default(&params->transient);
+
+    params->scheduling = APP_SCHEDULING;
+    schedule_params_default(&params->schedule);
+
+    current_learner_params_default(&params->current_learner);
+}
+
+void app_init(app_state_t *state)
+{
+    memset(state, 0, sizeof(app_state_t));
+    state->mode = APP_MODE_POST_BOOT_WAIT;
+    state->tracking.motor_start_time = 0;
+    state->motor_on = false;
+    pid_init(&state->pid);
+    pid_window_init(&state->pid_window);
+    transient_init(&state->transient);
+    current_run_init(&state->current.run);
+    state->schedule = SCHEDULE_NONE;
+    persistent_config_default(&state->config);
+    app_params_default(&state->params);
+}
+
+void app_step(app_state_t *state, app_inputs_t const *inputs, app_outputs_t *outputs)
+{
+    memset(outputs, 0, sizeof(app_outputs_t));
+
+    const bool relearn = handle_buttons(state, inputs, outputs);
+    follow_schedule(state, inputs, outputs);
+
+    switch (state->mode)
+    {
+#ifndef NO_CURRENT_MONITORING
+        case APP_MODE_MOTOR_STALLED:
+            state->mode = handle_motor_stalled_loop(state, inputs, outputs);
+            break;
+#endif
+
+        case APP_MODE_POST_BOOT_WAIT:
+        case APP_MODE_NORMAL:
+        case APP_MODE_WAITING_START_MOTOR:
+        default:
+            handle_normal_operation_loop(state, inputs, outputs, relearn);
+            break;
+    }
+
+    outputs->motor_on = state->motor_on;
+}
+
+// One degree step of the target temperature, clamped to the NTC curve
+static void step_target(app_state_t *const state, const uint8_t button, app_outputs_t *const outputs)
+{
+    if (button == BUTTON_PLUS)
+    {
+        state->config.target_temperature++;
+        if (state->config.target_temperature > state->params.max_target_temperature)
+        {
+            state->config.target_temperature = state->params.max_target_temperature;
+        }
+        outputs->events |= APP_EVENT_TARGET_INCREASED;
+    }
+    else
+    {
+        state->config.target_temperature--;
+        if (state->config.target_temperature < state->params.min_target_temperature)
+        {
+            state->config.target_temperature = state->params.min_target_temperature;
+        }
+        outputs->events |= APP_EVENT_TARGET_DECREASED;
+    }
+    outputs->config_changed = true;
+}
+
+// Drains the buttons gestures, returns true if the user asked for a new current learning
+static bool handle_buttons(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs)
+{
+    bool relearn = false;
+    gesture_event_t event;
+
+    while ((inputs->gestures != NULL) && gesture_queue_pop(inputs->gestures, &event))
+    {
+        switch (event.kind)
+        {
+            // Both buttons held : raised once per chord
+            case GESTURE_CHORD:
+                relearn = true;
+                break;
+
+            // The first click of a double click is not raised on its own : both move the target
+            case GESTURE_DOUBLE_CLICK:
+                step_target(state, event.button, outputs);
+                step_target(state, event.button, outputs);
+                break;
+
+            // Holding + or - keeps moving the target, one degree per repeat
+            case GESTURE_CLICK:
+            case GESTURE_LONG_PRESS:
+            case GESTURE_REPEAT:
+                step_target(state, event.button, outputs);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return relearn;
+}
+
+#ifndef NO_CURRENT_MONITORING
+static app_mode_t handle_motor_stalled_loop(app_state_t const *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs)
+{
+    // Wait for 5 minutes before exiting this state
+    uint32_t elapsed_time = inputs->time.seconds - state->tracking.stalled_cond_time;
+    if (elapsed_time >= state->params.stalled_motor_wait_seconds)
+    {
+        // Revert to normal operation mode
+        outputs->events |= APP_EVENT_STALL_TIMEOUT;
+        return APP_MODE_NORMAL;
+    }
+    return APP_MODE_MOTOR_STALLED;
+}
+#endif
+
+static void handle_normal_operation_loop(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs,
+                                         const bool relearn)
+{
+    const uint32_t now = inputs->time.seconds;
+    persistent_config_t *const config = &state->config;
+    app_params_t const *const params = &state->params;
+
+    if (relearn)
+    {
+        // Reset memory back to default (starts a new "Learning" mode)
+        config->current_threshold = 0;
+        config->current_sigma = 0;
+        config->current_runs = 0;
+        outputs->config_changed = true;
+        outputs->events |= APP_EVENT_RELEARN_REQUESTED;
+        set_led_pattern(outputs, LED_BLINK_ACCEPT);
+
+        led_next_event_t event = {.kind = LED_NEXT_EVENT_PATTERN, .data = {.pattern = LED_BLINK_BREATHING}};
+        set_led_next_event(outputs, &event);
+
+        if (state->motor_on)
+        {
+            // Reset the tracker so that we start counting from now on
+            state->tracking.motor_start_time = now;
+            state->learner.switch_valid = false;
+            current_run_init(&state->current.run);
+        }
+    }
+
+    // Just learnt new "normal" motor behavior ! Save it to persistent memory. That first reading is only a seed :
+    // the statistics of the whole run replace it once the motor stops, and the following runs refine them
+    const uint32_t motor_runtime = now - state->tracking.motor_start_time;
+    bool motor_run_long_enough = motor_runtime > params->steady_motor_runtime;
+
+    // Running current statistics leave the inrush current out
+    if (state->motor_on && motor_run_long_enough && (motor_runtime >= params->stalled_motor_immune_period))
+    {
+        current_run_sample(&state->current.run, inputs->current_rms, motor_runtime);
+    }
+    if (state->motor_on && (config->current_threshold == 0) && (motor_run_long_enough))
+    {
+        config->current_threshold = inputs->current_rms;
+        set_led_pattern(outputs, LED_BLINK_ACCEPT);
+        led_next_event_t event = {.kind = LED_NEXT_EVENT_IO_STATE, .data = {.io_state = 1U}};
+        set_led_next_event(outputs, &event);
+
+        outputs->config_changed = true;
+        outputs->events |= APP_EVENT_CURRENT_LEARNT;
+    }
+
+#ifndef NO_CURRENT_MONITORING
+    // Detected stalled motor, stop trying to trigger the compressor for now
+    bool overcurrent_detected = inputs->current_rms > (int16_t)app_get_stall_threshold(state);
+
+    // Wait for about 10 seconds to allow the motor to get back up to speed
+    // clang-format off
+    if ((config->current_threshold > 0)
+    &&  (overcurrent_detected)
+    &&  (now - state->tracking.motor_stopped_time >= params->stalled_motor_immune_period))
+    // clang-format on
+    {
+        state->mode = APP_MODE_MOTOR_STALLED;
+        set_motor_output(state, false);
+        state->tracking.stalled_cond_time = now;
+        state->learner.switch_valid = false;
+
+        outputs->events |= APP_EVENT_STALL_DETECTED;
+        set_led_pattern(outputs, LED_BLINK_WARNING);
+        return;
+    }
+#endif
+
+    bool demand = compute_motor_demand(state, inputs);
+    demand = hold_transient_start(state, inputs, outputs, demand);
+    if (!state->motor_on && demand)
+    {
+        uint32_t elapsed_seconds = (now - state->tracking.motor_stopped_time);
+
+        // state->tracking.motor_start_time == 0 -> Checks if we have just booted
+        // That's the only case where we can bypass the "waiting" period as we have no clue
+        // It means that we have just booted for the first time and we'll need to discover whether the motor can be driven or not
+        // Otherwise :
+        // Don't try to restart the motor right after a stop, need to wait for pressure to equalize in the system
+        // Otherwise we might run in the motor stalled condition
+        if (state->tracking.motor_start_time == 0 || elapsed_seconds >= params->stalled_motor_wait_seconds)
+        {
+            // Start the compressor
+            learn_thermal_rates(state, inputs, outputs, state->tracking.motor_start_time != 0U);
+            set_motor_output(state, true);
+            state->tracking.motor_start_time = now;
+            current_run_init(&state->current.run);
+            outputs->events |= APP_EVENT_MOTOR_STARTED;
+            set_led_pattern(outputs, LED_BLINK_NONE);
+            outputs->led.set_io = true;
+            outputs->led.io_state = 1U;
+        }
+        else
+        {
+            // Only called once when we transition to this new state
+            if (APP_MODE_WAITING_START_MOTOR != state->mode)
+            {
+                set_led_pattern(outputs, LED_BLINK_BREATHING);
+                state->mode = APP_MODE_WAITING_START_MOTOR;
+            }
+
+            // Report periodically the current waiting status
+            if ((now - state->last_eta_report) >= APP_RESTART_ETA_REPORT_PERIOD_S)
+            {
+                outputs->events |= APP_EVENT_RESTART_PENDING;
+                outputs->restart_eta_s = (uint16_t)(params->stalled_motor_wait_seconds - elapsed_seconds);
+                state->last_eta_report = now;
+            }
+        }
+    }
+    else if (state->motor_on && !demand)
+    {
+        // Stop the compressor
+        learn_thermal_rates(state, inputs, outputs, true);
+        learn_running_current(state, outputs);
+        set_motor_output(state, false);
+        state->tracking.motor_stopped_time = now;
+        outputs->events |= APP_EVENT_MOTOR_STOPPED;
+    }
+}
+
+static void follow_schedule(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs)
+{
+    // Level based : the phase only depends on the time of day
+    schedule_phase_t phase = SCHEDULE_NONE;
+    if (state->params.scheduling && (inputs->time_of_day != APP_TIME_OF_DAY_UNKNOWN))
+    {
+        phase = schedule_phase(&state->params.schedule, inputs->time_of_day);
+    }
+
+    if (phase != state->schedule)
+    {
+        state->schedule = phase;
+        outputs->events |= APP_EVENT_SCHEDULE_CHANGED;
+    }
+}
+
+static bool compute_motor_demand(app_state_t *const state, app_inputs_t const *const inputs)
+{
+    const uint32_t now = inputs->time.seconds;
+    app_params_t const *const params = &state->params;
+
+    // Target temperature, moved by the schedule
+    int8_t setpoint;
+    uint8_t high;
+    uint8_t low;
+    get_control_point(state, &setpoint, &high, &low);
+
+    if (APP_CONTROL_PID == params->control_mode)
+    {
+        pid_update(&params->pid, &state->pid, PID_TO_Q8(setpoint), inputs->temperature_q8, inputs->temperature_slope, now);
+
+        // tracking holds the start time while the motor runs, the stop time otherwise : both are the last switch time
+        const pid_window_params_t window = {.window_s = params->pid_window_seconds,
+                                            .min_on_s = params->min_motor_runtime_seconds,
+                                            .min_off_s = params->stalled_motor_wait_seconds,
+                                            .min_idle_s = params->pid_min_idle_seconds};
+        return pid_window_demand(&window, &state->pid_window, state->pid.output, state->motor_on, state->tracking.motor_start_time, now);
+    }
+
+    // Simple hysteresis to control the compressor based on the set point
+    if (state->motor_on)
+    {
+        return inputs->temperature >= (int8_t)(setpoint - low);
+    }
+    return inputs->temperature > (int8_t)(setpoint + high);
+}
+
+static bool hold_transient_start(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs, const bool demand)
+{
+    app_params_t const *const params = &state->params;
+    if (!params->transient_detection)
+    {
+        return demand;
+    }
+
+    // Only starts are held, the detector keeps tracking the temperature shape while the compressor runs
+    int8_t setpoint;
+    uint8_t high;
+    uint8_t low;
+    get_control_point(state, &setpoint, &high, &low);
+    const int32_t threshold = ((int32_t)setpoint + high) * 256;
+    int32_t excess = (int32_t)inputs->temperature_q8 - threshold;
+    excess = (excess > INT16_MAX) ? INT16_MAX : ((excess < INT16_MIN) ? INT16_MIN : excess);
+
+    const uint16_t suppressed = state->transient.suppressed;
+    const bool start = transient_filter_start(&params->transient, &state->transient, inputs->temperature_slope,
+                                              inputs->temperature_curvature, (int16_t)excess, !state->motor_on && demand, inputs->time.seconds);
+    if (state->transient.suppressed != suppressed)
+    {
+        outputs->events |= APP_EVENT_START_HELD;
+    }
+    return state->motor_on ? demand : start;
+}
+
+void app_get_hysteresis_band(app_state_t const *state, uint8_t *high, uint8_t *low)
+{
+    int8_t setpoint;
+    get_control_point(state, &setpoint, high, low);
+}
+
+uint16_t app_get_stall_threshold(app_state_t const *state)
+{
+    current_baseline_t baseline;
+    get_current_baseline(&state->config, &baseline);
+    return current_baseline_threshold(&state->params.current_learner, &baseline, state->params.stalled_current_multiplier_percent);
+}
+
+int8_t app_get_setpoint(app_state_t const *state)
+{
+    int8_t setpoint;
+    uint8_t high;
+    uint8_t low;
+    get_control_point(state, &setpoint, &high, &low);
+    return setpoint;
+}
+
+static void get_control_point(app_state_t const *const state, int8_t *const setpoint, uint8_t *const high, uint8_t *const low)
+{
+    uint8_t band;
+    if (get_adaptive_band(state, &band))
+    {
+        *high = band;
+        *low = band;
+    }
+    else
+    {
+        *high = state->params.temp_hysteresis_high;
+        *low = state->params.temp_hysteresis_low;
+    }
+    schedule_apply(&state->params.schedule, state->schedule, state->config.target_temperature, setpoint, high, *low);
+}
+
+static bool get_adaptive_band(app_state_t const *const state, uint8_t *const band)
+{
+    app_params_t const *const params = &state->params;
+    persistent_config_t const *const config = &state->config;
+
+    // Fixed bands until both rates were measured at least once
+    if (!params->adaptive_hysteresis || (config->warming_rate == THERMAL_RATE_UNKNOWN) || (config->cooling_rate == THERMAL_RATE_UNKNOWN))
+    {
+        return false;
+    }
+
+    *band = thermal_band_for_cycle(config->warming_rate, config->cooling_rate, (uint32_t)params->adaptive_cycle_minutes * 60U,
+                                   params->adaptive_band_min, params->adaptive_band_max);
+    return true;
+}
+
+static void learn_thermal_rates(app_state_t *const state, app_inputs_t const *const inputs, app_outputs_t *const outputs, const bool regular)
+{
+    app_params_t const *const params = &state->params;
+    persistent_config_t *const config = &state->config;
+
+    // Only whole phases in between 2 regular thermostat switches are measured (no boot, stall or relearn in between)
+    if (state->learner.switch_valid && regular && params->adaptive_hysteresis && (APP_CONTROL_HYSTERESIS == params->control_mode))
+    {
+        // tracking holds the last switch time, whichever it was (start or stop)
+        const uint32_t duration = inputs->time.seconds - state->tracking.motor_start_time;
+        const uint16_t rate = thermal_rate_measure((int16_t)inputs->temperature - state->learner.switch_temperature, duration);
+
+        uint8_t band_before = 0;
+        const bool had_band = get_adaptive_band(state, &band_before);
+
+        // Called right before the switch : a running motor ends a cool-down phase
+        thermal_rate_learn(state->motor_on ? &config->cooling_rate : &config->warming_rate, rate);
+        outputs->events |= APP_EVENT_RATE_LEARNT;
+
+        // Persistent memory is written when the band changes, or once in a while so that a reboot does not lose everything
+        uint8_t band_after = 0;
+        const bool has_band = get_adaptive_band(state, &band_after);
+        state->learner.unsaved_cycles++;
+        if ((had_band != has_band) || (band_before != band_after) || (state->learner.unsaved_cycles >= APP_LEARNER_SAVE_CYCLES))
+        {
+            outputs->config_changed = true;
+            state->learner.unsaved_cycles = 0;
+        }
+    }
+
+    state->learner.switch_temperature = inputs->temperature;
+    state->learner.switch_valid = regular;
+}
+
+static void get_current_baseline(persistent_config_t const *const config, current_baseline_t *const baseline)
+{
+    baseline->mean = config->current_threshold;
+    baseline->sigma = config->current_sigma;
+    baseline->runs = config->current_runs;
+}
+
+static void learn_running_current(app_state_t *const state, app_outputs_t *const outputs)
+{
+    // Only regular stops end a run worth learning (no stall), once the seed reading exists
+    persistent_config_t *const config = &state->config;
+    current_baseline_t baseline;
+    get_current_baseline(config, &baseline);
+    if ((config->current_threshold == 0U) || !current_baseline_learn(&state->params.current_learner, &baseline, &state->current.run))
+    {
+        return;
+    }
+
+    config->current_threshold = baseline.mean;
+    config->current_sigma = baseline.sigma;
+    config->current_runs = baseline.runs;
+    outputs->events |= APP_EVENT_CURRENT_REFINED;
+
+    // Saved right away until the statistical margin is in use, then every few runs
+    state->current.unsaved_runs++;
+    if ((baseline.runs <= state->params.current_learner.min_runs) || (state->current.unsaved_runs >= APP_LEARNER_SAVE_CYCLES))
+    {
+        outputs->config_changed = true;
+        state->current.unsaved_runs = 0;
+    }
+}
+
+static void set_motor_output(app_state_t *const state, const bool on)
+{
+    // Actual output is driven by the caller, using outputs->motor_on
+    state->motor_on = on;
+}
+
+static void set_led_pattern(app_outputs_t *const outputs, const led_blink_pattern_t pattern)
+{
+    outputs->led.set_pattern = true;
+    outputs->led.pattern = pattern;
+}
+
+static void set_led_next_event(app_outputs_t *const outputs, led_next_event_t const *const event)
+{
+    outputs->led.set_next_event = true;
+    outputs->led.next_event = *event;
+}
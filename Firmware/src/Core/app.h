@@ -0,0 +1,302 @@
+#ifndef APP_HEADER
+#define APP_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "current_learner.h"
+#include "gesture.h"
+#include "led.h"
+#include "mcu_time.h"
+#include "persistent_config.h"
+#include "pid.h"
+#include "schedule.h"
+#include "thermal_learner.h"
+#include "transient.h"
+
+// Control law constants generated by the fridge_tuner simulation tool (see Sim/Readme.md), override the defaults below
+#ifdef APP_TUNED_PARAMS
+#include "app_tuned_params.h"
+#endif
+
+// clang-format off
+#ifndef STALLED_CURRENT_MULTIPLIER_PERCENT
+#define STALLED_CURRENT_MULTIPLIER_PERCENT 20U /**> Used to detect overcurrent conditions.                               */
+                                               /**> Inrush current is several times bigger than normal current           */
+#endif
+
+#ifndef STEADY_MOTOR_RUNTIME
+#define STEADY_MOTOR_RUNTIME 5U  /**> Minimum time to wait after motor is triggered to consider it in                    */
+                                 /**> it's normal operation mode                                                         */
+#endif
+
+#ifndef STALLED_MOTOR_WAIT_MINUTES
+#define STALLED_MOTOR_WAIT_MINUTES 5U                                  /**> How long we'll need to wait between motor starts when motor is stalled  */
+#endif
+#define STALLED_MOTOR_WAIT_SECONDS (STALLED_MOTOR_WAIT_MINUTES * 60U)  /**> Same as above in seconds                                                */
+
+#ifndef STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART
+#define STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART 10U                  /**> How long (in seconds) we prevent over current detection after a restart */
+#endif
+
+#ifndef TEMP_HYSTERESIS_HIGH
+#define TEMP_HYSTERESIS_HIGH 2U     /**> Upper limit of the hysteresis window. If temp gets higher than 2°C above the target temp, we start the compressor  */
+#endif
+#ifndef TEMP_HYSTERESIS_LOW
+#define TEMP_HYSTERESIS_LOW 2U      /**> Lower limit of the hysteresis window. If temp gets lower than 2°C below the target temp, we stop the compressor    */
+#endif
+
+#ifndef ADAPTIVE_HYSTERESIS
+#define ADAPTIVE_HYSTERESIS 1U      /**> Hysteresis bands follow the learnt thermal rates instead of TEMP_HYSTERESIS_HIGH/LOW   */
+#endif
+#ifndef ADAPTIVE_CYCLE_MINUTES
+#define ADAPTIVE_CYCLE_MINUTES 150U /**> Compressor cycle length (start to start) the adaptive bands aim for (minutes)         */
+#endif
+#ifndef ADAPTIVE_BAND_MIN
+#define ADAPTIVE_BAND_MIN 1U        /**> Narrowest adaptive band, above and below the target (°C)                              */
+#endif
+#ifndef ADAPTIVE_BAND_MAX
+#define ADAPTIVE_BAND_MAX 3U        /**> Widest adaptive band, above and below the target (°C) : keeps the cabinet above 0°C   */
+#endif
+#define APP_LEARNER_SAVE_CYCLES 8U  /**> Learnt rates and current statistics are written to persistent memory at least every that many measurements */
+
+#define APP_CONTROL_HYSTERESIS 0U    /**> Compressor driven by a simple hysteresis around the target temperature                 */
+#define APP_CONTROL_PID 1U           /**> Experimental : compressor driven by a PID controller through a time-proportioning window */
+#ifndef APP_CONTROL_MODE
+#define APP_CONTROL_MODE APP_CONTROL_HYSTERESIS /**> Build time selection of the control law                                     */
+#endif
+
+#ifndef PID_KP
+#define PID_KP 150                  /**> Proportional gain (permille of compressor duty per °C above the target)                 */
+#endif
+#ifndef PID_KI
+#define PID_KI 4                    /**> Integral gain (Q8 permille per °C and per sample, 4 = 1/64 permille/°C/sample)           */
+#endif
+#ifndef PID_KD
+#define PID_KD 10                   /**> Derivative gain (permille per °C/h of the filtered temperature slope)                   */
+#endif
+#ifndef PID_DERIVATIVE_FILTER_SHIFT
+#define PID_DERIVATIVE_FILTER_SHIFT 2U /**> Derivative low pass filter strength (0 : no filter)                                  */
+#endif
+#ifndef PID_SAMPLE_PERIOD_S
+#define PID_SAMPLE_PERIOD_S 60U     /**> PID update period (seconds)                                                             */
+#endif
+#ifndef PID_WINDOW_SECONDS
+#define PID_WINDOW_SECONDS 2400U    /**> Time-proportioning window length (seconds)                                              */
+#endif
+#ifndef MIN_MOTOR_RUNTIME_SECONDS
+#define MIN_MOTOR_RUNTIME_SECONDS 1200U /**> Shortest compressor run the PID mode can request (seconds)                          */
+#endif
+#ifndef PID_MIN_IDLE_SECONDS
+#define PID_MIN_IDLE_SECONDS 14400U /**> Shortest compressor rest of the PID mode unless its output saturates, bounds the starts rate (seconds) */
+#endif
+
+#ifndef TRANSIENT_DETECTION
+#define TRANSIENT_DETECTION 1U      /**> Compressor starts are held during door openings (@see transient.h), needs the temperature filter */
+#endif
+
+#ifndef APP_SCHEDULING
+#define APP_SCHEDULING 1U           /**> Pre-cooling and wider bands around the peak hours once the wall clock is synchronized (@see schedule.h) */
+#endif
+#define APP_TIME_OF_DAY_UNKNOWN 0xFFFFU /**> app_inputs_t::time_of_day value without a synchronized wall clock                       */
+
+#define APP_RESTART_ETA_REPORT_PERIOD_S 10U /**> How often the motor restart ETA is reported while waiting for it                               */
+// clang-format on
+
+/**
+ * @brief controls the application state (state machine)
+ */
+typedef enum
+{
+    APP_MODE_NORMAL,             /**> Normal fridge operation                                                                                  */
+    APP_MODE_POST_BOOT_WAIT,     /**> Post boot time window waits for 5 seconds without triggering the compressor.
+                                      This allows the user to enter the Learning mode when exiting the boot.                                   */
+    APP_MODE_MOTOR_STALLED,      /**> Motor stalled condition was detected, waiting for 5 minutes before trying again                          */
+    APP_MODE_WAITING_START_MOTOR /**> We are waiting before restarting the motor. This is done before we run into the MOTOR STALLED condition  */
+} app_mode_t;
+
+/**
+ * @brief control law tuning parameters (default to the compile time constants above)
+ */
+typedef struct
+{
+    uint8_t temp_hysteresis_high;               /**> Compressor starts above target + temp_hysteresis_high (°C)                 */
+    uint8_t temp_hysteresis_low;                /**> Compressor stops below target - temp_hysteresis_low (°C)                   */
+    uint8_t stalled_current_multiplier_percent; /**> Widest overcurrent margin above the learnt running current (percent)      */
+    uint8_t steady_motor_runtime;               /**> Time to wait after a start before learning the motor current (seconds)     */
+    uint8_t stalled_motor_immune_period;        /**> Overcurrent detection is disabled after a restart for this long (seconds)  */
+    uint16_t stalled_motor_wait_seconds;        /**> Minimum time in between a motor stop and the next start (seconds)          */
+    int8_t min_target_temperature;              /**> Lowest target temperature the user can set (°C)                            */
+    int8_t max_target_temperature;              /**> Highest target temperature the user can set (°C)                           */
+    uint8_t adaptive_hysteresis;                /**> Bands derived from the learnt thermal rates (0 : fixed bands)              */
+    uint16_t adaptive_cycle_minutes;            /**> Cycle length the adaptive bands aim for (minutes)                          */
+    uint8_t adaptive_band_min;                  /**> Narrowest adaptive band (°C)                                               */
+    uint8_t adaptive_band_max;                  /**> Widest adaptive band (°C)                                                  */
+    uint8_t control_mode;                       /**> APP_CONTROL_HYSTERESIS or APP_CONTROL_PID                                  */
+    pid_params_t pid;                           /**> PID tuning (APP_CONTROL_PID)                                               */
+    uint16_t pid_window_seconds;                /**> Time-proportioning window length (APP_CONTROL_PID, seconds)                */
+    uint16_t min_motor_runtime_seconds;         /**> Shortest compressor run (APP_CONTROL_PID, seconds)                         */
+    uint16_t pid_min_idle_seconds;              /**> Shortest compressor rest in between two runs (APP_CONTROL_PID, seconds)    */
+    uint8_t transient_detection;                /**> Starts are held during door openings (0 : never held)                      */
+    transient_params_t transient;               /**> Door openings detection tuning                                             */
+    uint8_t scheduling;                         /**> Set point and bands follow the time of day schedule (0 : never)            */
+    schedule_params_t schedule;                 /**> Peak hours schedule                                                        */
+    current_learner_params_t current_learner;   /**> Running current statistics and stall margin tuning                         */
+} app_params_t;
+
+/**
+ * @brief whole application state, nothing is kept elsewhere
+ */
+typedef struct
+{
+    app_mode_t mode; /**> Tracks application current state                                               */
+    /**
+     * @brief maps the start time conditions in a union
+     * (because we are only using one value at a time, they are mutually exclusive)
+     */
+    union
+    {
+        uint32_t stalled_cond_time;  /**> Keeps track of the stalled condition start in time */
+        uint32_t motor_start_time;   /**> Keeps track of the time where motor was started    */
+        uint32_t motor_stopped_time; /**> Keeps track of the time where motor was shut off  */
+    } tracking;
+
+    persistent_config_t config;  /**> Persistent configuration (mirrors what is stored in EEPROM)  */
+    app_params_t params;         /**> Control law tuning parameters                                */
+    bool motor_on;               /**> Motor output command, as last applied                        */
+    uint32_t last_eta_report;    /**> Last time the motor restart ETA was reported (seconds)       */
+
+    /**
+     * @brief Thermal rates learning (adaptive hysteresis)
+     */
+    struct
+    {
+        int8_t switch_temperature; /**> Temperature when the motor was last started or stopped                                   */
+        bool switch_valid;         /**> Last switch was a regular thermostat one : the phase that follows it can be measured    */
+        uint8_t unsaved_cycles;    /**> Measurements not written to persistent memory yet                                       */
+    } learner;
+
+    /**
+     * @brief Running current learning (stall threshold)
+     */
+    struct
+    {
+        current_run_t run;    /**> Statistics of the current compressor run                      */
+        uint8_t unsaved_runs; /**> Learnt runs not written to persistent memory yet              */
+    } current;
+
+    pid_state_t pid;             /**> PID controller state (APP_CONTROL_PID)                       */
+    pid_window_t pid_window;     /**> Time-proportioning window state (APP_CONTROL_PID)            */
+    transient_state_t transient; /**> Door openings detection state                                */
+    schedule_phase_t schedule;   /**> Current schedule phase, as of the last step                  */
+} app_state_t;
+
+/**
+ * @brief sensors readings and user inputs for a single step
+ */
+typedef struct
+{
+    mcu_time_t time;               /**> Current time                                       */
+    int8_t temperature;            /**> Fridge temperature (°C)                            */
+    int16_t temperature_q8;        /**> Fridge temperature, finer resolution (Q8 °C)       */
+    int16_t temperature_slope;     /**> Fridge temperature rate of change (Q8 °C per hour) */
+    int16_t temperature_curvature; /**> Slope rate of change (Q8 °C per hour, per minute)  */
+    int16_t current_rms;           /**> Compressor RMS current (milliamps)                 */
+    uint16_t time_of_day;          /**> Local time (minutes since midnight), APP_TIME_OF_DAY_UNKNOWN without wall clock */
+    gesture_queue_t *gestures;     /**> User buttons gestures, drained by the step (NULL : none) */
+} app_inputs_t;
+
+/**
+ * @brief events raised during a step, used by the caller for logging
+ */
+typedef enum
+{
+    APP_EVENT_TARGET_INCREASED  = (1U << 0U), /**> User raised the target temperature                              */
+    APP_EVENT_TARGET_DECREASED  = (1U << 1U), /**> User lowered the target temperature                             */
+    APP_EVENT_RELEARN_REQUESTED = (1U << 2U), /**> User requested a new current learning (both buttons held)       */
+    APP_EVENT_CURRENT_LEARNT    = (1U << 3U), /**> Compressor current threshold was learnt                         */
+    APP_EVENT_STALL_DETECTED    = (1U << 4U), /**> Overcurrent detected, compressor was stopped                    */
+    APP_EVENT_STALL_TIMEOUT     = (1U << 5U), /**> Stalled motor waiting period is over                            */
+    APP_EVENT_MOTOR_STARTED     = (1U << 6U), /**> Compressor was started                                          */
+    APP_EVENT_MOTOR_STOPPED     = (1U << 7U), /**> Compressor was stopped (temperature is low enough or on time is over) */
+    APP_EVENT_RESTART_PENDING   = (1U << 8U), /**> Compressor needs to start but waits for pressure to equalize    */
+    APP_EVENT_RATE_LEARNT       = (1U << 9U), /**> A warm-up or cool-down rate was measured (adaptive hysteresis)  */
+    APP_EVENT_START_HELD        = (1U << 10U), /**> Compressor start is held while a door opening spike goes away   */
+    APP_EVENT_SCHEDULE_CHANGED  = (1U << 11U), /**> Schedule phase changed (pre-cooling, peak hours, regular)       */
+    APP_EVENT_CURRENT_REFINED   = (1U << 12U), /**> A compressor run was folded in the running current statistics  */
+} app_event_t;
+
+/**
+ * @brief commands computed during a single step, to be applied by the caller
+ */
+typedef struct
+{
+    bool motor_on;          /**> Motor output command                                            */
+    bool config_changed;    /**> Configuration needs to be written to persistent memory          */
+    uint16_t events;        /**> Raised events (app_event_t bitmask)                             */
+    uint16_t restart_eta_s; /**> Motor restart ETA, valid with APP_EVENT_RESTART_PENDING         */
+
+    /**
+     * @brief led driver commands (status led), applied in this order
+     */
+    struct
+    {
+        bool set_pattern;            /**> led_set_blink_pattern() needs to be called with pattern  */
+        led_blink_pattern_t pattern; /**> New led pattern                                          */
+        bool set_next_event;         /**> led_set_next_event() needs to be called with next_event  */
+        led_next_event_t next_event; /**> Event triggered when the current pattern is over         */
+        bool set_io;                 /**> led_blink_none_set_io() needs to be called with io_state */
+        uint8_t io_state;            /**> IO state used by the LED_BLINK_NONE pattern              */
+    } led;
+} app_outputs_t;
+
+/**
+ * @brief initializes tuning parameters with compile time defaults
+ */
+void app_params_default(app_params_t *params);
+
+/**
+ * @brief initializes the application state : default parameters, post boot mode and default configuration.
+ * Configuration is expected to be overwritten by the caller with the content of the persistent memory.
+ */
+void app_init(app_state_t *state);
+
+/**
+ * @brief runs a single step of the application state machine.
+ * This function is pure : everything it depends on is either passed as input or stored in the state.
+ * @param[in/out] state   : application state
+ * @param[in]     inputs  : sensors readings and user inputs
+ * @param[out]    outputs : commands to be applied by the caller (fully overwritten)
+ */
+void app_step(app_state_t *state, app_inputs_t const *inputs, app_outputs_t *outputs);
+
+/**
+ * @brief hysteresis bands currently in use (APP_CONTROL_HYSTERESIS) : the adaptive band once both thermal rates are known,
+ * the fixed bands otherwise, widened during the peak hours. The compressor starts above setpoint + high and stops below setpoint - low.
+ * @param[out] high : upper band (°C)
+ * @param[out] low  : lower band (°C)
+ */
+void app_get_hysteresis_band(app_state_t const *state, uint8_t *high, uint8_t *low);
+
+/**
+ * @brief overcurrent (stalled motor) threshold : learnt mean running current plus k standard deviations (@see current_learner.h)
+ * @return threshold (mA), 0 while learning
+ */
+uint16_t app_get_stall_threshold(app_state_t const *state);
+
+/**
+ * @brief temperature the control law currently aims for : the target temperature, lowered while pre-cooling (@see schedule.h)
+ * @return set point (°C)
+ */
+int8_t app_get_setpoint(app_state_t const *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_HEADER */
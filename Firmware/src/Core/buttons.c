@@ -1,41 +1,38 @@
 #include "buttons.h"
 
-#define LOW 0U
-#define HIGH 1U
-
-void button_local_mem_default(button_local_mem_t *button)
+void button_init(button_t *const button)
 {
-    button->current = LOW;
-    button->previous = LOW;
-    button->pressed = 0;
-    button->event = BUTTON_STATE_DEFAULT;
+    button->level = false;
+    button->pressed = false;
+    time_default(&button->changed);
 }
 
-void read_single_button_event(button_local_mem_t *const button, uint32_t const *const time)
+bool button_update(button_t *const button, const bool pressed, mcu_time_t const *const now)
 {
-    if (button->current == LOW)
+    // Every edge (bounces included) restarts the debouncing timer
+    if (pressed != button->level)
     {
-        // Start of long press, count press duration
-        if (button->current == button->previous)
-        {
-            const uint32_t duration = *time - button->pressed;
-            if (duration >= BUTTON_PRESS_TIME_THRESHOLD)
-            {
-                button->event = BUTTON_STATE_HOLD;
-            }
-        }
-        // New button pressed event (was not pressed before)
-        else
-        {
-            button->event = BUTTON_STATE_PRESSED;
-            button->pressed = *time;
-        }
+        button->level = pressed;
+        button->changed = *now;
     }
-    // Button is released
-    else
+
+    // Edges are timed at their acceptance : all of them are delayed alike, which keeps the press durations and their order
+    if ((button->level != button->pressed) && (time_elapsed_ms(&button->changed, now) >= BUTTON_DEBOUNCE_MS))
     {
-        button->event = BUTTON_STATE_RELEASED;
+        button->pressed = button->level;
+        return true;
     }
-    button->previous = button->current;
+    return false;
 }
 
+bool button_get_deadline(button_t const *const button, mcu_time_t *const deadline)
+{
+    if (button->level == button->pressed)
+    {
+        return false;
+    }
+
+    *deadline = button->changed;
+    time_add_ms(deadline, BUTTON_DEBOUNCE_MS);
+    return true;
+}
@@ -6,34 +6,65 @@ extern "C"
 {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
-#ifndef BUTTON_PRESS_TIME_THRESHOLD
-#define BUTTON_PRESS_TIME_THRESHOLD 3U
+#include "mcu_time.h"
+
+/**
+ * @brief push buttons debouncing, at the millisecond.
+ * Buttons are only fed when their level may have changed (pin change interrupt) or when their debouncing timer expires
+ * (@see button_get_deadline()) : each raw level change restarts the timer, and the level is only accepted once it
+ * stayed stable for BUTTON_DEBOUNCE_MS. Accepted levels changes are the edges the gestures are made of (@see gesture.h).
+ */
+
+#ifndef BUTTON_DEBOUNCE_MS
+#define BUTTON_DEBOUNCE_MS 20U /**> A level needs to stay stable that long to be accepted (milliseconds) */
 #endif
 
+/**
+ * @brief thermostat buttons
+ */
 typedef enum
 {
-    BUTTON_STATE_HOLD,
-    BUTTON_STATE_PRESSED,
-    BUTTON_STATE_RELEASED,
-    BUTTON_STATE_DEFAULT
-} button_state_t;
+    BUTTON_PLUS,  /**> Raises the target temperature              */
+    BUTTON_MINUS, /**> Lowers the target temperature              */
+    BUTTON_COUNT  /**> Number of buttons, not a valid button      */
+} button_id_t;
 
+/**
+ * @brief debouncing state of a single button
+ */
 typedef struct
 {
-    uint8_t current;      /**> Current button state (read from IO)          */
-    uint8_t previous;     /**> Previous button state (used to raise events) */
-    uint32_t pressed;     /**> When the button was pressed (using timebase) */
-    button_state_t event; /**> Output button state                          */
-} button_local_mem_t;
+    bool level;         /**> Last raw level fed (true : pressed) */
+    bool pressed;       /**> Debounced level (true : pressed)    */
+    mcu_time_t changed; /**> Last raw level change               */
+} button_t;
+
+/**
+ * @brief resets a button to released, with no pending timer
+ */
+void button_init(button_t *const button);
 
-void button_local_mem_default(button_local_mem_t *button);
+/**
+ * @brief feeds the current raw level of a button.
+ * Needs to be called on every raw level change, and at the deadline returned by button_get_deadline().
+ * @param[in] pressed : raw level (true : pressed)
+ * @param[in] now     : current time
+ * @return true if the debounced level (button_t::pressed) changed : that's an edge, made at the current time
+ */
+bool button_update(button_t *const button, const bool pressed, mcu_time_t const *const now);
 
-void read_single_button_event(button_local_mem_t *const button, uint32_t const *const time);
+/**
+ * @brief next time the button needs to be fed even if its level does not change (debouncing timer)
+ * @param[out] deadline : next deadline, left untouched if none is pending
+ * @return false if the level is settled : the button only needs to be fed on level changes
+ */
+bool button_get_deadline(button_t const *const button, mcu_time_t *const deadline);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* BUTTONS_HEADER */
\ No newline at end of file
+#endif /* BUTTONS_HEADER */
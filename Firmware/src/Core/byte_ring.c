@@ -0,0 +1,70 @@
+#include "byte_ring.h"
+#include "flash.h"
+
+static uint16_t saturated_add(const uint16_t counter, const uint16_t value)
+{
+    const uint32_t sum = (uint32_t)counter + value;
+    return (sum > UINT16_MAX) ? UINT16_MAX : (uint16_t)sum;
+}
+
+void byte_ring_init(byte_ring_t *const ring, uint8_t *const storage, const uint16_t size)
+{
+    ring->data = storage;
+    ring->mask = (uint16_t)(size - 1U);
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped_bytes = 0;
+    ring->dropped_writes = 0;
+}
+
+uint16_t byte_ring_count(byte_ring_t const *const ring)
+{
+    // Free running indices : the difference is right across wraps, and a full ring is not mistaken for an empty one
+    return (uint16_t)(ring->head - ring->tail);
+}
+
+uint16_t byte_ring_free(byte_ring_t const *const ring)
+{
+    return (uint16_t)(ring->mask + 1U - byte_ring_count(ring));
+}
+
+static bool write(byte_ring_t *const ring, uint8_t const *const data, const uint16_t length, const bool flash)
+{
+    if (length > byte_ring_free(ring))
+    {
+        ring->dropped_bytes = saturated_add(ring->dropped_bytes, length);
+        ring->dropped_writes = saturated_add(ring->dropped_writes, 1U);
+        return false;
+    }
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        ring->data[(uint16_t)(ring->head + i) & ring->mask] = flash ? FLASH_READ_U8(&data[i]) : data[i];
+    }
+
+    // Published once the bytes are in : the reader never sees a partial message
+    ring->head = (uint16_t)(ring->head + length);
+    return true;
+}
+
+bool byte_ring_write(byte_ring_t *const ring, uint8_t const *const data, const uint16_t length)
+{
+    return write(ring, data, length, false);
+}
+
+bool byte_ring_write_flash(byte_ring_t *const ring, uint8_t const *const data, const uint16_t length)
+{
+    return write(ring, data, length, true);
+}
+
+bool byte_ring_read(byte_ring_t *const ring, uint8_t *const byte)
+{
+    if (ring->head == ring->tail)
+    {
+        return false;
+    }
+
+    *byte = ring->data[ring->tail & ring->mask];
+    ring->tail++;
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef BYTE_RING_HEADER
+#define BYTE_RING_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief bytes FIFO over a caller provided storage (power of two size), with drop accounting.
+ * Meant to sit in between the main loop and an interrupt (e.g. serial transmission) : one side only writes, the other only reads,
+ * and neither ever waits. Writes are all or nothing, so that a full ring drops whole messages instead of truncating them.
+ * Indices are 16 bits wide : on 8 bits MCUs, the main loop side needs to call in with interrupts disabled.
+ */
+
+/**
+ * @brief ring state
+ */
+typedef struct
+{
+    uint8_t *data;           /**> Storage, size bytes                                          */
+    uint16_t mask;           /**> Storage size - 1 (size is a power of two)                    */
+    uint16_t head;           /**> Free running write index (writer side only)                  */
+    uint16_t tail;           /**> Free running read index (reader side only)                   */
+    uint16_t dropped_bytes;  /**> Bytes lost because the ring was full (saturates)             */
+    uint16_t dropped_writes; /**> Writes (messages) lost because the ring was full (saturates) */
+} byte_ring_t;
+
+/**
+ * @brief empties the ring and clears its drop counters
+ * @param[in] storage : ring storage, needs to outlive the ring
+ * @param[in] size    : storage size, power of two (up to 32768)
+ */
+void byte_ring_init(byte_ring_t *const ring, uint8_t *const storage, const uint16_t size);
+
+/**
+ * @brief appends a message, or drops (and counts) it as a whole if it does not fit
+ * @return false if the message was dropped
+ */
+bool byte_ring_write(byte_ring_t *const ring, uint8_t const *const data, const uint16_t length);
+
+/**
+ * @brief same as byte_ring_write(), the message being kept in flash (FLASH_STORAGE, @see flash.h)
+ */
+bool byte_ring_write_flash(byte_ring_t *const ring, uint8_t const *const data, const uint16_t length);
+
+/**
+ * @brief takes the oldest byte out of the ring
+ * @param[out] byte : oldest byte, left untouched if the ring is empty
+ * @return false if the ring is empty
+ */
+bool byte_ring_read(byte_ring_t *const ring, uint8_t *const byte);
+
+/**
+ * @brief pending bytes
+ */
+uint16_t byte_ring_count(byte_ring_t const *const ring);
+
+/**
+ * @brief room left for the next write
+ */
+uint16_t byte_ring_free(byte_ring_t const *const ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BYTE_RING_HEADER */
@@ -4,9 +4,7 @@
 static void int_sqrt(int32_t const* const input, int32_t* const out);
 #endif
 
-static int16_t data[CURRENT_MEASURE_SAMPLES_PER_SINE] = {0};
-static uint8_t  index                                  = 0;
-static uint8_t  capacity                               = 0;
+static current_rms_window_t default_window = {0};
 
 #define SQRT_2X100 141
 
@@ -23,27 +21,43 @@ void current_export_internal_data(int16_t (* out_data)[CURRENT_MEASURE_SAMPLES_P
 {
     for(uint8_t i = 0 ; i < CURRENT_MEASURE_SAMPLES_PER_SINE ; i++)
     {
-        (*out_data)[i] = data[i];
+        (*out_data)[i] = default_window.data[i];
     }
 }
 
-// Note : very naive implementation
+void current_rms_window_init(current_rms_window_t* const window)
+{
+    for (uint8_t i = 0; i < CURRENT_MEASURE_SAMPLES_PER_SINE; i++)
+    {
+        window->data[i] = 0;
+    }
+    window->index    = 0;
+    window->capacity = 0;
+}
+
 void current_compute_rms_sine(int16_t const* const current_ma, int16_t* const out_rms_ma)
 {
+    current_rms_window_compute_sine(&default_window, current_ma, out_rms_ma);
+}
+
+// Note : very naive implementation
+void current_rms_window_compute_sine(current_rms_window_t* const window, int16_t const* const current_ma, int16_t* const out_rms_ma)
+{
+    int16_t* const data = window->data;
     uint8_t max_idx = 0;
     uint8_t min_idx = 0;
 
     // Store new input data in RMS buffer
-    data[index] = *current_ma;
-    index       = (index + 1) % CURRENT_MEASURE_SAMPLES_PER_SINE;
+    data[window->index] = *current_ma;
+    window->index       = (window->index + 1) % CURRENT_MEASURE_SAMPLES_PER_SINE;
 
-    if (capacity < CURRENT_MEASURE_SAMPLES_PER_SINE)
+    if (window->capacity < CURRENT_MEASURE_SAMPLES_PER_SINE)
     {
-        capacity++;
+        window->capacity++;
     }
 
     // Find min and max values in stored buffer
-    for (uint8_t i = 0; i < capacity; i++)
+    for (uint8_t i = 0; i < window->capacity; i++)
     {
         if (data[i] > data[max_idx])
         {
@@ -63,25 +77,33 @@ void current_compute_rms_sine(int16_t const* const current_ma, int16_t* const ou
 }
 
 #if CURRENT_RMS_ARBITRARY_FCT
-// Note : very naive implementation
 void current_compute_rms_arbitrary(int16_t const* const current_ma, int16_t* const out_rms_ma, int16_t const* const dc_offset_current)
 {
+    current_rms_window_compute_arbitrary(&default_window, current_ma, out_rms_ma, dc_offset_current);
+}
+
+// Note : very naive implementation
+void current_rms_window_compute_arbitrary(current_rms_window_t* const window, int16_t const* const current_ma, int16_t* const out_rms_ma,
+                                          int16_t const* const dc_offset_current)
+{
+    int16_t* const data = window->data;
+
     // Circular buffer
-    data[index] = *current_ma;
-    index       = (index + 1) % CURRENT_MEASURE_SAMPLES_PER_SINE;
-    capacity    = capacity < CURRENT_MEASURE_SAMPLES_PER_SINE ? capacity + 1 : capacity;
+    data[window->index] = *current_ma;
+    window->index       = (window->index + 1) % CURRENT_MEASURE_SAMPLES_PER_SINE;
+    window->capacity    = window->capacity < CURRENT_MEASURE_SAMPLES_PER_SINE ? window->capacity + 1 : window->capacity;
 
-    if (capacity == 0)
+    if (window->capacity == 0)
     {
         return;
     }
 
     uint32_t sum = 0;
-    for (uint8_t i = 0; i < capacity; i++)
+    for (uint8_t i = 0; i < window->capacity; i++)
     {
         sum += data[i] * data[i];
     }
-    uint32_t intermediate       = (sum / capacity);
+    uint32_t intermediate       = (sum / window->capacity);
     uint32_t global_rms_current = 0;
     int_sqrt(&intermediate, &global_rms_current);
 
@@ -12,6 +12,29 @@ extern "C"
 #define CURRENT_MEASURE_GAIN 22
 #define CURRENT_TRANSFORMER_INV_RATIO 10  /**> Current Transformer has a 1000:1 turn ratio, with a 0.1V/1A spec, so invert that*/
 #define CURRENT_RMS_ARBITRARY_FCT 0
+
+/**
+ * @brief RMS sliding window context (last N samples, @see CURRENT_MEASURE_SAMPLES_PER_SINE).
+ * The functions below that do not take a context work on a default, module-wide one.
+*/
+typedef struct
+{
+    int16_t data[CURRENT_MEASURE_SAMPLES_PER_SINE]; /**> Last current samples (milliamperes) */
+    uint8_t index;                                  /**> Next write position                  */
+    uint8_t capacity;                               /**> Count of valid samples in data       */
+} current_rms_window_t;
+
+/**
+ * @brief clears an RMS sliding window
+ * @param[out] window : window to be reset
+*/
+void current_rms_window_init(current_rms_window_t * const window);
+
+/**
+ * @brief same as current_compute_rms_sine(), using the given sliding window
+*/
+void current_rms_window_compute_sine(current_rms_window_t * const window, int16_t const * const current_ma, int16_t * const out_rms_ma);
+
 /**
  * @brief Computes current RMS over a sliding window (N last samples, @see CURRENT_MEASURE_SAMPLES_PER_SINE)
  * @param[in]   current_ma  : current reading in milliamperes
@@ -21,6 +44,11 @@ void current_compute_rms_sine(int16_t const * const current_ma, int16_t * const
 
 #if CURRENT_RMS_ARBITRARY_FCT
 
+/**
+ * @brief same as current_compute_rms_arbitrary(), using the given sliding window
+*/
+void current_rms_window_compute_arbitrary(current_rms_window_t * const window, int16_t const * const current_ma, int16_t * const out_rms_ma, int16_t const * const dc_offset);
+
 /**
  * @brief computes the RMS current value for an arbitrary waveform.
  * That's useful for waveforms that are not exact sine waves
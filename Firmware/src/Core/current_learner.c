@@ -0,0 +1,131 @@
+#include "current_learner.h"
+
+#define SIGMA_SHIFT 4U          /**> Standard deviation fractional bits (Q4)                       */
+#define PERCENT 100UL
+#define VARIANCE_MAX 0xFFFFFFUL /**> Keeps the Q8 variance within 32 bits (sigma below 4096 mA)     */
+
+// Bitwise integer square root, floor(sqrt(value))
+static uint32_t square_root(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30U;
+    while (bit > value)
+    {
+        bit >>= 2U;
+    }
+    while (bit != 0U)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1U) + bit;
+        }
+        else
+        {
+            root >>= 1U;
+        }
+        bit >>= 2U;
+    }
+    return root;
+}
+
+void current_learner_params_default(current_learner_params_t *const params)
+{
+    params->sigma_k = CURRENT_LEARNER_SIGMA_K;
+    params->min_runs = CURRENT_LEARNER_MIN_RUNS;
+    params->forget_shift = CURRENT_LEARNER_FORGET_SHIFT;
+    params->min_margin_percent = CURRENT_LEARNER_MIN_MARGIN_PERCENT;
+    params->min_samples = CURRENT_LEARNER_MIN_SAMPLES;
+}
+
+void current_run_init(current_run_t *const run)
+{
+    run->count = 0;
+    run->last_second = 0;
+    run->reference = 0;
+    run->sum = 0;
+    run->square_sum = 0;
+}
+
+void current_run_sample(current_run_t *const run, const int16_t rms, const uint32_t second)
+{
+    // Level based : one reading per second at most, and runs longer than the counters are cut short
+    if ((run->count == UINT16_MAX) || (second > UINT16_MAX) || ((run->count != 0U) && (second <= run->last_second)))
+    {
+        return;
+    }
+
+    if (run->count == 0U)
+    {
+        run->reference = rms;
+    }
+
+    const int32_t deviation = (int32_t)rms - run->reference;
+    const uint32_t magnitude = (uint32_t)((deviation < 0) ? -deviation : deviation);
+    const uint32_t square = magnitude * magnitude;
+    if (square > UINT32_MAX - run->square_sum)
+    {
+        return;
+    }
+
+    run->sum += deviation;
+    run->square_sum += square;
+    run->count++;
+    run->last_second = (uint16_t)second;
+}
+
+bool current_baseline_learn(current_learner_params_t const *const params, current_baseline_t *const baseline, current_run_t const *const run)
+{
+    if ((run->count == 0U) || (run->count < params->min_samples))
+    {
+        return false;
+    }
+
+    // Run statistics : mean (mA) and variance (mA²), 64 bits math only happens once per run
+    const int32_t count = (int32_t)run->count;
+    const int32_t run_sum = run->sum;
+    const int32_t run_mean = run->reference + ((run_sum >= 0) ? (run_sum + count / 2) : (run_sum - count / 2)) / count;
+    const int64_t spread = (int64_t)run->square_sum - ((int64_t)run_sum * run_sum) / count;
+    const int64_t run_variance = ((spread > 0) ? spread : 0) / count;
+    if (run_mean <= 0)
+    {
+        return false;
+    }
+
+    // Plain average over the first runs, exponential forgetting afterwards
+    const int32_t divisor = ((uint32_t)baseline->runs + 1U < (1UL << params->forget_shift)) ? (int32_t)baseline->runs + 1
+                                                                                             : (int32_t)(1UL << params->forget_shift);
+    const int32_t mean = (int32_t)baseline->mean;
+    const int64_t variance = (int64_t)(((uint32_t)baseline->sigma * baseline->sigma) >> (2U * SIGMA_SHIFT));
+    const int32_t delta = run_mean - mean;
+    const int64_t between = ((int64_t)delta * delta * (divisor - 1)) / divisor;
+    int64_t new_variance = variance + (run_variance + between - variance) / divisor;
+    int32_t new_mean = mean + ((delta >= 0) ? (delta + divisor / 2) : (delta - divisor / 2)) / divisor;
+
+    new_variance = (new_variance < 0) ? 0 : ((new_variance > (int64_t)VARIANCE_MAX) ? (int64_t)VARIANCE_MAX : new_variance);
+    new_mean = (new_mean > (int32_t)UINT16_MAX) ? (int32_t)UINT16_MAX : new_mean;
+
+    baseline->mean = (uint16_t)new_mean;
+    baseline->sigma = (uint16_t)square_root((uint32_t)new_variance << (2U * SIGMA_SHIFT));
+    baseline->runs = (baseline->runs < CURRENT_LEARNER_RUNS_MAX) ? (uint8_t)(baseline->runs + 1U) : baseline->runs;
+    return true;
+}
+
+uint16_t current_baseline_threshold(current_learner_params_t const *const params, current_baseline_t const *const baseline,
+                                    const uint8_t max_margin_percent)
+{
+    const uint32_t mean = baseline->mean;
+    const uint32_t max_margin = (mean * max_margin_percent) / PERCENT;
+    uint32_t margin = max_margin;
+
+    if (baseline->runs >= params->min_runs)
+    {
+        const uint32_t min_margin = (mean * params->min_margin_percent) / PERCENT;
+        margin = ((uint32_t)params->sigma_k * baseline->sigma) >> (2U * SIGMA_SHIFT);
+        margin = (margin < min_margin) ? min_margin : margin;
+        margin = (margin > max_margin) ? max_margin : margin;
+    }
+
+    const uint32_t threshold = mean + margin;
+    return (uint16_t)((threshold > UINT16_MAX) ? UINT16_MAX : threshold);
+}
@@ -0,0 +1,109 @@
+#ifndef CURRENT_LEARNER_HEADER
+#define CURRENT_LEARNER_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Compressor running current baseline, learnt over many runs instead of a single reading.
+ * Each run accumulates one RMS reading per second once the motor is steady : its mean and variance are then folded in the baseline
+ * statistics (mean and standard deviation), weighted as a plain average over the first runs and with an exponential forgetting afterwards,
+ * so that the baseline follows the compressor aging and the seasons. Merging a run also accounts for the spread in between runs :
+ *      var = var + w x (run_var + (1 - w) x (run_mean - mean)² - var)
+ * The overcurrent (stall) threshold is then mean + k x sigma, kept within a margin range relative to the mean. Until enough runs were
+ * learnt, the widest margin is used, like the former fixed percentage.
+ */
+
+// clang-format off
+#ifndef CURRENT_LEARNER_SIGMA_K
+#define CURRENT_LEARNER_SIGMA_K (5U * 16U)     /**> Stall threshold distance from the mean, in standard deviations (Q4)                */
+#endif
+#ifndef CURRENT_LEARNER_MIN_RUNS
+#define CURRENT_LEARNER_MIN_RUNS 3U            /**> Runs learnt before the statistical margin replaces the widest one                 */
+#endif
+#ifndef CURRENT_LEARNER_FORGET_SHIFT
+#define CURRENT_LEARNER_FORGET_SHIFT 4U        /**> Past the first 2^shift runs, each new run counts for 1 / 2^shift                 */
+#endif
+#ifndef CURRENT_LEARNER_MIN_MARGIN_PERCENT
+#define CURRENT_LEARNER_MIN_MARGIN_PERCENT 6U  /**> Tightest stall margin above the mean (percent)                                   */
+#endif
+#ifndef CURRENT_LEARNER_MIN_SAMPLES
+#define CURRENT_LEARNER_MIN_SAMPLES 60U        /**> Steady readings (seconds) a run needs to be learnt                               */
+#endif
+#define CURRENT_LEARNER_RUNS_MAX 0xFFU          /**> Learnt runs counter saturates there                                              */
+// clang-format on
+
+/**
+ * @brief learner tuning (default to the compile time constants above)
+ */
+typedef struct
+{
+    uint8_t sigma_k;            /**> Stall threshold distance from the mean (standard deviations, Q4)     */
+    uint8_t min_runs;           /**> Runs needed before the statistical margin is used                    */
+    uint8_t forget_shift;       /**> Exponential forgetting weight (1 / 2^shift per run)                  */
+    uint8_t min_margin_percent; /**> Tightest stall margin (percent of the mean)                          */
+    uint16_t min_samples;       /**> Steady readings a run needs to be learnt                             */
+} current_learner_params_t;
+
+/**
+ * @brief running statistics of the current compressor run, in deviations from its first reading so that they fit 32 bits
+ */
+typedef struct
+{
+    uint16_t count;       /**> Readings accumulated                                              */
+    uint16_t last_second; /**> Last reading time, since the motor start (seconds)                */
+    int16_t reference;    /**> First reading (mA)                                                */
+    int32_t sum;          /**> Sum of the deviations from the reference (mA)                     */
+    uint32_t square_sum;  /**> Sum of the squared deviations (mA²), accumulation stops at its top */
+} current_run_t;
+
+/**
+ * @brief baseline statistics, stored in persistent memory
+ */
+typedef struct
+{
+    uint16_t mean;  /**> Mean running current (mA, 0 : not learnt)     */
+    uint16_t sigma; /**> Standard deviation (Q4 mA)                    */
+    uint8_t runs;   /**> Runs learnt so far (saturates)                */
+} current_baseline_t;
+
+/**
+ * @brief fills the tuning with the compile time defaults
+ */
+void current_learner_params_default(current_learner_params_t *const params);
+
+/**
+ * @brief starts a new run accumulation
+ */
+void current_run_init(current_run_t *const run);
+
+/**
+ * @brief accumulates a steady reading, at most once per second : can be called on every step
+ * @param[in] rms    : RMS current (mA)
+ * @param[in] second : time elapsed since the motor start (seconds)
+ */
+void current_run_sample(current_run_t *const run, const int16_t rms, const uint32_t second);
+
+/**
+ * @brief folds a finished run in the baseline, if it holds enough readings
+ * @return true if the baseline changed
+ */
+bool current_baseline_learn(current_learner_params_t const *const params, current_baseline_t *const baseline, current_run_t const *const run);
+
+/**
+ * @brief overcurrent threshold : mean + k x sigma, within [min margin, max margin] above the mean
+ * @param[in] max_margin_percent : widest margin, used alone until enough runs were learnt (percent of the mean)
+ * @return threshold (mA), 0 if the baseline is not learnt
+ */
+uint16_t current_baseline_threshold(current_learner_params_t const *const params, current_baseline_t const *const baseline,
+                                    const uint8_t max_margin_percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CURRENT_LEARNER_HEADER */
@@ -0,0 +1,36 @@
+#ifndef FLASH_HEADER
+#define FLASH_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Read-only tables kept in program memory.
+ * AVR has separate address spaces : const data is copied to RAM at startup unless it's tagged PROGMEM, and then needs
+ * to be read with the LPM instruction (pgm_read_*). Other targets (host builds, tests) read it as regular memory.
+ * String literals are no exception : log messages and formats go through FLASH_STRING() so that they don't take RAM.
+ */
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define FLASH_STORAGE PROGMEM                         /**> Places a const table in program memory                        */
+#define FLASH_READ_U8(address) pgm_read_byte(address) /**> Reads a byte of a FLASH_STORAGE table                          */
+#define FLASH_STRING(text) PSTR(text)                 /**> String literal kept in program memory (function scope only)   */
+#define FLASH_STRLEN(text) strlen_P(text)             /**> Length of a FLASH_STRING()                                    */
+#define FLASH_SNPRINTF snprintf_P                     /**> snprintf() taking a FLASH_STRING() format                     */
+#else
+#include <stdio.h>
+#include <string.h>
+#define FLASH_STORAGE
+#define FLASH_READ_U8(address) (*(address))
+#define FLASH_STRING(text) (text)
+#define FLASH_STRLEN(text) strlen(text)
+#define FLASH_SNPRINTF snprintf
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_HEADER */
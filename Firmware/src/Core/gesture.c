@@ -0,0 +1,228 @@
+#include "gesture.h"
+#include "flash.h"
+
+#define QUEUE_MASK (GESTURE_QUEUE_SIZE - 1U)
+#define GESTURE_NONE 0xFFU /**> Transition raises no gesture */
+
+/**
+ * @brief recognizer inputs, the edges are relative to the button the gesture in progress is about
+ */
+typedef enum
+{
+    INPUT_PRESS_SAME,  /**> That button is pressed                       */
+    INPUT_PRESS_OTHER, /**> Another button is pressed                    */
+    INPUT_RELEASE_ONE, /**> A button is released, others are still down  */
+    INPUT_RELEASE_ALL, /**> The last button down is released             */
+    INPUT_TIMEOUT,     /**> Timer expired                                */
+} input_t;
+
+/**
+ * @brief timer action of a transition
+ */
+typedef enum
+{
+    TIMER_STOP,
+    TIMER_DOUBLE_CLICK,
+    TIMER_LONG_PRESS,
+    TIMER_REPEAT,
+    TIMER_CHORD,
+} timer_action_t;
+
+/**
+ * @brief transition table row : state, input, next state, gesture raised, timer armed
+ */
+enum
+{
+    ROW_STATE,
+    ROW_INPUT,
+    ROW_NEXT,
+    ROW_GESTURE,
+    ROW_TIMER,
+    ROW_SIZE
+};
+
+// clang-format off
+// Pairs missing from the table leave the state (and the timer) untouched
+static const uint8_t transitions[][ROW_SIZE] FLASH_STORAGE = {
+    {GESTURE_STATE_IDLE,      INPUT_PRESS_SAME,  GESTURE_STATE_PRESSED,   GESTURE_NONE,         TIMER_LONG_PRESS  },
+    {GESTURE_STATE_IDLE,      INPUT_PRESS_OTHER, GESTURE_STATE_PRESSED,   GESTURE_NONE,         TIMER_LONG_PRESS  },
+    {GESTURE_STATE_PRESSED,   INPUT_PRESS_OTHER, GESTURE_STATE_CHORD,     GESTURE_NONE,         TIMER_CHORD       },
+    {GESTURE_STATE_PRESSED,   INPUT_RELEASE_ALL, GESTURE_STATE_RELEASED,  GESTURE_NONE,         TIMER_DOUBLE_CLICK},
+    {GESTURE_STATE_PRESSED,   INPUT_TIMEOUT,     GESTURE_STATE_REPEATING, GESTURE_LONG_PRESS,   TIMER_REPEAT      },
+    {GESTURE_STATE_RELEASED,  INPUT_PRESS_SAME,  GESTURE_STATE_SECOND,    GESTURE_DOUBLE_CLICK, TIMER_STOP        },
+    {GESTURE_STATE_RELEASED,  INPUT_PRESS_OTHER, GESTURE_STATE_PRESSED,   GESTURE_CLICK,        TIMER_LONG_PRESS  },
+    {GESTURE_STATE_RELEASED,  INPUT_TIMEOUT,     GESTURE_STATE_IDLE,      GESTURE_CLICK,        TIMER_STOP        },
+    {GESTURE_STATE_SECOND,    INPUT_PRESS_OTHER, GESTURE_STATE_CHORD,     GESTURE_NONE,         TIMER_CHORD       },
+    {GESTURE_STATE_SECOND,    INPUT_RELEASE_ALL, GESTURE_STATE_IDLE,      GESTURE_NONE,         TIMER_STOP        },
+    {GESTURE_STATE_REPEATING, INPUT_PRESS_OTHER, GESTURE_STATE_CHORD,     GESTURE_NONE,         TIMER_CHORD       },
+    {GESTURE_STATE_REPEATING, INPUT_RELEASE_ALL, GESTURE_STATE_IDLE,      GESTURE_NONE,         TIMER_STOP        },
+    {GESTURE_STATE_REPEATING, INPUT_TIMEOUT,     GESTURE_STATE_REPEATING, GESTURE_REPEAT,       TIMER_REPEAT      },
+    {GESTURE_STATE_CHORD,     INPUT_RELEASE_ONE, GESTURE_STATE_DRAINING,  GESTURE_NONE,         TIMER_STOP        },
+    {GESTURE_STATE_CHORD,     INPUT_TIMEOUT,     GESTURE_STATE_DRAINING,  GESTURE_CHORD,        TIMER_STOP        },
+    {GESTURE_STATE_DRAINING,  INPUT_RELEASE_ALL, GESTURE_STATE_IDLE,      GESTURE_NONE,         TIMER_STOP        },
+};
+// clang-format on
+
+#define TRANSITION_COUNT (sizeof(transitions) / sizeof(transitions[0]))
+
+void gesture_params_default(gesture_params_t *const params)
+{
+    params->double_click_ms = GESTURE_DOUBLE_CLICK_MS;
+    params->long_press_ms = GESTURE_LONG_PRESS_MS;
+    params->repeat_ms = GESTURE_REPEAT_MS;
+    params->chord_ms = GESTURE_CHORD_MS;
+}
+
+void gesture_queue_init(gesture_queue_t *const queue)
+{
+    queue->head = 0;
+    queue->count = 0;
+    queue->dropped = 0;
+}
+
+bool gesture_queue_push(gesture_queue_t *const queue, const uint8_t button, const uint8_t kind)
+{
+    // Older gestures are kept : the application sees them in the order they were made
+    if (queue->count >= GESTURE_QUEUE_SIZE)
+    {
+        queue->dropped = (queue->dropped < UINT8_MAX) ? (uint8_t)(queue->dropped + 1U) : queue->dropped;
+        return false;
+    }
+
+    gesture_event_t *const event = &queue->events[(queue->head + queue->count) & QUEUE_MASK];
+    event->button = button;
+    event->kind = kind;
+    queue->count++;
+    return true;
+}
+
+bool gesture_queue_pop(gesture_queue_t *const queue, gesture_event_t *const event)
+{
+    if (queue->count == 0U)
+    {
+        return false;
+    }
+
+    *event = queue->events[queue->head];
+    queue->head = (uint8_t)((queue->head + 1U) & QUEUE_MASK);
+    queue->count--;
+    return true;
+}
+
+void gesture_init(gesture_recognizer_t *const recognizer)
+{
+    recognizer->state = GESTURE_STATE_IDLE;
+    recognizer->button = 0;
+    recognizer->down = 0;
+    recognizer->timer_armed = false;
+    time_default(&recognizer->deadline);
+}
+
+// Arms the timer from the input time (edge time, or the deadline that just expired so that repeats don't drift)
+static void arm_timer(gesture_params_t const *const params, gesture_recognizer_t *const recognizer, const uint8_t timer,
+                      mcu_time_t const *const origin)
+{
+    uint16_t delay_ms = 0;
+    bool armed = true;
+    switch (timer)
+    {
+        case TIMER_DOUBLE_CLICK:
+            delay_ms = params->double_click_ms;
+            break;
+        case TIMER_LONG_PRESS:
+            delay_ms = params->long_press_ms;
+            break;
+        case TIMER_REPEAT:
+            delay_ms = params->repeat_ms;
+            armed = (params->repeat_ms != 0U);
+            break;
+        case TIMER_CHORD:
+            delay_ms = params->chord_ms;
+            break;
+        case TIMER_STOP:
+        default:
+            armed = false;
+            break;
+    }
+
+    recognizer->timer_armed = armed;
+    recognizer->deadline = *origin;
+    time_add_ms(&recognizer->deadline, delay_ms);
+}
+
+static void apply(gesture_params_t const *const params, gesture_recognizer_t *const recognizer, const uint8_t input, const uint8_t button,
+                  mcu_time_t const *const time, gesture_queue_t *const queue)
+{
+    for (uint8_t i = 0; i < TRANSITION_COUNT; i++)
+    {
+        if ((FLASH_READ_U8(&transitions[i][ROW_STATE]) != recognizer->state) || (FLASH_READ_U8(&transitions[i][ROW_INPUT]) != input))
+        {
+            continue;
+        }
+
+        const uint8_t next = FLASH_READ_U8(&transitions[i][ROW_NEXT]);
+        const uint8_t gesture = FLASH_READ_U8(&transitions[i][ROW_GESTURE]);
+        if (gesture != GESTURE_NONE)
+        {
+            gesture_queue_push(queue, (gesture == GESTURE_CHORD) ? GESTURE_ALL_BUTTONS : recognizer->button, gesture);
+        }
+
+        // A new single button gesture starts with the press that leads to it
+        if ((next == GESTURE_STATE_PRESSED) && ((input == INPUT_PRESS_SAME) || (input == INPUT_PRESS_OTHER)))
+        {
+            recognizer->button = button;
+        }
+        recognizer->state = next;
+        arm_timer(params, recognizer, FLASH_READ_U8(&transitions[i][ROW_TIMER]), time);
+        return;
+    }
+}
+
+void gesture_process(gesture_params_t const *const params, gesture_recognizer_t *const recognizer, mcu_time_t const *const now,
+                     gesture_queue_t *const queue)
+{
+    while (recognizer->timer_armed && (time_compare(&recognizer->deadline, now) <= 0))
+    {
+        const mcu_time_t expired = recognizer->deadline;
+        recognizer->timer_armed = false;
+        apply(params, recognizer, INPUT_TIMEOUT, recognizer->button, &expired, queue);
+    }
+}
+
+void gesture_edge(gesture_params_t const *const params, gesture_recognizer_t *const recognizer, const uint8_t button, const bool pressed,
+                  mcu_time_t const *const time, gesture_queue_t *const queue)
+{
+    const uint8_t mask = (uint8_t)(1U << button);
+    if (pressed == ((recognizer->down & mask) != 0U))
+    {
+        return;
+    }
+
+    gesture_process(params, recognizer, time, queue);
+
+    uint8_t input;
+    if (pressed)
+    {
+        recognizer->down |= mask;
+        input = (button == recognizer->button) ? INPUT_PRESS_SAME : INPUT_PRESS_OTHER;
+    }
+    else
+    {
+        recognizer->down &= (uint8_t)~mask;
+        input = (recognizer->down == 0U) ? INPUT_RELEASE_ALL : INPUT_RELEASE_ONE;
+    }
+    apply(params, recognizer, input, button, time, queue);
+
+    // Zero delays expire right away (e.g. no double click : clicks are raised on release)
+    gesture_process(params, recognizer, time, queue);
+}
+
+bool gesture_get_deadline(gesture_recognizer_t const *const recognizer, mcu_time_t *const deadline)
+{
+    if (!recognizer->timer_armed)
+    {
+        return false;
+    }
+    *deadline = recognizer->deadline;
+    return true;
+}
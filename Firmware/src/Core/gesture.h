@@ -0,0 +1,177 @@
+#ifndef GESTURE_HEADER
+#define GESTURE_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "buttons.h"
+#include "mcu_time.h"
+
+/**
+ * @brief turns the debounced buttons edges (@see buttons.h) into gestures, queued for the application.
+ * The recognizer is a state machine whose transitions are a table kept in flash : each (state, input) pair gives the next state,
+ * the gesture raised and the timer armed. Inputs are the edges (press or release, of the button the gesture is about or of the other one)
+ * and the timer expiry. Recognized gestures :
+ *  - GESTURE_CLICK        : pressed and released, not followed by a second press within the double click delay
+ *  - GESTURE_DOUBLE_CLICK : pressed again within the double click delay, raised on the second press
+ *  - GESTURE_LONG_PRESS   : held past the long press delay, then GESTURE_REPEAT every repeat period until released
+ *  - GESTURE_CHORD        : both buttons held together for the chord delay (single button gestures in progress are dropped)
+ * Timers run from the edges and from each other, so that gestures only depend on the edges timestamps and not on when the
+ * recognizer is called.
+ */
+
+// clang-format off
+#ifndef GESTURE_DOUBLE_CLICK_MS
+#define GESTURE_DOUBLE_CLICK_MS 300U /**> Longest gap in between a release and the next press of a double click (milliseconds) */
+#endif
+#ifndef GESTURE_LONG_PRESS_MS
+#define GESTURE_LONG_PRESS_MS 600U   /**> Press duration after which a long press is raised, and auto-repeat starts            */
+#endif
+#ifndef GESTURE_REPEAT_MS
+#define GESTURE_REPEAT_MS 200U       /**> Auto-repeat period while the button stays held (milliseconds)                         */
+#endif
+#ifndef GESTURE_CHORD_MS
+#define GESTURE_CHORD_MS 3000U       /**> Both buttons need to be held that long to raise a chord (milliseconds)                */
+#endif
+#ifndef GESTURE_QUEUE_SIZE
+#define GESTURE_QUEUE_SIZE 8U        /**> Pending gestures, power of two (the oldest ones are kept when it is full)             */
+#endif
+// clang-format on
+
+#if (GESTURE_QUEUE_SIZE & (GESTURE_QUEUE_SIZE - 1U)) != 0U
+#error "GESTURE_QUEUE_SIZE must be a power of two"
+#endif
+
+#define GESTURE_ALL_BUTTONS BUTTON_COUNT /**> Button of the gestures made with all the buttons (chord) */
+
+/**
+ * @brief gestures raised by the recognizer
+ */
+typedef enum
+{
+    GESTURE_CLICK,        /**> Single short press, raised once the double click delay is over   */
+    GESTURE_DOUBLE_CLICK, /**> Second press within the double click delay                       */
+    GESTURE_LONG_PRESS,   /**> Held past the long press delay                                   */
+    GESTURE_REPEAT,       /**> Still held, one per repeat period after the long press           */
+    GESTURE_CHORD,        /**> All buttons held together past the chord delay                   */
+    GESTURE_COUNT         /**> Number of gestures, not a valid gesture                          */
+} gesture_kind_t;
+
+/**
+ * @brief recognizer states
+ */
+typedef enum
+{
+    GESTURE_STATE_IDLE,      /**> No button down                                               */
+    GESTURE_STATE_PRESSED,   /**> Single button down, before the long press delay              */
+    GESTURE_STATE_RELEASED,  /**> Short press released, waiting for a second one               */
+    GESTURE_STATE_SECOND,    /**> Double click done, waiting for the release                   */
+    GESTURE_STATE_REPEATING, /**> Long press, auto-repeating until the release                 */
+    GESTURE_STATE_CHORD,     /**> All buttons down, before the chord delay                     */
+    GESTURE_STATE_DRAINING,  /**> Waiting for all the buttons to be released (chord ended)     */
+    GESTURE_STATE_COUNT      /**> Number of states, not a valid state                          */
+} gesture_state_t;
+
+/**
+ * @brief recognizer timings (default to the compile time constants above)
+ */
+typedef struct
+{
+    uint16_t double_click_ms; /**> Double click delay (milliseconds, 0 : no double click, clicks are raised right away) */
+    uint16_t long_press_ms;   /**> Long press delay (milliseconds)                                                     */
+    uint16_t repeat_ms;       /**> Auto-repeat period (milliseconds, 0 : no auto-repeat)                               */
+    uint16_t chord_ms;        /**> Chord delay (milliseconds)                                                          */
+} gesture_params_t;
+
+/**
+ * @brief queued gesture
+ */
+typedef struct
+{
+    uint8_t button; /**> Button that made the gesture (button_id_t, GESTURE_ALL_BUTTONS for a chord) */
+    uint8_t kind;   /**> Gesture (gesture_kind_t)                                                     */
+} gesture_event_t;
+
+/**
+ * @brief gestures raised by the recognizer, drained by the application
+ */
+typedef struct
+{
+    gesture_event_t events[GESTURE_QUEUE_SIZE]; /**> Ring buffer                                          */
+    uint8_t head;                               /**> Next gesture to be read                              */
+    uint8_t count;                              /**> Pending gestures                                     */
+    uint8_t dropped;                            /**> Gestures lost because the queue was full (saturates) */
+} gesture_queue_t;
+
+/**
+ * @brief recognizer state
+ */
+typedef struct
+{
+    uint8_t state;       /**> Current state (gesture_state_t)                             */
+    uint8_t button;      /**> Button the gesture in progress is about                    */
+    uint8_t down;        /**> Buttons currently down (bit n : button n)                  */
+    bool timer_armed;    /**> A timer runs, the timeout input is raised at its deadline  */
+    mcu_time_t deadline; /**> Timer expiry                                               */
+} gesture_recognizer_t;
+
+/**
+ * @brief fills the timings with the compile time defaults
+ */
+void gesture_params_default(gesture_params_t *const params);
+
+/**
+ * @brief empties the queue and clears its drop counter
+ */
+void gesture_queue_init(gesture_queue_t *const queue);
+
+/**
+ * @brief appends a gesture, dropped (and counted) if the queue is full
+ * @return false if the gesture was dropped
+ */
+bool gesture_queue_push(gesture_queue_t *const queue, const uint8_t button, const uint8_t kind);
+
+/**
+ * @brief takes the oldest pending gesture out of the queue
+ * @param[out] event : oldest gesture, left untouched if the queue is empty
+ * @return false if the queue is empty
+ */
+bool gesture_queue_pop(gesture_queue_t *const queue, gesture_event_t *const event);
+
+/**
+ * @brief resets the recognizer : no button down, no timer
+ */
+void gesture_init(gesture_recognizer_t *const recognizer);
+
+/**
+ * @brief feeds a debounced edge. Timers that expire up to the edge are handled first.
+ * @param[in] button  : button identifier (button_id_t)
+ * @param[in] pressed : edge direction (true : pressed)
+ * @param[in] time    : edge time, edges and gesture_process() calls need to come in chronological order
+ */
+void gesture_edge(gesture_params_t const *const params, gesture_recognizer_t *const recognizer, const uint8_t button, const bool pressed,
+                  mcu_time_t const *const time, gesture_queue_t *const queue);
+
+/**
+ * @brief handles the timers that expired up to now (auto-repeats missed by a late call are all raised)
+ */
+void gesture_process(gesture_params_t const *const params, gesture_recognizer_t *const recognizer, mcu_time_t const *const now,
+                     gesture_queue_t *const queue);
+
+/**
+ * @brief next time gesture_process() needs to be called, even if no edge comes in
+ * @param[out] deadline : timer expiry, left untouched if no timer runs
+ * @return false if the recognizer only waits for edges
+ */
+bool gesture_get_deadline(gesture_recognizer_t const *const recognizer, mcu_time_t *const deadline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GESTURE_HEADER */
@@ -0,0 +1,118 @@
+#include "idle.h"
+
+#include <stddef.h>
+
+typedef struct
+{
+    bool armed;          /**> Whether this user currently constrains sleep  */
+    mcu_time_t deadline; /**> Next time this user needs to run              */
+} idle_deadline_t;
+
+static idle_deadline_t deadlines[IDLE_USER_COUNT];
+
+static struct
+{
+    mcu_time_t start;   /**> Start of the current statistics window                       */
+    uint32_t asleep_us; /**> Time spent asleep since start (microseconds)                 */
+} stats_window;
+
+void idle_init(mcu_time_t const *const now)
+{
+    for (uint8_t i = 0; i < IDLE_USER_COUNT; i++)
+    {
+        deadlines[i].armed = false;
+        time_default(&deadlines[i].deadline);
+    }
+    idle_reset_stats(now);
+}
+
+void idle_set_deadline(const idle_user_t user, mcu_time_t const *const deadline)
+{
+    if (user >= IDLE_USER_COUNT)
+    {
+        return;
+    }
+    deadlines[user].armed = true;
+    deadlines[user].deadline = *deadline;
+}
+
+void idle_clear_deadline(const idle_user_t user)
+{
+    if (user >= IDLE_USER_COUNT)
+    {
+        return;
+    }
+    deadlines[user].armed = false;
+}
+
+bool idle_get_next_deadline(mcu_time_t *const deadline)
+{
+    mcu_time_t const *earliest = NULL;
+    for (uint8_t i = 0; i < IDLE_USER_COUNT; i++)
+    {
+        if (deadlines[i].armed && ((NULL == earliest) || (time_compare(&deadlines[i].deadline, earliest) < 0)))
+        {
+            earliest = &deadlines[i].deadline;
+        }
+    }
+
+    if (NULL == earliest)
+    {
+        return false;
+    }
+    *deadline = *earliest;
+    return true;
+}
+
+uint16_t idle_get_sleep_budget_ms(mcu_time_t const *const now)
+{
+    mcu_time_t deadline;
+    if (!idle_get_next_deadline(&deadline))
+    {
+        return IDLE_MAX_SLEEP_MS;
+    }
+
+    // Returns 0 when the deadline is already reached (or late)
+    uint32_t budget = time_elapsed_ms(now, &deadline);
+    return budget > IDLE_MAX_SLEEP_MS ? IDLE_MAX_SLEEP_MS : (uint16_t)budget;
+}
+
+void idle_account_sleep(const uint32_t slept_us)
+{
+    // Saturate instead of wrapping around if the window is never reset
+    if (UINT32_MAX - stats_window.asleep_us < slept_us)
+    {
+        stats_window.asleep_us = UINT32_MAX;
+        return;
+    }
+    stats_window.asleep_us += slept_us;
+}
+
+void idle_get_stats(mcu_time_t const *const now, idle_stats_t *const stats)
+{
+    stats->window_ms = time_elapsed_ms(&stats_window.start, now);
+    stats->asleep_ms = stats_window.asleep_us / 1000U;
+
+    // Sleep measurement and window use different clocks, clamp ratio to 100%
+    if (stats->asleep_ms > stats->window_ms)
+    {
+        stats->asleep_ms = stats->window_ms;
+    }
+
+    // Stays on 32 bits arithmetic (64 bits divisions are expensive on AVR)
+    stats->asleep_permille = 0;
+    if (stats->window_ms > (UINT32_MAX / 1000U))
+    {
+        stats->asleep_permille = (uint16_t)(stats->asleep_ms / (stats->window_ms / 1000U));
+    }
+    else if (stats->window_ms != 0)
+    {
+        stats->asleep_permille = (uint16_t)((stats->asleep_ms * 1000U) / stats->window_ms);
+    }
+}
+
+void idle_reset_stats(mcu_time_t const *const now)
+{
+    stats_window.start = *now;
+    stats_window.asleep_us = 0;
+}
@@ -0,0 +1,90 @@
+#ifndef IDLE_HEADER
+#define IDLE_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mcu_time.h"
+
+#ifndef IDLE_MAX_SLEEP_MS
+#define IDLE_MAX_SLEEP_MS 250U /**> Upper bound of a single sleep request, even when no deadline is armed (milliseconds) */
+#endif
+
+/**
+ * @brief lists the timebase users which can prevent the MCU from sleeping.
+ */
+typedef enum
+{
+    IDLE_USER_LED,         /**> LED driver (soft PWM and blink patterns)  */
+    IDLE_USER_CURRENT,     /**> Current sensor sampling                   */
+    IDLE_USER_TEMPERATURE, /**> Temperature sensor sampling               */
+    IDLE_USER_BUTTONS,     /**> Buttons debouncing and long press timers  */
+    IDLE_USER_COUNT        /**> Number of users, not a valid user         */
+} idle_user_t;
+
+/**
+ * @brief awake/asleep statistics, computed over a measurement window
+ */
+typedef struct
+{
+    uint32_t window_ms;       /**> Measurement window length (milliseconds)        */
+    uint32_t asleep_ms;       /**> Time spent sleeping within the window           */
+    uint16_t asleep_permille; /**> Ratio of the window spent asleep (0 - 1000)      */
+} idle_stats_t;
+
+/**
+ * @brief disarms all deadlines and restarts the statistics window.
+ * @param[in] now : current time
+ */
+void idle_init(mcu_time_t const *const now);
+
+/**
+ * @brief arms (or moves) the next deadline of a given user.
+ * @param[in] user     : timebase user
+ * @param[in] deadline : absolute time at which the user needs to be processed again
+ */
+void idle_set_deadline(const idle_user_t user, mcu_time_t const *const deadline);
+
+/**
+ * @brief disarms the deadline of a given user (it won't constrain sleep anymore).
+ */
+void idle_clear_deadline(const idle_user_t user);
+
+/**
+ * @brief computes the earliest armed deadline across all users.
+ * @param[out] deadline : earliest deadline, left untouched if none is armed
+ * @return true if at least one deadline is armed, false otherwise
+ */
+bool idle_get_next_deadline(mcu_time_t *const deadline);
+
+/**
+ * @brief computes how long the MCU can sleep without missing a deadline.
+ * @param[in] now : current time
+ * @return sleep budget in milliseconds (0 : don't sleep), capped to IDLE_MAX_SLEEP_MS
+ */
+uint16_t idle_get_sleep_budget_ms(mcu_time_t const *const now);
+
+/**
+ * @brief accounts time spent asleep in the current statistics window.
+ * @param[in] slept_us : time spent asleep (microseconds)
+ */
+void idle_account_sleep(const uint32_t slept_us);
+
+/**
+ * @brief computes awake/asleep statistics since the beginning of the current window.
+ */
+void idle_get_stats(mcu_time_t const *const now, idle_stats_t *const stats);
+
+/**
+ * @brief starts a new statistics window
+ */
+void idle_reset_stats(mcu_time_t const *const now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IDLE_HEADER */
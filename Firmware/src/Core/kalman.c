@@ -0,0 +1,92 @@
+#include "kalman.h"
+
+#define KALMAN_Q8_SHIFT 8U
+#define KALMAN_GAIN_SHIFT 16U                                       /**> Gains are Q16                                           */
+#define KALMAN_INITIAL_SLOPE_VARIANCE ((int32_t)364 * 364 * 256)   /**> Slope is unknown at boot : (20°C/h)² in Q8 v² at 1 Hz   */
+#define KALMAN_MS_PER_HOUR 3600000UL
+
+static int16_t clamp16(const int32_t value)
+{
+    return (value < INT16_MIN) ? INT16_MIN : ((value > INT16_MAX) ? INT16_MAX : (int16_t)value);
+}
+
+void kalman_params_default(kalman_params_t *const params)
+{
+    params->measurement_noise = KALMAN_MEASUREMENT_NOISE;
+    params->temperature_noise = KALMAN_TEMPERATURE_NOISE;
+    params->slope_noise = KALMAN_SLOPE_NOISE;
+    params->sample_period_ms = KALMAN_SAMPLE_PERIOD_MS;
+}
+
+void kalman_init(kalman_state_t *const state)
+{
+    state->temperature = 0;
+    state->slope = 0;
+    state->p00 = 0;
+    state->p01 = 0;
+    state->p11 = 0;
+    state->started = false;
+}
+
+void kalman_skip(kalman_state_t *const state)
+{
+    if (state->started)
+    {
+        state->temperature += state->slope >> KALMAN_Q8_SHIFT;
+    }
+}
+
+void kalman_update(kalman_params_t const *const params, kalman_state_t *const state, const int16_t measurement)
+{
+    const int32_t noise = (int32_t)((params->measurement_noise == 0U) ? 1U : params->measurement_noise) << KALMAN_Q8_SHIFT;
+    const int32_t measured = (int32_t)measurement << KALMAN_Q8_SHIFT;
+
+    if (!state->started)
+    {
+        state->temperature = measured;
+        state->slope = 0;
+        state->p00 = noise;
+        state->p01 = 0;
+        state->p11 = KALMAN_INITIAL_SLOPE_VARIANCE;
+        state->started = true;
+        return;
+    }
+
+    // Predict : one sample period at the current slope (1 v = 1/256 u per sample)
+    state->temperature += state->slope >> KALMAN_Q8_SHIFT;
+    state->p00 += (state->p01 / 128) + (state->p11 / 65536) + params->temperature_noise;
+    state->p01 += state->p11 / 256;
+    state->p11 += params->slope_noise;
+
+    // Correct : gains are below 1 for the temperature, in v/u for the slope
+    const int32_t innovation = measured - state->temperature;
+    const int64_t innovation_variance = (int64_t)state->p00 + noise;
+    const int32_t gain_temperature = (int32_t)(((int64_t)state->p00 << KALMAN_GAIN_SHIFT) / innovation_variance);
+    const int32_t gain_slope = (int32_t)(((int64_t)state->p01 << KALMAN_GAIN_SHIFT) / innovation_variance);
+
+    state->temperature += (int32_t)(((int64_t)gain_temperature * innovation) >> KALMAN_GAIN_SHIFT);
+    state->slope += (int32_t)(((int64_t)gain_slope * innovation) >> KALMAN_GAIN_SHIFT);
+
+    // P = (I - KH) P, P01 before its update is needed by P11
+    const int32_t p01 = state->p01;
+    state->p11 -= (int32_t)(((int64_t)gain_slope * p01) >> KALMAN_GAIN_SHIFT);
+    state->p01 -= (int32_t)(((int64_t)gain_temperature * p01) >> KALMAN_GAIN_SHIFT);
+    state->p00 -= (int32_t)(((int64_t)gain_temperature * state->p00) >> KALMAN_GAIN_SHIFT);
+
+    // Rounding can't be allowed to make the variances negative
+    state->p00 = (state->p00 < 0) ? 0 : state->p00;
+    state->p11 = (state->p11 < 0) ? 0 : state->p11;
+}
+
+int16_t kalman_temperature(kalman_state_t const *const state)
+{
+    return clamp16((state->temperature + (1L << (KALMAN_Q8_SHIFT - 1U))) >> KALMAN_Q8_SHIFT);
+}
+
+int16_t kalman_slope(kalman_params_t const *const params, kalman_state_t const *const state)
+{
+    // Q16 °C per 256 samples -> Q8 °C per hour : x samples per hour, / 65536
+    const uint32_t samples_per_hour = KALMAN_MS_PER_HOUR / ((params->sample_period_ms == 0U) ? 1U : params->sample_period_ms);
+    const int64_t slope = ((int64_t)state->slope * (int64_t)samples_per_hour) >> 16U;
+    return (slope < INT16_MIN) ? INT16_MIN : ((slope > INT16_MAX) ? INT16_MAX : (int16_t)slope);
+}
@@ -0,0 +1,100 @@
+#ifndef KALMAN_HEADER
+#define KALMAN_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-point two states Kalman filter (temperature and rate of change), run on every temperature sample.
+ * Constant slope model with a fixed sample period :
+ *      temperature += slope x period
+ *      slope       += random walk
+ * Units keep every step in 32 bits products, but the gains and covariance updates (64 bits) :
+ * - temperature (x0) : Q16 °C, noises in u² where u = 1/256 °C (the Q8 measurement resolution)
+ * - slope (x1)       : Q16 °C per 256 samples, noises in v² where v = 1/256 °C per 256 samples (0.055°C/h at 1 Hz)
+ * - covariance       : Q8 u², u.v and v²
+ * The steady state filter is an alpha-beta filter, but the covariance recursion gives a fast convergence after boot.
+ */
+
+// clang-format off
+#ifndef KALMAN_MEASUREMENT_NOISE
+#define KALMAN_MEASUREMENT_NOISE 1600U  /**> Temperature reading variance (u²) : 2 ADC codes (≈ 0.16°C) standard deviation   */
+#endif
+#ifndef KALMAN_TEMPERATURE_NOISE
+#define KALMAN_TEMPERATURE_NOISE 16U    /**> Temperature process noise (Q8 u² per sample) : unmodelled heat inputs             */
+#endif
+#ifndef KALMAN_SLOPE_NOISE
+#define KALMAN_SLOPE_NOISE 64U          /**> Slope process noise (Q8 v² per sample) : how fast the rate of change may move     */
+#endif
+#ifndef KALMAN_SAMPLE_PERIOD_MS
+#define KALMAN_SAMPLE_PERIOD_MS 1000U   /**> Time in between two samples (milliseconds), only used to scale the slope output  */
+#endif
+// clang-format on
+
+/**
+ * @brief filter tuning (default to the compile time constants above)
+ */
+typedef struct
+{
+    uint16_t measurement_noise; /**> Measurement variance (u²), 0 is handled as 1                  */
+    uint16_t temperature_noise; /**> Temperature process noise (Q8 u² per sample)                  */
+    uint16_t slope_noise;       /**> Slope process noise (Q8 v² per sample)                        */
+    uint16_t sample_period_ms;  /**> Sample period, skipped samples included (milliseconds)        */
+} kalman_params_t;
+
+/**
+ * @brief filter state
+ */
+typedef struct
+{
+    int32_t temperature; /**> Estimated temperature (Q16 °C)                    */
+    int32_t slope;       /**> Estimated slope (Q16 °C per 256 samples)          */
+    int32_t p00;         /**> Temperature variance (Q8 u²)                      */
+    int32_t p01;         /**> Temperature and slope covariance (Q8 u.v)         */
+    int32_t p11;         /**> Slope variance (Q8 v²)                            */
+    bool started;        /**> Set by the first sample                           */
+} kalman_state_t;
+
+/**
+ * @brief fills the tuning with the compile time defaults
+ */
+void kalman_params_default(kalman_params_t *const params);
+
+/**
+ * @brief resets the filter : the next sample restarts it from scratch
+ */
+void kalman_init(kalman_state_t *const state);
+
+/**
+ * @brief moves the temperature one sample period ahead at the current slope, for a sample that was skipped on purpose (no measurement).
+ * The covariance is kept as is : the next measurement gets the weight it would have at the regular rate, rather than the higher
+ * weight a longer prediction calls for (which lets a door opening spike pull the estimate further). Does nothing until the first sample.
+ */
+void kalman_skip(kalman_state_t *const state);
+
+/**
+ * @brief predicts the state one sample period ahead and corrects it with the measurement.
+ * The first sample initializes the temperature, with an unknown slope.
+ * @param[in] measurement : temperature reading (Q8 °C)
+ */
+void kalman_update(kalman_params_t const *const params, kalman_state_t *const state, const int16_t measurement);
+
+/**
+ * @brief filtered temperature (Q8 °C, rounded)
+ */
+int16_t kalman_temperature(kalman_state_t const *const state);
+
+/**
+ * @brief filtered rate of change (Q8 °C per hour, clamped to the int16_t range)
+ */
+int16_t kalman_slope(kalman_params_t const *const params, kalman_state_t const *const state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KALMAN_HEADER */
@@ -1,91 +1,137 @@
 #include <stdbool.h>
 #include <stddef.h>
-#include <string.h>
 
+#include "flash.h"
 #include "interpolation.h"
 #include "led.h"
-
-#ifdef LED_PWM_PULSE_STUFFING
 #include "spanner.h"
-#endif
 
-typedef struct
+#define LED_PC_RESTART 0xFFU        /**> Program (re)starts on the next led_process() call                       */
+#define LED_DUTY_UNKNOWN 0xFFU      /**> Output state is unknown : the next duty cycle is always written          */
+#define LED_MAX_TRANSITIONS 16U     /**> Keyframes a single call can go through (bounds zero duration loops)     */
+#define LED_WAVEFORM_DURATION_MS (LED_BLINK_BREATHING_STEPS * LED_BLINK_BREATHING_RESOLUTION_MS)
+
+// clang-format off
+static const uint8_t program_accept[] FLASH_STORAGE = {
+    LED_KF_LEVEL(100U, LED_BLINK_ACCEPT_ON_TIME_MS),
+    LED_KF_LEVEL(0U, LED_BLINK_ACCEPT_CYCLE_PERIOD_MS - LED_BLINK_ACCEPT_ON_TIME_MS),
+    LED_KF_REPEAT(0U, LED_BLINK_ACCEPT_FLASHES - 1U),
+    LED_KF_END(),
+};
+
+static const uint8_t program_warning[] FLASH_STORAGE = {
+    LED_KF_LEVEL(100U, LED_BLINK_WARNING_HALF_P * 1000U),
+    LED_KF_LEVEL(0U, (LED_BLINK_WARNING_PERIOD_S - LED_BLINK_WARNING_HALF_P) * 1000U),
+    LED_KF_REPEAT(0U, 0U),
+};
+
+static const uint8_t program_breathing[] FLASH_STORAGE = {
+    LED_KF_WAVEFORM(),
+    LED_KF_REPEAT(0U, 0U),
+};
+
+static const uint8_t program_solid[] FLASH_STORAGE = {
+    LED_KF_SOLID(),
+};
+
+// Indexed by led_blink_pattern_t
+static uint8_t const *const builtin_programs[LED_BLINK_PATTERN_COUNT] = {
+    program_accept,
+    program_warning,
+    program_breathing,
+    program_solid,
+};
+// clang-format on
+
+/**
+ * @brief LEDs state, stored as arrays (one entry per LED) : each pass only walks the fields it needs,
+ * and configured LEDs are always the first ones
+ */
+static struct
 {
-    bool configured;           /**> Used to know if this specific LED construct is used or not      */
-    led_io_t io;               /**> Static led IO config                                            */
-    uint8_t io_state;          /**> IO state, only used for the LED_BLINK_NONE pattern (aka SOLID)  */
-    mcu_time_t last_processed; /**> Last time this LED was processed (used to perform soft PWM)     */
-    struct
-    {
-        led_blink_pattern_t current;  /**> Current LED Pattern (used to trigger state changed events)                                       */
-        led_blink_pattern_t previous; /**> Previous LED Pattern (used to trigger state changed events)                                      */
-    } patterns;
-
-    led_next_event_t event; /**> Event that'll be triggered when the LED pattern is finished processing (some of the patterns have a limited life)  */
-
-    struct
-    {
-
-        /**
-         * @brief breathing LED pattern configuration and trackers
-         */
-        struct
-        {
-            uint16_t step;   /**> Keeps track of the current duty cycle applied to the LED   */
-            bool new_step;   /**> Used to trigger the "new step" event. Some computation is performed only once to save time */
-            uint8_t on_time; /**> Currently applied duty cycle : 0 - 100                                                     */
-
-#ifdef LED_PWM_PULSE_STUFFING
-            struct
-            {
-                bool used;     /**> Tells the algorithm whether stuffing is currently in use or not                   */
-                uint8_t index; /**> Current index in the data sequence                                                */
-                uint8_t sequence[LED_BLINK_BREATHING_RESOLUTION_MS]; /**> Sequence spans over max Resolution (for 100Hz signal with millisecond tick,
-                                                                        resolution is 10). This field is used when the desired duty cycle can't be
-                                                                        exactly represented with the physical resolution, hence pulse stuffing needs
-                                                                        to be applied */
-
-            } stuffing;
-#endif /* LED_PWM_PULSE_STUFFING */
-        } breathing;
-
-        struct
-        {
-            uint8_t count; /**> Keeps track of the amount of blinks already executed       */
-        } accept;
-    } states;
-} internal_config_t;
+    uint8_t count;                                /**> Configured LEDs                                                                   */
+    uint8_t port_index[MAX_LED_COUNT];            /**> Index of the LED port in ports[] (software output only)                           */
+    uint8_t pin_mask[MAX_LED_COUNT];              /**> LED bit in its port                                                               */
+    led_set_duty_t set_duty[MAX_LED_COUNT];       /**> Hardware PWM backend, NULL : software output on the port                         */
+    uint8_t io_state[MAX_LED_COUNT];              /**> IO state, only used for the LED_BLINK_NONE pattern (aka SOLID)                    */
+    led_next_event_t event[MAX_LED_COUNT];        /**> Event that'll be triggered when the LED program is over                            */
+
+    uint8_t const *program[MAX_LED_COUNT];        /**> Running keyframes, NULL once the LED settled on a solid state                     */
+    uint16_t start_ms[MAX_LED_COUNT];             /**> Current keyframe start (lowest 16 bits of the time, in milliseconds)              */
+    uint8_t pc[MAX_LED_COUNT];                    /**> Current keyframe index (LED_PC_RESTART : program starts on the next process)      */
+    uint8_t repeats[MAX_LED_COUNT];               /**> Jumps already taken by the current REPEAT keyframe                                 */
+    uint8_t origin[MAX_LED_COUNT];                /**> Duty cycle at the keyframe start (ramps start from there)                          */
+    uint8_t duty[MAX_LED_COUNT];                  /**> Duty cycle computed by the program : 0 - 100                                       */
+    uint8_t output[MAX_LED_COUNT];                /**> Duty cycle last applied to the IO (LED_DUTY_UNKNOWN : none yet)                     */
+    uint8_t on_ticks[MAX_LED_COUNT];              /**> Software PWM on time for that duty cycle, within a resolution window               */
+    bool timed[MAX_LED_COUNT];                    /**> Output changes at the deadline, otherwise it holds until the program changes       */
+    mcu_time_t deadline[MAX_LED_COUNT];           /**> Next output change : the LED is skipped until then                                 */
+#if LED_PWM_PULSE_STUFFING == 1
+    uint16_t stuffing_error[MAX_LED_COUNT];       /**> Pulse stuffing error accumulator (@see span_next())                                */
+    uint8_t phase[MAX_LED_COUNT];                 /**> Software PWM window position at the last pass                                      */
+#endif
 
-static internal_config_t internal_config[MAX_LED_COUNT];
+    uint8_t port_count;                           /**> Distinct ports driven in software                                                 */
+    volatile uint8_t *ports[MAX_LED_COUNT];       /**> Ports, each one is written once per pass                                          */
+} leds;
 
-static void handle_led_accept(mcu_time_t const *const time, internal_config_t *const config);
-static void handle_led_warning(mcu_time_t const *const time, internal_config_t *const config);
-static void handle_led_breathing(mcu_time_t const *const time, internal_config_t *const config);
-static void get_elapsed_milliseconds(mcu_time_t const *const time, internal_config_t *const config, uint32_t *const elapsed);
+/**
+ * @brief earliest deadline of all LEDs, so that led_process() returns right away in between output changes
+ */
+static struct
+{
+    bool pending;         /**> A program was (re)started : LEDs are processed on the next call  */
+    bool armed;           /**> At least one LED waits for a deadline                             */
+    mcu_time_t deadline;  /**> Earliest of the LEDs deadlines                                    */
+} schedule;
+
+/**
+ * @brief port bits computed by a led_process() pass, committed with a single read-modify-write per port
+ */
+typedef struct
+{
+    uint8_t touched[MAX_LED_COUNT]; /**> LED bits driven by this pass, per port   */
+    uint8_t values[MAX_LED_COUNT];  /**> Their new state                          */
+} port_writes_t;
 
-static void led_on(led_io_t *const io);
-static void led_set_io(led_io_t *const io, uint8_t state);
-static void toggle_led(led_io_t *const io);
-static void led_off(led_io_t *const io);
+static uint16_t time_low_ms(mcu_time_t const *const time);
+static void start_program(const uint8_t led, uint8_t const *const program);
+static void apply_next_event(const uint8_t led);
+static void run_program(const uint8_t led, mcu_time_t const *const time, const uint16_t now_ms);
+static void apply_output(const uint8_t led, mcu_time_t const *const time, port_writes_t *const writes);
+static void schedule_in(const uint8_t led, mcu_time_t const *const time, const uint16_t delay_ms);
 
 void led_static_config_default(led_io_t *io)
 {
     io->pin = 0;
     io->port = NULL;
+    io->set_duty = NULL;
 }
 
 void led_reset(void)
 {
+    leds.count = 0;
+    leds.port_count = 0;
     for (uint8_t i = 0; i < MAX_LED_COUNT; i++)
     {
-        led_static_config_default(&internal_config[i].io);
-        internal_config[i].configured = false;
-        time_default(&internal_config[i].last_processed);
-        internal_config[i].patterns.current = LED_BLINK_NONE;
-        internal_config[i].patterns.previous = LED_BLINK_NONE;
-        internal_config[i].event.kind = LED_NEXT_EVENT_NONE;
-        internal_config[i].event.data.io_state = 0;
+        leds.port_index[i] = 0;
+        leds.pin_mask[i] = 0;
+        leds.set_duty[i] = NULL;
+        leds.io_state[i] = 0;
+        leds.event[i].kind = LED_NEXT_EVENT_NONE;
+        leds.event[i].data.io_state = 0;
+        leds.duty[i] = 0;
+        leds.output[i] = LED_DUTY_UNKNOWN;
+        leds.on_ticks[i] = 0;
+        leds.timed[i] = false;
+        leds.ports[i] = NULL;
+#if LED_PWM_PULSE_STUFFING == 1
+        leds.stuffing_error[i] = 0;
+        leds.phase[i] = 0;
+#endif
+        start_program(i, program_solid);
     }
+    schedule.armed = false;
 }
 
 void led_init(const led_io_t *config, const uint8_t length)
@@ -94,54 +140,60 @@ void led_init(const led_io_t *config, const uint8_t length)
     uint8_t max_length = length < MAX_LED_COUNT ? length : MAX_LED_COUNT;
     for (uint8_t i = 0; i < max_length; i++)
     {
-        internal_config[i].io.port = config[i].port;
-        internal_config[i].io.pin = config[i].pin;
-        internal_config[i].configured = true;
-        internal_config[i].states.breathing.step = 0;
-        internal_config[i].states.breathing.new_step = true;
-
-        // Pulse stuffing requires an additional data structure array
-#ifdef LED_PWM_PULSE_STUFFING
-        internal_config[i].states.breathing.stuffing.index = 0;
-        internal_config[i].states.breathing.stuffing.used = false;
-        memset(internal_config[i].states.breathing.stuffing.sequence, 0, LED_BLINK_BREATHING_RESOLUTION_MS);
-#endif
+        leds.pin_mask[i] = (uint8_t)(1U << config[i].pin);
+        leds.set_duty[i] = config[i].set_duty;
+
+        // LEDs sharing a port share its write
+        if (NULL == config[i].set_duty)
+        {
+            uint8_t port = 0;
+            while ((port < leds.port_count) && (leds.ports[port] != config[i].port))
+            {
+                port++;
+            }
+            if (port == leds.port_count)
+            {
+                leds.ports[port] = config[i].port;
+                leds.port_count++;
+            }
+            leds.port_index[i] = port;
+        }
     }
+    leds.count = max_length;
 }
 
 void led_set_blink_pattern(const uint8_t led_id, const led_blink_pattern_t pattern)
 {
-    if (led_id >= MAX_LED_COUNT)
+    if (pattern >= LED_BLINK_PATTERN_COUNT)
     {
         return;
     }
+    led_run_program(led_id, builtin_programs[pattern]);
+}
 
-    internal_config_t *config = &internal_config[led_id];
-    config->patterns.current = pattern;
-
-    // Reinitializes the "states" trackers
-    switch (pattern)
+void led_run_program(const uint8_t led_id, uint8_t const *const program)
+{
+    if ((led_id >= MAX_LED_COUNT) || (NULL == program))
     {
-        case LED_BLINK_ACCEPT:
-            config->states.accept.count = 0;
-            break;
-
-        case LED_BLINK_BREATHING:
-            config->states.breathing.step = 0;
-            // Forces the calculation of new values for the LED duty cycle (ms)
-            config->states.breathing.new_step = true;
-            break;
-
-        case LED_BLINK_WARNING:
-        default:
-            break;
+        return;
     }
+    start_program(led_id, program);
 }
 
 void led_blink_none_set_io(const uint8_t led_id, const uint8_t io_state)
 {
-    internal_config_t *config = &internal_config[led_id];
-    config->io_state = io_state;
+    if (led_id >= MAX_LED_COUNT)
+    {
+        return;
+    }
+
+    leds.io_state[led_id] = io_state;
+
+    // A settled LED follows its IO state right away, running programs only use it when they are over
+    if ((NULL == leds.program[led_id]) || (program_solid == leds.program[led_id]))
+    {
+        start_program(led_id, program_solid);
+    }
 }
 
 void led_set_next_event(const uint8_t led_id, const led_next_event_t * event)
@@ -151,131 +203,277 @@ void led_set_next_event(const uint8_t led_id, const led_next_event_t * event)
         return;
     }
 
-    internal_config_t *config = &internal_config[led_id];
-    config->event = *event;
+    leds.event[led_id] = *event;
 }
 
 
 void led_process(mcu_time_t const *const time)
 {
-    for (uint8_t i = 0; i < MAX_LED_COUNT; i++)
+    // Nothing changes before the earliest deadline
+    if (!schedule.pending && (!schedule.armed || (time_compare(time, &schedule.deadline) < 0)))
     {
-        internal_config_t *const config = &internal_config[i];
-        if (false == internal_config[i].configured)
+        return;
+    }
+    schedule.pending = false;
+    schedule.armed = false;
+
+    port_writes_t writes;
+    for (uint8_t port = 0; port < leds.port_count; port++)
+    {
+        writes.touched[port] = 0;
+        writes.values[port] = 0;
+    }
+
+    const uint16_t now_ms = time_low_ms(time);
+    for (uint8_t i = 0; i < leds.count; i++)
+    {
+        // Settled LEDs keep their IO state, nothing to do
+        if (NULL == leds.program[i])
         {
-            // First non configured led implies there is no more configured ones after it
-            // This is sufficient for us to jump out
-            break;
+            continue;
         }
 
-        // Update time of last processed (useful to start new patterns)
-        if (config->patterns.current != config->patterns.previous)
+        if ((LED_PC_RESTART == leds.pc[i]) || (leds.timed[i] && (time_compare(time, &leds.deadline[i]) >= 0)))
         {
-            config->last_processed = *time;
+            leds.timed[i] = false;
+            run_program(i, time, now_ms);
+            apply_output(i, time, &writes);
         }
 
-        switch (config->patterns.current)
+        if (leds.timed[i] && (!schedule.armed || (time_compare(&leds.deadline[i], &schedule.deadline) < 0)))
         {
-            case LED_BLINK_BREATHING:
-                handle_led_breathing(time, &internal_config[i]);
-                break;
+            schedule.deadline = leds.deadline[i];
+            schedule.armed = true;
+        }
+    }
 
-            case LED_BLINK_WARNING:
-                handle_led_warning(time, &internal_config[i]);
-                break;
+    // A single read-modify-write per port, whatever the number of LEDs on it
+    for (uint8_t port = 0; port < leds.port_count; port++)
+    {
+        if (0U != writes.touched[port])
+        {
+            *leds.ports[port] = (uint8_t)((*leds.ports[port] & ~writes.touched[port]) | writes.values[port]);
+        }
+    }
+}
 
-            case LED_BLINK_ACCEPT:
-                handle_led_accept(time, &internal_config[i]);
-                break;
+bool led_get_next_deadline(mcu_time_t const *const now, mcu_time_t *const deadline)
+{
+    if (schedule.pending)
+    {
+        *deadline = *now;
+        return true;
+    }
 
-            case LED_BLINK_NONE:
-            default:
-                // Only turn the led off in case of event generation
-                if (config->patterns.previous != config->patterns.current)
-                {
-                    if(0 == config->io_state)
-                    {
-                        led_off(&config->io);
-                    }
-                    else
-                    {
-                        led_on(&config->io);
-                    }
-                }
+    *deadline = schedule.deadline;
+    return schedule.armed;
+}
 
-                break;
-        }
+static uint16_t time_low_ms(mcu_time_t const *const time)
+{
+    // Keyframes are shorter than a minute : the lowest 16 bits of the time are enough, and they wrap cleanly
+    return (uint16_t)((uint16_t)time->seconds * 1000U + time->milliseconds);
+}
 
-        config->patterns.previous = config->patterns.current;
-    }
+static void start_program(const uint8_t led, uint8_t const *const program)
+{
+    leds.program[led] = program;
+    leds.pc[led] = LED_PC_RESTART;
+    leds.repeats[led] = 0;
+    schedule.pending = true;
 }
 
-static void handle_led_accept(mcu_time_t const *const time, internal_config_t *const config)
+static void apply_next_event(const uint8_t led)
 {
-    uint32_t elapsed = 0;
-    get_elapsed_milliseconds(time, config, &elapsed);
+    led_next_event_t *const event = &leds.event[led];
+    switch (event->kind)
+    {
+        case LED_NEXT_EVENT_PATTERN:
+            leds.program[led] = (event->data.pattern < LED_BLINK_PATTERN_COUNT) ? builtin_programs[event->data.pattern] : program_solid;
+            break;
 
-    if (elapsed >= LED_BLINK_ACCEPT_CYCLE_PERIOD_MS)
+        case LED_NEXT_EVENT_IO_STATE:
+            leds.io_state[led] = event->data.io_state;
+            leds.program[led] = program_solid;
+            break;
+
+        default:
+            leds.program[led] = program_solid;
+            break;
+    }
+    leds.pc[led] = 0;
+    leds.repeats[led] = 0;
+    event->kind = LED_NEXT_EVENT_NONE;
+}
+
+static void run_program(const uint8_t led, mcu_time_t const *const time, const uint16_t now_ms)
+{
+    if (LED_PC_RESTART == leds.pc[led])
     {
-        config->last_processed.milliseconds = time->milliseconds;
-        config->states.accept.count++;
+        leds.pc[led] = 0;
+        leds.start_ms[led] = now_ms;
+        leds.origin[led] = leds.duty[led];
     }
 
-    // Reverts back to original state when pattern is fully executed
-    if (config->states.accept.count >= LED_BLINK_ACCEPT_FLASHES)
+    // Goes through the keyframes that are over : the next one starts when the previous one was due.
+    // The current keyframe then tells when the duty cycle changes next (the keyframe end, a ramp or waveform step)
+    for (uint8_t transitions = 0; transitions < LED_MAX_TRANSITIONS; transitions++)
     {
-        config->states.accept.count = 0;
-        switch(config->event.kind)
+        uint8_t const *const keyframe = &leds.program[led][leds.pc[led] * LED_KEYFRAME_SIZE];
+        const uint8_t op = FLASH_READ_U8(&keyframe[0]);
+        const uint8_t arg = FLASH_READ_U8(&keyframe[1]);
+        const uint16_t duration = (uint16_t)(FLASH_READ_U8(&keyframe[2]) | ((uint16_t)FLASH_READ_U8(&keyframe[3]) << 8U));
+        const uint16_t elapsed = (uint16_t)(now_ms - leds.start_ms[led]);
+
+        switch (op)
         {
-            case LED_NEXT_EVENT_IO_STATE:
-                led_set_io(&config->io, config->event.data.io_state);
-                config->patterns.current = LED_BLINK_NONE;
+            case LED_OP_LEVEL:
+                leds.duty[led] = arg;
+                if (0U == duration)
+                {
+                    return;
+                }
+                if (elapsed < duration)
+                {
+                    schedule_in(led, time, duration - elapsed);
+                    return;
+                }
+                leds.start_ms[led] += duration;
+                leds.origin[led] = arg;
+                leds.pc[led]++;
                 break;
 
-            case LED_NEXT_EVENT_PATTERN:
-                config->patterns.current = config->event.data.pattern;
+            case LED_OP_RAMP:
+                if (elapsed < duration)
+                {
+                    // Next change is when the duty cycle moves by one more unit
+                    const uint8_t origin = leds.origin[led];
+                    const bool rising = (arg >= origin);
+                    const uint16_t span = rising ? (uint16_t)(arg - origin) : (uint16_t)(origin - arg);
+                    const uint16_t moved = (uint16_t)(((uint32_t)span * elapsed) / duration);
+                    const uint16_t next = (0U == span) ? duration : (uint16_t)((((uint32_t)moved + 1U) * duration + span - 1U) / span);
+                    leds.duty[led] = rising ? (uint8_t)(origin + moved) : (uint8_t)(origin - moved);
+                    schedule_in(led, time, ((next < duration) ? next : duration) - elapsed);
+                    return;
+                }
+                leds.duty[led] = arg;
+                leds.start_ms[led] += duration;
+                leds.origin[led] = arg;
+                leds.pc[led]++;
                 break;
 
+            case LED_OP_WAVEFORM:
+                if (elapsed < LED_WAVEFORM_DURATION_MS)
+                {
+                    leds.duty[led] = led_breathing_get_duty(elapsed / LED_BLINK_BREATHING_RESOLUTION_MS);
+                    schedule_in(led, time, LED_BLINK_BREATHING_RESOLUTION_MS - (elapsed % LED_BLINK_BREATHING_RESOLUTION_MS));
+                    return;
+                }
+                leds.duty[led] = led_breathing_get_duty(LED_BLINK_BREATHING_STEPS - 1U);
+                leds.start_ms[led] += LED_WAVEFORM_DURATION_MS;
+                leds.origin[led] = leds.duty[led];
+                leds.pc[led]++;
+                break;
+
+            case LED_OP_REPEAT:
+                if ((0U == duration) || (leds.repeats[led] < duration))
+                {
+                    leds.repeats[led] = (0U == duration) ? 0U : (uint8_t)(leds.repeats[led] + 1U);
+                    leds.pc[led] = arg;
+                }
+                else
+                {
+                    leds.repeats[led] = 0;
+                    leds.pc[led]++;
+                }
+                break;
+
+            case LED_OP_NEXT:
+                leds.program[led] = (arg < LED_BLINK_PATTERN_COUNT) ? builtin_programs[arg] : program_solid;
+                leds.pc[led] = 0;
+                leds.repeats[led] = 0;
+                break;
+
+            case LED_OP_SOLID:
+                leds.duty[led] = (0U != leds.io_state[led]) ? 100U : 0U;
+                leds.program[led] = NULL;
+                return;
+
+            case LED_OP_END:
             default:
-                config->patterns.current = LED_BLINK_NONE;
+                apply_next_event(led);
                 break;
         }
-        config->event.kind = LED_NEXT_EVENT_NONE;
-        return;
     }
 
-    uint32_t elapsed_clamped = elapsed % LED_BLINK_ACCEPT_CYCLE_PERIOD_MS;
-
-    // First half of the cycle period (ON time)
-    if (elapsed_clamped < LED_BLINK_ACCEPT_ON_TIME_MS)
-    {
-        led_on(&config->io);
-    }
-    // Second half of the cycle period (OFF time)
-    else if (elapsed_clamped < LED_BLINK_ACCEPT_CYCLE_PERIOD_MS)
-    {
-        led_off(&config->io);
-    }
+    // Too many transitions for a single call (zero duration loop) : carries on with the next one
+    schedule_in(led, time, 0U);
 }
 
-static void handle_led_warning(mcu_time_t const *const time, internal_config_t *const config)
+static void apply_output(const uint8_t led, mcu_time_t const *const time, port_writes_t *const writes)
 {
-    uint32_t elapsed = (time->seconds - config->last_processed.seconds);
-    if ((elapsed % LED_BLINK_WARNING_PERIOD_S) < LED_BLINK_WARNING_HALF_P)
+    const uint8_t duty = leds.duty[led];
+    const bool changed = (duty != leds.output[led]);
+    leds.output[led] = duty;
+
+    // Hardware PWM keeps the duty cycle by itself : only changes are written
+    if (NULL != leds.set_duty[led])
     {
-        led_on(&config->io);
+        if (changed)
+        {
+            leds.set_duty[led](duty);
+        }
+        return;
     }
-    else if ((elapsed % LED_BLINK_WARNING_PERIOD_S) < LED_BLINK_WARNING_PERIOD_S)
+
+    // Software PWM : the LED is on for the first on_ticks of every resolution window, next edge is either the end of the on time or the window end
+    bool on = (100U == duty);
+    if ((0U != duty) && (100U != duty))
     {
-        led_off(&config->io);
+        const uint8_t phase = (uint8_t)(time->milliseconds % LED_BLINK_BREATHING_RESOLUTION_MS);
+#if LED_PWM_PULSE_STUFFING == 1
+        // Duty cycles falling in between two on times get the shorter one for some windows and the longer one for the others,
+        // picked at the start of each window (the window position went back)
+        if (changed || (phase <= leds.phase[led]))
+        {
+            const uint8_t increment = LED_BLINK_BREATHING_DUTY_INCREMENT_PER_RESOLUTION_POINT;
+            const span_data_t stuffing = {.a_val = (uint8_t)(duty / increment),
+                                          .b_val = (uint8_t)(duty / increment + 1U),
+                                          .a_cnt = (uint8_t)(increment - duty % increment),
+                                          .b_cnt = (uint8_t)(duty % increment),
+                                          .kind = SPAN_EVEN};
+            leds.on_ticks[led] = span_next(&stuffing, &leds.stuffing_error[led]);
+        }
+        leds.phase[led] = phase;
+#else
+        if (changed)
+        {
+            leds.on_ticks[led] = led_get_on_time_ticks(duty, LED_BLINK_BREATHING_RESOLUTION_MS, LED_BLINK_BREATHING_DUTY_INCREMENT_PER_RESOLUTION_POINT);
+        }
+#endif
+
+        on = (phase < leds.on_ticks[led]);
+        schedule_in(led, time, on ? (uint16_t)(leds.on_ticks[led] - phase) : (uint16_t)(LED_BLINK_BREATHING_RESOLUTION_MS - phase));
     }
 
-    if (elapsed >= LED_BLINK_WARNING_PERIOD_S)
+    const uint8_t port = leds.port_index[led];
+    writes->touched[port] |= leds.pin_mask[led];
+    if (on)
     {
-        config->last_processed.seconds = time->seconds;
+        writes->values[port] |= leds.pin_mask[led];
     }
 }
 
+static void schedule_in(const uint8_t led, mcu_time_t const *const time, const uint16_t delay_ms)
+{
+    mcu_time_t deadline = *time;
+    time_add_ms(&deadline, delay_ms);
+    if (!leds.timed[led] || (time_compare(&deadline, &leds.deadline[led]) < 0))
+    {
+        leds.deadline[led] = deadline;
+        leds.timed[led] = true;
+    }
+}
 
 uint8_t led_get_on_time_ticks(const uint8_t duty, const uint8_t resolution, const uint8_t duty_inc)
 {
@@ -300,148 +498,10 @@ uint8_t led_get_on_time_ticks(const uint8_t duty, const uint8_t resolution, cons
     return on_time;
 }
 
-// Current performances (observed with an oscilloscope) :
-// target frequency     25      50      75      100     150     200     225
-// actual frequency     24.6    47.63   71.44   90.92   142.86  166.66  200,07
-// % deviation          1%      4%       5%     9%      5%      16%     12%
-
-static void handle_led_breathing(mcu_time_t const *const time, internal_config_t *config)
-{
-    static uint32_t elapsed = 0;
-    get_elapsed_milliseconds(time, config, &elapsed);
-
-    // Calculates new values for the currently evaluated step (only evaluated when we are running a new step)
-    if (true == config->states.breathing.new_step)
-    {
-        uint8_t duty = led_breathing_get_duty_sawtooth(config->states.breathing.step);
-        uint8_t on_time = led_get_on_time_ticks(duty, LED_BLINK_BREATHING_RESOLUTION_MS, LED_BLINK_BREATHING_DUTY_INCREMENT_PER_RESOLUTION_POINT);
-
-        config->states.breathing.on_time = on_time;
-        config->states.breathing.new_step = false;
-
-#ifdef LED_PWM_PULSE_STUFFING
-        if (on_time / LED_BLINK_BREATHING_RESOLUTION_MS != config->states.breathing.on_time / LED_BLINK_BREATHING_RESOLUTION_MS)
-        {
-            // Only recompute if we are moving to a new multiple (e.g. 3x to 4x)
-            uint8_t remainder = duty % LED_BLINK_BREATHING_RESOLUTION_MS;
-            if (remainder == 0)
-            {
-                // We can represent exactly the duty cycle with the current resolution
-                // Se we're good to go without using the stuffing method.
-                config->states.breathing.stuffing.used = false;
-            }
-            else
-            {
-                config->states.breathing.stuffing.used = true;
-                config->states.breathing.stuffing.index = 0;
-                span_data_t data = {.a_val = duty / LED_BLINK_BREATHING_RESOLUTION_MS,
-                                    .b_val = duty / LED_BLINK_BREATHING_RESOLUTION_MS + 1,
-                                    .a_cnt = (LED_BLINK_BREATHING_RESOLUTION_MS - remainder),
-                                    .b_cnt = remainder};
-                span(&data, config->states.breathing.stuffing.sequence, LED_BLINK_BREATHING_RESOLUTION_MS);
-            }
-        }
-#endif /* LED_PWM_PULSE_STUFFING */
-    }
-
-    // Time to process the new duty-cycle
-    // Event is generated at a target frequency of 25Hz
-    if (elapsed <= LED_BLINK_BREATHING_RESOLUTION_MS)
-    {
-
-#ifdef LED_PWM_PULSE_STUFFING
-        if (true == config->states.breathing.stuffing.used)
-        {
-            uint8_t index = config->states.breathing.stuffing.index;
-            config->states.breathing.on_time = config->states.breathing.stuffing.sequence[index];
-        }
-#endif /* LED_PWM_PULSE_STUFFING */
-
-        if (config->states.breathing.on_time == 0)
-        {
-            led_off(&config->io);
-            return;
-        }
-
-        if (config->states.breathing.on_time == LED_BLINK_BREATHING_RESOLUTION_MS)
-        {
-            led_on(&config->io);
-            return;
-        }
-
-        if (elapsed < config->states.breathing.on_time)
-        {
-            led_on(&config->io);
-        }
-        else
-        {
-            // Switch off the LED
-            led_off(&config->io);
-        }
-    }
-    // Reset the window
-    else
-    {
-        config->last_processed = *time;
-        config->states.breathing.step++;
-        config->states.breathing.new_step = true;
-        config->states.breathing.step %= LED_BLINK_BREATHING_FULL_CYCLE_STEPS;
-
-#ifdef LED_PWM_PULSE_STUFFING
-        if (config->states.breathing.stuffing.index < (LED_BLINK_BREATHING_RESOLUTION_MS - 1))
-        {
-            // Prevent recomputing
-            config->states.breathing.stuffing.index++;
-            // config->states.breathing.new_step = false;
-        }
-        else
-        {
-            config->states.breathing.stuffing.index = 0;
-        }
-#endif /* LED_PWM_PULSE_STUFFING */
-    }
-}
-
-static void led_on(led_io_t *const io)
-{
-    *io->port |= (1 << io->pin);
-}
-
-static void led_set_io(led_io_t *const io, uint8_t state)
+uint8_t led_breathing_get_duty(const uint16_t step)
 {
-    if(state != 0)
-    {
-        led_on(io);
-    }
-    else
-    {
-        led_off(io);
-    }
-}
-
-
-// static void toggle_led(led_io_t *const io)
-// {
-//     *io->port ^= (1 << io->pin);
-// }
-
-
-static void led_off(led_io_t *const io)
-{
-    *io->port &= ~(1 << io->pin);
-}
-
-static void get_elapsed_milliseconds(mcu_time_t const *const time, internal_config_t *const config, uint32_t *const elapsed)
-{
-    if (time->milliseconds >= config->last_processed.milliseconds)
-    {
-        *elapsed = time->milliseconds - config->last_processed.milliseconds;
-    }
-    // Milliseconds was reset to 0 after reaching 1000
-    else
-    {
-        *elapsed = (time->milliseconds + 1000) - config->last_processed.milliseconds;
-    }
+    // No modulo (a software division on AVR) : callers already wrap the step
+    return (step < LED_BLINK_BREATHING_STEPS) ? FLASH_READ_U8(&led_breathing_table[step]) : 0U;
 }
 
 uint8_t led_breathing_get_duty_sawtooth(const uint16_t step)
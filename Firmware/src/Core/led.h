@@ -5,10 +5,14 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "led_breathing_table.h"
 #include "mcu_time.h"
 
-#define MAX_LED_COUNT 1
+#ifndef MAX_LED_COUNT
+#define MAX_LED_COUNT 4U    /**> Status, compressor, fault and learning LEDs                        */
+#endif
 
 // clang-format off
 
@@ -23,24 +27,10 @@ extern "C" {
 #define LED_BLINK_BREATHING_DUTY_CYCLE_INC  \
     ((LED_BLINK_BREATHING_DUTY_CYCLE_INC_ALIASING_FACTOR * 100) / (LED_BLINK_BREATHING_HALF_P * LED_BLINK_BREATHING_FREQ_H))   /**> LED breathing duty cycle increment  */
 #define LED_BLINK_BREATHING_DUTY_INCREMENT_PER_RESOLUTION_POINT (100 / LED_BLINK_BREATHING_RESOLUTION_MS)   /**> Increment of duty cycle per point of resolution        */
-
-/**
- * @brief Macro used to enable pulse stuffing in software PWM code.
- * Pulse stuffing is used to represent duty cycles which are not achievable with the physical resolution alone.
- * For instance, when requiring a 100Hz pulse with a millisecond tick capability, we'll end with 1000ms/100Hz steps => 10 ms time period (window) per PWM pulse @100Hz.
- * It means we only achieve a 10 grades resolution @100Hz max. And applied duty cycle (e.g. 50 duty -> 0-4 (ON), then 5-9 (OFF), same for 51, 53, 59.) will be aligned with
- * the pulses.
- * However we can use the remaining part of the division to stuff several consecutive time window (10) with a mix and match of pulses to virtually achieve intermediate levels of resolution.
- * E.g. :
- * 100 Hz, duty cycle of 55% :
- * [5,6,5,6,5,6,5,6,5,6] -> The 1:1 alternating 5 ms and 6 ms pulse simulates the "effective" pulse in the exact middle
- *
- * Duty cycle : 33%
- * [3,3,4,3,3,4,3,3,4,3]
-*/
-// #ifndef LED_PWM_NO_PULSE_STUFFING
-// #define LED_PWM_PULSE_STUFFING
-// #endif
+#define LED_BLINK_BREATHING_STEPS LED_BREATHING_TABLE_STEPS                                                 /**> Breathing waveform steps (one per resolution window), @see led_breathing_table.h */
+#ifndef LED_PWM_PULSE_STUFFING
+#define LED_PWM_PULSE_STUFFING 1    /**> Software PWM alternates on times from window to window so that the average duty cycle is exact (@see span_next()) */
+#endif
 
 // ################################### LED BLINK WARNING PATTERN Defines ##############################################
 #define LED_BLINK_WARNING_PERIOD_S 2U                                                                       /**> LED warning cycle period                       */
@@ -57,16 +47,55 @@ extern "C" {
     (LED_BLINK_ACCEPT_PERIOD_MS / LED_BLINK_ACCEPT_FLASHES)         /**> LED accept pattern individual cycle period (milliseconds)                  */
 #define LED_BLINK_ACCEPT_ON_TIME_MS \
     (LED_BLINK_ACCEPT_CYCLE_PERIOD_MS / 2U)                         /**> LED accept pattern ON time (milliseconds) - half period (on/off is 333 ms) */
+
+// ################################### LED pattern engine ##############################################
+/**
+ * @brief Patterns are keyframe programs run by a small engine, instead of one handler per pattern.
+ * A program is a byte array kept in flash (FLASH_STORAGE), made of LED_KEYFRAME_SIZE bytes keyframes : opcode, argument
+ * and a 16 bits duration (milliseconds), built with the LED_KF_*() macros. Keyframes follow each other on an exact schedule
+ * (a keyframe starts when the previous one was due, not when it was processed). E.g. 3 flashes (played once, then repeated twice) then
+ * the next event :
+ *      static const uint8_t flashes[] FLASH_STORAGE = {LED_KF_LEVEL(100U, 166U), LED_KF_LEVEL(0U, 167U), LED_KF_REPEAT(0U, 2U), LED_KF_END()};
+ * Durations are measured on 16 bits : the main loop must not stall for more than a minute.
+ */
+#define LED_OP_END 0U           /**> Program is over : the LED follows its next event (@see led_set_next_event()), solid IO state by default  */
+#define LED_OP_LEVEL 1U         /**> Holds a duty cycle (argument, 0 - 100) for the duration, 0 : forever                                     */
+#define LED_OP_RAMP 2U          /**> Moves linearly from the current duty cycle to the argument over the duration                            */
+#define LED_OP_WAVEFORM 3U      /**> Plays the breathing table, one step per LED_BLINK_BREATHING_RESOLUTION_MS (@see led_breathing_table.h)    */
+#define LED_OP_REPEAT 4U        /**> Jumps back to keyframe index (argument), as many times as the duration field says (up to 255), 0 : forever */
+#define LED_OP_NEXT 5U          /**> Chains to a built-in pattern (argument, led_blink_pattern_t)                                             */
+#define LED_OP_SOLID 6U         /**> Applies the solid IO state (@see led_blink_none_set_io()) and stops                                     */
+
+#define LED_KEYFRAME_SIZE 4U    /**> Opcode, argument, duration (little endian)                                                               */
+#define LED_KEYFRAME(op, arg, duration_ms) \
+    (uint8_t)(op), (uint8_t)(arg), (uint8_t)((duration_ms) & 0xFFU), (uint8_t)(((duration_ms) >> 8U) & 0xFFU)
+#define LED_KF_LEVEL(level, duration_ms) LED_KEYFRAME(LED_OP_LEVEL, level, duration_ms)
+#define LED_KF_RAMP(level, duration_ms) LED_KEYFRAME(LED_OP_RAMP, level, duration_ms)
+#define LED_KF_WAVEFORM() LED_KEYFRAME(LED_OP_WAVEFORM, 0U, 0U)
+#define LED_KF_REPEAT(keyframe, count) LED_KEYFRAME(LED_OP_REPEAT, keyframe, count)
+#define LED_KF_NEXT(pattern) LED_KEYFRAME(LED_OP_NEXT, pattern, 0U)
+#define LED_KF_SOLID() LED_KEYFRAME(LED_OP_SOLID, 0U, 0U)
+#define LED_KF_END() LED_KEYFRAME(LED_OP_END, 0U, 0U)
 // clang-format on
 
+/**
+ * @brief built-in patterns (programs defined in led.c)
+ */
 typedef enum
 {
     LED_BLINK_ACCEPT,    /**> Shows the "accept/ok" pattern : 3 short blinks then back to previous state                            */
     LED_BLINK_WARNING,   /**> Shows the "warning" pattern : continuous slow blink 1s ON 1s OFF                                      */
-    LED_BLINK_BREATHING, /**> Shows the "breathing" pattern : soft dimming from 0 to 100 and 100 to 0 (sawtooth pattern, 4s period) */
-    LED_BLINK_NONE       /**> No particular pattern is applied to the LED*/
+    LED_BLINK_BREATHING, /**> Shows the "breathing" pattern : soft dimming from 0 to 100 and 100 to 0 (gamma corrected table, 4s period) */
+    LED_BLINK_NONE,      /**> No particular pattern is applied to the LED : solid IO state                                           */
+    LED_BLINK_PATTERN_COUNT
 } led_blink_pattern_t;
 
+/**
+ * @brief hardware PWM output driving a LED (e.g. a timer compare output)
+ * @param[in] duty : duty cycle, 0 (off) to 100 (fully on)
+ */
+typedef void (*led_set_duty_t)(const uint8_t duty);
+
 /**
  * @brief encodes the static configuration we need for led driver
  */
@@ -74,6 +103,8 @@ typedef struct
 {
     volatile uint8_t *port; /**> Specifies the LED IO port (needs to be a pointer to the PORT[ABCD]) */
     uint8_t pin;            /**> Specifies the LED IO id (0 to 7)                                    */
+    led_set_duty_t set_duty; /**> Optional hardware PWM backend : drives the LED instead of the port, */
+                             /**> only called when the duty cycle changes. NULL : software PWM               */
 } led_io_t;
 
 typedef enum
@@ -112,16 +143,24 @@ void led_reset(void);
 
 /**
  * @brief processes events on all registered LEDs.
+ * Every program keyframe (and software PWM edge) tells when the LED output changes next : until the earliest of these
+ * deadlines, this is a single comparison and returns right away, so it can be called on every loop iteration.
  */
 void led_process(mcu_time_t const *const time);
 
 /**
- * @brief changes the blink pattern for a single led
+ * @brief changes the blink pattern for a single led, restarting it from its first keyframe
  */
 void led_set_blink_pattern(const uint8_t led_id, const led_blink_pattern_t pattern);
 
 /**
- * @brief when pattern is LED_BLINK_NONE, specify in which state the LED IO should be
+ * @brief runs a custom keyframe program on a single led (@see LED_KF_LEVEL() and friends)
+ * @param[in] program : keyframes, in flash (FLASH_STORAGE), they need to outlive their execution
+ */
+void led_run_program(const uint8_t led_id, uint8_t const *const program);
+
+/**
+ * @brief when pattern is LED_BLINK_NONE, specify in which state the LED IO should be (applied by the next led_process() if the LED is solid)
  * @param[in] led_id    : internal led id
  * @param[in] io_state  : desired IO state for that led
 */
@@ -134,8 +173,26 @@ void led_blink_none_set_io(const uint8_t led_id, const uint8_t io_state);
 */
 void led_set_next_event(const uint8_t led_id, const led_next_event_t * event);
 
+/**
+ * @brief tells when the LED driver needs to be processed again, so that an idle manager can sleep until then.
+ * This is the earliest LED deadline, as of the last led_process() call : the next keyframe, ramp or waveform step, or
+ * software PWM edge. LEDs with a constant IO state (or holding a level forever) don't need to be processed at all.
+ * @param[in]  now      : current time, the deadline when a program was just started
+ * @param[out] deadline : next time led_process() needs to be called
+ * @return true if a deadline was computed, false if no LED needs processing
+ */
+bool led_get_next_deadline(mcu_time_t const *const now, mcu_time_t *const deadline);
+
+/**
+ * @brief duty cycle of the breathing pattern at a given step : a single read of the generated waveform table
+ * @param[in] step : current step number (0 to LED_BLINK_BREATHING_STEPS - 1). Not wrapped : the caller does it, steps out of range read 0
+ * @return duty cycle (ranging from 0 to 100)
+*/
+uint8_t led_breathing_get_duty(const uint16_t step);
+
 /**
  * @brief computes the duty cycle for a sawtooth (dual ramp) with the current step number.
+ * Linear reference waveform : the breathing pattern now reads the gamma corrected table instead (@see led_breathing_get_duty())
  * @param[in] step : current step number
  * @return computed duty cycle (ranging from 0 to 100)
 */
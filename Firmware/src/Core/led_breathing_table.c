@@ -0,0 +1,14 @@
+#include "led_breathing_table.h"
+
+const uint8_t led_breathing_table[LED_BREATHING_TABLE_STEPS] FLASH_STORAGE = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   3,
+      3,   3,   4,   4,   4,   5,   5,   6,   6,   7,   7,   8,   8,   9,   9,  10,  11,  11,  12,  13,
+     13,  14,  15,  16,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,
+     33,  34,  35,  36,  37,  39,  40,  41,  43,  44,  46,  47,  49,  50,  52,  53,  55,  56,  58,  60,
+     61,  63,  65,  66,  68,  70,  72,  74,  75,  77,  79,  81,  83,  85,  87,  89,  91,  94,  96,  98,
+    100,  98,  96,  94,  91,  89,  87,  85,  83,  81,  79,  77,  75,  74,  72,  70,  68,  66,  65,  63,
+     61,  60,  58,  56,  55,  53,  52,  50,  49,  47,  46,  44,  43,  41,  40,  39,  37,  36,  35,  34,
+     33,  31,  30,  29,  28,  27,  26,  25,  24,  23,  22,  21,  20,  19,  18,  17,  16,  16,  15,  14,
+     13,  13,  12,  11,  11,  10,   9,   9,   8,   8,   7,   7,   6,   6,   5,   5,   4,   4,   4,   3,
+      3,   3,   2,   2,   2,   2,   1,   1,   1,   1,   1,   1,   0,   0,   0,   0,   0,   0,   0,   0
+};
@@ -0,0 +1,24 @@
+#ifndef LED_BREATHING_TABLE_HEADER
+#define LED_BREATHING_TABLE_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "flash.h"
+
+/**
+ * @brief LED breathing waveform, generated by Tools/breathing_generator.py (triangle, gamma 2.2).
+ * One duty cycle (0 - 100) per breathing step, read with FLASH_READ_U8().
+ */
+#define LED_BREATHING_TABLE_STEPS 200U
+
+extern const uint8_t led_breathing_table[LED_BREATHING_TABLE_STEPS] FLASH_STORAGE;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LED_BREATHING_TABLE_HEADER */
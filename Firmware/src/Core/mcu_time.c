@@ -4,4 +4,47 @@ void time_default(mcu_time_t * time)
 {
     time->milliseconds = 0;
     time->seconds = 0;
-}
\ No newline at end of file
+}
+
+void time_add_ms(mcu_time_t *time, const uint32_t duration)
+{
+    uint32_t milliseconds = time->milliseconds + (duration % 1000U);
+    time->seconds += duration / 1000U;
+    if (milliseconds >= 1000U)
+    {
+        time->seconds++;
+        milliseconds -= 1000U;
+    }
+    time->milliseconds = (uint16_t)milliseconds;
+}
+
+int8_t time_compare(mcu_time_t const *const a, mcu_time_t const *const b)
+{
+    if (a->seconds != b->seconds)
+    {
+        return a->seconds < b->seconds ? -1 : 1;
+    }
+
+    if (a->milliseconds != b->milliseconds)
+    {
+        return a->milliseconds < b->milliseconds ? -1 : 1;
+    }
+    return 0;
+}
+
+uint32_t time_elapsed_ms(mcu_time_t const *const from, mcu_time_t const *const to)
+{
+    if (time_compare(from, to) >= 0)
+    {
+        return 0;
+    }
+
+    uint32_t seconds = to->seconds - from->seconds;
+    if (seconds >= (UINT32_MAX / 1000U))
+    {
+        return UINT32_MAX;
+    }
+
+    // "to" is after "from", so this never underflows even when to.milliseconds < from.milliseconds
+    return ((seconds * 1000U) + to->milliseconds) - from->milliseconds;
+}
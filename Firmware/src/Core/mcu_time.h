@@ -22,8 +22,29 @@ typedef struct
  */
 void time_default(mcu_time_t *time);
 
+/**
+ * @brief adds a duration (milliseconds) to the given time construct.
+ * @param[in/out] time     : time construct to be moved forward
+ * @param[in]     duration : duration to be added (milliseconds)
+ */
+void time_add_ms(mcu_time_t *time, const uint32_t duration);
+
+/**
+ * @brief compares two time constructs
+ * @return -1 if a is before b, 0 if both are equal, 1 if a is after b
+ */
+int8_t time_compare(mcu_time_t const *const a, mcu_time_t const *const b);
+
+/**
+ * @brief computes the elapsed time between two time constructs
+ * @param[in] from : start time
+ * @param[in] to   : end time
+ * @return elapsed time in milliseconds, 0 if "to" is before "from". Saturates to UINT32_MAX.
+ */
+uint32_t time_elapsed_ms(mcu_time_t const *const from, mcu_time_t const *const to);
+
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* TIME_HEADER */
\ No newline at end of file
+#endif /* TIME_HEADER */
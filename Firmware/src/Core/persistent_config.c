@@ -0,0 +1,13 @@
+#include "persistent_config.h"
+
+void persistent_config_default(persistent_config_t * config)
+{
+    config->header = PERMANENT_STORAGE_HEADER;
+    config->target_temperature = 4;
+    config->current_threshold = 500;
+    config->warming_rate = 0;
+    config->cooling_rate = 0;
+    config->current_sigma = 0;
+    config->current_runs = 0;
+    config->footer = PERMANENT_STORAGE_FOOTER;
+}
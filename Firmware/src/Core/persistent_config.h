@@ -0,0 +1,44 @@
+#ifndef PERSISTENT_CONFIG_HEADER
+#define PERSISTENT_CONFIG_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+// Permanent storage header and footer are used to make sure EEPROM was already
+// used and is valid. These are default constant values which is really
+// unlikely we'll find in the EEPROM straight from factory. They will be used
+// to invalidate cached values and trigger board auto-learning
+#define PERMANENT_STORAGE_HEADER 0xDE
+#define PERMANENT_STORAGE_FOOTER 0xAD
+
+/**
+ * @brief this little structure embeds necessay data for
+ * the board to permanently store settings and configurations.
+ * This is meant to be written in EEPROM, hence it shall be preserved in between power cycles
+*/
+typedef struct
+{
+    uint8_t header;             /**> Constant header value. Used with Footer to know if EEPROM has already been written to or is blank (first boot)*/
+    int8_t target_temperature;  /**> Target temperature set point. Regular values range from -20 to 25 °Celsius                                    */
+    uint16_t current_threshold; /**> Learnt compressor running current, mean over the runs (milliAmps, 0 : learning). Stall threshold derives from it */
+    uint16_t warming_rate;      /**> Learnt cabinet warm-up rate, compressor off (Q8 °C per hour, 0 : not learnt yet)                             */
+    uint16_t cooling_rate;      /**> Learnt cabinet cool-down rate, compressor on (Q8 °C per hour, 0 : not learnt yet)                            */
+    uint16_t current_sigma;     /**> Running current standard deviation over the runs (Q4 milliAmps)                                             */
+    uint8_t current_runs;       /**> Compressor runs the running current was learnt from (saturates at 255)                                      */
+    uint8_t footer;             /**> Constant footer value. Used with Header to know if EEPROM has already been written to or is blank (first boot)*/
+} persistent_config_t;
+
+/**
+ * @brief initializes the configuration with factory defaults
+*/
+void persistent_config_default(persistent_config_t * config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENT_CONFIG_HEADER */
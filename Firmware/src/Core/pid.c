@@ -0,0 +1,98 @@
+#include "pid.h"
+
+#define PID_Q16_SHIFT 16U
+#define PID_TERM_LIMIT_Q8 ((int32_t)2000 * PID_Q8_ONE)        /**> Twice the full output range, prevents overflows when summing the terms */
+#define PID_TERM_LIMIT ((int32_t)2000 << PID_Q16_SHIFT)       /**> Same as above, Q16                                                       */
+
+static int32_t clamp32(const int32_t value, const int32_t min, const int32_t max)
+{
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+void pid_init(pid_state_t *const state)
+{
+    state->integral = 0;
+    state->derivative = 0;
+    state->output = 0;
+    state->last_update = 0;
+    state->started = false;
+}
+
+bool pid_update(pid_params_t const *const params, pid_state_t *const state, const int16_t setpoint, const int16_t measurement,
+                const int16_t slope, const uint32_t now)
+{
+    if (state->started && ((now - state->last_update) < params->sample_period_s))
+    {
+        return false;
+    }
+
+    const int32_t output_min = (int32_t)params->output_min << PID_Q16_SHIFT;
+    const int32_t output_max = (int32_t)params->output_max << PID_Q16_SHIFT;
+    const int32_t error = (int32_t)measurement - setpoint;
+
+    state->last_update = now;
+    state->started = true;
+
+    // permille/°C x Q8 °C gives Q8 permille, clamped before the conversion to Q16 so that it can't overflow
+    const int32_t proportional = clamp32((int32_t)params->kp * error, -PID_TERM_LIMIT_Q8, PID_TERM_LIMIT_Q8) * PID_Q8_ONE;
+
+    // permille/(°C/h) x Q8 °C/h gives Q8 permille as well
+    const int32_t derivative_raw = clamp32((int32_t)params->kd * slope, -PID_TERM_LIMIT_Q8, PID_TERM_LIMIT_Q8) * PID_Q8_ONE;
+    state->derivative += (derivative_raw - state->derivative) >> params->derivative_shift;
+
+    // Conditional integration : the integral only moves if it does not push a saturated output further
+    const int32_t unsaturated = proportional + state->integral + state->derivative;
+    const int32_t step = clamp32((int32_t)params->ki * error, -PID_TERM_LIMIT, PID_TERM_LIMIT);
+    if (!((unsaturated >= output_max) && (step > 0)) && !((unsaturated <= output_min) && (step < 0)))
+    {
+        state->integral = clamp32(state->integral + step, output_min, output_max);
+    }
+
+    const int32_t output = clamp32(proportional + state->integral + state->derivative, output_min, output_max);
+    state->output = (int16_t)(output >> PID_Q16_SHIFT);
+    return true;
+}
+
+void pid_window_init(pid_window_t *const window)
+{
+    window->start = 0;
+    window->on_s = 0;
+    window->started = false;
+}
+
+bool pid_window_demand(pid_window_params_t const *const params, pid_window_t *const window, const int16_t output, const bool running,
+                       const uint32_t last_switch, const uint32_t now)
+{
+    const uint32_t since_switch = now - last_switch;
+    // The rest bounds the start rate, a saturated output (full demand, e.g. a heat load) only waits for the restart protection
+    const int16_t duty = (output < 0) ? 0 : ((output > 1000) ? 1000 : output);
+    const uint16_t rest_s = (duty < 1000) ? params->min_idle_s : 0U;
+    const uint16_t min_off_s = (rest_s > params->min_off_s) ? rest_s : params->min_off_s;
+    const bool may_start = (last_switch == 0U) || (since_switch >= min_off_s);
+
+    // A new window waits for the restart protection : shifting it is better than shortening its on time
+    if ((!window->started || ((now - window->start) >= params->window_s)) && (running || may_start))
+    {
+        window->start = now;
+        window->started = true;
+    }
+
+    // Output is followed within the window, so that a sudden heat load does not wait for the next one
+    uint32_t on_s = ((uint32_t)duty * params->window_s) / 1000U;
+    if ((on_s + params->min_off_s) > params->window_s)
+    {
+        // Off time too short for the restart protection : keeps running through the whole window
+        on_s = params->window_s;
+    }
+    window->on_s = (uint16_t)on_s;
+
+    const uint32_t elapsed = now - window->start;
+    if (running)
+    {
+        // A running compressor goes on until the minimum run time, whatever the window says
+        return (elapsed < on_s) || (since_switch < params->min_on_s);
+    }
+
+    // Only starts if the remaining on time is worth it
+    return may_start && ((elapsed + params->min_on_s) <= on_s);
+}
@@ -0,0 +1,114 @@
+#ifndef PID_HEADER
+#define PID_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-point PID controller (no floating point on the MCU).
+ * Temperatures are Q8 fixed point °C (1°C = 256) and the output is a duty cycle in permille.
+ * Terms are accumulated in Q16 permille (1 permille = 65536), which keeps enough resolution for very small integral gains.
+ * - Derivative acts on the measured slope (no kick when the setpoint changes), fed by the temperature Kalman filter
+ *   (@see kalman.h) rather than differences of readings that the ADC quantization turns into spikes. A first order low pass
+ *   filter can smooth it further
+ * - Anti-windup : the integral term is clamped to the output range, and frozen while the output saturates in the same direction
+ */
+
+#define PID_Q8_ONE 256                  /**> 1.0 in Q8 fixed point                */
+#define PID_TO_Q8(value) ((int16_t)((value) * PID_Q8_ONE)) /**> Integer to Q8 fixed point */
+
+/**
+ * @brief PID tuning. Error is measurement - setpoint : a warm fridge asks for more cooling.
+ */
+typedef struct
+{
+    int16_t kp;                /**> Proportional gain, permille per °C                                           */
+    int16_t ki;                /**> Integral gain, Q8 permille per °C and per sample (256 = 1 permille/°C/sample) */
+    int16_t kd;                /**> Derivative gain, permille per °C/h of measurement slope                      */
+    uint8_t derivative_shift;  /**> Derivative low pass filter : d += (raw - d) >> shift (0 disables the filter)  */
+    uint16_t sample_period_s;  /**> Time in between two updates (seconds)                                        */
+    int16_t output_min;        /**> Lowest output (permille)                                                     */
+    int16_t output_max;        /**> Highest output (permille)                                                    */
+} pid_params_t;
+
+/**
+ * @brief PID state
+ */
+typedef struct
+{
+    int32_t integral;              /**> Integral term (Q16 permille)                         */
+    int32_t derivative;            /**> Filtered derivative term (Q16 permille)              */
+    int16_t output;                /**> Last output (permille)                               */
+    uint32_t last_update;          /**> Time of the last update (seconds)                    */
+    bool started;                  /**> Set by the first update                              */
+} pid_state_t;
+
+/**
+ * @brief time-proportioning window : turns the PID output into compressor on/off periods.
+ * The compressor runs for output x window at the beginning of every window, the output being followed as it changes.
+ * Starts that can't last min_on_s are skipped, off times shorter than min_off_s are merged into the on time (no short stop),
+ * and a window only opens once the compressor may restart, so the restart protection never cuts an on time short.
+ * min_idle_s bounds the start rate : a stopped compressor rests at least that long, the window waiting for it like it
+ * waits for the restart protection, unless the output saturates (full demand only waits for the restart protection).
+ */
+typedef struct
+{
+    uint16_t window_s;   /**> Window length (seconds)                                                              */
+    uint16_t min_on_s;   /**> Minimum compressor run time (seconds)                                                */
+    uint16_t min_off_s;  /**> Minimum compressor off time : restart protection (seconds)                           */
+    uint16_t min_idle_s; /**> Minimum compressor rest unless the output saturates, bounds the start rate (seconds) */
+} pid_window_params_t;
+
+/**
+ * @brief time-proportioning window state
+ */
+typedef struct
+{
+    uint32_t start;     /**> Current window start time (seconds)                  */
+    uint16_t on_s;      /**> Compressor run time within the current window        */
+    bool started;       /**> Set when the first window opens                      */
+} pid_window_t;
+
+/**
+ * @brief resets the controller (integral, derivative and output)
+ */
+void pid_init(pid_state_t *const state);
+
+/**
+ * @brief runs the controller if a sample period elapsed since the last update (always runs the first time)
+ * @param[in] setpoint    : target (Q8 °C)
+ * @param[in] measurement : current measurement (Q8 °C)
+ * @param[in] slope       : measurement rate of change (Q8 °C per hour)
+ * @param[in] now         : current time (seconds)
+ * @return true if the controller ran, the output is in state->output
+ */
+bool pid_update(pid_params_t const *const params, pid_state_t *const state, const int16_t setpoint, const int16_t measurement,
+                const int16_t slope, const uint32_t now);
+
+/**
+ * @brief resets the window, the next pid_window_demand() call opens a new one
+ */
+void pid_window_init(pid_window_t *const window);
+
+/**
+ * @brief tells whether the compressor should run
+ * @param[in] output     : PID output (permille)
+ * @param[in] running    : whether the compressor currently runs
+ * @param[in] last_switch: when the compressor was last started or stopped (seconds, 0 : never) :
+ *                          a running compressor runs for at least min_on_s, a stopped one stays off for at least
+ *                          min_off_s (and min_idle_s unless the output saturates)
+ * @param[in] now        : current time (seconds)
+ * @return compressor demand
+ */
+bool pid_window_demand(pid_window_params_t const *const params, pid_window_t *const window, const int16_t output, const bool running,
+                       const uint32_t last_switch, const uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PID_HEADER */
@@ -0,0 +1,587 @@
+#include "pipeline.h"
+
+#include <string.h>
+
+void pipeline_init(pipeline_t *const pipeline, sensors_config_t const *const sensors, thermistor_data_t const *const thermistor)
+{
+    pipeline->sensors = sensors;
+    pipeline->thermistor = thermistor;
+    app_init(&pipeline->app);
+
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        button_init(&pipeline->buttons[i]);
+    }
+    gesture_params_default(&pipeline->gesture_params);
+    gesture_init(&pipeline->gestures);
+    gesture_queue_init(&pipeline->gesture_events);
+
+    current_rms_window_init(&pipeline->current_window);
+    kalman_params_default(&pipeline->filter_params);
+    kalman_init(&pipeline->filter);
+    pipeline->temperature_filter = (PIPELINE_TEMPERATURE_FILTER != 0U);
+    sampling_params_default(&pipeline->sampling_params);
+    pipeline->adaptive_sampling = (PIPELINE_ADAPTIVE_SAMPLING != 0U);
+    pipeline->temperature_period = 1U;
+    pipeline->temperature = 0;
+    pipeline->temperature_q8 = 0;
+    pipeline->temperature_slope = 0;
+    pipeline->temperature_curvature = 0;
+    pipeline->current_ma = 0;
+    pipeline->current_rms = 0;
+    wall_clock_init(&pipeline->clock);
+    pipeline->time_of_day = APP_TIME_OF_DAY_UNKNOWN;
+    pipeline->time_of_day_second = 0;
+    pipeline->time_of_day_stale = true;
+}
+
+// Rounds up to the degree, like thermistor_read_temperature() does : both paths feed the same thresholds
+static int8_t temperature_from_q8(const int16_t temperature_q8)
+{
+    const int16_t degrees = (int16_t)((temperature_q8 >= 0) ? ((temperature_q8 + 255) / 256) : -((-temperature_q8) / 256));
+    return (degrees < INT8_MIN) ? INT8_MIN : ((degrees > INT8_MAX) ? INT8_MAX : (int8_t)degrees);
+}
+
+// Time until the next reading : the closer to the next switching threshold, the faster
+static uint8_t next_temperature_period(pipeline_t const *const pipeline)
+{
+    app_state_t const *const app = &pipeline->app;
+
+    // The door openings detector times its phases on every reading
+    if (!pipeline->adaptive_sampling || (TRANSIENT_NONE != app->transient.phase))
+    {
+        return 1U;
+    }
+
+    // Same thresholds as the integer comparisons of the hysteresis : starts above setpoint + high, stops at setpoint - low - 1 and below
+    uint8_t high;
+    uint8_t low;
+    app_get_hysteresis_band(app, &high, &low);
+    const int32_t target = app_get_setpoint(app);
+    int32_t distance = app->motor_on ? ((int32_t)pipeline->temperature_q8 - (target - low - 1) * 256)
+                                     : ((target + high) * 256 - (int32_t)pipeline->temperature_q8);
+    distance = (distance > INT16_MAX) ? INT16_MAX : ((distance < INT16_MIN) ? INT16_MIN : distance);
+
+    return sampling_next_period(&pipeline->sampling_params, (int16_t)distance, pipeline->temperature_slope, pipeline->temperature_curvature,
+                                pipeline->filter_params.sample_period_ms);
+}
+
+void pipeline_sample_temperature(pipeline_t *const pipeline, const uint16_t raw)
+{
+    if (!pipeline->temperature_filter)
+    {
+        pipeline->temperature = sensors_temperature_from_adc(pipeline->sensors, pipeline->thermistor, raw);
+        pipeline->temperature_q8 = (int16_t)(pipeline->temperature * 256);
+        pipeline->temperature_slope = 0;
+        pipeline->temperature_curvature = 0;
+        pipeline->temperature_period = 1U;
+        return;
+    }
+
+    // Readings skipped by the sampling policy are predicted over
+    for (uint8_t i = 1U; i < pipeline->temperature_period; i++)
+    {
+        kalman_skip(&pipeline->filter);
+    }
+
+    const int16_t reading = sensors_temperature_q8_from_adc(pipeline->sensors, pipeline->thermistor, raw);
+    kalman_update(&pipeline->filter_params, &pipeline->filter, reading);
+    const int16_t previous_slope = pipeline->temperature_slope;
+    const uint32_t elapsed_ms = pipeline_temperature_period_ms(pipeline);
+    pipeline->temperature_q8 = kalman_temperature(&pipeline->filter);
+    pipeline->temperature_slope = kalman_slope(&pipeline->filter_params, &pipeline->filter);
+    transient_curvature_update(&pipeline->temperature_curvature, previous_slope, pipeline->temperature_slope,
+                               (uint16_t)((elapsed_ms > UINT16_MAX) ? UINT16_MAX : elapsed_ms));
+    pipeline->temperature = temperature_from_q8(pipeline->temperature_q8);
+    pipeline->temperature_period = next_temperature_period(pipeline);
+}
+
+uint32_t pipeline_temperature_period_ms(pipeline_t const *const pipeline)
+{
+    return (uint32_t)pipeline->temperature_period * pipeline->filter_params.sample_period_ms;
+}
+
+void pipeline_sample_current(pipeline_t *const pipeline, const uint16_t raw)
+{
+    pipeline->current_ma = sensors_current_from_adc(pipeline->sensors, raw);
+
+#if CURRENT_RMS_ARBITRARY_FCT == 1
+    const int16_t dc_offset_current = 300;
+    current_rms_window_compute_arbitrary(&pipeline->current_window, &pipeline->current_ma, &pipeline->current_rms, &dc_offset_current);
+#else
+    // Takes care about the remaining DC part, current_ma should still have this DC component otherwise RMS won't work.
+    current_rms_window_compute_sine(&pipeline->current_window, &pipeline->current_ma, &pipeline->current_rms);
+#endif
+}
+
+void pipeline_sample_buttons(pipeline_t *const pipeline, const uint8_t levels, mcu_time_t const *const time)
+{
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        // Buttons are active low
+        const bool pressed = (levels & (1U << i)) == 0U;
+        if (button_update(&pipeline->buttons[i], pressed, time))
+        {
+            gesture_edge(&pipeline->gesture_params, &pipeline->gestures, i, pipeline->buttons[i].pressed, time, &pipeline->gesture_events);
+        }
+    }
+    gesture_process(&pipeline->gesture_params, &pipeline->gestures, time, &pipeline->gesture_events);
+}
+
+bool pipeline_buttons_deadline(pipeline_t const *const pipeline, mcu_time_t *const deadline)
+{
+    bool pending = gesture_get_deadline(&pipeline->gestures, deadline);
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        mcu_time_t button_deadline;
+        if (button_get_deadline(&pipeline->buttons[i], &button_deadline) && (!pending || (time_compare(&button_deadline, deadline) < 0)))
+        {
+            *deadline = button_deadline;
+            pending = true;
+        }
+    }
+    return pending;
+}
+
+void pipeline_sync_clock(pipeline_t *const pipeline, mcu_time_t const *const time, const uint32_t wall_s)
+{
+    wall_clock_sync(&pipeline->clock, time, wall_s);
+    pipeline->time_of_day_stale = true;
+}
+
+// The wall time only depends on the MCU seconds : computed once per second rather than on every current sample
+static uint16_t time_of_day(pipeline_t *const pipeline, mcu_time_t const *const time)
+{
+    if (pipeline->time_of_day_stale || (pipeline->time_of_day_second != time->seconds))
+    {
+        uint32_t wall_s;
+        const bool known = wall_clock_now(&pipeline->clock, time, &wall_s);
+        pipeline->time_of_day = known ? (uint16_t)((wall_s % WALL_CLOCK_SECONDS_PER_DAY) / 60U) : APP_TIME_OF_DAY_UNKNOWN;
+        pipeline->time_of_day_second = time->seconds;
+        pipeline->time_of_day_stale = false;
+    }
+    return pipeline->time_of_day;
+}
+
+void pipeline_step(pipeline_t *const pipeline, mcu_time_t const *const time, app_outputs_t *const outputs)
+{
+    app_inputs_t inputs;
+    inputs.time = *time;
+    inputs.temperature = pipeline->temperature;
+    inputs.temperature_q8 = pipeline->temperature_q8;
+    inputs.temperature_slope = pipeline->temperature_slope;
+    inputs.temperature_curvature = pipeline->temperature_curvature;
+    inputs.current_rms = pipeline->current_rms;
+    inputs.gestures = &pipeline->gesture_events;
+    inputs.time_of_day = time_of_day(pipeline, time);
+    app_step(&pipeline->app, &inputs, outputs);
+}
+
+// Little endian helpers, the cursor is moved past the written/read bytes
+static void put_u8(uint8_t **cursor, const uint8_t value)
+{
+    *(*cursor)++ = value;
+}
+
+static void put_u16(uint8_t **cursor, const uint16_t value)
+{
+    put_u8(cursor, (uint8_t)value);
+    put_u8(cursor, (uint8_t)(value >> 8U));
+}
+
+static void put_u32(uint8_t **cursor, const uint32_t value)
+{
+    put_u16(cursor, (uint16_t)value);
+    put_u16(cursor, (uint16_t)(value >> 16U));
+}
+
+static uint8_t get_u8(uint8_t const **cursor)
+{
+    return *(*cursor)++;
+}
+
+static uint16_t get_u16(uint8_t const **cursor)
+{
+    const uint16_t low = get_u8(cursor);
+    return (uint16_t)(low | ((uint16_t)get_u8(cursor) << 8U));
+}
+
+static uint32_t get_u32(uint8_t const **cursor)
+{
+    const uint32_t low = get_u16(cursor);
+    return low | ((uint32_t)get_u16(cursor) << 16U);
+}
+
+static void put_time(uint8_t **cursor, mcu_time_t const *const time)
+{
+    put_u32(cursor, time->seconds);
+    put_u16(cursor, time->milliseconds);
+}
+
+static void get_time(uint8_t const **cursor, mcu_time_t *const time)
+{
+    time->seconds = get_u32(cursor);
+    time->milliseconds = get_u16(cursor);
+}
+
+static void put_button(uint8_t **cursor, button_t const *const button)
+{
+    put_u8(cursor, button->level ? 1U : 0U);
+    put_u8(cursor, button->pressed ? 1U : 0U);
+    put_time(cursor, &button->changed);
+}
+
+static void get_button(uint8_t const **cursor, button_t *const button)
+{
+    button->level = get_u8(cursor) != 0U;
+    button->pressed = get_u8(cursor) != 0U;
+    get_time(cursor, &button->changed);
+}
+
+static void put_gestures(uint8_t **cursor, gesture_params_t const *const params, gesture_recognizer_t const *const recognizer)
+{
+    put_u16(cursor, params->double_click_ms);
+    put_u16(cursor, params->long_press_ms);
+    put_u16(cursor, params->repeat_ms);
+    put_u16(cursor, params->chord_ms);
+    put_u8(cursor, recognizer->state);
+    put_u8(cursor, recognizer->button);
+    put_u8(cursor, recognizer->down);
+    put_u8(cursor, recognizer->timer_armed ? 1U : 0U);
+    put_time(cursor, &recognizer->deadline);
+}
+
+static void get_gestures(uint8_t const **cursor, gesture_params_t *const params, gesture_recognizer_t *const recognizer)
+{
+    params->double_click_ms = get_u16(cursor);
+    params->long_press_ms = get_u16(cursor);
+    params->repeat_ms = get_u16(cursor);
+    params->chord_ms = get_u16(cursor);
+    recognizer->state = get_u8(cursor);
+    recognizer->button = get_u8(cursor);
+    recognizer->down = get_u8(cursor);
+    recognizer->timer_armed = get_u8(cursor) != 0U;
+    get_time(cursor, &recognizer->deadline);
+}
+
+// The whole ring is kept, so that a restored queue is identical down to its unused slots
+static void put_gesture_queue(uint8_t **cursor, gesture_queue_t const *const queue)
+{
+    put_u8(cursor, queue->head);
+    put_u8(cursor, queue->count);
+    put_u8(cursor, queue->dropped);
+    for (uint8_t i = 0; i < GESTURE_QUEUE_SIZE; i++)
+    {
+        put_u8(cursor, queue->events[i].button);
+        put_u8(cursor, queue->events[i].kind);
+    }
+}
+
+static void get_gesture_queue(uint8_t const **cursor, gesture_queue_t *const queue)
+{
+    queue->head = get_u8(cursor);
+    queue->count = get_u8(cursor);
+    queue->dropped = get_u8(cursor);
+    for (uint8_t i = 0; i < GESTURE_QUEUE_SIZE; i++)
+    {
+        queue->events[i].button = get_u8(cursor);
+        queue->events[i].kind = get_u8(cursor);
+    }
+}
+
+// Recognizer needs to be in a known state, pending gestures need to name a valid button (or all of them) and gesture
+static bool gestures_valid(gesture_recognizer_t const *const recognizer, gesture_queue_t const *const queue)
+{
+    if ((recognizer->state >= GESTURE_STATE_COUNT) || (recognizer->button >= BUTTON_COUNT) || (recognizer->down >= (1U << BUTTON_COUNT)) ||
+        (queue->head >= GESTURE_QUEUE_SIZE) || (queue->count > GESTURE_QUEUE_SIZE))
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < queue->count; i++)
+    {
+        gesture_event_t const *const event = &queue->events[(queue->head + i) % GESTURE_QUEUE_SIZE];
+        if ((event->button > GESTURE_ALL_BUTTONS) || (event->kind >= GESTURE_COUNT))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void pipeline_snapshot_write(pipeline_t const *const pipeline, uint8_t *const out)
+{
+    uint8_t *cursor = out;
+    app_state_t const *const app = &pipeline->app;
+
+    put_u8(&cursor, app->params.temp_hysteresis_high);
+    put_u8(&cursor, app->params.temp_hysteresis_low);
+    put_u8(&cursor, app->params.stalled_current_multiplier_percent);
+    put_u8(&cursor, app->params.steady_motor_runtime);
+    put_u8(&cursor, app->params.stalled_motor_immune_period);
+    put_u16(&cursor, app->params.stalled_motor_wait_seconds);
+    put_u8(&cursor, (uint8_t)app->params.min_target_temperature);
+    put_u8(&cursor, (uint8_t)app->params.max_target_temperature);
+    put_u8(&cursor, app->params.adaptive_hysteresis);
+    put_u16(&cursor, app->params.adaptive_cycle_minutes);
+    put_u8(&cursor, app->params.adaptive_band_min);
+    put_u8(&cursor, app->params.adaptive_band_max);
+    put_u8(&cursor, app->params.control_mode);
+    put_u16(&cursor, (uint16_t)app->params.pid.kp);
+    put_u16(&cursor, (uint16_t)app->params.pid.ki);
+    put_u16(&cursor, (uint16_t)app->params.pid.kd);
+    put_u8(&cursor, app->params.pid.derivative_shift);
+    put_u16(&cursor, app->params.pid.sample_period_s);
+    put_u16(&cursor, (uint16_t)app->params.pid.output_min);
+    put_u16(&cursor, (uint16_t)app->params.pid.output_max);
+    put_u16(&cursor, app->params.pid_window_seconds);
+    put_u16(&cursor, app->params.min_motor_runtime_seconds);
+    put_u16(&cursor, app->params.pid_min_idle_seconds);
+    put_u8(&cursor, app->params.transient_detection);
+    put_u16(&cursor, (uint16_t)app->params.transient.slope_limit);
+    put_u16(&cursor, (uint16_t)app->params.transient.curvature_limit);
+    put_u16(&cursor, (uint16_t)app->params.transient.recovery_curvature);
+    put_u16(&cursor, app->params.transient.confirm_s);
+    put_u16(&cursor, app->params.transient.hold_max_s);
+    put_u8(&cursor, app->params.transient.hard_limit);
+    put_u8(&cursor, app->params.scheduling);
+    put_u16(&cursor, app->params.schedule.peak_start_minute);
+    put_u16(&cursor, app->params.schedule.peak_end_minute);
+    put_u16(&cursor, app->params.schedule.precool_minutes);
+    put_u8(&cursor, app->params.schedule.precool_offset);
+    put_u8(&cursor, app->params.schedule.peak_band_extra);
+    put_u8(&cursor, (uint8_t)app->params.schedule.min_temperature);
+    put_u8(&cursor, (uint8_t)app->params.schedule.max_temperature);
+    put_u8(&cursor, app->params.current_learner.sigma_k);
+    put_u8(&cursor, app->params.current_learner.min_runs);
+    put_u8(&cursor, app->params.current_learner.forget_shift);
+    put_u8(&cursor, app->params.current_learner.min_margin_percent);
+    put_u16(&cursor, app->params.current_learner.min_samples);
+
+    put_u8(&cursor, (uint8_t)app->mode);
+    put_u32(&cursor, app->tracking.motor_start_time);
+    put_u8(&cursor, (uint8_t)app->config.target_temperature);
+    put_u16(&cursor, app->config.current_threshold);
+    put_u16(&cursor, app->config.warming_rate);
+    put_u16(&cursor, app->config.cooling_rate);
+    put_u16(&cursor, app->config.current_sigma);
+    put_u8(&cursor, app->config.current_runs);
+    put_u8(&cursor, app->motor_on ? 1U : 0U);
+    put_u32(&cursor, app->last_eta_report);
+    put_u8(&cursor, (uint8_t)app->learner.switch_temperature);
+    put_u8(&cursor, app->learner.switch_valid ? 1U : 0U);
+    put_u8(&cursor, app->learner.unsaved_cycles);
+    put_u16(&cursor, app->current.run.count);
+    put_u16(&cursor, app->current.run.last_second);
+    put_u16(&cursor, (uint16_t)app->current.run.reference);
+    put_u32(&cursor, (uint32_t)app->current.run.sum);
+    put_u32(&cursor, app->current.run.square_sum);
+    put_u8(&cursor, app->current.unsaved_runs);
+    put_u32(&cursor, (uint32_t)app->pid.integral);
+    put_u32(&cursor, (uint32_t)app->pid.derivative);
+    put_u16(&cursor, (uint16_t)app->pid.output);
+    put_u32(&cursor, app->pid.last_update);
+    put_u8(&cursor, app->pid.started ? 1U : 0U);
+    put_u32(&cursor, app->pid_window.start);
+    put_u16(&cursor, app->pid_window.on_s);
+    put_u8(&cursor, app->pid_window.started ? 1U : 0U);
+    put_u8(&cursor, (uint8_t)app->transient.phase);
+    put_u32(&cursor, app->transient.start);
+    put_u8(&cursor, app->transient.holding ? 1U : 0U);
+    put_u16(&cursor, app->transient.suppressed);
+    put_u16(&cursor, app->transient.avoided);
+    put_u16(&cursor, app->transient.released);
+    put_u8(&cursor, (uint8_t)app->schedule);
+
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        put_button(&cursor, &pipeline->buttons[i]);
+    }
+    put_gestures(&cursor, &pipeline->gesture_params, &pipeline->gestures);
+    put_gesture_queue(&cursor, &pipeline->gesture_events);
+
+    for (uint8_t i = 0; i < CURRENT_MEASURE_SAMPLES_PER_SINE; i++)
+    {
+        put_u16(&cursor, (uint16_t)pipeline->current_window.data[i]);
+    }
+    put_u8(&cursor, pipeline->current_window.index);
+    put_u8(&cursor, pipeline->current_window.capacity);
+
+    put_u16(&cursor, pipeline->filter_params.measurement_noise);
+    put_u16(&cursor, pipeline->filter_params.temperature_noise);
+    put_u16(&cursor, pipeline->filter_params.slope_noise);
+    put_u16(&cursor, pipeline->filter_params.sample_period_ms);
+    put_u8(&cursor, pipeline->temperature_filter ? 1U : 0U);
+    put_u8(&cursor, pipeline->sampling_params.max_period);
+    put_u16(&cursor, (uint16_t)pipeline->sampling_params.edge_margin);
+    put_u16(&cursor, (uint16_t)pipeline->sampling_params.slope_guard);
+    put_u16(&cursor, (uint16_t)pipeline->sampling_params.fast_curvature);
+    put_u8(&cursor, pipeline->adaptive_sampling ? 1U : 0U);
+    put_u32(&cursor, (uint32_t)pipeline->filter.temperature);
+    put_u32(&cursor, (uint32_t)pipeline->filter.slope);
+    put_u32(&cursor, (uint32_t)pipeline->filter.p00);
+    put_u32(&cursor, (uint32_t)pipeline->filter.p01);
+    put_u32(&cursor, (uint32_t)pipeline->filter.p11);
+    put_u8(&cursor, pipeline->filter.started ? 1U : 0U);
+
+    put_u8(&cursor, (uint8_t)pipeline->temperature);
+    put_u16(&cursor, (uint16_t)pipeline->temperature_q8);
+    put_u16(&cursor, (uint16_t)pipeline->temperature_slope);
+    put_u16(&cursor, (uint16_t)pipeline->temperature_curvature);
+    put_u8(&cursor, pipeline->temperature_period);
+    put_u16(&cursor, (uint16_t)pipeline->current_ma);
+    put_u16(&cursor, (uint16_t)pipeline->current_rms);
+
+    put_u8(&cursor, pipeline->clock.synced ? 1U : 0U);
+    put_u8(&cursor, pipeline->clock.drift_known ? 1U : 0U);
+    put_u32(&cursor, pipeline->clock.wall_s);
+    put_u32(&cursor, pipeline->clock.mcu_s);
+    put_u32(&cursor, (uint32_t)pipeline->clock.offset_s);
+    put_u16(&cursor, (uint16_t)pipeline->clock.drift_ppm);
+}
+
+bool pipeline_snapshot_read(pipeline_t *const pipeline, uint8_t const *const in)
+{
+    // Decodes in a scratch copy first, so that a corrupted snapshot leaves the pipeline untouched
+    pipeline_t decoded = *pipeline;
+    app_state_t *const app = &decoded.app;
+    uint8_t const *cursor = in;
+
+    app->params.temp_hysteresis_high = get_u8(&cursor);
+    app->params.temp_hysteresis_low = get_u8(&cursor);
+    app->params.stalled_current_multiplier_percent = get_u8(&cursor);
+    app->params.steady_motor_runtime = get_u8(&cursor);
+    app->params.stalled_motor_immune_period = get_u8(&cursor);
+    app->params.stalled_motor_wait_seconds = get_u16(&cursor);
+    app->params.min_target_temperature = (int8_t)get_u8(&cursor);
+    app->params.max_target_temperature = (int8_t)get_u8(&cursor);
+    app->params.adaptive_hysteresis = get_u8(&cursor);
+    app->params.adaptive_cycle_minutes = get_u16(&cursor);
+    app->params.adaptive_band_min = get_u8(&cursor);
+    app->params.adaptive_band_max = get_u8(&cursor);
+    app->params.control_mode = get_u8(&cursor);
+    app->params.pid.kp = (int16_t)get_u16(&cursor);
+    app->params.pid.ki = (int16_t)get_u16(&cursor);
+    app->params.pid.kd = (int16_t)get_u16(&cursor);
+    app->params.pid.derivative_shift = get_u8(&cursor);
+    app->params.pid.sample_period_s = get_u16(&cursor);
+    app->params.pid.output_min = (int16_t)get_u16(&cursor);
+    app->params.pid.output_max = (int16_t)get_u16(&cursor);
+    app->params.pid_window_seconds = get_u16(&cursor);
+    app->params.min_motor_runtime_seconds = get_u16(&cursor);
+    app->params.pid_min_idle_seconds = get_u16(&cursor);
+    app->params.transient_detection = get_u8(&cursor);
+    app->params.transient.slope_limit = (int16_t)get_u16(&cursor);
+    app->params.transient.curvature_limit = (int16_t)get_u16(&cursor);
+    app->params.transient.recovery_curvature = (int16_t)get_u16(&cursor);
+    app->params.transient.confirm_s = get_u16(&cursor);
+    app->params.transient.hold_max_s = get_u16(&cursor);
+    app->params.transient.hard_limit = get_u8(&cursor);
+    app->params.scheduling = get_u8(&cursor);
+    app->params.schedule.peak_start_minute = get_u16(&cursor);
+    app->params.schedule.peak_end_minute = get_u16(&cursor);
+    app->params.schedule.precool_minutes = get_u16(&cursor);
+    app->params.schedule.precool_offset = get_u8(&cursor);
+    app->params.schedule.peak_band_extra = get_u8(&cursor);
+    app->params.schedule.min_temperature = (int8_t)get_u8(&cursor);
+    app->params.schedule.max_temperature = (int8_t)get_u8(&cursor);
+    app->params.current_learner.sigma_k = get_u8(&cursor);
+    app->params.current_learner.min_runs = get_u8(&cursor);
+    app->params.current_learner.forget_shift = get_u8(&cursor);
+    app->params.current_learner.min_margin_percent = get_u8(&cursor);
+    app->params.current_learner.min_samples = get_u16(&cursor);
+
+    app->mode = (app_mode_t)get_u8(&cursor);
+    app->tracking.motor_start_time = get_u32(&cursor);
+    app->config.target_temperature = (int8_t)get_u8(&cursor);
+    app->config.current_threshold = get_u16(&cursor);
+    app->config.warming_rate = get_u16(&cursor);
+    app->config.cooling_rate = get_u16(&cursor);
+    app->config.current_sigma = get_u16(&cursor);
+    app->config.current_runs = get_u8(&cursor);
+    app->motor_on = get_u8(&cursor) != 0U;
+    app->last_eta_report = get_u32(&cursor);
+    app->learner.switch_temperature = (int8_t)get_u8(&cursor);
+    app->learner.switch_valid = get_u8(&cursor) != 0U;
+    app->learner.unsaved_cycles = get_u8(&cursor);
+    app->current.run.count = get_u16(&cursor);
+    app->current.run.last_second = get_u16(&cursor);
+    app->current.run.reference = (int16_t)get_u16(&cursor);
+    app->current.run.sum = (int32_t)get_u32(&cursor);
+    app->current.run.square_sum = get_u32(&cursor);
+    app->current.unsaved_runs = get_u8(&cursor);
+    app->pid.integral = (int32_t)get_u32(&cursor);
+    app->pid.derivative = (int32_t)get_u32(&cursor);
+    app->pid.output = (int16_t)get_u16(&cursor);
+    app->pid.last_update = get_u32(&cursor);
+    app->pid.started = get_u8(&cursor) != 0U;
+    app->pid_window.start = get_u32(&cursor);
+    app->pid_window.on_s = get_u16(&cursor);
+    app->pid_window.started = get_u8(&cursor) != 0U;
+    app->transient.phase = (transient_phase_t)get_u8(&cursor);
+    app->transient.start = get_u32(&cursor);
+    app->transient.holding = get_u8(&cursor) != 0U;
+    app->transient.suppressed = get_u16(&cursor);
+    app->transient.avoided = get_u16(&cursor);
+    app->transient.released = get_u16(&cursor);
+    app->schedule = (schedule_phase_t)get_u8(&cursor);
+
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        get_button(&cursor, &decoded.buttons[i]);
+    }
+    get_gestures(&cursor, &decoded.gesture_params, &decoded.gestures);
+    get_gesture_queue(&cursor, &decoded.gesture_events);
+
+    for (uint8_t i = 0; i < CURRENT_MEASURE_SAMPLES_PER_SINE; i++)
+    {
+        decoded.current_window.data[i] = (int16_t)get_u16(&cursor);
+    }
+    decoded.current_window.index = get_u8(&cursor);
+    decoded.current_window.capacity = get_u8(&cursor);
+
+    decoded.filter_params.measurement_noise = get_u16(&cursor);
+    decoded.filter_params.temperature_noise = get_u16(&cursor);
+    decoded.filter_params.slope_noise = get_u16(&cursor);
+    decoded.filter_params.sample_period_ms = get_u16(&cursor);
+    decoded.temperature_filter = get_u8(&cursor) != 0U;
+    decoded.sampling_params.max_period = get_u8(&cursor);
+    decoded.sampling_params.edge_margin = (int16_t)get_u16(&cursor);
+    decoded.sampling_params.slope_guard = (int16_t)get_u16(&cursor);
+    decoded.sampling_params.fast_curvature = (int16_t)get_u16(&cursor);
+    decoded.adaptive_sampling = get_u8(&cursor) != 0U;
+    decoded.filter.temperature = (int32_t)get_u32(&cursor);
+    decoded.filter.slope = (int32_t)get_u32(&cursor);
+    decoded.filter.p00 = (int32_t)get_u32(&cursor);
+    decoded.filter.p01 = (int32_t)get_u32(&cursor);
+    decoded.filter.p11 = (int32_t)get_u32(&cursor);
+    decoded.filter.started = get_u8(&cursor) != 0U;
+
+    decoded.temperature = (int8_t)get_u8(&cursor);
+    decoded.temperature_q8 = (int16_t)get_u16(&cursor);
+    decoded.temperature_slope = (int16_t)get_u16(&cursor);
+    decoded.temperature_curvature = (int16_t)get_u16(&cursor);
+    decoded.temperature_period = get_u8(&cursor);
+    decoded.current_ma = (int16_t)get_u16(&cursor);
+    decoded.current_rms = (int16_t)get_u16(&cursor);
+
+    decoded.clock.synced = get_u8(&cursor) != 0U;
+    decoded.clock.drift_known = get_u8(&cursor) != 0U;
+    decoded.clock.wall_s = get_u32(&cursor);
+    decoded.clock.mcu_s = get_u32(&cursor);
+    decoded.clock.offset_s = (int32_t)get_u32(&cursor);
+    decoded.clock.drift_ppm = (int16_t)get_u16(&cursor);
+    decoded.time_of_day_stale = true;
+
+    if ((app->mode > APP_MODE_WAITING_START_MOTOR) || !gestures_valid(&decoded.gestures, &decoded.gesture_events) ||
+        (decoded.current_window.index >= CURRENT_MEASURE_SAMPLES_PER_SINE) ||
+        (decoded.current_window.capacity > CURRENT_MEASURE_SAMPLES_PER_SINE) || (app->params.control_mode > APP_CONTROL_PID) ||
+        (app->params.pid.derivative_shift > 15U) || (decoded.filter.p00 < 0) || (decoded.filter.p11 < 0) ||
+        (app->transient.phase > TRANSIENT_SUSTAINED) || (decoded.temperature_period == 0U) || (app->schedule > SCHEDULE_PEAK) ||
+        (app->params.current_learner.forget_shift > 15U))
+    {
+        return false;
+    }
+
+    *pipeline = decoded;
+    return true;
+}
@@ -0,0 +1,141 @@
+#ifndef PIPELINE_HEADER
+#define PIPELINE_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app.h"
+#include "buttons.h"
+#include "current.h"
+#include "gesture.h"
+#include "kalman.h"
+#include "mcu_time.h"
+#include "sampling.h"
+#include "sensors.h"
+#include "thermistor.h"
+#include "transient.h"
+#include "wall_clock.h"
+
+#define PIPELINE_BUTTON_PLUS (1U << BUTTON_PLUS)   /**> Plus button level bit, @see pipeline_sample_buttons()  */
+#define PIPELINE_BUTTON_MINUS (1U << BUTTON_MINUS) /**> Minus button level bit, @see pipeline_sample_buttons() */
+
+#define PIPELINE_SNAPSHOT_SIZE 297U /**> Serialized pipeline state size (bytes), @see pipeline_snapshot_write() */
+
+#ifndef PIPELINE_TEMPERATURE_FILTER
+#define PIPELINE_TEMPERATURE_FILTER 1U /**> Temperature readings go through the Kalman filter (@see kalman.h) before reaching the application */
+#endif
+
+#ifndef PIPELINE_ADAPTIVE_SAMPLING
+#define PIPELINE_ADAPTIVE_SAMPLING 1U  /**> Temperature sampling period follows the signal dynamics (@see sampling.h), needs the filter      */
+#endif
+
+/**
+ * @brief everything that sits in between the raw readings (ADC codes, buttons levels) and the application outputs.
+ * The firmware, the simulator and the trace replay all feed the very same pipeline, which keeps them bit-exact.
+ */
+typedef struct
+{
+    sensors_config_t const *sensors;      /**> Sensors front-end the conversions assume                     */
+    thermistor_data_t const *thermistor;  /**> NTC characteristic curve                                     */
+    app_state_t app;                      /**> Application state machine                                    */
+    button_t buttons[BUTTON_COUNT];       /**> Buttons debouncing state                                     */
+    gesture_params_t gesture_params;      /**> Gestures timings                                             */
+    gesture_recognizer_t gestures;        /**> Gestures recognizer, fed with the debounced edges            */
+    gesture_queue_t gesture_events;       /**> Gestures, drained by the next step                           */
+    current_rms_window_t current_window;  /**> Current RMS sliding window                                   */
+    kalman_params_t filter_params;        /**> Temperature filter tuning                                    */
+    kalman_state_t filter;                /**> Temperature filter state                                     */
+    bool temperature_filter;              /**> Temperature readings are filtered (false : raw readings)     */
+    sampling_params_t sampling_params;    /**> Temperature sampling policy tuning                           */
+    bool adaptive_sampling;               /**> Temperature sampling period adapts (false : base period)     */
+    uint8_t temperature_period;           /**> Base periods until the next temperature reading              */
+    int8_t temperature;                   /**> Last temperature reading (°C)                                */
+    int16_t temperature_q8;               /**> Last temperature reading (Q8 °C)                             */
+    int16_t temperature_slope;            /**> Temperature rate of change (Q8 °C per hour, 0 if unfiltered) */
+    int16_t temperature_curvature;        /**> Slope rate of change (Q8 °C per hour, per minute)            */
+    int16_t current_ma;                   /**> Last instantaneous current reading (milliamps)               */
+    int16_t current_rms;                  /**> Last RMS current reading (milliamps)                         */
+    wall_clock_t clock;                   /**> Local time, synchronized by the host                         */
+    uint16_t time_of_day;                 /**> Local time (minutes since midnight) as of time_of_day_second */
+    uint32_t time_of_day_second;          /**> MCU second time_of_day was computed at                       */
+    bool time_of_day_stale;               /**> time_of_day needs to be computed again (sync, restore)       */
+} pipeline_t;
+
+/**
+ * @brief initializes the pipeline and the application state (@see app_init())
+ * @param[out] pipeline   : pipeline to be initialized
+ * @param[in]  sensors    : sensors front-end configuration, referenced (not copied)
+ * @param[in]  thermistor : NTC characteristic curve, referenced (not copied)
+ */
+void pipeline_init(pipeline_t *const pipeline, sensors_config_t const *const sensors, thermistor_data_t const *const thermistor);
+
+/**
+ * @brief converts a raw NTC bridge reading and runs it through the temperature filter, the temperature, its slope and curvature are used by
+ * the next steps.
+ * The filter assumes the readings are taken at the pace asked by pipeline_temperature_period_ms().
+ */
+void pipeline_sample_temperature(pipeline_t *const pipeline, const uint16_t raw);
+
+/**
+ * @brief time until the next temperature reading, chosen by the sampling policy after every reading.
+ * The caller is expected to sample the temperature at that pace : readings are assumed to be that far apart.
+ * @return period (milliseconds), a multiple of the filter sample period (kalman_params_t::sample_period_ms)
+ */
+uint32_t pipeline_temperature_period_ms(pipeline_t const *const pipeline);
+
+/**
+ * @brief converts a raw current sense reading and pushes it to the RMS sliding window
+ */
+void pipeline_sample_current(pipeline_t *const pipeline, const uint16_t raw);
+
+/**
+ * @brief feeds the buttons debouncers with their current levels, and the gestures recognizer with their edges : the gestures
+ * are handled by the next step. Needs to be called whenever a level changes, and at the deadline given by pipeline_buttons_deadline().
+ * @param[in] levels : PIPELINE_BUTTON_* bits set for the buttons read HIGH (released, buttons are active low)
+ * @param[in] time   : reading time
+ */
+void pipeline_sample_buttons(pipeline_t *const pipeline, const uint8_t levels, mcu_time_t const *const time);
+
+/**
+ * @brief earliest time the buttons need to be read again even though their levels did not change (debouncing, gestures timers)
+ * @param[out] deadline : earliest deadline, left untouched if none is pending
+ * @return false if the buttons only need to be read on level changes
+ */
+bool pipeline_buttons_deadline(pipeline_t const *const pipeline, mcu_time_t *const deadline);
+
+/**
+ * @brief applies a wall clock synchronization received from the host (@see wall_clock.h)
+ * @param[in] time   : MCU time the synchronization was received at
+ * @param[in] wall_s : local time (seconds since the epoch)
+ */
+void pipeline_sync_clock(pipeline_t *const pipeline, mcu_time_t const *const time, const uint32_t wall_s);
+
+/**
+ * @brief runs the application state machine with the latest readings (@see app_step())
+ */
+void pipeline_step(pipeline_t *const pipeline, mcu_time_t const *const time, app_outputs_t *const outputs);
+
+/**
+ * @brief serializes the pipeline state (application, buttons, RMS window and readings) in a portable way
+ * (fixed little endian layout, independent of the compiler structures layout)
+ * @param[out] out : PIPELINE_SNAPSHOT_SIZE bytes
+ */
+void pipeline_snapshot_write(pipeline_t const *const pipeline, uint8_t *const out);
+
+/**
+ * @brief restores a state serialized by pipeline_snapshot_write(). Sensors and thermistor are left untouched.
+ * @param[in] in : PIPELINE_SNAPSHOT_SIZE bytes
+ * @return false if the snapshot holds out of range values (pipeline is left untouched)
+ */
+bool pipeline_snapshot_read(pipeline_t *const pipeline, uint8_t const *const in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIPELINE_HEADER */
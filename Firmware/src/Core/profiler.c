@@ -0,0 +1,94 @@
+#include "profiler.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static profiler_clock_t profiler_clock = NULL;
+static profiler_histogram_t histograms[PROFILER_STAGE_COUNT];
+
+static const char *const stage_names[PROFILER_STAGE_COUNT] = {
+    "loop", "timebase", "led", "current", "temperature", "buttons", "eeprom", "logging",
+};
+
+void profiler_init(profiler_clock_t clock)
+{
+    profiler_clock = clock;
+    profiler_reset();
+}
+
+void profiler_reset(void)
+{
+    memset(histograms, 0, sizeof(histograms));
+}
+
+void profiler_enter(const profiler_stage_t stage)
+{
+    if ((NULL == profiler_clock) || (stage >= PROFILER_STAGE_COUNT))
+    {
+        return;
+    }
+    histograms[stage].entered = profiler_clock();
+}
+
+void profiler_exit(const profiler_stage_t stage)
+{
+    if ((NULL == profiler_clock) || (stage >= PROFILER_STAGE_COUNT))
+    {
+        return;
+    }
+
+    // Unsigned arithmetic handles the clock wrapping around
+    const uint32_t cycles = profiler_clock() - histograms[stage].entered;
+    profiler_record(stage, cycles);
+}
+
+void profiler_record(const profiler_stage_t stage, const uint32_t cycles)
+{
+    if (stage >= PROFILER_STAGE_COUNT)
+    {
+        return;
+    }
+
+    profiler_histogram_t *const histogram = &histograms[stage];
+    const uint8_t index = profiler_bucket_index(cycles);
+    if (histogram->buckets[index] < UINT16_MAX)
+    {
+        histogram->buckets[index]++;
+    }
+
+    if (cycles > histogram->max)
+    {
+        histogram->max = cycles;
+    }
+}
+
+uint8_t profiler_bucket_index(const uint32_t cycles)
+{
+    // Index is the position of the most significant bit, plus one (0 stays in bucket 0)
+    uint8_t index = 0;
+    uint32_t remaining = cycles;
+    while ((remaining != 0) && (index < (PROFILER_BUCKET_COUNT - 1U)))
+    {
+        remaining >>= 1U;
+        index++;
+    }
+    return index;
+}
+
+profiler_histogram_t const *profiler_get_histogram(const profiler_stage_t stage)
+{
+    if (stage >= PROFILER_STAGE_COUNT)
+    {
+        return NULL;
+    }
+    return &histograms[stage];
+}
+
+const char *profiler_stage_name(const profiler_stage_t stage)
+{
+    if (stage >= PROFILER_STAGE_COUNT)
+    {
+        return "unknown";
+    }
+    return stage_names[stage];
+}
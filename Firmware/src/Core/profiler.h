@@ -0,0 +1,107 @@
+#ifndef PROFILER_HEADER
+#define PROFILER_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Lightweight hot path profiler.
+ * Stages are timestamped on entry and exit using a free running clock (e.g. a hardware timer counting cpu cycles),
+ * elapsed cycles are accumulated in log2 buckets : bucket 0 counts durations of 0 cycles, bucket N counts durations within [2^(N-1), 2^N[.
+ * Last bucket gathers all the remaining (longer) durations.
+ * Instrumentation macros compile out to nothing unless PROFILER_ENABLED is set to 1.
+ */
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
+
+#ifndef PROFILER_BUCKET_COUNT
+#define PROFILER_BUCKET_COUNT 20U /**> 20 buckets covers up to 2^19 cycles (~32ms @16MHz), longer durations end up in the last bucket */
+#endif
+
+// clang-format off
+#if PROFILER_ENABLED == 1
+    #define PROFILER_ENTER(stage) profiler_enter(stage)
+    #define PROFILER_EXIT(stage) profiler_exit(stage)
+#else
+    #define PROFILER_ENTER(stage)
+    #define PROFILER_EXIT(stage)
+#endif
+// clang-format on
+
+typedef enum
+{
+    PROFILER_STAGE_LOOP,        /**> Whole loop() iteration      */
+    PROFILER_STAGE_TIMEBASE,    /**> timebase_process()          */
+    PROFILER_STAGE_LED,         /**> led_process()               */
+    PROFILER_STAGE_CURRENT,     /**> read_current()              */
+    PROFILER_STAGE_TEMPERATURE, /**> read_temperature()          */
+    PROFILER_STAGE_BUTTONS,     /**> read_buttons()              */
+    PROFILER_STAGE_EEPROM,      /**> EEPROM writes               */
+    PROFILER_STAGE_LOGGING,     /**> Serial logging              */
+    PROFILER_STAGE_COUNT        /**> Number of stages            */
+} profiler_stage_t;
+
+/**
+ * @brief free running clock used to timestamp stages (wraps around UINT32_MAX)
+ */
+typedef uint32_t (*profiler_clock_t)(void);
+
+typedef struct
+{
+    uint16_t buckets[PROFILER_BUCKET_COUNT]; /**> Log2 histogram of stage durations (saturating counters)   */
+    uint32_t max;                            /**> Longest duration ever recorded (cycles)                   */
+    uint32_t entered;                        /**> Timestamp of the last stage entry                         */
+} profiler_histogram_t;
+
+/**
+ * @brief registers the profiler clock and clears out all histograms.
+ * @param[in] clock : free running clock, profiling is disabled if NULL
+ */
+void profiler_init(profiler_clock_t clock);
+
+/**
+ * @brief clears out all histograms
+ */
+void profiler_reset(void);
+
+/**
+ * @brief timestamps the entry of a stage
+ */
+void profiler_enter(const profiler_stage_t stage);
+
+/**
+ * @brief timestamps the exit of a stage and records its duration
+ */
+void profiler_exit(const profiler_stage_t stage);
+
+/**
+ * @brief records a duration directly in the stage histogram
+ */
+void profiler_record(const profiler_stage_t stage, const uint32_t cycles);
+
+/**
+ * @brief computes the log2 bucket index of a duration
+ * @return bucket index, ranging from 0 to PROFILER_BUCKET_COUNT - 1
+ */
+uint8_t profiler_bucket_index(const uint32_t cycles);
+
+/**
+ * @brief gives read access to a single stage histogram
+ * @return stage histogram, NULL if stage is out of range
+ */
+profiler_histogram_t const *profiler_get_histogram(const profiler_stage_t stage);
+
+/**
+ * @brief human readable name of a stage (used to dump histograms)
+ */
+const char *profiler_stage_name(const profiler_stage_t stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_HEADER */
@@ -0,0 +1,40 @@
+#include "sampling.h"
+
+#define SECONDS_PER_HOUR 3600L
+#define MS_PER_SECOND 1000UL
+#define REACH_MAX_S 0xFFFFUL /**> Keeps the periods computation within 32 bits, way above any useful period */
+
+static int32_t magnitude(const int16_t value)
+{
+    return (value < 0) ? -(int32_t)value : (int32_t)value;
+}
+
+void sampling_params_default(sampling_params_t *const params)
+{
+    params->max_period = SAMPLING_MAX_PERIOD;
+    params->edge_margin = SAMPLING_EDGE_MARGIN;
+    params->slope_guard = SAMPLING_SLOPE_GUARD;
+    params->fast_curvature = SAMPLING_FAST_CURVATURE;
+}
+
+uint8_t sampling_next_period(sampling_params_t const *const params, const int16_t distance, const int16_t slope, const int16_t curvature,
+                             const uint16_t period_ms)
+{
+    if ((params->max_period <= 1U) || (distance <= params->edge_margin) || (magnitude(curvature) >= params->fast_curvature))
+    {
+        return 1U;
+    }
+
+    // Time the temperature needs to get within the margin at the current slope, plus the guard
+    const int32_t speed = magnitude(slope) + params->slope_guard;
+    uint32_t reach_s = (uint32_t)(((int32_t)distance - params->edge_margin) * SECONDS_PER_HOUR) / (uint32_t)((speed < 1) ? 1 : speed);
+    reach_s = (reach_s > REACH_MAX_S) ? REACH_MAX_S : reach_s;
+    const uint32_t periods = (reach_s * MS_PER_SECOND) / ((period_ms == 0U) ? 1U : period_ms);
+
+    uint8_t period = 1U;
+    while (((uint16_t)period * 2U <= params->max_period) && ((uint32_t)period * 2U <= periods))
+    {
+        period = (uint8_t)(period * 2U);
+    }
+    return period;
+}
@@ -0,0 +1,65 @@
+#ifndef SAMPLING_HEADER
+#define SAMPLING_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Adaptive temperature sampling period.
+ * The cabinet temperature moves by a few degrees per hour : once a second is only needed close to a switching threshold,
+ * or while the temperature changes fast. Elsewhere, the next reading is pushed back as long as the temperature can't get
+ * within the edge margin of the threshold before it, assuming it keeps drifting at the current slope plus a guard :
+ *      period <= (distance - margin) / (|slope| + guard)
+ * Periods are powers of two of the base period, so that the filter (@see kalman.h) predicts over whole base periods.
+ */
+
+// clang-format off
+#ifndef SAMPLING_MAX_PERIOD
+#define SAMPLING_MAX_PERIOD 4U                  /**> Longest period, in base periods (power of two)                                   */
+#endif
+#ifndef SAMPLING_EDGE_MARGIN
+#define SAMPLING_EDGE_MARGIN (256 / 2)          /**> Readings closer than that to the threshold are taken every base period (Q8 °C)  */
+#endif
+#ifndef SAMPLING_SLOPE_GUARD
+#define SAMPLING_SLOPE_GUARD (30 * 256)         /**> Added to the slope magnitude, covers a sudden change (Q8 °C per hour)            */
+#endif
+#ifndef SAMPLING_FAST_CURVATURE
+#define SAMPLING_FAST_CURVATURE (3 * 256)       /**> Slope changing faster than that is sampled every base period (Q8 °C/h per minute) */
+#endif
+// clang-format on
+
+/**
+ * @brief sampling policy tuning (default to the compile time constants above)
+ */
+typedef struct
+{
+    uint8_t max_period;      /**> Longest period (base periods, power of two, 1 : fixed rate)  */
+    int16_t edge_margin;     /**> Distance to the threshold sampled at full rate (Q8 °C)        */
+    int16_t slope_guard;     /**> Added to the slope magnitude (Q8 °C per hour)                 */
+    int16_t fast_curvature;  /**> Curvature sampled at full rate (Q8 °C per hour, per minute)   */
+} sampling_params_t;
+
+/**
+ * @brief fills the tuning with the compile time defaults
+ */
+void sampling_params_default(sampling_params_t *const params);
+
+/**
+ * @brief computes the time until the next reading
+ * @param[in] distance    : how far the temperature is from the next switching threshold (Q8 °C, negative past it)
+ * @param[in] slope       : temperature slope (Q8 °C per hour)
+ * @param[in] curvature   : slope rate of change (Q8 °C per hour, per minute)
+ * @param[in] period_ms   : base period (milliseconds)
+ * @return period, in base periods : 1 up to max_period
+ */
+uint8_t sampling_next_period(sampling_params_t const *const params, const int16_t distance, const int16_t slope, const int16_t curvature,
+                             const uint16_t period_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAMPLING_HEADER */
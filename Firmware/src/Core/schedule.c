@@ -0,0 +1,60 @@
+#include "schedule.h"
+
+void schedule_params_default(schedule_params_t *const params)
+{
+    params->peak_start_minute = SCHEDULE_PEAK_START_MINUTE;
+    params->peak_end_minute = SCHEDULE_PEAK_END_MINUTE;
+    params->precool_minutes = SCHEDULE_PRECOOL_MINUTES;
+    params->precool_offset = SCHEDULE_PRECOOL_OFFSET;
+    params->peak_band_extra = SCHEDULE_PEAK_BAND_EXTRA;
+    params->min_temperature = SCHEDULE_MIN_TEMPERATURE;
+    params->max_temperature = SCHEDULE_MAX_TEMPERATURE;
+}
+
+// Minutes from "from" to "to", going forward across midnight if needed
+static uint16_t minutes_until(const uint16_t from, const uint16_t to)
+{
+    return (uint16_t)((to + SCHEDULE_MINUTES_PER_DAY - from) % SCHEDULE_MINUTES_PER_DAY);
+}
+
+schedule_phase_t schedule_phase(schedule_params_t const *const params, const uint16_t minute)
+{
+    if ((params->peak_start_minute == params->peak_end_minute) || (minute >= SCHEDULE_MINUTES_PER_DAY))
+    {
+        return SCHEDULE_NONE;
+    }
+
+    const uint16_t peak_length = minutes_until(params->peak_start_minute, params->peak_end_minute);
+    const uint16_t since_start = minutes_until(params->peak_start_minute, minute);
+    if (since_start < peak_length)
+    {
+        return SCHEDULE_PEAK;
+    }
+
+    // Pre-cooling never overlaps the previous peak hours
+    const uint16_t until_start = minutes_until(minute, params->peak_start_minute);
+    const uint16_t off_peak_length = (uint16_t)(SCHEDULE_MINUTES_PER_DAY - peak_length);
+    const uint16_t precool = (params->precool_minutes > off_peak_length) ? off_peak_length : params->precool_minutes;
+    return (until_start <= precool) ? SCHEDULE_PRECOOL : SCHEDULE_NONE;
+}
+
+void schedule_apply(schedule_params_t const *const params, const schedule_phase_t phase, const int8_t target, int8_t *const setpoint,
+                    uint8_t *const high, const uint8_t low)
+{
+    *setpoint = target;
+
+    if (SCHEDULE_PRECOOL == phase)
+    {
+        // Whole band moves down, until its stop threshold reaches the limit
+        const int16_t room = (int16_t)target - (int16_t)low - params->min_temperature;
+        const int16_t offset = (room <= 0) ? 0 : ((room < params->precool_offset) ? room : params->precool_offset);
+        *setpoint = (int8_t)(target - offset);
+    }
+    else if (SCHEDULE_PEAK == phase)
+    {
+        // Upper band only grows, until its start threshold reaches the limit
+        const int16_t room = (int16_t)params->max_temperature - (int16_t)target - (int16_t)*high;
+        const int16_t extra = (room <= 0) ? 0 : ((room < params->peak_band_extra) ? room : params->peak_band_extra);
+        *high = (uint8_t)(*high + extra);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef SCHEDULE_HEADER
+#define SCHEDULE_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Time of day control schedule, for electricity tariffs with peak hours.
+ * The cabinet contents store cold : the set point is lowered for a while before the peak hours (pre-cooling), and the upper band
+ * is widened during them, so that the compressor runs as little as possible while electricity is expensive.
+ * Both stay within safety limits : the pre-cooling never brings the stop threshold below SCHEDULE_MIN_TEMPERATURE (no frozen food),
+ * and the widened band never brings the start threshold above SCHEDULE_MAX_TEMPERATURE (food safety).
+ * Regular settings already beyond those limits are left untouched.
+ */
+
+// clang-format off
+#ifndef SCHEDULE_PEAK_START_MINUTE
+#define SCHEDULE_PEAK_START_MINUTE (17U * 60U)  /**> Peak hours start (minutes since midnight, local time)                          */
+#endif
+#ifndef SCHEDULE_PEAK_END_MINUTE
+#define SCHEDULE_PEAK_END_MINUTE (21U * 60U)    /**> Peak hours end (minutes since midnight, can be before the start : spans midnight) */
+#endif
+#ifndef SCHEDULE_PRECOOL_MINUTES
+#define SCHEDULE_PRECOOL_MINUTES 120U           /**> Pre-cooling duration, right before the peak hours (minutes)                      */
+#endif
+#ifndef SCHEDULE_PRECOOL_OFFSET
+#define SCHEDULE_PRECOOL_OFFSET 2U              /**> Set point is lowered by that much while pre-cooling (°C)                         */
+#endif
+#ifndef SCHEDULE_PEAK_BAND_EXTRA
+#define SCHEDULE_PEAK_BAND_EXTRA 2U             /**> Upper band is widened by that much during the peak hours (°C)                    */
+#endif
+#ifndef SCHEDULE_MIN_TEMPERATURE
+#define SCHEDULE_MIN_TEMPERATURE 1              /**> Lowest stop threshold (set point - low band) pre-cooling can go to (°C)          */
+#endif
+#ifndef SCHEDULE_MAX_TEMPERATURE
+#define SCHEDULE_MAX_TEMPERATURE 8              /**> Highest start threshold (set point + high band) the peak hours can go to (°C)    */
+#endif
+#define SCHEDULE_MINUTES_PER_DAY 1440U
+// clang-format on
+
+/**
+ * @brief schedule phases
+ */
+typedef enum
+{
+    SCHEDULE_NONE,    /**> Regular operation (off-peak hours, or no wall clock)  */
+    SCHEDULE_PRECOOL, /**> Right before the peak hours : lower set point          */
+    SCHEDULE_PEAK     /**> Peak hours : wider upper band                         */
+} schedule_phase_t;
+
+/**
+ * @brief schedule tuning (default to the compile time constants above)
+ */
+typedef struct
+{
+    uint16_t peak_start_minute; /**> Peak hours start (minutes since midnight, equal to the end : no peak hours) */
+    uint16_t peak_end_minute;   /**> Peak hours end (minutes since midnight)                                    */
+    uint16_t precool_minutes;   /**> Pre-cooling duration (minutes)                                             */
+    uint8_t precool_offset;     /**> Set point offset while pre-cooling (°C)                                    */
+    uint8_t peak_band_extra;    /**> Upper band extension during the peak hours (°C)                            */
+    int8_t min_temperature;     /**> Lowest pre-cooling stop threshold (°C)                                     */
+    int8_t max_temperature;     /**> Highest peak hours start threshold (°C)                                    */
+} schedule_params_t;
+
+/**
+ * @brief fills the tuning with the compile time defaults
+ */
+void schedule_params_default(schedule_params_t *const params);
+
+/**
+ * @brief schedule phase at a given time of day
+ * @param[in] minute : minutes since midnight (local time)
+ */
+schedule_phase_t schedule_phase(schedule_params_t const *const params, const uint16_t minute);
+
+/**
+ * @brief applies a schedule phase to the regular hysteresis, within the safety limits
+ * @param[in]     target   : user target temperature (°C)
+ * @param[out]    setpoint : temperature the hysteresis is centered on (°C)
+ * @param[in/out] high     : upper band (°C)
+ * @param[in]     low      : lower band (°C)
+ */
+void schedule_apply(schedule_params_t const *const params, const schedule_phase_t phase, const int8_t target, int8_t *const setpoint,
+                    uint8_t *const high, const uint8_t low);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDULE_HEADER */
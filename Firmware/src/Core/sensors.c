@@ -0,0 +1,35 @@
+#include "sensors.h"
+#include "bridge.h"
+#include "current.h"
+
+uint16_t sensors_adc_to_mv(sensors_config_t const *const config, const uint16_t raw)
+{
+    return (uint16_t)((((config->vcc_mv * 10U) / SENSORS_ADC_RESOLUTION) * raw) / 10U);
+}
+
+int8_t sensors_temperature_from_adc(sensors_config_t const *const config, thermistor_data_t const *const thermistor, const uint16_t raw)
+{
+    uint16_t reading_mv = sensors_adc_to_mv(config, raw);
+    uint16_t ntc_resistance = 0;
+    bridge_get_lower_resistance(&config->upper_resistance, &reading_mv, &config->vcc_mv, &ntc_resistance);
+
+    return thermistor_read_temperature(thermistor, &ntc_resistance);
+}
+
+int16_t sensors_temperature_q8_from_adc(sensors_config_t const *const config, thermistor_data_t const *const thermistor, const uint16_t raw)
+{
+    uint16_t reading_mv = sensors_adc_to_mv(config, raw);
+    uint16_t ntc_resistance = 0;
+    bridge_get_lower_resistance(&config->upper_resistance, &reading_mv, &config->vcc_mv, &ntc_resistance);
+
+    return thermistor_read_temperature_q8(thermistor, &ntc_resistance);
+}
+
+int16_t sensors_current_from_adc(sensors_config_t const *const config, const uint16_t raw)
+{
+    // Remove the DC part of the read current, as the opamp output is still polarized to vcc_mv/2
+    int16_t reading_mv = (int16_t)sensors_adc_to_mv(config, raw) - config->current_dc_bias_mv;
+    int16_t current_ma = 0;
+    current_from_voltage(&reading_mv, &current_ma);
+    return current_ma;
+}
@@ -0,0 +1,62 @@
+#ifndef SENSORS_HEADER
+#define SENSORS_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#include "thermistor.h"
+
+#define SENSORS_ADC_RESOLUTION 1024U /**> 10 bits ADC */
+
+/**
+ * @brief electrical setup of the sensors front-end (board dependent)
+ */
+typedef struct
+{
+    uint16_t vcc_mv;             /**> ADC reference and resistor bridge supply voltage (millivolts)                 */
+    uint16_t upper_resistance;   /**> Upper resistor of the NTC bridge (same unit as the thermistor curve)          */
+    int16_t current_dc_bias_mv;  /**> DC bias of the current sense amplifier output, removed before conversion (mV) */
+} sensors_config_t;
+
+/**
+ * @brief converts a raw ADC reading into millivolts.
+ * Uses a x10 scale to lower aliasing while remaining right under the overflow (5000 x 10 < UINT16_MAX)
+ * @param[in] config : sensors front-end configuration
+ * @param[in] raw    : raw ADC reading
+ * @return voltage in millivolts
+ */
+uint16_t sensors_adc_to_mv(sensors_config_t const *const config, const uint16_t raw);
+
+/**
+ * @brief temperature pipeline : raw ADC reading -> bridge voltage -> NTC resistance -> temperature
+ * @param[in] config     : sensors front-end configuration
+ * @param[in] thermistor : NTC characteristic curve
+ * @param[in] raw        : raw ADC reading of the NTC bridge
+ * @return temperature in °C (clamped to the thermistor curve boundaries)
+ */
+int8_t sensors_temperature_from_adc(sensors_config_t const *const config, thermistor_data_t const *const thermistor, const uint16_t raw);
+
+/**
+ * @brief same as sensors_temperature_from_adc(), with a finer resolution (@see thermistor_read_temperature_q8())
+ * @return temperature in Q8 fixed point °C (1°C = 256, clamped to the thermistor curve boundaries)
+ */
+int16_t sensors_temperature_q8_from_adc(sensors_config_t const *const config, thermistor_data_t const *const thermistor, const uint16_t raw);
+
+/**
+ * @brief current pipeline : raw ADC reading -> amplifier voltage (DC bias removed) -> instantaneous current.
+ * Result is meant to be fed to current_compute_rms_sine().
+ * @param[in] config : sensors front-end configuration
+ * @param[in] raw    : raw ADC reading of the current sense amplifier
+ * @return instantaneous current in milliamperes
+ */
+int16_t sensors_current_from_adc(sensors_config_t const *const config, const uint16_t raw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSORS_HEADER */
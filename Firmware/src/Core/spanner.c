@@ -122,4 +122,69 @@ static inline void span_even(const span_data_t * data, uint8_t *sequence, const
 
         index++;
     }
-}
\ No newline at end of file
+}
+
+uint8_t span_next(const span_data_t * data, uint16_t *error)
+{
+    const uint16_t length = (uint16_t)data->a_cnt + data->b_cnt;
+    if(length == 0U)
+    {
+        return data->a_val;
+    }
+
+    // Bresenham : B values are output each time the accumulated B share crosses the length
+    uint16_t accumulator = *error + data->b_cnt;
+    uint8_t value = data->a_val;
+    if(accumulator >= length)
+    {
+        accumulator -= length;
+        value = data->b_val;
+    }
+    *error = accumulator;
+    return value;
+}
+
+bool span_stream_init(span_stream_t *stream, const uint8_t *values, const uint8_t *counts, const uint8_t level_count)
+{
+    if((level_count == 0U) || (level_count > SPAN_STREAM_MAX_LEVELS))
+    {
+        return false;
+    }
+
+    uint16_t length = 0;
+    for(uint8_t i = 0 ; i < level_count ; i++)
+    {
+        length += counts[i];
+    }
+    if((length == 0U) || (length > UINT8_MAX))
+    {
+        return false;
+    }
+
+    stream->level_count = level_count;
+    stream->length = (uint8_t)length;
+    for(uint8_t i = 0 ; i < level_count ; i++)
+    {
+        stream->values[i] = values[i];
+        stream->counts[i] = counts[i];
+        stream->credits[i] = 0;
+    }
+    return true;
+}
+
+uint8_t span_stream_next(span_stream_t *stream)
+{
+    // Credits always add up to 0 : the highest one is positive, and stays within the sequence length
+    uint8_t selected = 0;
+    for(uint8_t i = 0 ; i < stream->level_count ; i++)
+    {
+        stream->credits[i] += stream->counts[i];
+        if(stream->credits[i] > stream->credits[selected])
+        {
+            selected = i;
+        }
+    }
+
+    stream->credits[selected] -= stream->length;
+    return stream->values[selected];
+}
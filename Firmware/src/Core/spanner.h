@@ -5,6 +5,7 @@
 extern "C" {
 #endif
 
+#include "stdbool.h"
 #include "stdint.h"
 
 /**
@@ -26,6 +27,23 @@ typedef struct
     span_type_t kind; /**> Desired distribution kind applied to the sequence  */
 } span_data_t;
 
+/**
+ * @brief Streaming spanner state : yields the sequence one value at a time, without materializing it.
+ * Each level accumulates its count as a credit on every call, the level with the highest credit is output and pays back
+ * the sequence length (smooth weighted round robin, Bresenham's error accumulator when there are only 2 levels).
+ * Over every run of `length` consecutive calls, each level is output exactly `count` times, as evenly spread as possible.
+ */
+#define SPAN_STREAM_MAX_LEVELS 4U
+
+typedef struct
+{
+    uint8_t level_count;                      /**> Levels used (1 to SPAN_STREAM_MAX_LEVELS)                    */
+    uint8_t length;                           /**> Sequence length : sum of the counts                          */
+    uint8_t values[SPAN_STREAM_MAX_LEVELS];   /**> Output value of each level                                   */
+    uint8_t counts[SPAN_STREAM_MAX_LEVELS];   /**> Desired count of each level in the sequence                  */
+    int16_t credits[SPAN_STREAM_MAX_LEVELS];  /**> Error accumulators                                           */
+} span_stream_t;
+
 /**
  * @brief distributes 2 values (A and B) across the whole length of the given sequence.
  * @param[in] data      : constant input data for spanner algorithm
@@ -34,6 +52,29 @@ typedef struct
  */
 void span(const span_data_t * data, uint8_t *sequence, const uint8_t length);
 
+/**
+ * @brief yields the next value of an evenly spread A/B sequence, from a single accumulator (kind is ignored).
+ * Every a_cnt + b_cnt calls output exactly a_cnt A values and b_cnt B values.
+ * @param[in]     data  : A and B values and counts
+ * @param[in,out] error : error accumulator, start with 0 (stays below a_cnt + b_cnt, up to 510)
+ * @return next value of the sequence
+ */
+uint8_t span_next(const span_data_t * data, uint16_t *error);
+
+/**
+ * @brief starts a streaming sequence of several levels
+ * @param[in] values      : output value of each level
+ * @param[in] counts      : desired count of each level in the sequence
+ * @param[in] level_count : number of levels (1 to SPAN_STREAM_MAX_LEVELS)
+ * @return false (and the stream is left untouched) if there are too many levels or if the counts don't add up to 1 - 255
+ */
+bool span_stream_init(span_stream_t *stream, const uint8_t *values, const uint8_t *counts, const uint8_t level_count);
+
+/**
+ * @brief yields the next value of a streaming sequence
+ */
+uint8_t span_stream_next(span_stream_t *stream);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,66 @@
+#include "thermal_learner.h"
+
+#define SECONDS_PER_HOUR 3600UL
+#define Q8_ONE 256L
+#define DELTA_MAX 255U /**> Keeps the rate computation within 32 bits, way above any real temperature change */
+
+uint16_t thermal_rate_measure(const int16_t delta_c, const uint32_t duration_s)
+{
+    if (duration_s == 0U)
+    {
+        return THERMAL_RATE_UNKNOWN;
+    }
+
+    uint32_t delta = (uint32_t)((delta_c < 0) ? -delta_c : delta_c);
+    if (delta > DELTA_MAX)
+    {
+        delta = DELTA_MAX;
+    }
+    const uint32_t rate = (delta * Q8_ONE * SECONDS_PER_HOUR) / duration_s;
+    return (uint16_t)((rate > THERMAL_RATE_MAX) ? THERMAL_RATE_MAX : rate);
+}
+
+void thermal_rate_learn(uint16_t *const rate, const uint16_t sample)
+{
+    if (*rate == THERMAL_RATE_UNKNOWN)
+    {
+        *rate = sample;
+        return;
+    }
+
+    const int32_t delta = (int32_t)sample - (int32_t)*rate;
+    int32_t learnt = (int32_t)*rate + delta / (1L << THERMAL_RATE_FILTER_SHIFT);
+
+    // Keeps learnt rates away from the unknown value
+    if (learnt < 1)
+    {
+        learnt = 1;
+    }
+    *rate = (uint16_t)learnt;
+}
+
+uint8_t thermal_band_for_cycle(const uint16_t warming_rate, const uint16_t cooling_rate, const uint32_t cycle_s, const uint8_t min_band,
+                               const uint8_t max_band)
+{
+    if ((warming_rate == THERMAL_RATE_UNKNOWN) || (cooling_rate == THERMAL_RATE_UNKNOWN))
+    {
+        return min_band;
+    }
+
+    // Both rates are below 2^16 : their product fits in 32 bits
+    const uint32_t combined_rate = ((uint32_t)warming_rate * cooling_rate) / ((uint32_t)warming_rate + cooling_rate);
+    const uint32_t span = (combined_rate * (cycle_s / 60U)) / 60U; // Q8 °C, minutes resolution keeps it within 32 bits
+
+    // span = 2 x band + 2°C (@see thermal_band_for_cycle() documentation), rounded to the closest band
+    const int32_t band = ((int32_t)span - 2L * Q8_ONE + Q8_ONE) / (2L * Q8_ONE);
+
+    if (band < (int32_t)min_band)
+    {
+        return min_band;
+    }
+    if (band > (int32_t)max_band)
+    {
+        return max_band;
+    }
+    return (uint8_t)band;
+}
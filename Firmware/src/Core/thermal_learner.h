@@ -0,0 +1,58 @@
+#ifndef THERMAL_LEARNER_HEADER
+#define THERMAL_LEARNER_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Online estimation of the cabinet warm-up and cool-down rates, and hysteresis bands derived from them.
+ * Rates are measured in between two compressor switches (crossing to crossing) and smoothed with an exponential moving average,
+ * so that the fridge load (full or empty) and the season (ambient temperature) are tracked over a few days.
+ * With a warm-up rate w and a cool-down rate c, a temperature span S gives a cycle length of S / w + S / c :
+ * the span needed to reach a given cycle length is cycle x w x c / (w + c).
+ */
+
+#ifndef THERMAL_RATE_FILTER_SHIFT
+#define THERMAL_RATE_FILTER_SHIFT 3U /**> Rates moving average weight : each new cycle counts for 1 / 2^shift               */
+#endif
+
+#define THERMAL_RATE_UNKNOWN 0U      /**> Rate value used before the first measurement                                        */
+#define THERMAL_RATE_MAX 0xFFFFU     /**> Highest rate (Q8 °C per hour, ~256°C/h), measurements are clamped to it             */
+
+/**
+ * @brief measures a rate in between two switches
+ * @param[in] delta_c    : temperature change (°C, absolute value is used)
+ * @param[in] duration_s : time elapsed in between both switches (seconds)
+ * @return rate (Q8 °C per hour), THERMAL_RATE_UNKNOWN if the duration is 0
+ */
+uint16_t thermal_rate_measure(const int16_t delta_c, const uint32_t duration_s);
+
+/**
+ * @brief folds a new measurement in a learnt rate (moving average, the first measurement is taken as is)
+ * @param[in/out] rate   : learnt rate (Q8 °C per hour)
+ * @param[in]     sample : new measurement (Q8 °C per hour)
+ */
+void thermal_rate_learn(uint16_t *const rate, const uint16_t sample);
+
+/**
+ * @brief computes the hysteresis band (above and below the target) that gives the requested cycle length.
+ * Temperature is read with a 1°C resolution : the compressor starts on the first reading above target + band,
+ * and stops on the first reading below target - band, so the span actually covered is 2 x band + 2°C.
+ * @param[in] warming_rate : learnt warm-up rate, compressor off (Q8 °C per hour)
+ * @param[in] cooling_rate : learnt cool-down rate, compressor on (Q8 °C per hour)
+ * @param[in] cycle_s      : requested cycle length, compressor start to compressor start (seconds)
+ * @param[in] min_band     : lowest band (°C)
+ * @param[in] max_band     : highest band (°C)
+ * @return band (°C), in between min_band and max_band
+ */
+uint8_t thermal_band_for_cycle(const uint16_t warming_rate, const uint16_t cooling_rate, const uint32_t cycle_s, const uint8_t min_band,
+                               const uint8_t max_band);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THERMAL_LEARNER_HEADER */
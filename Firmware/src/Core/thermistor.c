@@ -92,4 +92,23 @@ int8_t thermistor_read_temperature(thermistor_data_t const * const thermistor, u
     // Then linearly interpolate the value within the boundaries
     result = interpolation_linear_uint16_to_int8(resistance, &res_range, &temp_range);
     return result;
-}
\ No newline at end of file
+}
+
+int16_t thermistor_read_temperature_q8(thermistor_data_t const * const thermistor, uint16_t const * const resistance)
+{
+    thermistor_temp_res_t const * low = NULL;
+    thermistor_temp_res_t const * high = NULL;
+
+    interpolation_range_check_t check = thermistor_frame_value(thermistor, resistance, &low, &high);
+    if((check != RANGE_CHECK_INCLUDED) || (low == high) || (low->resistance == high->resistance))
+    {
+        return (int16_t)(low->temperature * 256);
+    }
+
+    // 32 bits arithmetic : (resistance offset x 256) fits easily, no aliasing trick needed here
+    int32_t offset = (int32_t)*resistance - (int32_t)low->resistance;
+    int32_t res_delta = (int32_t)high->resistance - (int32_t)low->resistance;
+    int32_t temp_delta = (int32_t)high->temperature - (int32_t)low->temperature;
+
+    return (int16_t)((int32_t)low->temperature * 256 + (offset * temp_delta * 256) / res_delta);
+}
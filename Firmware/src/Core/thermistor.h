@@ -53,6 +53,14 @@ typedef struct {
 */
 int8_t thermistor_read_temperature(thermistor_data_t const * const thermistor, uint16_t const * const resistance);
 
+/**
+ * @brief same as thermistor_read_temperature(), with a finer resolution : the interpolation is not truncated to the degree.
+ * @param[in] thermistor : thermistor characteristic curve dataset
+ * @param[in] resistance : NTC resistance as calculated from output voltage (resistor bridge with NTC)
+ * @return the interpolated temperature, Q8 fixed point °C (1°C = 256), clamped to the curve boundaries.
+*/
+int16_t thermistor_read_temperature_q8(thermistor_data_t const * const thermistor, uint16_t const * const resistance);
+
 /**
  * @brief finds the enclosing range that contains the input resistance within the thermistor data curve.
  *
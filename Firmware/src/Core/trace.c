@@ -0,0 +1,235 @@
+#include "trace.h"
+
+#define TRACE_TYPE_SHIFT 5U
+#define TRACE_DELTA_MASK 0x1FU
+#define TRACE_SYNC_TAG ((uint8_t)(TRACE_RECORD_SYNC << TRACE_TYPE_SHIFT))
+#define TRACE_VARINT_MAX_SIZE 5U
+
+static uint8_t put_varint(uint8_t *const out, uint32_t value)
+{
+    uint8_t length = 0;
+    while (value >= 0x80U)
+    {
+        out[length++] = (uint8_t)(value | 0x80U);
+        value >>= 7U;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+/**
+ * @return consumed bytes, 0 if the varint is truncated or too long
+ */
+static size_t get_varint(uint8_t const *const data, const size_t size, uint32_t *const value)
+{
+    *value = 0;
+    for (size_t i = 0; (i < size) && (i < TRACE_VARINT_MAX_SIZE); i++)
+    {
+        *value |= (uint32_t)(data[i] & 0x7FU) << (7U * i);
+        if ((data[i] & 0x80U) == 0U)
+        {
+            return i + 1U;
+        }
+    }
+    return 0;
+}
+
+// Zigzag maps small signed differences onto small unsigned values : 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+static uint16_t zigzag_encode(const int16_t value)
+{
+    return (uint16_t)(((uint16_t)value << 1U) ^ (uint16_t)(value >> 15));
+}
+
+static int16_t zigzag_decode(const uint16_t value)
+{
+    return (int16_t)((value >> 1U) ^ (uint16_t)(-(int16_t)(value & 1U)));
+}
+
+static bool is_adc_record(const trace_record_type_t type)
+{
+    return (type == TRACE_RECORD_CURRENT) || (type == TRACE_RECORD_TEMPERATURE);
+}
+
+void trace_encoder_init(trace_encoder_t *const encoder, trace_write_t write, void *context)
+{
+    encoder->write = write;
+    encoder->context = context;
+    time_default(&encoder->time);
+    encoder->adc[TRACE_RECORD_CURRENT] = 0;
+    encoder->adc[TRACE_RECORD_TEMPERATURE] = 0;
+    encoder->synced = false;
+}
+
+void trace_write_sync(trace_encoder_t *const encoder, mcu_time_t const *const time, uint8_t const *const snapshot, const uint16_t size)
+{
+    uint8_t record[TRACE_SYNC_HEADER_SIZE];
+    const uint16_t snapshot_size = (size > TRACE_SNAPSHOT_MAX_SIZE) ? TRACE_SNAPSHOT_MAX_SIZE : size;
+
+    record[0] = TRACE_SYNC_TAG;
+    record[1] = TRACE_SYNC_MAGIC_0;
+    record[2] = TRACE_SYNC_MAGIC_1;
+    record[3] = TRACE_VERSION;
+    record[4] = (uint8_t)time->seconds;
+    record[5] = (uint8_t)(time->seconds >> 8U);
+    record[6] = (uint8_t)(time->seconds >> 16U);
+    record[7] = (uint8_t)(time->seconds >> 24U);
+    record[8] = (uint8_t)time->milliseconds;
+    record[9] = (uint8_t)(time->milliseconds >> 8U);
+    record[10] = (uint8_t)snapshot_size;
+    record[11] = (uint8_t)(snapshot_size >> 8U);
+
+    encoder->time = *time;
+    encoder->adc[TRACE_RECORD_CURRENT] = 0;
+    encoder->adc[TRACE_RECORD_TEMPERATURE] = 0;
+    encoder->synced = true;
+    // Snapshot is written straight from the caller buffer : spares a copy on the (small) MCU stack. Sink lengths fit a byte, hence the chunks
+    encoder->write(record, TRACE_SYNC_HEADER_SIZE, encoder->context);
+    for (uint16_t offset = 0; offset < snapshot_size; offset = (uint16_t)(offset + UINT8_MAX))
+    {
+        const uint16_t left = (uint16_t)(snapshot_size - offset);
+        encoder->write(&snapshot[offset], (uint8_t)((left > UINT8_MAX) ? UINT8_MAX : left), encoder->context);
+    }
+}
+
+void trace_write_record(trace_encoder_t *const encoder, const trace_record_type_t type, mcu_time_t const *const time, const uint32_t value)
+{
+    if (!encoder->synced || (type == TRACE_RECORD_SYNC))
+    {
+        return;
+    }
+
+    uint8_t record[1U + 2U * TRACE_VARINT_MAX_SIZE];
+    uint8_t length = 1U;
+    const uint32_t delta = time_elapsed_ms(&encoder->time, time);
+    if (delta < TRACE_DELTA_VARINT)
+    {
+        record[0] = (uint8_t)((type << TRACE_TYPE_SHIFT) | delta);
+    }
+    else
+    {
+        record[0] = (uint8_t)((type << TRACE_TYPE_SHIFT) | TRACE_DELTA_VARINT);
+        length += put_varint(&record[length], delta);
+    }
+
+    if (is_adc_record(type))
+    {
+        length += put_varint(&record[length], zigzag_encode((int16_t)((uint16_t)value - encoder->adc[type])));
+        encoder->adc[type] = (uint16_t)value;
+    }
+    else
+    {
+        length += put_varint(&record[length], value);
+    }
+
+    // Time is only moved forward by the actual delta, so that a backward time does not corrupt the following records
+    time_add_ms(&encoder->time, delta);
+    encoder->write(record, length, encoder->context);
+}
+
+void trace_decoder_init(trace_decoder_t *const decoder)
+{
+    time_default(&decoder->time);
+    decoder->adc[TRACE_RECORD_CURRENT] = 0;
+    decoder->adc[TRACE_RECORD_TEMPERATURE] = 0;
+    decoder->synced = false;
+}
+
+static size_t decode_sync(trace_decoder_t *const decoder, uint8_t const *const data, const size_t size, trace_record_t *const record)
+{
+    if ((size < TRACE_SYNC_HEADER_SIZE) || (data[1] != TRACE_SYNC_MAGIC_0) || (data[2] != TRACE_SYNC_MAGIC_1) || (data[3] != TRACE_VERSION))
+    {
+        return 0;
+    }
+
+    const uint16_t snapshot_size = (uint16_t)(data[10] | (data[11] << 8U));
+    if ((snapshot_size > TRACE_SNAPSHOT_MAX_SIZE) || (size < (size_t)(TRACE_SYNC_HEADER_SIZE + snapshot_size)))
+    {
+        return 0;
+    }
+
+    record->type = TRACE_RECORD_SYNC;
+    record->time.seconds = (uint32_t)data[4] | ((uint32_t)data[5] << 8U) | ((uint32_t)data[6] << 16U) | ((uint32_t)data[7] << 24U);
+    record->time.milliseconds = (uint16_t)(data[8] | (data[9] << 8U));
+    record->value = 0;
+    record->snapshot = &data[TRACE_SYNC_HEADER_SIZE];
+    record->snapshot_size = snapshot_size;
+
+    if (record->time.milliseconds >= 1000U)
+    {
+        return 0;
+    }
+
+    decoder->time = record->time;
+    decoder->adc[TRACE_RECORD_CURRENT] = 0;
+    decoder->adc[TRACE_RECORD_TEMPERATURE] = 0;
+    decoder->synced = true;
+    return TRACE_SYNC_HEADER_SIZE + snapshot_size;
+}
+
+size_t trace_decode(trace_decoder_t *const decoder, uint8_t const *const data, const size_t size, trace_record_t *const record)
+{
+    if (size == 0U)
+    {
+        return 0;
+    }
+
+    const trace_record_type_t type = (trace_record_type_t)(data[0] >> TRACE_TYPE_SHIFT);
+    if (type == TRACE_RECORD_SYNC)
+    {
+        return ((data[0] & TRACE_DELTA_MASK) == 0U) ? decode_sync(decoder, data, size, record) : 0U;
+    }
+
+    if (!decoder->synced || (type > TRACE_RECORD_CLOCK))
+    {
+        return 0;
+    }
+
+    size_t length = 1U;
+    uint32_t delta = data[0] & TRACE_DELTA_MASK;
+    if (delta == TRACE_DELTA_VARINT)
+    {
+        const size_t consumed = get_varint(&data[length], size - length, &delta);
+        if (consumed == 0U)
+        {
+            return 0;
+        }
+        length += consumed;
+    }
+
+    uint32_t value = 0;
+    const size_t consumed = get_varint(&data[length], size - length, &value);
+    if ((consumed == 0U) || ((value > UINT16_MAX) && (type != TRACE_RECORD_CLOCK)))
+    {
+        return 0;
+    }
+    length += consumed;
+
+    record->type = type;
+    record->snapshot = NULL;
+    record->snapshot_size = 0;
+    if (is_adc_record(type))
+    {
+        record->value = (uint16_t)(decoder->adc[type] + zigzag_decode((uint16_t)value));
+        decoder->adc[type] = (uint16_t)record->value;
+    }
+    else
+    {
+        record->value = value;
+    }
+
+    time_add_ms(&decoder->time, delta);
+    record->time = decoder->time;
+    return length;
+}
+
+size_t trace_find_sync(uint8_t const *const data, const size_t size)
+{
+    for (size_t i = 0; (i + 2U) < size; i++)
+    {
+        if ((data[i] == TRACE_SYNC_TAG) && (data[i + 1U] == TRACE_SYNC_MAGIC_0) && (data[i + 2U] == TRACE_SYNC_MAGIC_1))
+        {
+            return i;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,130 @@
+#ifndef TRACE_HEADER
+#define TRACE_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcu_time.h"
+
+/**
+ * Compact binary trace of everything the pipeline consumes and produces (@see pipeline.h), so that field units can be replayed.
+ * Every record starts with a tag byte : record type (3 upper bits) and time elapsed since the previous record (5 lower bits,
+ * milliseconds, TRACE_DELTA_VARINT means that a varint follows). ADC readings are stored as zigzag varint differences from the
+ * previous reading of the same channel, which fits 1 byte most of the time.
+ * Sync records hold the absolute time and a pipeline snapshot : they reset the differential coding, so that decoding
+ * (and replay) can start from any of them.
+ */
+
+#define TRACE_DELTA_VARINT 0x1FU        /**> Tag delta value meaning that the time delta is stored as a varint after the tag   */
+#define TRACE_SYNC_MAGIC_0 'N'          /**> First magic byte following a sync tag                                             */
+#define TRACE_SYNC_MAGIC_1 'T'          /**> Second magic byte following a sync tag                                            */
+#define TRACE_VERSION 11U               /**> Format version, stored in sync records                                            */
+#define TRACE_SNAPSHOT_MAX_SIZE 512U    /**> Largest snapshot a sync record can hold (bytes)                                   */
+#define TRACE_SYNC_HEADER_SIZE 12U      /**> Sync record size, snapshot excluded : tag, magic, version, time, snapshot size    */
+#define TRACE_RECORD_MAX_SIZE (TRACE_SYNC_HEADER_SIZE + TRACE_SNAPSHOT_MAX_SIZE) /**> Largest record (bytes)                   */
+
+#ifndef TRACE_SYNC_PERIOD_S
+#define TRACE_SYNC_PERIOD_S 60U         /**> How often the firmware emits a sync record (seconds)                              */
+#endif
+
+typedef enum
+{
+    TRACE_RECORD_CURRENT,       /**> Raw current sense ADC reading                                    */
+    TRACE_RECORD_TEMPERATURE,   /**> Raw NTC bridge ADC reading                                       */
+    TRACE_RECORD_BUTTONS,       /**> Buttons levels, as polled (PIPELINE_BUTTON_* bits)               */
+    TRACE_RECORD_MOTOR,         /**> Motor output command (0 / 1), only recorded when it changes      */
+    TRACE_RECORD_EVENTS,        /**> Application events raised by a step (APP_EVENT_* flags)          */
+    TRACE_RECORD_CLOCK,         /**> Wall clock synchronization from the host (local time, seconds)   */
+    TRACE_RECORD_SYNC = 7,      /**> Absolute time and pipeline snapshot                              */
+} trace_record_type_t;
+
+/**
+ * @brief sink of the encoded bytes (serial port, file, ...)
+ */
+typedef void (*trace_write_t)(uint8_t const *data, const uint8_t length, void *context);
+
+/**
+ * @brief encoder state
+ */
+typedef struct
+{
+    trace_write_t write;  /**> Encoded records sink                                          */
+    void *context;        /**> Passed back to the sink                                       */
+    mcu_time_t time;      /**> Time of the last record                                       */
+    uint16_t adc[2];      /**> Last ADC readings (current, temperature), differential coding */
+    bool synced;          /**> Records are dropped until the first sync record               */
+} trace_encoder_t;
+
+/**
+ * @brief decoded record
+ */
+typedef struct
+{
+    trace_record_type_t type;   /**> Record type                                                     */
+    mcu_time_t time;            /**> Absolute record time                                            */
+    uint32_t value;             /**> ADC reading, buttons levels, motor command, events or wall time */
+    uint8_t const *snapshot;    /**> Sync records only : pipeline snapshot (points into the trace)   */
+    uint16_t snapshot_size;     /**> Sync records only : snapshot size (bytes)                       */
+} trace_record_t;
+
+/**
+ * @brief decoder state
+ */
+typedef struct
+{
+    mcu_time_t time;   /**> Time of the last record                   */
+    uint16_t adc[2];   /**> Last ADC readings (current, temperature)  */
+    bool synced;       /**> Set by the first sync record              */
+} trace_decoder_t;
+
+/**
+ * @brief initializes an encoder
+ * @param[in] write   : encoded records sink
+ * @param[in] context : passed back to the sink
+ */
+void trace_encoder_init(trace_encoder_t *const encoder, trace_write_t write, void *context);
+
+/**
+ * @brief writes a sync record : absolute time and pipeline snapshot (truncated to TRACE_SNAPSHOT_MAX_SIZE)
+ */
+void trace_write_sync(trace_encoder_t *const encoder, mcu_time_t const *const time, uint8_t const *const snapshot, const uint16_t size);
+
+/**
+ * @brief writes a sample or output record (anything but a sync record). Dropped until the first sync record.
+ * @param[in] type  : record type
+ * @param[in] time  : record time, shall not go backwards
+ * @param[in] value : ADC reading, buttons levels, motor command, events or wall time
+ */
+void trace_write_record(trace_encoder_t *const encoder, const trace_record_type_t type, mcu_time_t const *const time, const uint32_t value);
+
+/**
+ * @brief initializes a decoder, the first decoded record needs to be a sync one
+ */
+void trace_decoder_init(trace_decoder_t *const decoder);
+
+/**
+ * @brief decodes a single record
+ * @param[in]  data   : encoded bytes, starting at a record boundary
+ * @param[in]  size   : available bytes
+ * @param[out] record : decoded record
+ * @return consumed bytes, 0 if the record is truncated or invalid (decoder is left untouched)
+ */
+size_t trace_decode(trace_decoder_t *const decoder, uint8_t const *const data, const size_t size, trace_record_t *const record);
+
+/**
+ * @brief looks for the next sync record candidate (used to resynchronize on a corrupted stream or a capture started mid-record)
+ * @return offset of the candidate, size if there is none
+ */
+size_t trace_find_sync(uint8_t const *const data, const size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_HEADER */
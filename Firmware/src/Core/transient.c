@@ -0,0 +1,116 @@
+#include "transient.h"
+
+#define MS_PER_MINUTE 60000L
+#define Q8_ONE 256L
+
+void transient_params_default(transient_params_t *const params)
+{
+    params->slope_limit = TRANSIENT_SLOPE_LIMIT;
+    params->curvature_limit = TRANSIENT_CURVATURE_LIMIT;
+    params->recovery_curvature = TRANSIENT_RECOVERY_CURVATURE;
+    params->confirm_s = TRANSIENT_CONFIRM_SECONDS;
+    params->hold_max_s = TRANSIENT_HOLD_MAX_SECONDS;
+    params->hard_limit = TRANSIENT_HARD_LIMIT;
+}
+
+void transient_init(transient_state_t *const state)
+{
+    state->phase = TRANSIENT_NONE;
+    state->start = 0;
+    state->holding = false;
+    state->suppressed = 0;
+    state->avoided = 0;
+    state->released = 0;
+}
+
+void transient_curvature_update(int16_t *const curvature, const int16_t previous_slope, const int16_t slope, const uint16_t period_ms)
+{
+    // Slope change in between two samples, scaled to a change per minute
+    const int32_t samples_per_minute = MS_PER_MINUTE / ((period_ms == 0U) ? 1U : period_ms);
+    int64_t raw = ((int64_t)slope - previous_slope) * samples_per_minute;
+    raw = (raw < INT16_MIN) ? INT16_MIN : ((raw > INT16_MAX) ? INT16_MAX : raw);
+
+    // The slope is a filtered estimate already, but its sample to sample changes are not.
+    // Weighted by the time in between samples, so that the smoothing does not depend on the sampling rate
+    const int32_t time_constant_ms = (int32_t)TRANSIENT_CURVATURE_TIME_CONSTANT_MS;
+    const int32_t weight_ms = ((int32_t)period_ms > time_constant_ms) ? time_constant_ms : (int32_t)period_ms;
+    *curvature = (int16_t)(*curvature + (((int32_t)raw - *curvature) * weight_ms) / time_constant_ms);
+}
+
+static bool is_calm(transient_params_t const *const params, const int16_t slope, const int16_t curvature)
+{
+    return (slope < params->slope_limit) && (curvature < params->curvature_limit);
+}
+
+bool transient_filter_start(transient_params_t const *const params, transient_state_t *const state, const int16_t slope,
+                            const int16_t curvature, const int16_t excess, const bool demand, const uint32_t now)
+{
+    const bool calm = is_calm(params, slope, curvature);
+
+    switch (state->phase)
+    {
+        case TRANSIENT_NONE:
+            if (!calm)
+            {
+                state->phase = TRANSIENT_SPIKE;
+                state->start = now;
+            }
+            break;
+
+        case TRANSIENT_SPIKE:
+            if (curvature <= -params->recovery_curvature)
+            {
+                state->phase = TRANSIENT_RECOVERING;
+            }
+            else if ((now - state->start) >= params->confirm_s)
+            {
+                // Still warming up as fast : that's no spike
+                state->phase = TRANSIENT_SUSTAINED;
+            }
+            break;
+
+        case TRANSIENT_RECOVERING:
+            // Over once the temperature is back below the threshold and settled, or after holding for too long
+            if ((now - state->start) >= params->hold_max_s)
+            {
+                state->phase = TRANSIENT_SUSTAINED;
+            }
+            else if (!demand && calm)
+            {
+                state->phase = TRANSIENT_NONE;
+            }
+            break;
+
+        case TRANSIENT_SUSTAINED:
+        default:
+            if (calm)
+            {
+                state->phase = TRANSIENT_NONE;
+            }
+            break;
+    }
+
+    const bool spike = (TRANSIENT_SPIKE == state->phase) || (TRANSIENT_RECOVERING == state->phase);
+    const bool too_warm = (int32_t)excess >= (int32_t)params->hard_limit * Q8_ONE;
+    const bool hold = demand && spike && !too_warm && ((now - state->start) < params->hold_max_s);
+
+    if (hold && !state->holding)
+    {
+        state->suppressed++;
+    }
+    else if (!hold && state->holding)
+    {
+        // Demand still there : the start goes ahead after all
+        if (demand)
+        {
+            state->released++;
+        }
+        else
+        {
+            state->avoided++;
+        }
+    }
+    state->holding = hold;
+
+    return demand && !hold;
+}
@@ -0,0 +1,119 @@
+#ifndef TRANSIENT_HEADER
+#define TRANSIENT_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Door openings (and other short lived disturbances) detection, from the filtered temperature slope and curvature.
+ * The NTC probe sits in the cabinet air : an open door warms it up within seconds, way faster than the cabinet contents,
+ * and the air cools back down on its own once the door is closed. Starting the compressor on such a spike is a wasted cycle.
+ * A spike is told apart from a real load by its shape :
+ * - it starts abruptly : slope or curvature (slope change rate) above their limits, a food load builds up its slope slowly
+ * - it turns around quickly : strongly negative curvature once the door is closed
+ * Starts are held while a spike is going on, up to a maximum delay and as long as the temperature does not go too far.
+ * A slope that does not turn around within the confirmation delay is a sustained load : the start is released.
+ */
+
+// clang-format off
+#ifndef TRANSIENT_SLOPE_LIMIT
+#define TRANSIENT_SLOPE_LIMIT (20 * 256)        /**> Slope that flags a spike (Q8 °C per hour)                                         */
+#endif
+#ifndef TRANSIENT_CURVATURE_LIMIT
+#define TRANSIENT_CURVATURE_LIMIT (6 * 256)     /**> Curvature that flags a spike (Q8 °C per hour, per minute)                         */
+#endif
+#ifndef TRANSIENT_RECOVERY_CURVATURE
+#define TRANSIENT_RECOVERY_CURVATURE (3 * 256)  /**> Negative curvature that tells the spike is turning around (Q8 °C per hour, per minute) */
+#endif
+#ifndef TRANSIENT_CONFIRM_SECONDS
+#define TRANSIENT_CONFIRM_SECONDS 300U          /**> A spike that did not turn around within that delay is a sustained load (seconds)  */
+#endif
+#ifndef TRANSIENT_HOLD_MAX_SECONDS
+#define TRANSIENT_HOLD_MAX_SECONDS 900U         /**> Longest a spike can hold a start, counted from its beginning (seconds)            */
+#endif
+#ifndef TRANSIENT_HARD_LIMIT
+#define TRANSIENT_HARD_LIMIT 3U                 /**> Starts are never held further than that above the start threshold (°C)           */
+#endif
+#ifndef TRANSIENT_CURVATURE_TIME_CONSTANT_MS
+#define TRANSIENT_CURVATURE_TIME_CONSTANT_MS 8000U /**> Curvature moving average : a new sample counts for its period / time constant  */
+#endif
+// clang-format on
+
+/**
+ * @brief detection phases
+ */
+typedef enum
+{
+    TRANSIENT_NONE,       /**> Nothing going on                                                        */
+    TRANSIENT_SPIKE,      /**> Abrupt warm-up, not turning around yet : starts are held                */
+    TRANSIENT_RECOVERING, /**> Spike turning around : starts are held until it is over                 */
+    TRANSIENT_SUSTAINED   /**> Spike that lasted too long : a real load, starts are no longer held      */
+} transient_phase_t;
+
+/**
+ * @brief detector tuning (default to the compile time constants above)
+ */
+typedef struct
+{
+    int16_t slope_limit;         /**> Slope that flags a spike (Q8 °C per hour)                              */
+    int16_t curvature_limit;     /**> Curvature that flags a spike (Q8 °C per hour, per minute)              */
+    int16_t recovery_curvature;  /**> Negative curvature of a spike turning around (Q8 °C per hour, per minute) */
+    uint16_t confirm_s;          /**> Delay for a spike to turn around (seconds)                             */
+    uint16_t hold_max_s;         /**> Longest a start can be held (seconds)                                  */
+    uint8_t hard_limit;          /**> Highest excess above the start threshold a start can be held at (°C)    */
+} transient_params_t;
+
+/**
+ * @brief detector state
+ */
+typedef struct
+{
+    transient_phase_t phase; /**> Current detection phase                                                    */
+    uint32_t start;          /**> Time the current spike was flagged (seconds)                           */
+    bool holding;            /**> A start is being held                                                  */
+    uint16_t suppressed;     /**> Starts held so far                                                     */
+    uint16_t avoided;        /**> Held starts that were no longer needed once the spike was over          */
+    uint16_t released;       /**> Held starts that eventually happened (sustained load, hard limit, delay) */
+} transient_state_t;
+
+/**
+ * @brief fills the tuning with the compile time defaults
+ */
+void transient_params_default(transient_params_t *const params);
+
+/**
+ * @brief resets the detector, counters included
+ */
+void transient_init(transient_state_t *const state);
+
+/**
+ * @brief folds a new slope sample in the curvature estimate (rate of change of the slope, smoothed), called once per temperature sample
+ * @param[in/out] curvature      : curvature estimate (Q8 °C per hour, per minute)
+ * @param[in]     previous_slope : slope at the previous sample (Q8 °C per hour)
+ * @param[in]     slope          : current slope (Q8 °C per hour)
+ * @param[in]     period_ms      : time in between both samples (milliseconds)
+ */
+void transient_curvature_update(int16_t *const curvature, const int16_t previous_slope, const int16_t slope, const uint16_t period_ms);
+
+/**
+ * @brief tracks the detection phase and filters the compressor start demand, as long as the compressor is off.
+ * Only depends on levels, so it can be called any number of times in between two temperature samples.
+ * @param[in] slope     : temperature slope (Q8 °C per hour)
+ * @param[in] curvature : temperature curvature (Q8 °C per hour, per minute)
+ * @param[in] excess    : temperature above the start threshold (Q8 °C, negative below it)
+ * @param[in] demand    : the control law asks for a start
+ * @param[in] now       : current time (seconds)
+ * @return start demand, false while it is held
+ */
+bool transient_filter_start(transient_params_t const *const params, transient_state_t *const state, const int16_t slope,
+                            const int16_t curvature, const int16_t excess, const bool demand, const uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRANSIENT_HEADER */
@@ -0,0 +1,121 @@
+#include "wall_clock.h"
+
+#define PPM 1000000LL
+#define THOUSAND 1000L
+#define DECIMAL_BASE 10U
+
+static void anchor(wall_clock_t *const clock, mcu_time_t const *const now, const uint32_t wall_s)
+{
+    clock->synced = true;
+    clock->wall_s = wall_s;
+    clock->mcu_s = now->seconds;
+    clock->offset_s = 0;
+}
+
+void wall_clock_init(wall_clock_t *const clock)
+{
+    clock->synced = false;
+    clock->drift_known = false;
+    clock->wall_s = 0;
+    clock->mcu_s = 0;
+    clock->offset_s = 0;
+    clock->drift_ppm = 0;
+}
+
+void wall_clock_sync(wall_clock_t *const clock, mcu_time_t const *const now, const uint32_t wall_s)
+{
+    const uint32_t elapsed_s = now->seconds - clock->mcu_s;
+    if (!clock->synced)
+    {
+        anchor(clock, now, wall_s);
+        return;
+    }
+
+    // Too close to the anchor to tell the drift apart from the seconds rounding : only the time is corrected
+    if (elapsed_s < WALL_CLOCK_MIN_DRIFT_INTERVAL_S)
+    {
+        uint32_t expected_s;
+        if (wall_clock_now(clock, now, &expected_s))
+        {
+            clock->offset_s += (int32_t)(wall_s - expected_s);
+        }
+        return;
+    }
+
+    // Raw MCU time against raw host time, whatever was corrected in between
+    const int32_t wall_elapsed_s = (int32_t)(wall_s - clock->wall_s);
+    if (wall_elapsed_s > 0)
+    {
+        const int64_t measured = (((int64_t)elapsed_s - wall_elapsed_s) * PPM) / wall_elapsed_s;
+        if ((measured <= WALL_CLOCK_MAX_DRIFT_PPM) && (measured >= -WALL_CLOCK_MAX_DRIFT_PPM))
+        {
+            const int32_t drift = clock->drift_known ? clock->drift_ppm + ((int32_t)measured - clock->drift_ppm) / (1L << WALL_CLOCK_DRIFT_FILTER_SHIFT)
+                                                     : (int32_t)measured;
+            clock->drift_ppm = (int16_t)drift;
+            clock->drift_known = true;
+        }
+    }
+    anchor(clock, now, wall_s);
+}
+
+bool wall_clock_now(wall_clock_t const *const clock, mcu_time_t const *const now, uint32_t *const wall_s)
+{
+    const uint32_t elapsed_s = now->seconds - clock->mcu_s;
+    if (!clock->synced || (elapsed_s > WALL_CLOCK_VALIDITY_S))
+    {
+        return false;
+    }
+
+    // elapsed x drift / 10^6, split so that it fits 32 bits : elapsed is bounded by the validity
+    const int32_t thousands = (int32_t)(elapsed_s / THOUSAND) * clock->drift_ppm;
+    const int32_t units = ((int32_t)(elapsed_s % THOUSAND) * clock->drift_ppm) / THOUSAND;
+    const int32_t correction_s = (thousands + units) / THOUSAND;
+
+    *wall_s = (uint32_t)((int32_t)(clock->wall_s + elapsed_s) - correction_s + clock->offset_s);
+    return true;
+}
+
+void wall_clock_parser_init(wall_clock_parser_t *const parser)
+{
+    parser->value = 0;
+    parser->digits = 0;
+    parser->active = false;
+}
+
+bool wall_clock_parse(wall_clock_parser_t *const parser, const char c, uint32_t *const wall_s)
+{
+    if (c == WALL_CLOCK_SYNC_COMMAND)
+    {
+        wall_clock_parser_init(parser);
+        parser->active = true;
+        return false;
+    }
+
+    if (!parser->active)
+    {
+        return false;
+    }
+
+    if ((c >= '0') && (c <= '9'))
+    {
+        const uint32_t digit = (uint32_t)(c - '0');
+        if (parser->value > (UINT32_MAX - digit) / DECIMAL_BASE)
+        {
+            // Does not fit : the whole command is dropped
+            parser->active = false;
+            return false;
+        }
+        parser->value = parser->value * DECIMAL_BASE + digit;
+        parser->digits++;
+        return false;
+    }
+
+    // Anything else ends the command, only a new line validates it
+    const bool complete = ((c == '\n') || (c == '\r')) && (parser->digits > 0U);
+    parser->active = false;
+    if (complete)
+    {
+        *wall_s = parser->value;
+    }
+    return complete;
+}
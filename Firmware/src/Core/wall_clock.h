@@ -0,0 +1,99 @@
+#ifndef WALL_CLOCK_HEADER
+#define WALL_CLOCK_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mcu_time.h"
+
+/**
+ * @brief Local wall clock time, kept on top of the MCU timebase and synchronized by the host over the serial port.
+ * The MCU clock is off by a few hundred ppm (more with a ceramic resonator) : the elapsed MCU time is corrected by the drift
+ * measured in between synchronizations at least WALL_CLOCK_MIN_DRIFT_INTERVAL_S apart (whole seconds are too coarse for closer ones).
+ * Closer synchronizations only correct the time by an offset : host corrections and daylight saving changes are applied right away,
+ * and a drift measurement spanning such a jump is out of range and dropped.
+ * The host sends "T<local time, seconds since the epoch>\n", local time being UTC plus the current offset (daylight saving included).
+ * Only whole MCU seconds are used, so that the wall time only depends on the MCU seconds count.
+ */
+
+// clang-format off
+#ifndef WALL_CLOCK_MIN_DRIFT_INTERVAL_S
+#define WALL_CLOCK_MIN_DRIFT_INTERVAL_S 21600UL  /**> Shortest interval in between two synchronizations the drift is measured over (seconds) */
+#endif
+#ifndef WALL_CLOCK_MAX_DRIFT_PPM
+#define WALL_CLOCK_MAX_DRIFT_PPM 20000L         /**> Measurements beyond that are a host clock jump, not a drift (ppm)                   */
+#endif
+#ifndef WALL_CLOCK_DRIFT_FILTER_SHIFT
+#define WALL_CLOCK_DRIFT_FILTER_SHIFT 2U        /**> Drift moving average weight : each new measurement counts for 1 / 2^shift           */
+#endif
+#ifndef WALL_CLOCK_VALIDITY_S
+#define WALL_CLOCK_VALIDITY_S 604800UL          /**> Time is no longer trusted that long after the anchor synchronization (seconds, a week)  */
+#endif
+#define WALL_CLOCK_SYNC_COMMAND 'T'             /**> Serial synchronization command, followed by the decimal local time and a new line   */
+#define WALL_CLOCK_SECONDS_PER_DAY 86400UL
+// clang-format on
+
+/**
+ * @brief wall clock state
+ */
+typedef struct
+{
+    bool synced;        /**> Synchronized at least once                                               */
+    bool drift_known;   /**> Drift was measured at least once                                         */
+    uint32_t wall_s;    /**> Local time at the anchor, the synchronization drift is measured from     */
+    uint32_t mcu_s;     /**> MCU time at the anchor (seconds)                                         */
+    int32_t offset_s;   /**> Corrections applied by the synchronizations since the anchor (seconds)   */
+    int16_t drift_ppm;  /**> MCU clock error, positive when it runs fast (ppm)                        */
+} wall_clock_t;
+
+/**
+ * @brief host synchronization command parser (@see WALL_CLOCK_SYNC_COMMAND)
+ */
+typedef struct
+{
+    uint32_t value; /**> Time parsed so far                          */
+    uint8_t digits; /**> Digits parsed so far                        */
+    bool active;    /**> Command character was received              */
+} wall_clock_parser_t;
+
+/**
+ * @brief resets the clock to the unsynchronized state
+ */
+void wall_clock_init(wall_clock_t *const clock);
+
+/**
+ * @brief applies a host synchronization, measures the drift and moves the anchor when the previous one is old enough
+ * @param[in] now    : MCU time the synchronization was received at
+ * @param[in] wall_s : local time (seconds since the epoch)
+ */
+void wall_clock_sync(wall_clock_t *const clock, mcu_time_t const *const now, const uint32_t wall_s);
+
+/**
+ * @brief drift compensated local time
+ * @param[in]  now    : MCU time
+ * @param[out] wall_s : local time (seconds since the epoch)
+ * @return false if the clock was never synchronized, or not for too long (WALL_CLOCK_VALIDITY_S)
+ */
+bool wall_clock_now(wall_clock_t const *const clock, mcu_time_t const *const now, uint32_t *const wall_s);
+
+/**
+ * @brief resets a command parser
+ */
+void wall_clock_parser_init(wall_clock_parser_t *const parser);
+
+/**
+ * @brief feeds a character received from the host, other commands characters are ignored
+ * @param[out] wall_s : local time, set when a whole command was parsed
+ * @return true once a whole synchronization command was parsed
+ */
+bool wall_clock_parse(wall_clock_parser_t *const parser, const char c, uint32_t *const wall_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WALL_CLOCK_HEADER */
@@ -0,0 +1,74 @@
+#ifndef ARDUINO_SHIM_HEADER
+#define ARDUINO_SHIM_HEADER
+
+/**
+ * @brief Minimal Arduino API shim, used to build the firmware natively (host HAL).
+ * Only the subset of the Arduino API the firmware relies on is mapped here.
+ * Pins 0-7 map to PORTD, 8-13 to PORTB and A0-A5 (14-19) to PORTC, just like on the Arduino Nano.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arduino_shim.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define A0 14U
+#define A1 15U
+#define A2 16U
+#define A3 17U
+#define A4 18U
+#define A5 19U
+#define A6 20U
+#define A7 21U
+
+// Interrupts are meaningless on the host
+#define sei()
+#define cli()
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void     pinMode(uint8_t pin, uint8_t mode);
+void     digitalWrite(uint8_t pin, uint8_t value);
+int      digitalRead(uint8_t pin);
+int      analogRead(uint8_t pin);
+uint32_t millis(void);
+
+#ifdef __cplusplus
+}
+
+#include <stddef.h>
+
+/**
+ * @brief Serial port shim : output goes to stdout (unless muted), input is fed through arduino_shim_serial_push_input()
+ */
+class HardwareSerialShim
+{
+public:
+    void   begin(unsigned long baudrate);
+    int    available(void);
+    int    read(void);
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const char* str);
+    size_t print(char c);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+};
+
+extern HardwareSerialShim Serial;
+#endif
+
+#endif /* ARDUINO_SHIM_HEADER */
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "Arduino.h"
+#include "Hal/gpio.h"
+#include "Hal/persistent_memory.h"
+#include "Hal/pin_change.h"
+#include "Hal/power.h"
+#include "Hal/pwm.h"
+#include "Hal/timebase.h"
+#include "Hal/uart.h"
+#include "persistent_memory_host.h"
+#include "pwm_host.h"
+#include "timebase_host.h"
+#include "uart_host.h"
+
+class HalHostFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        arduino_shim_reset();
+        arduino_shim_serial_mute(true);
+        timebase_host_set_clock(nullptr);
+        timebase_init();
+        persistent_mem_host_open(nullptr);
+    }
+};
+
+static uint64_t fixed_clock(void)
+{
+    return 12345U;
+}
+
+TEST_F(HalHostFixture, virtual_clock_test)
+{
+    ASSERT_TRUE(timebase_host_is_virtual());
+    timebase_process();
+    ASSERT_EQ(timebase_get_time()->seconds, 0U);
+
+    timebase_host_advance_ms(2500U);
+    timebase_process();
+    ASSERT_EQ(timebase_get_time()->seconds, 2U);
+    ASSERT_EQ(timebase_get_time()->milliseconds, 500U);
+
+    // Sleeping skips virtual time
+    ASSERT_EQ(power_idle(20U), 20000U);
+    ASSERT_EQ(timebase_get_subticks(), 520U * TIMEBASE_SUBTICKS_PER_MS);
+    timebase_process();
+    ASSERT_EQ(timebase_get_time()->milliseconds, 520U);
+
+    // Injected clock takes precedence
+    timebase_host_set_clock(fixed_clock);
+    ASSERT_FALSE(timebase_host_is_virtual());
+    timebase_process();
+    ASSERT_EQ(timebase_get_time()->seconds, 12U);
+    ASSERT_EQ(timebase_get_time()->milliseconds, 345U);
+    timebase_host_set_clock(nullptr);
+}
+
+TEST_F(HalHostFixture, eeprom_test)
+{
+    ASSERT_TRUE(persistent_mem_is_first_boot(0xDE, 0xAD));
+
+    persistent_config_t config = {.header = 0xDE, .target_temperature = 6, .current_threshold = 700, .warming_rate = 0, .cooling_rate = 0, .current_sigma = 0, .current_runs = 0, .footer = 0xAD};
+    persistent_mem_write_config(&config);
+    ASSERT_FALSE(persistent_mem_is_first_boot(0xDE, 0xAD));
+    ASSERT_EQ(persistent_mem_host_get_write_count(), 1U);
+
+    persistent_config_t read_back = {};
+    persistent_mem_read_config(&read_back);
+    ASSERT_EQ(read_back.target_temperature, 6);
+    ASSERT_EQ(read_back.current_threshold, 700U);
+
+    // File backed EEPROM survives "power cycles"
+    const std::string path = testing::TempDir() + "hal_host_eeprom.bin";
+    std::remove(path.c_str());
+    ASSERT_TRUE(persistent_mem_host_open(path.c_str()));
+    ASSERT_TRUE(persistent_mem_is_first_boot(0xDE, 0xAD));
+    persistent_mem_write_config(&config);
+
+    persistent_mem_host_open(nullptr);
+    ASSERT_TRUE(persistent_mem_is_first_boot(0xDE, 0xAD));
+
+    ASSERT_TRUE(persistent_mem_host_open(path.c_str()));
+    ASSERT_FALSE(persistent_mem_is_first_boot(0xDE, 0xAD));
+    persistent_mem_host_open(nullptr);
+    std::remove(path.c_str());
+}
+
+TEST_F(HalHostFixture, arduino_shim_test)
+{
+    pinMode(2, OUTPUT);
+    pinMode(4, INPUT);
+
+    // Inputs default to HIGH (released buttons)
+    ASSERT_EQ(digitalRead(4), HIGH);
+    arduino_shim_set_digital_input(4, LOW);
+    ASSERT_EQ(digitalRead(4), LOW);
+
+    // Outputs are mirrored in port registers and read back
+    digitalWrite(2, HIGH);
+    ASSERT_EQ(PORTD & (1U << 2U), (1U << 2U));
+    ASSERT_EQ(digitalRead(2), HIGH);
+    ASSERT_EQ(arduino_shim_get_digital_output(2), HIGH);
+
+    arduino_shim_set_analog_input(A0, 2000U);
+    ASSERT_EQ(analogRead(A0), 1023);
+    ASSERT_EQ(arduino_shim_get_analog_read_count(), 1U);
+
+    arduino_shim_serial_push_input("pr");
+    ASSERT_EQ(Serial.available(), 2);
+    ASSERT_EQ(Serial.read(), 'p');
+    ASSERT_EQ(Serial.read(), 'r');
+    ASSERT_EQ(Serial.read(), -1);
+
+    Serial.print("hello");
+    ASSERT_EQ(arduino_shim_serial_get_output_count(), 5U);
+}
+
+TEST_F(HalHostFixture, gpio_test)
+{
+    // Same mapping as the Arduino numbering
+    static_assert((gpio_pin<2U>::port == gpio_port_t::D) && (gpio_pin<2U>::mask == 0x04U), "D2 is PORTD2");
+    static_assert((gpio_pin<9U>::port == gpio_port_t::B) && (gpio_pin<9U>::bit == 1U), "D9 is PORTB1");
+    static_assert((gpio_pin<A1>::port == gpio_port_t::C) && (gpio_pin<A1>::bit == 1U), "A1 is PORTC1");
+
+    gpio_pin<2U>::set_output();
+    ASSERT_EQ(DDRD, 0x04U);
+    gpio_pin<2U>::write(true);
+    ASSERT_EQ(arduino_shim_get_digital_output(2U), HIGH);
+    ASSERT_EQ(digitalRead(2U), HIGH);
+    gpio_pin<2U>::set_low();
+    ASSERT_EQ(arduino_shim_get_digital_output(2U), LOW);
+
+    // Other pins of the port are left untouched
+    gpio_pin<13U>::set_output();
+    gpio_pin<13U>::set_high();
+    gpio_pin<8U>::set_output();
+    gpio_pin<8U>::set_high();
+    gpio_pin<8U>::set_low();
+    ASSERT_EQ(PORTB, 0x20U);
+    ASSERT_EQ(*gpio_pin<13U>::out_register(), PORTB);
+
+    // Inputs follow the injected levels, just like digitalRead()
+    gpio_pin<4U>::set_input();
+    ASSERT_TRUE(gpio_pin<4U>::read());
+    arduino_shim_set_digital_input(4U, LOW);
+    ASSERT_FALSE(gpio_pin<4U>::read());
+    ASSERT_EQ(digitalRead(4U), LOW);
+}
+
+TEST_F(HalHostFixture, pin_change_test)
+{
+    pinMode(4, INPUT);
+    pinMode(5, INPUT);
+
+    // Initial levels need to be read
+    pin_change_init((1U << 4U) | (1U << 5U));
+    ASSERT_TRUE(pin_change_pending());
+    ASSERT_FALSE(pin_change_pending());
+
+    // Unwatched pins are ignored
+    arduino_shim_set_digital_input(6, LOW);
+    ASSERT_FALSE(pin_change_pending());
+
+    // Flag is cleared once read
+    arduino_shim_set_digital_input(4, LOW);
+    ASSERT_TRUE(pin_change_pending());
+    ASSERT_FALSE(pin_change_pending());
+
+    // A change back and forth in between two reads goes unnoticed on the host
+    arduino_shim_set_digital_input(5, LOW);
+    arduino_shim_set_digital_input(5, HIGH);
+    ASSERT_FALSE(pin_change_pending());
+}
+
+TEST_F(HalHostFixture, uart_test)
+{
+    // 9600 bauds : 960 bytes per second
+    uart_init(9600U);
+    const std::string line(40U, 'x');
+    uint8_t queued = 0;
+    while (uart_print(line.c_str()))
+    {
+        queued++;
+    }
+
+    // Writes never wait : once the ring is full, whole messages are dropped
+    ASSERT_EQ(queued, UART_TX_RING_SIZE / line.size());
+    ASSERT_EQ(arduino_shim_serial_get_output_count(), 0U);
+    ASSERT_FALSE(uart_print(line.c_str()));
+    uart_stats_t stats;
+    uart_get_stats(&stats);
+    ASSERT_EQ(stats.tx_dropped_messages, 2U);
+    ASSERT_EQ(stats.tx_dropped_bytes, 2U * line.size());
+
+    // The line drains the ring in the background, at its own pace
+    timebase_host_advance_ms(50U);
+    timebase_process();
+    ASSERT_TRUE(uart_print("ok"));
+    ASSERT_EQ(arduino_shim_serial_get_output_count(), 48U);
+    ASSERT_TRUE(uart_print_flash("flash"));
+    uart_host_flush();
+    ASSERT_EQ(arduino_shim_serial_get_output_count(), queued * line.size() + 7U);
+
+    // Received bytes are read one at a time
+    arduino_shim_serial_push_input("p");
+    ASSERT_EQ(uart_read(), 'p');
+    ASSERT_EQ(uart_read(), -1);
+}
+
+TEST_F(HalHostFixture, pwm_test)
+{
+    pwm_init();
+    ASSERT_EQ(pwm_host_get_duty(), 0U);
+
+    pwm_set_duty(42U);
+    ASSERT_EQ(pwm_host_get_duty(), 42U);
+
+    // Clamped to fully on
+    pwm_set_duty(150U);
+    ASSERT_EQ(pwm_host_get_duty(), 100U);
+    ASSERT_EQ(pwm_host_get_write_count(), 2U);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
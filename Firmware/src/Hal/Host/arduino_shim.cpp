@@ -0,0 +1,314 @@
+#include "Arduino.h"
+#include "Hal/timebase.h"
+
+#include <deque>
+#include <stdio.h>
+#include <string.h>
+
+volatile uint8_t PORTB = 0;
+volatile uint8_t PORTC = 0;
+volatile uint8_t PORTD = 0;
+volatile uint8_t PINB  = 0;
+volatile uint8_t PINC  = 0;
+volatile uint8_t PIND  = 0;
+volatile uint8_t DDRB  = 0;
+volatile uint8_t DDRC  = 0;
+volatile uint8_t DDRD  = 0;
+
+HardwareSerialShim Serial;
+
+static uint16_t                       analog_inputs[ARDUINO_SHIM_PIN_COUNT] = {0};
+static arduino_shim_analog_provider_t analog_provider                       = NULL;
+static uint32_t                       analog_read_count                     = 0;
+static bool                           serial_muted                          = false;
+static uint32_t                       serial_output_count                   = 0;
+static std::deque<char>               serial_input;
+
+typedef struct
+{
+    volatile uint8_t* port;
+    volatile uint8_t* pin;
+    volatile uint8_t* ddr;
+    uint8_t           bit;
+} pin_mapping_t;
+
+// Compound assignments on volatile operands are deprecated in C++20
+static inline void set_bit(volatile uint8_t* reg, const uint8_t bit)
+{
+    *reg = *reg | (uint8_t)(1U << bit);
+}
+
+static inline void clear_bit(volatile uint8_t* reg, const uint8_t bit)
+{
+    *reg = *reg & (uint8_t)~(1U << bit);
+}
+
+static bool get_pin_mapping(const uint8_t pin, pin_mapping_t* mapping)
+{
+    if (pin < 8U)
+    {
+        *mapping = {&PORTD, &PIND, &DDRD, pin};
+        return true;
+    }
+
+    if (pin < 14U)
+    {
+        *mapping = {&PORTB, &PINB, &DDRB, (uint8_t)(pin - 8U)};
+        return true;
+    }
+
+    // A6 and A7 are analog only pins
+    if (pin < 20U)
+    {
+        *mapping = {&PORTC, &PINC, &DDRC, (uint8_t)(pin - 14U)};
+        return true;
+    }
+    return false;
+}
+
+void arduino_shim_reset(void)
+{
+    PORTB = 0;
+    PORTC = 0;
+    PORTD = 0;
+    DDRB  = 0;
+    DDRC  = 0;
+    DDRD  = 0;
+
+    // Buttons are active low, default to released
+    PINB = 0xFF;
+    PINC = 0xFF;
+    PIND = 0xFF;
+
+    memset(analog_inputs, 0, sizeof(analog_inputs));
+    analog_provider     = NULL;
+    analog_read_count   = 0;
+    serial_muted        = false;
+    serial_output_count = 0;
+    serial_input.clear();
+}
+
+void arduino_shim_set_digital_input(const uint8_t pin, const uint8_t value)
+{
+    pin_mapping_t mapping;
+    if (!get_pin_mapping(pin, &mapping))
+    {
+        return;
+    }
+
+    if (value == LOW)
+    {
+        clear_bit(mapping.pin, mapping.bit);
+    }
+    else
+    {
+        set_bit(mapping.pin, mapping.bit);
+    }
+}
+
+void arduino_shim_set_analog_input(const uint8_t pin, const uint16_t value)
+{
+    if (pin < ARDUINO_SHIM_PIN_COUNT)
+    {
+        analog_inputs[pin] = value > 1023U ? 1023U : value;
+    }
+}
+
+void arduino_shim_set_analog_provider(arduino_shim_analog_provider_t provider)
+{
+    analog_provider = provider;
+}
+
+uint8_t arduino_shim_get_digital_output(const uint8_t pin)
+{
+    pin_mapping_t mapping;
+    if (!get_pin_mapping(pin, &mapping))
+    {
+        return LOW;
+    }
+    return (*mapping.port >> mapping.bit) & 1U;
+}
+
+uint32_t arduino_shim_get_analog_read_count(void)
+{
+    return analog_read_count;
+}
+
+void arduino_shim_serial_mute(const bool mute)
+{
+    serial_muted = mute;
+}
+
+void arduino_shim_serial_push_input(const char* input)
+{
+    for (const char* c = input; *c != '\0'; c++)
+    {
+        serial_input.push_back(*c);
+    }
+}
+
+uint32_t arduino_shim_serial_get_output_count(void)
+{
+    return serial_output_count;
+}
+
+// ################################################################################################################################################
+// ################################################################ Arduino API ###################################################################
+// ################################################################################################################################################
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    pin_mapping_t mapping;
+    if (!get_pin_mapping(pin, &mapping))
+    {
+        return;
+    }
+
+    if (mode == OUTPUT)
+    {
+        set_bit(mapping.ddr, mapping.bit);
+    }
+    else
+    {
+        clear_bit(mapping.ddr, mapping.bit);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    pin_mapping_t mapping;
+    if (!get_pin_mapping(pin, &mapping))
+    {
+        return;
+    }
+
+    if (value == LOW)
+    {
+        clear_bit(mapping.port, mapping.bit);
+    }
+    else
+    {
+        set_bit(mapping.port, mapping.bit);
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    pin_mapping_t mapping;
+    if (!get_pin_mapping(pin, &mapping))
+    {
+        return LOW;
+    }
+
+    // Output pins read back their driven level, just like the real PINx register does
+    if ((*mapping.ddr & (1U << mapping.bit)) != 0)
+    {
+        return (*mapping.port >> mapping.bit) & 1U;
+    }
+    return (*mapping.pin >> mapping.bit) & 1U;
+}
+
+int analogRead(uint8_t pin)
+{
+    analog_read_count++;
+    if (analog_provider != NULL)
+    {
+        return analog_provider(pin);
+    }
+
+    if (pin < ARDUINO_SHIM_PIN_COUNT)
+    {
+        return analog_inputs[pin];
+    }
+    return 0;
+}
+
+uint32_t millis(void)
+{
+    const mcu_time_t* time = timebase_get_time();
+    return (time->seconds * 1000U) + time->milliseconds;
+}
+
+// ################################################################################################################################################
+// ################################################################ Serial shim ###################################################################
+// ################################################################################################################################################
+
+void HardwareSerialShim::begin(unsigned long baudrate)
+{
+    (void)baudrate;
+}
+
+int HardwareSerialShim::available(void)
+{
+    return (int)serial_input.size();
+}
+
+int HardwareSerialShim::read(void)
+{
+    if (serial_input.empty())
+    {
+        return -1;
+    }
+    const char c = serial_input.front();
+    serial_input.pop_front();
+    return (uint8_t)c;
+}
+
+size_t HardwareSerialShim::write(uint8_t byte)
+{
+    serial_output_count++;
+    if (!serial_muted)
+    {
+        fputc(byte, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerialShim::write(const uint8_t* buffer, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+size_t HardwareSerialShim::print(const char* str)
+{
+    size_t length = strlen(str);
+    serial_output_count += length;
+    if (!serial_muted)
+    {
+        fputs(str, stdout);
+    }
+    return length;
+}
+
+size_t HardwareSerialShim::print(char c)
+{
+    return write((uint8_t)c);
+}
+
+size_t HardwareSerialShim::print(int value)
+{
+    return print((long)value);
+}
+
+size_t HardwareSerialShim::print(unsigned int value)
+{
+    return print((unsigned long)value);
+}
+
+size_t HardwareSerialShim::print(long value)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%ld", value);
+    return print(buffer);
+}
+
+size_t HardwareSerialShim::print(unsigned long value)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%lu", value);
+    return print(buffer);
+}
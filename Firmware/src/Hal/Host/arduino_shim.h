@@ -0,0 +1,81 @@
+#ifndef ARDUINO_SHIM_CONTROL_HEADER
+#define ARDUINO_SHIM_CONTROL_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ARDUINO_SHIM_PIN_COUNT 22U /**> Digital pins 0-13, then analog pins A0-A7 */
+
+// Mock IO registers, so that code writing directly to registers (e.g. the led driver) works on the host
+extern volatile uint8_t PORTB;
+extern volatile uint8_t PORTC;
+extern volatile uint8_t PORTD;
+extern volatile uint8_t PINB;
+extern volatile uint8_t PINC;
+extern volatile uint8_t PIND;
+extern volatile uint8_t DDRB;
+extern volatile uint8_t DDRC;
+extern volatile uint8_t DDRD;
+
+/**
+ * @brief analog inputs provider, used to plug a model behind analogRead()
+ * @return raw 10 bits ADC reading
+ */
+typedef uint16_t (*arduino_shim_analog_provider_t)(uint8_t pin);
+
+/**
+ * @brief reverts all pins, registers, serial buffers and providers to their default state.
+ * Digital inputs default to HIGH (buttons are active low), analog inputs default to 0.
+ */
+void arduino_shim_reset(void);
+
+/**
+ * @brief forces the level of a digital input pin
+ */
+void arduino_shim_set_digital_input(const uint8_t pin, const uint8_t value);
+
+/**
+ * @brief forces the raw ADC reading of an analog pin (0 - 1023)
+ */
+void arduino_shim_set_analog_input(const uint8_t pin, const uint16_t value);
+
+/**
+ * @brief plugs a function behind analogRead(), takes precedence over arduino_shim_set_analog_input() (NULL to unplug)
+ */
+void arduino_shim_set_analog_provider(arduino_shim_analog_provider_t provider);
+
+/**
+ * @brief reads back the output level of a pin, as driven by the firmware
+ */
+uint8_t arduino_shim_get_digital_output(const uint8_t pin);
+
+/**
+ * @brief counts analogRead() calls since last reset (used to measure ADC conversions)
+ */
+uint32_t arduino_shim_get_analog_read_count(void);
+
+/**
+ * @brief mutes (or unmutes) the serial output
+ */
+void arduino_shim_serial_mute(const bool mute);
+
+/**
+ * @brief appends characters to the serial input buffer (read by the firmware through Serial.read())
+ */
+void arduino_shim_serial_push_input(const char* input);
+
+/**
+ * @brief counts how many bytes the firmware wrote to the serial output
+ */
+uint32_t arduino_shim_serial_get_output_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARDUINO_SHIM_CONTROL_HEADER */
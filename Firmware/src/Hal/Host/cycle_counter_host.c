@@ -0,0 +1,17 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "Hal/cycle_counter.h"
+
+#include <time.h>
+
+void cycle_counter_init(void)
+{
+}
+
+uint32_t cycle_counter_read(void)
+{
+    // Host has no portable cycle counter : nanoseconds are used instead
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec);
+}
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "led.h"
+
+// Runs the LED driver against virtual time, one led_process() call per millisecond like the firmware loop does,
+// and reports its cost for an increasing number of LEDs. Built with a larger MAX_LED_COUNT than the firmware (see CMakeLists.txt).
+
+static volatile uint8_t port_b = 0;
+static volatile uint8_t port_d = 0;
+
+static void print_usage(const char* program)
+{
+    printf("Usage : %s [options]\n"
+           "  --duration <seconds>    Virtual time run for each LED count (default 60)\n"
+           "  --repeat <count>        Runs kept : the fastest one is reported (default 5)\n",
+           program);
+}
+
+// Average cost of a led_process() call (nanoseconds)
+static double run(const uint8_t count, const led_blink_pattern_t pattern, const uint32_t duration_ms, const uint32_t repeat)
+{
+    led_io_t leds[MAX_LED_COUNT];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        // Spread over two ports, 8 LEDs each
+        leds[i].port     = (i < 8U) ? &port_d : &port_b;
+        leds[i].pin      = (uint8_t)(i % 8U);
+        leds[i].set_duty = nullptr;
+    }
+
+    double best = 0.0;
+    for (uint32_t r = 0; r < repeat; r++)
+    {
+        led_init(leds, count);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            led_set_blink_pattern(i, pattern);
+        }
+
+        mcu_time_t time = {.seconds = 0, .milliseconds = 0};
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t ms = 0; ms < duration_ms; ms++)
+        {
+            led_process(&time);
+            time_add_ms(&time, 1U);
+        }
+        const auto   stop    = std::chrono::steady_clock::now();
+        const double average = std::chrono::duration<double, std::nano>(stop - start).count() / duration_ms;
+        best                 = (r == 0U || average < best) ? average : best;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t duration_ms = 60U * 1000U;
+    uint32_t repeat      = 5U;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const bool        value = (i + 1) < argc;
+        if (arg == "--duration" && value)
+        {
+            duration_ms = (uint32_t)std::strtoul(argv[++i], nullptr, 10) * 1000U;
+        }
+        else if (arg == "--repeat" && value)
+        {
+            repeat = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return (arg == "--help") ? 0 : 1;
+        }
+    }
+
+    if (duration_ms == 0U || repeat == 0U)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    printf("led_process() cost per call (ns), %lu calls per run\n", (unsigned long)duration_ms);
+    printf("LEDs   breathing (software PWM)   per LED   warning   per LED\n");
+    for (uint8_t count = 1; count <= MAX_LED_COUNT; count++)
+    {
+        const double breathing = run(count, LED_BLINK_BREATHING, duration_ms, repeat);
+        const double warning   = run(count, LED_BLINK_WARNING, duration_ms, repeat);
+        printf("%4u   %26.1f   %7.1f   %7.1f   %7.1f\n", count, breathing, breathing / count, warning, warning / count);
+    }
+
+    led_reset();
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "Arduino.h"
+#include "Hal/timebase.h"
+#include "persistent_memory_host.h"
+#include "timebase_host.h"
+#include "uart_host.h"
+
+// Arduino sketch entry points (main.cpp)
+void setup();
+void loop();
+
+static void print_usage(const char* program)
+{
+    printf("Usage : %s [options]\n"
+           "  --duration <seconds>    Virtual time to simulate (default 60)\n"
+           "  --loops <count>         Stops after this many loop() iterations (default : unlimited)\n"
+           "  --step-us <micros>      Virtual time consumed by each loop() iteration (default 100)\n"
+           "  --realtime              Uses the host monotonic clock instead of the virtual clock\n"
+           "  --eeprom <path>         Backs the EEPROM with a file (default : memory only)\n"
+           "  --temp-adc <raw>        Raw ADC reading of the thermistor bridge (default 386, ~10 C)\n"
+           "  --current-adc <raw>     Raw ADC reading of the current sensor (default 498, no current)\n"
+           "  --serial <text>         Text sent to the firmware serial input at boot\n"
+           "  --quiet                 Mutes serial output\n",
+           program);
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t    duration_ms  = 60U * 1000U;
+    uint64_t    max_loops    = 0;
+    uint64_t    step_us      = 100U;
+    bool        realtime     = false;
+    bool        quiet        = false;
+    const char* eeprom_path  = nullptr;
+    const char* serial_input = nullptr;
+    uint16_t    temp_adc     = 386U;
+    uint16_t    current_adc  = 498U;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const bool        value = (i + 1) < argc;
+        if (arg == "--duration" && value)
+        {
+            duration_ms = std::strtoull(argv[++i], nullptr, 10) * 1000U;
+        }
+        else if (arg == "--loops" && value)
+        {
+            max_loops = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--step-us" && value)
+        {
+            step_us = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--eeprom" && value)
+        {
+            eeprom_path = argv[++i];
+        }
+        else if (arg == "--temp-adc" && value)
+        {
+            temp_adc = (uint16_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--current-adc" && value)
+        {
+            current_adc = (uint16_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--serial" && value)
+        {
+            serial_input = argv[++i];
+        }
+        else if (arg == "--realtime")
+        {
+            realtime = true;
+        }
+        else if (arg == "--quiet")
+        {
+            quiet = true;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    arduino_shim_reset();
+    arduino_shim_serial_mute(quiet);
+    arduino_shim_set_analog_input(A0, temp_adc);
+    arduino_shim_set_analog_input(A1, current_adc);
+    if (!persistent_mem_host_open(eeprom_path))
+    {
+        fprintf(stderr, "Could not read EEPROM file %s\n", eeprom_path);
+        return EXIT_FAILURE;
+    }
+
+    if (realtime)
+    {
+        timebase_host_set_clock(timebase_host_realtime_clock);
+    }
+
+    setup();
+    if (serial_input != nullptr)
+    {
+        arduino_shim_serial_push_input(serial_input);
+    }
+
+    const auto start      = std::chrono::steady_clock::now();
+    uint64_t   loops      = 0;
+    uint64_t   carried_us = 0;
+    while (true)
+    {
+        timebase_process();
+        const mcu_time_t* time       = timebase_get_time();
+        const uint64_t    elapsed_ms = (uint64_t)time->seconds * 1000U + time->milliseconds;
+        if ((elapsed_ms >= duration_ms) || (max_loops != 0 && loops >= max_loops))
+        {
+            break;
+        }
+
+        loop();
+        loops++;
+
+        // Loop iterations consume a bit of virtual time, otherwise time would only move when the firmware sleeps
+        carried_us += step_us;
+        timebase_host_advance_ms(carried_us / 1000U);
+        carried_us %= 1000U;
+    }
+
+    // Whatever the line did not have time to send yet
+    uart_host_flush();
+
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const mcu_time_t* time = timebase_get_time();
+    fprintf(stderr, "Ran %llu loops, %u.%03u s of firmware time in %.3f s (%.1fx real time)\n", (unsigned long long)loops,
+            (unsigned)time->seconds, (unsigned)time->milliseconds, wall_s,
+            wall_s > 0.0 ? ((double)time->seconds + time->milliseconds / 1000.0) / wall_s : 0.0);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+#include "Hal/persistent_memory.h"
+#include "persistent_memory_host.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t eeprom[PERSISTENT_MEM_HOST_SIZE];
+static const char * backing_file = NULL;
+static uint32_t write_count = 0;
+static bool initialized = false;
+
+static void ensure_initialized(void)
+{
+    if (!initialized)
+    {
+        persistent_mem_host_erase();
+    }
+}
+
+static void flush_to_file(void)
+{
+    if (NULL == backing_file)
+    {
+        return;
+    }
+
+    FILE * file = fopen(backing_file, "wb");
+    if (NULL == file)
+    {
+        return;
+    }
+    fwrite(eeprom, 1U, sizeof(eeprom), file);
+    fclose(file);
+}
+
+bool persistent_mem_host_open(const char * path)
+{
+    persistent_mem_host_erase();
+    backing_file = path;
+    if (NULL == path)
+    {
+        return true;
+    }
+
+    FILE * file = fopen(path, "rb");
+    if (NULL == file)
+    {
+        // Not created yet : starts from a blank EEPROM
+        return true;
+    }
+
+    const size_t read = fread(eeprom, 1U, sizeof(eeprom), file);
+    fclose(file);
+    return read == sizeof(eeprom);
+}
+
+void persistent_mem_host_erase(void)
+{
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    write_count = 0;
+    initialized = true;
+}
+
+uint32_t persistent_mem_host_get_write_count(void)
+{
+    return write_count;
+}
+
+void persistent_mem_read_config(persistent_config_t * config)
+{
+    ensure_initialized();
+    memcpy(config, &eeprom[EEPROM_START_OFFSET], sizeof(persistent_config_t));
+}
+
+void persistent_mem_write_config(persistent_config_t const * const config)
+{
+    ensure_initialized();
+    memcpy(&eeprom[EEPROM_START_OFFSET], config, sizeof(persistent_config_t));
+    write_count++;
+    flush_to_file();
+}
+
+bool persistent_mem_is_first_boot(const uint8_t header_cst, const uint8_t footer_cst)
+{
+    ensure_initialized();
+    const uint8_t eep_header = eeprom[EEPROM_START_OFFSET + PERM_STORE_HEADER_IDX];
+    const uint8_t eep_footer = eeprom[EEPROM_START_OFFSET + PERM_STORE_FOOTER_IDX];
+
+    return (header_cst != eep_header) || (footer_cst != eep_footer);
+}
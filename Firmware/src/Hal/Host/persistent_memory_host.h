@@ -0,0 +1,35 @@
+#ifndef PERSISTENT_MEMORY_HOST_HEADER
+#define PERSISTENT_MEMORY_HOST_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PERSISTENT_MEM_HOST_SIZE 1024U /**> Same EEPROM size as the atmega328p */
+
+/**
+ * @brief backs the emulated EEPROM with a file : content is loaded from it (if it exists) and written back on each write.
+ * @param[in] path : backing file path, NULL reverts to a memory only EEPROM
+ * @return false if the file exists but could not be read
+*/
+bool persistent_mem_host_open(const char * path);
+
+/**
+ * @brief erases the emulated EEPROM (all bytes set to 0xFF, as shipped from factory)
+*/
+void persistent_mem_host_erase(void);
+
+/**
+ * @brief counts configuration writes since the last erase (useful to track EEPROM wear)
+*/
+uint32_t persistent_mem_host_get_write_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENT_MEMORY_HOST_HEADER */
@@ -0,0 +1,23 @@
+#include "Hal/pin_change.h"
+#include "arduino_shim.h"
+
+// No interrupt on the host : a change is detected by comparing the input register with its last known value
+static uint8_t watched = 0;
+static uint8_t levels = 0;
+static bool pending = false;
+
+void pin_change_init(const uint8_t mask)
+{
+    watched = mask;
+    levels = PIND & mask;
+    pending = true;
+}
+
+bool pin_change_pending(void)
+{
+    const uint8_t current = PIND & watched;
+    const bool changed = pending || (current != levels);
+    levels = current;
+    pending = false;
+    return changed;
+}
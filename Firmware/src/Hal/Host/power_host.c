@@ -0,0 +1,37 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "Hal/power.h"
+#include "timebase_host.h"
+
+#include <time.h>
+
+void power_init(void)
+{
+}
+
+uint32_t power_idle(const uint16_t budget_ms)
+{
+    if (budget_ms == 0)
+    {
+        return 0;
+    }
+
+    // Virtual time : skip the idle period altogether, that's what makes the host build run faster than real time
+    if (timebase_host_is_virtual())
+    {
+        timebase_host_advance_ms(budget_ms);
+        return (uint32_t)budget_ms * 1000U;
+    }
+
+    struct timespec duration = {
+        .tv_sec = budget_ms / 1000U,
+        .tv_nsec = (long)(budget_ms % 1000U) * 1000000L,
+    };
+    nanosleep(&duration, NULL);
+    return (uint32_t)budget_ms * 1000U;
+}
+
+// Inputs only change in between two loops on the host, nothing to cut short
+void power_wake(void)
+{
+}
@@ -0,0 +1,27 @@
+#include "Hal/pwm.h"
+#include "pwm_host.h"
+
+static uint8_t current_duty = 0;
+static uint32_t write_count = 0;
+
+void pwm_init(void)
+{
+    current_duty = 0;
+    write_count = 0;
+}
+
+void pwm_set_duty(const uint8_t duty)
+{
+    current_duty = (duty > 100U) ? 100U : duty;
+    write_count++;
+}
+
+uint8_t pwm_host_get_duty(void)
+{
+    return current_duty;
+}
+
+uint32_t pwm_host_get_write_count(void)
+{
+    return write_count;
+}
@@ -0,0 +1,26 @@
+#ifndef PWM_HOST_HEADER
+#define PWM_HOST_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief last duty cycle applied to the (emulated) hardware PWM output (host HAL only)
+ * @return duty cycle (0 - 100)
+*/
+uint8_t pwm_host_get_duty(void);
+
+/**
+ * @brief how many times the duty cycle was written since pwm_init()
+*/
+uint32_t pwm_host_get_write_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWM_HOST_HEADER */
@@ -0,0 +1,81 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "Hal/timebase.h"
+#include "timebase_host.h"
+
+#include <stddef.h>
+#include <time.h>
+
+static uint64_t              virtual_ms = 0;
+static timebase_host_clock_t clock_source = NULL;
+
+static mcu_time_t internal_time = {
+    .seconds = 0,
+    .milliseconds = 0,
+};
+
+static uint64_t read_clock(void)
+{
+    return (NULL == clock_source) ? virtual_ms : clock_source();
+}
+
+void timebase_host_set_clock(timebase_host_clock_t clock)
+{
+    clock_source = clock;
+}
+
+bool timebase_host_is_virtual(void)
+{
+    return NULL == clock_source;
+}
+
+void timebase_host_advance_ms(const uint64_t duration_ms)
+{
+    virtual_ms += duration_ms;
+}
+
+uint64_t timebase_host_realtime_clock(void)
+{
+    static bool started = false;
+    static struct timespec start;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (!started)
+    {
+        start = now;
+        started = true;
+    }
+
+    return ((uint64_t)(now.tv_sec - start.tv_sec) * 1000U) + ((now.tv_nsec - start.tv_nsec) / 1000000L);
+}
+
+void timebase_init(void)
+{
+    timebase_reset();
+}
+
+void timebase_reset(void)
+{
+    virtual_ms = 0;
+    time_default(&internal_time);
+}
+
+void timebase_process(void)
+{
+    const uint64_t now = read_clock();
+    internal_time.seconds = (uint32_t)(now / 1000U);
+    internal_time.milliseconds = (uint16_t)(now % 1000U);
+}
+
+const mcu_time_t *timebase_get_time(void)
+{
+    return &internal_time;
+}
+
+uint32_t timebase_get_subticks(void)
+{
+    // Same semantic as the AVR version : pending milliseconds since the last processed second
+    const uint64_t pending_ms = read_clock() - ((uint64_t)internal_time.seconds * 1000U);
+    return (uint32_t)(pending_ms * TIMEBASE_SUBTICKS_PER_MS);
+}
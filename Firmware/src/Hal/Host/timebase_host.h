@@ -0,0 +1,44 @@
+#ifndef TIMEBASE_HOST_HEADER
+#define TIMEBASE_HOST_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief clock source plugged behind the timebase (host HAL only)
+ * @return time elapsed since boot in milliseconds
+*/
+typedef uint64_t (*timebase_host_clock_t)(void);
+
+/**
+ * @brief replaces the clock source of the timebase.
+ * @param[in] clock : new clock source, NULL reverts to the built-in virtual clock
+*/
+void timebase_host_set_clock(timebase_host_clock_t clock);
+
+/**
+ * @brief tells whether the built-in virtual clock is in use (time only moves with timebase_host_advance_ms())
+*/
+bool timebase_host_is_virtual(void);
+
+/**
+ * @brief moves the built-in virtual clock forward (no effect when another clock is plugged in)
+ * @param[in] duration_ms : duration to be added, in milliseconds
+*/
+void timebase_host_advance_ms(const uint64_t duration_ms);
+
+/**
+ * @brief wall clock source, reading the host monotonic clock (time elapsed since its first call)
+*/
+uint64_t timebase_host_realtime_clock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMEBASE_HOST_HEADER */
@@ -0,0 +1,90 @@
+#include "Hal/uart.h"
+#include "Hal/timebase.h"
+#include "uart_host.h"
+
+#include "Arduino.h"
+#include "Core/byte_ring.h"
+
+#include <string.h>
+
+#define UART_BITS_PER_BYTE 10U /**> 8N1 : start and stop bits included */
+
+static uint8_t     tx_storage[UART_TX_RING_SIZE];
+static byte_ring_t tx_ring;
+static uint32_t    bytes_per_s = 0;
+static uint64_t    credit      = 0; // Line time not used yet, in thousandths of a byte
+static mcu_time_t  last_drain;
+
+// Line emulation : the bytes the line could have sent since the last call are handed to the serial shim
+static void drain(void)
+{
+    const mcu_time_t* now     = timebase_get_time();
+    const uint32_t    elapsed = time_elapsed_ms(&last_drain, now);
+    last_drain                = *now;
+
+    // An idle line does not save time up for later
+    if (byte_ring_count(&tx_ring) == 0U)
+    {
+        credit = 0;
+        return;
+    }
+
+    credit += (uint64_t)elapsed * bytes_per_s;
+    uint8_t byte;
+    while ((credit >= 1000U) && byte_ring_read(&tx_ring, &byte))
+    {
+        Serial.write(byte);
+        credit -= 1000U;
+    }
+}
+
+void uart_init(const uint32_t baudrate)
+{
+    byte_ring_init(&tx_ring, tx_storage, UART_TX_RING_SIZE);
+    bytes_per_s = baudrate / UART_BITS_PER_BYTE;
+    credit      = 0;
+    last_drain  = *timebase_get_time();
+    Serial.begin(baudrate);
+}
+
+bool uart_write(uint8_t const* const data, const uint16_t length)
+{
+    drain();
+    return byte_ring_write(&tx_ring, data, length);
+}
+
+bool uart_print(char const* const text)
+{
+    return uart_write((uint8_t const*)text, (uint16_t)strlen(text));
+}
+
+bool uart_print_flash(char const* const text)
+{
+    // No separate program memory on the host
+    drain();
+    return byte_ring_write_flash(&tx_ring, (uint8_t const*)text, (uint16_t)strlen(text));
+}
+
+int16_t uart_read(void)
+{
+    // Host input is not rate limited : the shim queue stands for the receive ring
+    drain();
+    return (int16_t)Serial.read();
+}
+
+void uart_get_stats(uart_stats_t* const stats)
+{
+    stats->tx_dropped_messages = tx_ring.dropped_writes;
+    stats->tx_dropped_bytes    = tx_ring.dropped_bytes;
+    stats->rx_dropped_bytes    = 0;
+}
+
+void uart_host_flush(void)
+{
+    uint8_t byte;
+    while (byte_ring_read(&tx_ring, &byte))
+    {
+        Serial.write(byte);
+    }
+    credit = 0;
+}
@@ -0,0 +1,20 @@
+#ifndef UART_HOST_HEADER
+#define UART_HOST_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief sends everything still pending in the transmit ring right away, whatever the baud rate (host HAL only).
+ * Bytes otherwise leave the ring at the baud rate, following the timebase : the ring fills up and drops messages
+ * just like it does on the MCU.
+*/
+void uart_host_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_HOST_HEADER */
@@ -0,0 +1,39 @@
+#include "cycle_counter.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+volatile static uint16_t overflows = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+    overflows++;
+}
+
+void cycle_counter_init(void)
+{
+    TCCR1A = 0;             // Normal mode
+    TCCR1B = (1 << CS10);   // No prescaler -> counts cpu cycles
+    TCNT1 = 0;
+    TIMSK1 |= (1 << TOIE1);
+}
+
+uint32_t cycle_counter_read(void)
+{
+    uint16_t high = 0;
+    uint16_t low = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        low = TCNT1;
+        high = overflows;
+
+        // Counter wrapped around but the ISR did not run yet
+        if ((TIFR1 & (1 << TOV1)) && (low < 0x8000U))
+        {
+            high++;
+        }
+    }
+    return ((uint32_t)high << 16U) | low;
+}
@@ -0,0 +1,26 @@
+#ifndef CYCLE_COUNTER_HEADER
+#define CYCLE_COUNTER_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief starts timer 1 as a free running counter clocked at the cpu frequency (no prescaler).
+ * Timer 1 overflows are counted in software to extend it to 32 bits (wraps every ~268 seconds @16MHz).
+*/
+void cycle_counter_init(void);
+
+/**
+ * @brief reads the current cycle count
+*/
+uint32_t cycle_counter_read(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYCLE_COUNTER_HEADER */
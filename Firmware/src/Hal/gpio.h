@@ -0,0 +1,120 @@
+#ifndef GPIO_HEADER
+#define GPIO_HEADER
+
+#ifndef __cplusplus
+#error "Hal/gpio.h is a C++ header (pins are template parameters)"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/io.h>
+#else
+#include "arduino_shim.h" // Mock IO registers
+#endif
+
+/**
+ * @brief direct register GPIO access, with pins known at compile time.
+ * Pins use the Arduino Nano numbering (0 - 7 : PORTD, 8 - 13 : PORTB, A0 - A5 (14 - 19) : PORTC), but unlike digitalRead()
+ * and digitalWrite() the port, bit and mask are all resolved by the compiler : no lookup tables, no PWM timer check,
+ * and each access compiles to a single sbi / cbi / sbic instruction on the AVR (read-modify-writes are spelled out : compound
+ * assignments to volatile are deprecated in C++20, the generated code is the same).
+ * On the host, the registers are the mock ones of the Arduino shim (@see Host/arduino_shim.h), so that the same code runs in tests.
+ * @code
+ * using motor_gpio = gpio_pin<2U>;
+ * motor_gpio::set_output();
+ * motor_gpio::write(true);
+ * @endcode
+ */
+
+/**
+ * @brief Atmega328p IO ports
+ */
+enum class gpio_port_t : uint8_t
+{
+    B, /**> D8 - D13        */
+    C, /**> A0 - A5         */
+    D, /**> D0 - D7         */
+};
+
+/**
+ * @brief registers of a port, as references so that constant addresses reach the instructions
+ */
+template <gpio_port_t PORT> struct gpio_registers;
+
+template <> struct gpio_registers<gpio_port_t::B>
+{
+    static inline volatile uint8_t& out() { return PORTB; }
+    static inline volatile uint8_t& in() { return PINB; }
+    static inline volatile uint8_t& ddr() { return DDRB; }
+};
+
+template <> struct gpio_registers<gpio_port_t::C>
+{
+    static inline volatile uint8_t& out() { return PORTC; }
+    static inline volatile uint8_t& in() { return PINC; }
+    static inline volatile uint8_t& ddr() { return DDRC; }
+};
+
+template <> struct gpio_registers<gpio_port_t::D>
+{
+    static inline volatile uint8_t& out() { return PORTD; }
+    static inline volatile uint8_t& in() { return PIND; }
+    static inline volatile uint8_t& ddr() { return DDRD; }
+};
+
+/**
+ * @brief single pin, Arduino Nano numbering
+ */
+template <uint8_t PIN> struct gpio_pin
+{
+    static_assert(PIN < 20U, "Only D0 - D13 and A0 - A5 are digital pins");
+
+    static constexpr gpio_port_t port = (PIN < 8U) ? gpio_port_t::D : ((PIN < 14U) ? gpio_port_t::B : gpio_port_t::C);
+    static constexpr uint8_t bit = (PIN < 8U) ? PIN : ((PIN < 14U) ? (uint8_t)(PIN - 8U) : (uint8_t)(PIN - 14U));
+    static constexpr uint8_t mask = (uint8_t)(1U << bit);
+
+    using registers = gpio_registers<port>;
+
+    /**
+     * @brief drives the pin (level is the one last written)
+     */
+    static inline void set_output() { registers::ddr() = registers::ddr() | mask; }
+
+    /**
+     * @brief high impedance input, pull-up disabled (the buttons have their own)
+     */
+    static inline void set_input()
+    {
+        registers::ddr() = registers::ddr() & (uint8_t)~mask;
+        registers::out() = registers::out() & (uint8_t)~mask;
+    }
+
+    static inline void set_high() { registers::out() = registers::out() | mask; }
+    static inline void set_low() { registers::out() = registers::out() & (uint8_t)~mask; }
+
+    static inline void write(const bool high)
+    {
+        if (high)
+        {
+            set_high();
+        }
+        else
+        {
+            set_low();
+        }
+    }
+
+    /**
+     * @brief input level. Outputs should not be read back : their state is known by whoever drives them
+     */
+    static inline bool read() { return (registers::in() & mask) != 0U; }
+
+    /**
+     * @brief output register, for drivers that batch several pins of a port in a single write (e.g. Core/led.h)
+     */
+    static inline volatile uint8_t* out_register() { return &registers::out(); }
+};
+
+#endif /* GPIO_HEADER */
@@ -10,18 +10,7 @@ extern "C"
 #include <stdint.h>
 #include <stdbool.h>
 
-/**
- * @brief this little structure embeds necessay data for
- * the board to permanently store settings and configurations.
- * This is meant to be written in EEPROM, hence it shall be preserved in between power cycles
-*/
-typedef struct
-{
-    uint8_t header;             /**> Constant header value. Used with Footer to know if EEPROM has already been written to or is blank (first boot)*/
-    int8_t target_temperature;  /**> Target temperature set point. Regular values range from -20 to 25 °Celsius                                    */
-    uint16_t current_threshold; /**> Fridge compressor current threshold (milliAmps). Used to discriminate stalled compressor conditions           */
-    uint8_t footer;             /**> Constant footer value. Used with Header to know if EEPROM has already been written to or is blank (first boot)*/
-} persistent_config_t;
+#include "Core/persistent_config.h"
 
 // Individual offsets are computed in order to access single values from the EEPROM if need be
 #define PERM_STORE_TGT_TEMP_IDX             offsetof(persistent_config_t, target_temperature)
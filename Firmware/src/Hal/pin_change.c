@@ -0,0 +1,34 @@
+#include "pin_change.h"
+#include "power.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+static volatile bool pending = false;
+
+// Any edge on a watched pin : bounces included, debouncing is done by the buttons driver
+ISR(PCINT2_vect)
+{
+    pending = true;
+    power_wake();
+}
+
+void pin_change_init(const uint8_t mask)
+{
+    PCMSK2 = mask;
+    PCIFR = (1 << PCIF2); // Drops a change that happened before the pins were watched
+    PCICR |= (1 << PCIE2);
+    pending = true;
+}
+
+bool pin_change_pending(void)
+{
+    bool changed;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        changed = pending;
+        pending = false;
+    }
+    return changed;
+}
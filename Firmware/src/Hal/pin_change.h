@@ -0,0 +1,29 @@
+#ifndef PIN_CHANGE_HEADER
+#define PIN_CHANGE_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief watches PORTD input pins (D0 - D7) with the pin change interrupt 2 (PCINT16 - PCINT23).
+ * The interrupt only flags the change and wakes the MCU up (@see power_wake()) : levels are read back by the main loop.
+ * The flag is raised right away, so that the initial levels get read as well.
+ * @param[in] mask : watched pins (bit n : Dn)
+*/
+void pin_change_init(const uint8_t mask);
+
+/**
+ * @brief tells whether a watched pin changed since the last call, and clears the flag
+*/
+bool pin_change_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIN_CHANGE_HEADER */
@@ -0,0 +1,54 @@
+#include "power.h"
+#include "timebase.h"
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <stdbool.h>
+
+#ifndef POWER_SLEEP_MODE
+#define POWER_SLEEP_MODE SLEEP_MODE_IDLE
+#endif
+
+static volatile bool wake_requested = false;
+
+void power_init(void)
+{
+    set_sleep_mode(POWER_SLEEP_MODE);
+}
+
+uint32_t power_idle(const uint16_t budget_ms)
+{
+    if (budget_ms == 0)
+    {
+        return 0;
+    }
+
+    const uint32_t start = timebase_get_subticks();
+    const uint32_t target = start + ((uint32_t)budget_ms * TIMEBASE_SUBTICKS_PER_MS);
+    uint32_t now = start;
+
+    while (now < target)
+    {
+        // sei() guarantees the next instruction (sleep) is executed before any pending interrupt,
+        // so we can't miss the wake up event in between.
+        cli();
+        if (wake_requested)
+        {
+            sei();
+            break;
+        }
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        now = timebase_get_subticks();
+    }
+
+    wake_requested = false;
+    return (now - start) * TIMEBASE_US_PER_SUBTICK;
+}
+
+void power_wake(void)
+{
+    wake_requested = true;
+}
@@ -0,0 +1,38 @@
+#ifndef POWER_HEADER
+#define POWER_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief configures the sleep mode used when the MCU idles.
+ * Defaults to SLEEP_MODE_IDLE, define POWER_SLEEP_MODE to override it.
+ * Note : timer 2 is clocked from the system clock, so deeper modes need to keep the main oscillator running
+ * (SLEEP_MODE_EXT_STANDBY) for the timebase to keep counting. USART and ADC are stopped in that mode.
+*/
+void power_init(void);
+
+/**
+ * @brief puts the MCU to sleep until the budget elapses.
+ * Timer 2 compare match (timebase, 1kHz) is used as the wake up source ; the MCU goes back to sleep
+ * after each interrupt until the budget is consumed, unless power_wake() was called.
+ * @param[in] budget_ms : sleep budget in milliseconds, returns immediately if 0
+ * @return time actually spent sleeping, in microseconds
+*/
+uint32_t power_idle(const uint16_t budget_ms);
+
+/**
+ * @brief cuts the ongoing (or next) power_idle() call short, so that the main loop runs right away.
+ * Meant to be called from the interrupts that need the main loop attention (e.g. pin change).
+*/
+void power_wake(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_HEADER */
@@ -0,0 +1,35 @@
+#include "pwm.h"
+#include "Arduino.h"
+
+#define PWM_TOP 124U        /**> Timer 2 TOP (OCR2A), set up by the timebase : 125 counts per period */
+#define PWM_DUTY_MAX 100U
+
+void pwm_init(void)
+{
+    // Output stays low until a duty cycle is set
+    DDRD |= (1 << DDD3);
+    PORTD &= ~(1 << PORTD3);
+    OCR2B = 0;
+
+    // Fast PWM, TOP = OCR2A (mode 7) : same counting sequence as CTC
+    TCCR2A |= (1 << WGM21) | (1 << WGM20);
+    TCCR2B |= (1 << WGM22);
+}
+
+void pwm_set_duty(const uint8_t duty)
+{
+    // OCR2B = 0 still outputs a single count pulse : disconnect the output instead
+    if (duty == 0U)
+    {
+        TCCR2A &= ~((1 << COM2B1) | (1 << COM2B0));
+        return;
+    }
+
+    // Output is high for OCR2B + 1 counts out of PWM_TOP + 1, OCR2B = TOP keeps it high
+    const uint8_t clamped = (duty > PWM_DUTY_MAX) ? PWM_DUTY_MAX : duty;
+    const uint16_t counts = (((uint16_t)clamped * (PWM_TOP + 1U)) + (PWM_DUTY_MAX / 2U)) / PWM_DUTY_MAX;
+    OCR2B = (uint8_t)(counts - 1U);
+
+    // Non inverting mode, (re)connected every time : Arduino's digitalWrite() disconnects it
+    TCCR2A |= (1 << COM2B1);
+}
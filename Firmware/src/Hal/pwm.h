@@ -0,0 +1,30 @@
+#ifndef PWM_HEADER
+#define PWM_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief configures OC2B (D3, status LED) as a hardware PWM output, sharing timer 2 with the timebase.
+ * Timer 2 is switched from CTC to fast PWM mode with OCR2A as TOP (mode 7) : it still counts from 0 to 124 and raises
+ * the compare A interrupt every millisecond, so the timebase is not affected, and OC2B outputs a 1kHz PWM signal.
+ * The output keeps running while the MCU sleeps (idle mode), without any CPU involvement.
+ * Note : needs to be called after timebase_init()
+*/
+void pwm_init(void);
+
+/**
+ * @brief changes the OC2B duty cycle. OCR2B is double buffered : the new value applies on the next period, without glitches.
+ * @param[in] duty : duty cycle (0 - 100), 0 disconnects the output so that the pin reads its PORT value (low)
+*/
+void pwm_set_duty(const uint8_t duty);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWM_HEADER */
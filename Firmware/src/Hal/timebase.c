@@ -1,6 +1,8 @@
 #include "timebase.h"
 #include "Arduino.h"
 
+#include <util/atomic.h>
+
 #define TCCR2B_PRESCALER_VALUE (1 << CS22) | (1 << CS20)
 
 // Used to count ticks 100 times a second
@@ -44,20 +46,59 @@ void timebase_reset(void)
     milliseconds = 0;
     TCNT2 = 0;
     TIMSK2 &= ~(1 << OCIE2A);
-    TCCR2A &= ~(1 << WGM21);
-    TCCR2B &= ~(TCCR2B_PRESCALER_VALUE);
+
+    // pwm_init() switches the timer to mode 7 and pwm_set_duty() connects OC2B : all of it goes back to the reset state
+    TCCR2A &= ~((1 << COM2B1) | (1 << COM2B0) | (1 << WGM21) | (1 << WGM20));
+    TCCR2B &= ~((1 << WGM22) | TCCR2B_PRESCALER_VALUE);
     OCR2A = 0;
+    OCR2B = 0;
 }
 
 
 void timebase_process(void)
 {
-    if (milliseconds >= 1000U)
+    uint16_t pending_ms = 0;
+
+    // Milliseconds might have run past 1000 if the loop was stalled (or sleeping) for a while,
+    // so carry the excess over instead of dropping it.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        while (milliseconds >= 1000U)
+        {
+            internal_time.seconds++;
+            milliseconds -= 1000U;
+        }
+        pending_ms = milliseconds;
+    }
+    internal_time.milliseconds = pending_ms;
+}
+
+uint32_t timebase_get_subticks(void)
+{
+    uint16_t pending_ms = 0;
+    uint8_t counter = 0;
+    bool overflow = false;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pending_ms = milliseconds;
+        // Compare match happened but the ISR did not run yet : counter was already cleared.
+        // Flag first, so that a match in between the two reads does not add a tick to a counter that already wrapped
+        overflow = (TIFR2 & (1 << OCF2A)) != 0;
+        counter = TCNT2;
+        if (!overflow && ((TIFR2 & (1 << OCF2A)) != 0))
+        {
+            // Match right after the flag read : the counter may be either side of it, read it again past the match
+            overflow = true;
+            counter = TCNT2;
+        }
+    }
+
+    if (overflow)
     {
-        internal_time.seconds++;
-        milliseconds = 0;
+        pending_ms++;
     }
-    internal_time.milliseconds = milliseconds;
+    return ((uint32_t)pending_ms * TIMEBASE_SUBTICKS_PER_MS) + counter;
 }
 
 const mcu_time_t * timebase_get_time(void)
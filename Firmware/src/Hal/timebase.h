@@ -9,6 +9,9 @@ extern "C"
 #include <stdint.h>
 #include "Core/mcu_time.h"
 
+#define TIMEBASE_SUBTICKS_PER_MS 125U   /**> Timer 2 counts per millisecond (16MHz / 128 prescaler / 1kHz) */
+#define TIMEBASE_US_PER_SUBTICK 8U      /**> Duration of a single timer 2 count in microseconds            */
+
 /**
  * @brief initialises timebase and starts timer 2
 */
@@ -26,7 +29,15 @@ void timebase_process(void);
 const mcu_time_t *  timebase_get_time(void);
 
 /**
- * @brief resets internal time back to 0 and reverts timer 2 to its original condition.
+ * @brief Retrieves a fine grained timestamp built from pending milliseconds and timer 2 counter.
+ * @note : this counter is only monotonic in between two calls to timebase_process(), which
+ * is enough to measure short durations (e.g. time spent sleeping).
+ * @return timestamp, in TIMEBASE_US_PER_SUBTICK units
+*/
+uint32_t timebase_get_subticks(void);
+
+/**
+ * @brief resets internal time back to 0 and reverts timer 2 to its original condition (PWM mode and OC2B output included, @see pwm_init()).
 */
 void timebase_reset(void);
 
@@ -0,0 +1,109 @@
+#include "uart.h"
+#include "power.h"
+
+#include "Core/byte_ring.h"
+#include "Core/flash.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <string.h>
+#include <util/atomic.h>
+
+static uint8_t tx_storage[UART_TX_RING_SIZE];
+static uint8_t rx_storage[UART_RX_RING_SIZE];
+static byte_ring_t tx_ring;
+static byte_ring_t rx_ring;
+
+// Transmit ring is only read from here : interrupts are off, and the main loop only ever adds to it
+ISR(USART_UDRE_vect)
+{
+    uint8_t byte;
+    if (byte_ring_read(&tx_ring, &byte))
+    {
+        UDR0 = byte;
+    }
+    else
+    {
+        // Nothing left to send, re-enabled by the next write
+        UCSR0B &= ~(1 << UDRIE0);
+    }
+}
+
+ISR(USART_RX_vect)
+{
+    // Reading UDR0 clears the interrupt, even if the byte is dropped
+    const uint8_t byte = UDR0;
+    byte_ring_write(&rx_ring, &byte, 1U);
+    power_wake();
+}
+
+void uart_init(const uint32_t baudrate)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        byte_ring_init(&tx_ring, tx_storage, UART_TX_RING_SIZE);
+        byte_ring_init(&rx_ring, rx_storage, UART_RX_RING_SIZE);
+
+        // Double speed mode, rounded to the nearest divider (same as Arduino's HardwareSerial)
+        UCSR0A = (1 << U2X0);
+        UBRR0 = (uint16_t)((((F_CPU / 4UL) / baudrate) - 1UL) / 2UL);
+        UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+        UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+    }
+}
+
+bool uart_write(uint8_t const *const data, const uint16_t length)
+{
+    bool queued;
+    // 16 bits ring indices are shared with the interrupt. Copying a log line takes a few tens of microseconds
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        queued = byte_ring_write(&tx_ring, data, length);
+        if (queued)
+        {
+            UCSR0B |= (1 << UDRIE0);
+        }
+    }
+    return queued;
+}
+
+bool uart_print(char const *const text)
+{
+    return uart_write((uint8_t const *)text, (uint16_t)strlen(text));
+}
+
+bool uart_print_flash(char const *const text)
+{
+    const uint16_t length = (uint16_t)FLASH_STRLEN(text);
+    bool queued;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        queued = byte_ring_write_flash(&tx_ring, (uint8_t const *)text, length);
+        if (queued)
+        {
+            UCSR0B |= (1 << UDRIE0);
+        }
+    }
+    return queued;
+}
+
+int16_t uart_read(void)
+{
+    uint8_t byte;
+    bool received;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        received = byte_ring_read(&rx_ring, &byte);
+    }
+    return received ? (int16_t)byte : -1;
+}
+
+void uart_get_stats(uart_stats_t *const stats)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        stats->tx_dropped_messages = tx_ring.dropped_writes;
+        stats->tx_dropped_bytes = tx_ring.dropped_bytes;
+        stats->rx_dropped_bytes = rx_ring.dropped_bytes;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef UART_HEADER
+#define UART_HEADER
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief non blocking serial port (USART0), replaces Arduino's Serial.
+ * Writes only copy the message into a RAM ring (@see Core/byte_ring.h), the USART data register empty interrupt sends it
+ * in the background. When the ring is full the message is dropped as a whole and counted : the main loop never waits on the line
+ * (a 50 bytes log line takes 52ms at 9600 bauds). Received bytes are queued by the receive interrupt, which also wakes the
+ * main loop up (@see power_wake()).
+ * Note : owns the USART interrupts, Serial can't be used alongside.
+ */
+
+// clang-format off
+#ifndef UART_TX_RING_SIZE
+#if TRACE_ENABLED == 1
+#define UART_TX_RING_SIZE 512U /**> Transmit ring (bytes, power of two) : a whole trace sync record (pipeline snapshot)    */
+#else
+#define UART_TX_RING_SIZE 256U /**> Transmit ring (bytes, power of two) : one periodic debug report (about 250 bytes)     */
+#endif
+#endif
+#ifndef UART_RX_RING_SIZE
+#define UART_RX_RING_SIZE 16U  /**> Receive ring (bytes, power of two) : commands are a few characters long              */
+#endif
+// clang-format on
+
+#if ((UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1U)) != 0U) || ((UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1U)) != 0U)
+#error "UART_TX_RING_SIZE and UART_RX_RING_SIZE must be powers of two"
+#endif
+
+/**
+ * @brief messages and bytes lost since uart_init(), all counters saturate
+ */
+typedef struct
+{
+    uint16_t tx_dropped_messages; /**> Writes dropped because the transmit ring was full          */
+    uint16_t tx_dropped_bytes;    /**> Bytes of those writes                                      */
+    uint16_t rx_dropped_bytes;    /**> Received bytes lost because the main loop did not read them */
+} uart_stats_t;
+
+/**
+ * @brief configures USART0 (8N1) and empties the rings. Can be called again to change the baud rate.
+ * @param[in] baudrate : line speed (bauds)
+ */
+void uart_init(const uint32_t baudrate);
+
+/**
+ * @brief queues a message for transmission, never blocks
+ * @return false if the message did not fit in the transmit ring : it was dropped as a whole
+ */
+bool uart_write(uint8_t const *const data, const uint16_t length);
+
+/**
+ * @brief queues a null terminated string (@see uart_write())
+ */
+bool uart_print(char const *const text);
+
+/**
+ * @brief queues a null terminated string kept in flash (FLASH_STRING(), @see Core/flash.h), never blocks (@see uart_write())
+ */
+bool uart_print_flash(char const *const text);
+
+/**
+ * @brief takes the oldest received byte
+ * @return received byte, or -1 if none is pending
+ */
+int16_t uart_read(void);
+
+/**
+ * @brief reads the drop counters
+ */
+void uart_get_stats(uart_stats_t *const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_HEADER */
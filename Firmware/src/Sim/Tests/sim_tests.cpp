@@ -0,0 +1,537 @@
+#include <gtest/gtest.h>
+
+#include "Core/thermistor_ntc_100k_3950K.h"
+#include "closed_loop.h"
+#include "fleet.h"
+#include "fridge_model.h"
+#include "sensor_models.h"
+#include "thread_pool.h"
+#include "trace_replay.h"
+#include "tuner.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+class FridgeModelFixture : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        fridge_params_default(&params);
+        fridge_model_init(&state, 20.0);
+    }
+
+    void run(const bool motor_cmd, const double duration_s)
+    {
+        for (double t = 0.0; t < duration_s; t += 1.0)
+        {
+            fridge_model_step(&params, &state, motor_cmd, 20.0, false, 0.0, 1.0);
+        }
+    }
+
+    fridge_params_t params;
+    fridge_state_t  state;
+};
+
+TEST_F(FridgeModelFixture, thermal_test)
+{
+    // Compressor off : stays at ambient temperature, no energy drawn
+    run(false, 3600.0);
+    ASSERT_NEAR(state.cabinet_c, 20.0, 1e-6);
+    ASSERT_EQ(state.energy_j, 0.0);
+
+    // Running pulls the cabinet down
+    run(true, 4.0 * 3600.0);
+    ASSERT_LT(state.cabinet_c, 4.0);
+    ASSERT_LT(state.evaporator_c, state.cabinet_c);
+    ASSERT_EQ(state.starts, 1U);
+    ASSERT_EQ(state.stalls, 0U);
+
+    // Steady power is about V x I x PF (inrush only lasts for a second)
+    const double expected_j = params.mains_voltage_v * params.running_current_a * params.power_factor * 4.0 * 3600.0;
+    ASSERT_NEAR(state.energy_j, expected_j, expected_j * 0.05);
+
+    // And it warms back up once stopped
+    const double cold = state.cabinet_c;
+    run(false, 3600.0);
+    ASSERT_GT(state.cabinet_c, cold + 1.0);
+}
+
+TEST_F(FridgeModelFixture, compressor_current_test)
+{
+    ASSERT_EQ(fridge_model_current_rms(&params, &state, 0.0), 0.0);
+
+    run(true, 1.0);
+    // Inrush decays in a fraction of a second
+    ASSERT_GT(fridge_model_current_rms(&params, &state, -1.0), params.running_current_a * 3.0);
+    run(true, 120.0);
+    ASSERT_NEAR(fridge_model_current_rms(&params, &state, 0.0), params.running_current_a, params.running_current_a * 0.05);
+    ASSERT_GT(state.head_pressure, 0.9);
+}
+
+TEST_F(FridgeModelFixture, stall_test)
+{
+    run(true, 600.0);
+
+    // Immediate restart : pressure did not equalize, rotor is locked
+    run(false, 10.0);
+    run(true, 1.0);
+    ASSERT_TRUE(state.stalled);
+    ASSERT_EQ(state.stalls, 1U);
+    ASSERT_EQ(fridge_model_current_rms(&params, &state, 0.0), params.running_current_a * params.locked_rotor_ratio);
+    const double cooling = state.cooling_j;
+
+    // Overload protector eventually cuts the compressor off, then lets it restart (pressure is equalized by then)
+    run(true, params.overload_trip_s);
+    ASSERT_EQ(state.overload_trips, 1U);
+    ASSERT_FALSE(state.running);
+    ASSERT_EQ(state.cooling_j, cooling);
+
+    run(true, params.overload_reset_s + 1.0);
+    ASSERT_TRUE(state.running);
+    ASSERT_FALSE(state.stalled);
+    ASSERT_EQ(state.stalls, 1U);
+
+    // Waiting long enough before restarting does not stall
+    run(false, 5.0 * params.pressure_equalization_time_s);
+    run(true, 1.0);
+    ASSERT_FALSE(state.stalled);
+}
+
+TEST(SensorModelTests, sensor_models_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+
+    // Precomputed boundaries give the same codes as the direct model
+    sensor_model_ntc_t ntc;
+    sensor_model_ntc_init(&ntc, &config.hardware, &thermistor_ntc_100k_3950K_data);
+    for (double t = 30.0; t > -30.0; t -= 0.07)
+    {
+        ASSERT_EQ(sensor_model_ntc_read(&ntc, t), sensor_model_temperature_adc(&config.hardware, &thermistor_ntc_100k_3950K_data, t));
+    }
+
+    // Round trip through the firmware temperature pipeline (resolution is 1°C, with some ADC scaling bias)
+    for (int8_t t = -20; t <= 20; t++)
+    {
+        const uint16_t raw = sensor_model_temperature_adc(&config.hardware, &thermistor_ntc_100k_3950K_data, t);
+        ASSERT_NEAR(sensors_temperature_from_adc(&config.sensors, &thermistor_ntc_100k_3950K_data, raw), t, 2);
+    }
+
+    // Current pipeline (ADC scaling leaves a small DC offset, removed by the RMS computation)
+    const int16_t offset = sensors_current_from_adc(&config.sensors, sensor_model_current_adc(&config.hardware, 0.0));
+    ASSERT_NEAR(offset, 0, 25);
+    ASSERT_NEAR(sensors_current_from_adc(&config.sensors, sensor_model_current_adc(&config.hardware, 0.5)) - offset, 500, 25);
+    ASSERT_EQ(sensor_model_current_adc(&config.hardware, 100.0), SENSORS_ADC_RESOLUTION - 1U);
+}
+
+TEST(ClosedLoopTests, closed_loop_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.duration_s = 4.0 * 86400.0;
+
+    closed_loop_report_t report;
+    closed_loop_run(&config, &report);
+
+    ASSERT_EQ(report.simulated_s, 3.0 * 86400.0);
+    ASSERT_GT(report.starts_per_hour, 0.1);
+    ASSERT_LT(report.starts_per_hour, 4.0);
+    ASSERT_GT(report.duty_cycle, 0.05);
+    ASSERT_LT(report.duty_cycle, 0.8);
+    ASSERT_GT(report.cabinet_min_c, -3.0);
+    ASSERT_LT(report.cabinet_max_c, 10.0);
+    ASSERT_EQ(report.stalls, 0U);
+    ASSERT_GT(report.energy_kwh, 0.0);
+
+    // Runs are reproducible
+    closed_loop_report_t again;
+    closed_loop_run(&config, &again);
+    ASSERT_EQ(report.starts, again.starts);
+    ASSERT_EQ(report.energy_kwh, again.energy_kwh);
+}
+
+TEST(ClosedLoopTests, temperature_filter_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.duration_s                   = 4.0 * 86400.0;
+    config.app.adaptive_hysteresis      = 0U;
+    config.hardware.ntc_noise_lsb       = 2.0;
+    config.hardware.ntc_spikes_per_hour = 6.0;
+    config.hardware.ntc_spike_lsb       = 40.0;
+
+    // Noisy raw readings switch the compressor before the threshold is actually crossed
+    closed_loop_report_t raw;
+    config.temperature_filter = false;
+    closed_loop_run(&config, &raw);
+    ASSERT_GT(raw.premature_starts + raw.premature_stops, 10U);
+
+    // Filtered : no premature switch, fewer starts
+    closed_loop_report_t filtered;
+    config.temperature_filter = true;
+    closed_loop_run(&config, &filtered);
+    ASSERT_EQ(filtered.premature_starts + filtered.premature_stops, 0U);
+    ASSERT_LT(filtered.starts, raw.starts);
+}
+
+TEST(ClosedLoopTests, door_detection_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.duration_s                   = 8.0 * 86400.0;
+    config.hardware.ntc_noise_lsb       = 2.0;
+    config.hardware.ntc_spikes_per_hour = 6.0;
+    config.hardware.ntc_spike_lsb       = 40.0;
+
+    // Door openings warm the probe up way faster than the cabinet contents : some starts don't help them
+    closed_loop_report_t plain;
+    config.app.transient_detection = 0U;
+    closed_loop_run(&config, &plain);
+    ASSERT_GT(plain.door_openings, 100U);
+    ASSERT_GT(plain.needless_starts, 10U);
+    ASSERT_EQ(plain.starts_held, 0U);
+
+    // Most of them are held until the spike went away
+    closed_loop_report_t detected;
+    config.app.transient_detection = 1U;
+    closed_loop_run(&config, &detected);
+    ASSERT_LT(detected.needless_starts * 2U, plain.needless_starts);
+    ASSERT_GT(detected.starts_avoided, detected.starts_released);
+    ASSERT_EQ(detected.starts_held, detected.starts_avoided + detected.starts_released);
+
+    // Reading noise and spurious readings alone are not mistaken for door openings
+    closed_loop_report_t closed;
+    config.environment.door_openings_per_day = 0.0;
+    closed_loop_run(&config, &closed);
+    ASSERT_EQ(closed.starts_held, 0U);
+}
+
+TEST(ClosedLoopTests, adaptive_sampling_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.duration_s                   = 8.0 * 86400.0;
+    config.hardware.ntc_noise_lsb       = 2.0;
+    config.hardware.ntc_spikes_per_hour = 6.0;
+    config.hardware.ntc_spike_lsb       = 40.0;
+
+    closed_loop_report_t fixed;
+    config.adaptive_sampling = false;
+    closed_loop_run(&config, &fixed);
+    ASSERT_NEAR(fixed.reads_per_hour, 3600.0, 1.0);
+
+    // Way fewer conversions, the regulation and the door openings detection barely notice
+    closed_loop_report_t adaptive;
+    config.adaptive_sampling = true;
+    closed_loop_run(&config, &adaptive);
+    ASSERT_LT(adaptive.temperature_reads * 2U, fixed.temperature_reads);
+    ASSERT_LE(adaptive.needless_starts, fixed.needless_starts + fixed.needless_starts / 4U + 2U);
+    ASSERT_LE(adaptive.premature_starts, fixed.premature_starts + 2U);
+    ASSERT_LT(adaptive.out_of_band_ratio, fixed.out_of_band_ratio + 0.01);
+}
+
+TEST(ClosedLoopTests, tariff_scheduling_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.duration_s          = 30.0 * 86400.0;
+    config.clock_drift_ppm     = 2000.0;
+    config.clock_sync_period_s = 86400.0;
+
+    // Without a host, the firmware has no time of day : scheduling changes nothing
+    closed_loop_report_t regular;
+    closed_loop_report_t unsynced;
+    config.app.scheduling      = 1U;
+    config.clock_sync_period_s = 0.0;
+    closed_loop_run(&config, &unsynced);
+    config.app.scheduling = 0U;
+    closed_loop_run(&config, &regular);
+    ASSERT_EQ(unsynced.starts, regular.starts);
+    ASSERT_DOUBLE_EQ(unsynced.energy_cost, regular.energy_cost);
+    ASSERT_EQ(unsynced.max_clock_error_s, 0.0);
+
+    // Daily synchronization : drift learnt, cheaper energy, the cabinet stays within reason
+    closed_loop_report_t scheduled;
+    config.app.scheduling      = 1U;
+    config.clock_sync_period_s = 86400.0;
+    closed_loop_run(&config, &scheduled);
+    ASSERT_NEAR(scheduled.clock_drift_ppm, 2000, 20);
+    ASSERT_LE(scheduled.max_clock_error_s, 3.0);
+    ASSERT_LT(scheduled.peak_energy_ratio, regular.peak_energy_ratio);
+    ASSERT_LT(scheduled.energy_cost, regular.energy_cost);
+    ASSERT_GT(scheduled.cabinet_min_c, regular.cabinet_min_c - 1.5);
+    ASSERT_LT(scheduled.cabinet_max_c, regular.cabinet_max_c + 1.5);
+}
+
+TEST(ThreadPoolTests, thread_pool_test)
+{
+    thread_pool pool(4U);
+    ASSERT_EQ(pool.worker_count(), 4U);
+
+    // Tasks can submit subtasks, wait() returns once all of them ran
+    std::atomic<uint32_t> count{0};
+    for (uint32_t i = 0; i < 100U; i++)
+    {
+        pool.submit([&pool, &count] {
+            for (uint32_t j = 0; j < 10U; j++)
+            {
+                pool.submit([&count] { count.fetch_add(1U); });
+            }
+            count.fetch_add(1U);
+        });
+    }
+    pool.wait();
+    ASSERT_EQ(count.load(), 1100U);
+
+    // Pool can be reused
+    pool.submit([&count] { count.fetch_add(1U); });
+    pool.wait();
+    ASSERT_EQ(count.load(), 1101U);
+}
+
+TEST(FleetTests, fleet_test)
+{
+    fleet_config_t config;
+    fleet_config_default(&config);
+    config.devices         = 6U;
+    config.base.duration_s = 1.5 * 86400.0;
+    config.base.warmup_s   = 0.5 * 86400.0;
+
+    // Devices differ from one another, but always draw the same parameters
+    closed_loop_config_t first;
+    closed_loop_config_t second;
+    closed_loop_config_t again;
+    fleet_draw_device(&config, 0U, &first);
+    fleet_draw_device(&config, 1U, &second);
+    fleet_draw_device(&config, 0U, &again);
+    ASSERT_NE(first.environment.ambient_mean_c, second.environment.ambient_mean_c);
+    ASSERT_NE(first.seed, second.seed);
+    ASSERT_EQ(first.environment.ambient_mean_c, again.environment.ambient_mean_c);
+    ASSERT_EQ(first.hardware.ntc_resistance_ratio, again.hardware.ntc_resistance_ratio);
+    ASSERT_EQ(first.sensors.vcc_mv, config.base.sensors.vcc_mv);
+
+    // Results don't depend on the threads count
+    std::vector<closed_loop_report_t> single;
+    std::vector<closed_loop_report_t> multi;
+    fleet_report_t report;
+    config.threads = 1U;
+    fleet_run(&config, &report, &single);
+    config.threads = 3U;
+    fleet_run(&config, &report, &multi);
+
+    ASSERT_EQ(report.devices, 6U);
+    ASSERT_EQ(report.threads, 3U);
+    ASSERT_DOUBLE_EQ(report.device_hours, 6U * 36.0);
+    ASSERT_GT(report.device_hours_per_s, 0.0);
+    ASSERT_LE(report.starts_per_hour.min, report.starts_per_hour.median);
+    ASSERT_LE(report.starts_per_hour.median, report.starts_per_hour.max);
+    for (uint32_t i = 0; i < config.devices; i++)
+    {
+        ASSERT_EQ(single[i].starts, multi[i].starts);
+        ASSERT_EQ(single[i].energy_kwh, multi[i].energy_kwh);
+    }
+}
+
+TEST(FleetTests, distribution_test)
+{
+    fleet_distribution_t distribution;
+    std::vector<double> values;
+    for (int i = 100; i >= 0; i--)
+    {
+        values.push_back(i);
+    }
+    fleet_distribution(values, &distribution);
+    ASSERT_EQ(distribution.min, 0.0);
+    ASSERT_EQ(distribution.p10, 10.0);
+    ASSERT_EQ(distribution.median, 50.0);
+    ASSERT_EQ(distribution.p90, 90.0);
+    ASSERT_EQ(distribution.max, 100.0);
+    ASSERT_EQ(distribution.mean, 50.0);
+}
+
+TEST(TunerTests, tuner_test)
+{
+    tuner_config_t config;
+    tuner_config_default(&config);
+    config.fleet.devices         = 2U;
+    config.fleet.threads         = 2U;
+    config.fleet.base.duration_s = 2.0 * 86400.0;
+    config.fleet.base.warmup_s   = 0.5 * 86400.0;
+    config.grid_points           = 2U;
+    config.max_iterations        = 3U;
+
+    // Only explores the hysteresis window
+    const tuner_candidate_t defaults = tuner_candidate_default();
+    for (uint8_t p = TUNER_PARAM_STALLED_CURRENT_MULTIPLIER_PERCENT; p < TUNER_PARAM_COUNT; p++)
+    {
+        config.ranges[p] = {defaults[p], defaults[p], 1};
+    }
+
+    tuner explorer(config);
+    const tuner_result_t baseline = explorer.evaluate({defaults}).front();
+    ASSERT_GT(baseline.kwh_per_day, 0.0);
+    ASSERT_GT(baseline.starts_per_hour, 0.0);
+    ASSERT_GT(baseline.temperature_rms_c, 0.0);
+
+    const tuner_result_t grid = explorer.grid_search();
+    ASSERT_EQ(explorer.ranked().size(), 5U);
+    ASSERT_EQ(explorer.ranked().front().candidate, grid.candidate);
+
+    // Evaluations are cached
+    ASSERT_EQ(explorer.evaluate({defaults}).front().cost, baseline.cost);
+    ASSERT_EQ(explorer.ranked().size(), 5U);
+
+    const tuner_result_t descent = explorer.coordinate_descent(defaults);
+    ASSERT_LE(descent.cost, baseline.cost);
+
+    const std::vector<tuner_result_t> ranked = explorer.ranked();
+    for (size_t i = 1; i < ranked.size(); i++)
+    {
+        ASSERT_LE(ranked[i - 1].cost, ranked[i].cost);
+    }
+
+    // Candidates are applied to the firmware runtime parameters
+    app_params_t params;
+    tuner_apply(ranked.front().candidate, &params);
+    ASSERT_EQ(params.temp_hysteresis_high, ranked.front().candidate[TUNER_PARAM_TEMP_HYSTERESIS_HIGH]);
+    ASSERT_EQ(params.stalled_motor_wait_seconds, STALLED_MOTOR_WAIT_SECONDS);
+
+    const std::string path = "tuner_test_params.h";
+    ASSERT_TRUE(tuner_write_header(path, ranked.front()));
+    std::ifstream file(path);
+    std::stringstream header;
+    header << file.rdbuf();
+    std::remove(path.c_str());
+
+    char expected[64];
+    snprintf(expected, sizeof(expected), "#define TEMP_HYSTERESIS_HIGH %uU\n", (unsigned int)ranked.front().candidate[TUNER_PARAM_TEMP_HYSTERESIS_HIGH]);
+    ASSERT_NE(header.str().find(expected), std::string::npos);
+    ASSERT_NE(header.str().find("#define STALLED_MOTOR_WAIT_MINUTES 5U\n"), std::string::npos);
+}
+
+static void write_to_vector(uint8_t const* data, const uint8_t length, void* context)
+{
+    std::vector<uint8_t>* const output = static_cast<std::vector<uint8_t>*>(context);
+    output->insert(output->end(), data, data + length);
+}
+
+static void write_file(const std::string& path, std::vector<uint8_t> const& contents)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(contents.data()), (std::streamsize)contents.size());
+}
+
+TEST(TraceReplayTests, trace_replay_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.duration_s        = 2.0 * 86400.0;
+    config.warmup_s          = 0.0;
+    config.adaptive_sampling = false; // One step per second
+
+    std::vector<uint8_t> recording;
+    trace_encoder_t encoder;
+    trace_encoder_init(&encoder, write_to_vector, &recording);
+    closed_loop_report_t closed_loop_report;
+    closed_loop_run(&config, &closed_loop_report, &encoder);
+    ASSERT_GT(closed_loop_report.starts, 2U);
+
+    const std::string path = "trace_replay_test.bin";
+    write_file(path, recording);
+
+    trace_file file;
+    ASSERT_TRUE(file.open(path));
+    ASSERT_EQ(file.size(), recording.size());
+    ASSERT_EQ(file.skipped_bytes(), 0U);
+    ASSERT_EQ(file.index().size(), 2U * 86400U / TRACE_SYNC_PERIOD_S);
+    ASSERT_EQ(file.start_ms(), 0U);
+
+    // Whole trace : same motor starts as the simulation, bit-exact
+    uint32_t starts = 0;
+    trace_replay_report_t report;
+    trace_replay_run(file, config.sensors, 0U, UINT64_MAX, &report,
+                     [&starts](mcu_time_t const&, app_outputs_t const& outputs, pipeline_t const&) {
+                         starts += (outputs.events & APP_EVENT_MOTOR_STARTED) ? 1U : 0U;
+                     });
+    ASSERT_FALSE(report.diverged);
+    ASSERT_EQ(report.records, file.record_count());
+    ASSERT_EQ(report.steps, 2U * 86400U);
+    ASSERT_EQ(report.syncs, file.index().size() - 1U);
+    ASSERT_EQ(starts, closed_loop_report.starts);
+
+    // Seeks to the last sync record before the requested time
+    const uint64_t from_ms = 86400U * 1000U + 30000U;
+    ASSERT_EQ(file.seek(from_ms), file.index()[86400U / TRACE_SYNC_PERIOD_S].offset);
+    trace_replay_run(file, config.sensors, from_ms, from_ms + 3600U * 1000U, &report);
+    ASSERT_FALSE(report.diverged);
+    ASSERT_EQ(report.start_ms, 86400U * 1000U);
+    ASSERT_LE(report.end_ms, from_ms + 3600U * 1000U);
+    ASSERT_EQ(report.steps, 3600U + 30U); // Sync records are written after the step sharing their time
+
+    // Firmware assuming other sensors : outputs diverge from the recording
+    sensors_config_t sensors = config.sensors;
+    sensors.upper_resistance = 200U;
+    trace_replay_run(file, sensors, 0U, UINT64_MAX, &report);
+    ASSERT_TRUE(report.diverged);
+    ASSERT_GT(report.snapshot_mismatches, 0U);
+
+    // Corrupted bytes are skipped up to the next sync record, replay goes on from there
+    std::vector<uint8_t> corrupted = recording;
+    const size_t middle = file.index()[1000].offset + TRACE_SYNC_HEADER_SIZE + PIPELINE_SNAPSHOT_SIZE + 40U;
+    corrupted.insert(corrupted.begin() + (std::ptrdiff_t)middle, {0xBF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    write_file(path, corrupted);
+    ASSERT_TRUE(file.open(path));
+    ASSERT_GT(file.skipped_bytes(), 0U);
+    ASSERT_EQ(file.index().size(), 2U * 86400U / TRACE_SYNC_PERIOD_S);
+    trace_replay_run(file, config.sensors, 0U, UINT64_MAX, &report);
+    ASSERT_EQ(report.skipped_bytes, file.skipped_bytes());
+    ASSERT_EQ(report.syncs, file.index().size() - 2U);
+    ASSERT_EQ(report.snapshot_mismatches, 0U);
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST(TraceReplayTests, wall_clock_replay_test)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.duration_s          = 86400.0;
+    config.warmup_s            = 0.0;
+    config.clock_drift_ppm     = -1500.0;
+    config.clock_sync_period_s = 4.0 * 3600.0;
+
+    std::vector<uint8_t> recording;
+    trace_encoder_t encoder;
+    trace_encoder_init(&encoder, write_to_vector, &recording);
+    closed_loop_report_t closed_loop_report;
+    closed_loop_run(&config, &closed_loop_report, &encoder);
+
+    const std::string path = "wall_clock_replay_test.bin";
+    write_file(path, recording);
+    trace_file file;
+    ASSERT_TRUE(file.open(path));
+
+    // Host synchronizations are part of the trace : the schedule replays bit-exact
+    bool peak = false;
+    trace_replay_report_t report;
+    trace_replay_run(file, config.sensors, 0U, UINT64_MAX, &report,
+                     [&peak](mcu_time_t const&, app_outputs_t const&, pipeline_t const& pipeline) {
+                         peak = peak || (pipeline.app.schedule == SCHEDULE_PEAK);
+                     });
+    ASSERT_FALSE(report.diverged);
+    ASSERT_EQ(report.snapshot_mismatches, 0U);
+    ASSERT_TRUE(peak);
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
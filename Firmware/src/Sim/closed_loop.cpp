@@ -0,0 +1,330 @@
+#include "closed_loop.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+#include "Core/pipeline.h"
+#include "Core/thermistor_ntc_100k_3950K.h"
+#include "sensor_models.h"
+
+#define CLOSED_LOOP_MAINS_FREQUENCY_HZ 50U
+#define CLOSED_LOOP_PREMATURE_MARGIN_Q8 64 /**> Decisions closer than 0.25°C to their threshold are not counted as premature */
+
+void closed_loop_config_default(closed_loop_config_t* config)
+{
+    config->duration_s = 365.0 * 86400.0;
+    config->warmup_s   = 86400.0;
+    config->seed       = 1U;
+    fridge_params_default(&config->fridge);
+    environment_params_default(&config->environment);
+
+    // Same as the firmware board
+    config->sensors.vcc_mv             = 5000U;
+    config->sensors.upper_resistance   = 330U;
+    config->sensors.current_dc_bias_mv = 2390;
+    sensor_hardware_nominal(&config->hardware, &config->sensors);
+
+    app_params_default(&config->app);
+    config->temperature_filter = (PIPELINE_TEMPERATURE_FILTER != 0U);
+    kalman_params_default(&config->filter);
+    config->adaptive_sampling = (PIPELINE_ADAPTIVE_SAMPLING != 0U);
+    sampling_params_default(&config->sampling);
+    persistent_config_default(&config->config);
+
+    // Same peak hours as the firmware schedule, no host to synchronize its wall clock
+    config->clock_drift_ppm       = 0.0;
+    config->clock_sync_period_s   = 0.0;
+    config->tariff.peak_start_h   = SCHEDULE_PEAK_START_MINUTE / 60.0;
+    config->tariff.peak_end_h     = SCHEDULE_PEAK_END_MINUTE / 60.0;
+    config->tariff.peak_price     = 0.40;
+    config->tariff.off_peak_price = 0.20;
+}
+
+/**
+ * @brief MCU time at a given simulation time : the MCU clock runs off by the drift
+ */
+static void mcu_time_at(const double now_s, const double drift_ppm, mcu_time_t* time)
+{
+    const uint64_t ms   = (uint64_t)std::llround(now_s * 1000.0 * (1.0 + drift_ppm * 1e-6));
+    time->seconds      = (uint32_t)(ms / 1000U);
+    time->milliseconds = (uint16_t)(ms % 1000U);
+}
+
+static bool is_peak_hour(tariff_t const* tariff, const double now_s)
+{
+    const double hour = std::fmod(now_s, 86400.0) / 3600.0;
+    if (tariff->peak_start_h <= tariff->peak_end_h)
+    {
+        return (hour >= tariff->peak_start_h) && (hour < tariff->peak_end_h);
+    }
+    return (hour >= tariff->peak_start_h) || (hour < tariff->peak_end_h);
+}
+
+/**
+ * @brief feeds one mains period worth of current samples to the Core pipeline, like the firmware does at 1kHz
+ */
+static void sample_current(closed_loop_config_t const* config, fridge_state_t const* fridge, pipeline_t* pipeline,
+                           double const (&sine)[CURRENT_MEASURE_SAMPLES_PER_SINE], trace_encoder_t* trace, mcu_time_t const* time)
+{
+    for (uint8_t i = 0; i < CURRENT_MEASURE_SAMPLES_PER_SINE; i++)
+    {
+        const double offset_s  = (double)i / (CURRENT_MEASURE_SAMPLES_PER_SINE * CLOSED_LOOP_MAINS_FREQUENCY_HZ);
+        const double current_a = fridge_model_current_rms(&config->fridge, fridge, offset_s) * sine[i];
+        const uint16_t raw     = sensor_model_current_adc(&config->hardware, current_a);
+        pipeline_sample_current(pipeline, raw);
+        if (trace != nullptr)
+        {
+            trace_write_record(trace, TRACE_RECORD_CURRENT, time, raw);
+        }
+    }
+}
+
+static void trace_sync(trace_encoder_t* trace, pipeline_t const* pipeline, mcu_time_t const* time)
+{
+    uint8_t snapshot[PIPELINE_SNAPSHOT_SIZE];
+    pipeline_snapshot_write(pipeline, snapshot);
+    trace_write_sync(trace, time, snapshot, PIPELINE_SNAPSHOT_SIZE);
+}
+
+void closed_loop_run(closed_loop_config_t const* config, closed_loop_report_t* report, trace_encoder_t* trace)
+{
+    fridge_state_t fridge;
+    environment_state_t environment;
+    pipeline_t pipeline;
+    app_outputs_t outputs = {};
+
+    fridge_model_init(&fridge, config->environment.ambient_mean_c);
+    environment_init(&environment, config->seed);
+
+    // Every simulated device has its own pipeline (RMS sliding window, ...), so that runs can happen in parallel
+    pipeline_init(&pipeline, &config->sensors, &thermistor_ntc_100k_3950K_data);
+    pipeline.app.params = config->app;
+    pipeline.app.config = config->config;
+    pipeline.temperature_filter = config->temperature_filter;
+    pipeline.filter_params = config->filter;
+    pipeline.adaptive_sampling = config->adaptive_sampling;
+    pipeline.sampling_params = config->sampling;
+    app_state_t const& app = pipeline.app;
+
+    // Instantaneous current = sqrt(2) x RMS x sin(wt), samples are always taken at the same phases
+    double sine[CURRENT_MEASURE_SAMPLES_PER_SINE];
+    for (uint8_t i = 0; i < CURRENT_MEASURE_SAMPLES_PER_SINE; i++)
+    {
+        sine[i] = std::numbers::sqrt2 * std::sin(2.0 * std::numbers::pi * i / CURRENT_MEASURE_SAMPLES_PER_SINE);
+    }
+
+    sensor_model_ntc_t ntc_model;
+    sensor_model_ntc_init(&ntc_model, &config->hardware, &thermistor_ntc_100k_3950K_data);
+    sim_random_t ntc_noise;
+    sim_random_seed(&ntc_noise, config->seed ^ 0x4E5443ULL);
+
+    // Replay starts from the boot state, then from any of the periodic sync records
+    mcu_time_t time = {};
+    mcu_time_t next_sync = {};
+    mcu_time_t next_temperature = {};
+    if (trace != nullptr)
+    {
+        trace_sync(trace, &pipeline, &time);
+        next_sync.seconds = TRACE_SYNC_PERIOD_S;
+    }
+    sample_current(config, &fridge, &pipeline, sine, trace, &time);
+    bool motor_on = false;
+
+    *report                    = closed_loop_report_t{};
+    report->cabinet_min_c      = std::numeric_limits<double>::max();
+    report->cabinet_max_c      = std::numeric_limits<double>::lowest();
+    fridge_state_t warm        = fridge;
+    uint32_t stall_detections  = 0;
+    uint32_t premature_starts  = 0;
+    uint32_t premature_stops   = 0;
+    uint32_t needless_starts   = 0;
+    uint32_t temperature_reads = 0;
+    uint64_t stats_steps       = 0;
+    double peak_energy_j       = 0.0;
+    double off_peak_energy_j   = 0.0;
+    double next_clock_sync_s   = (config->clock_sync_period_s > 0.0) ? 0.0 : std::numeric_limits<double>::max();
+    uint64_t running_steps     = 0;
+    uint64_t out_of_band_steps = 0;
+    double cabinet_sum         = 0.0;
+    double error_square_sum    = 0.0;
+    bool idle_window_flushed   = true;
+
+    transient_state_t warm_transient = app.transient;
+
+    const uint64_t steps        = (uint64_t)(config->duration_s / CLOSED_LOOP_STEP_S);
+    const uint64_t warmup_steps = (uint64_t)(config->warmup_s / CLOSED_LOOP_STEP_S);
+    for (uint64_t step = 0; step < steps; step++)
+    {
+        const double now_s = (double)(step * CLOSED_LOOP_STEP_S);
+        environment_sample_t conditions;
+        environment_step(&config->environment, &environment, now_s, CLOSED_LOOP_STEP_S, &conditions);
+
+        mcu_time_at(now_s, config->clock_drift_ppm, &time);
+
+        // Once the compressor is off and the RMS window only holds idle samples, the reading can't change anymore
+        bool sampled = false;
+        if (fridge.running || !idle_window_flushed)
+        {
+            sample_current(config, &fridge, &pipeline, sine, trace, &time);
+            idle_window_flushed = !fridge.running;
+            sampled             = true;
+        }
+
+        // NTC is read at the pace the sampling policy asks for, like the firmware does
+        const uint16_t noiseless_raw = sensor_model_ntc_read(&ntc_model, fridge.probe_c);
+        if (time_compare(&time, &next_temperature) >= 0)
+        {
+            const double period_s          = pipeline_temperature_period_ms(&pipeline) / 1000.0;
+            const uint16_t temperature_raw = sensor_model_ntc_noise(&config->hardware, &ntc_noise, noiseless_raw, period_s);
+            pipeline_sample_temperature(&pipeline, temperature_raw);
+            if (trace != nullptr)
+            {
+                trace_write_record(trace, TRACE_RECORD_TEMPERATURE, &time, temperature_raw);
+            }
+            next_temperature = time;
+            time_add_ms(&next_temperature, pipeline_temperature_period_ms(&pipeline));
+            temperature_reads += (step < warmup_steps) ? 0U : 1U;
+            sampled = true;
+        }
+
+        // Like the firmware, the control law only runs on fresh readings
+        outputs.events = 0U;
+        if (sampled)
+        {
+            pipeline_step(&pipeline, &time, &outputs);
+        }
+        if (sampled && (trace != nullptr))
+        {
+            if (outputs.motor_on != motor_on)
+            {
+                motor_on = outputs.motor_on;
+                trace_write_record(trace, TRACE_RECORD_MOTOR, &time, motor_on ? 1U : 0U);
+            }
+            if (outputs.events != 0U)
+            {
+                trace_write_record(trace, TRACE_RECORD_EVENTS, &time, outputs.events);
+            }
+        }
+
+        // The host synchronizes the wall clock with the actual time, handled after the step like the firmware serial commands
+        const uint32_t wall_s = CLOSED_LOOP_EPOCH_S + (uint32_t)now_s;
+        if (now_s >= next_clock_sync_s)
+        {
+            pipeline_sync_clock(&pipeline, &time, wall_s);
+            if (trace != nullptr)
+            {
+                trace_write_record(trace, TRACE_RECORD_CLOCK, &time, wall_s);
+            }
+            next_clock_sync_s += config->clock_sync_period_s;
+        }
+
+        if ((trace != nullptr) && (time_compare(&time, &next_sync) >= 0))
+        {
+            trace_sync(trace, &pipeline, &time);
+            next_sync.seconds = time.seconds + TRACE_SYNC_PERIOD_S;
+        }
+
+        const double energy_before_j = fridge.energy_j;
+        fridge_model_step(&config->fridge, &fridge, outputs.motor_on, conditions.ambient_c, conditions.door_open, conditions.heat_load_w,
+                          CLOSED_LOOP_STEP_S);
+
+        if (step < warmup_steps)
+        {
+            warm           = fridge;
+            warm_transient = app.transient;
+            continue;
+        }
+
+        if (outputs.events & APP_EVENT_STALL_DETECTED)
+        {
+            stall_detections++;
+        }
+
+        (is_peak_hour(&config->tariff, now_s) ? peak_energy_j : off_peak_energy_j) += fridge.energy_j - energy_before_j;
+        uint32_t firmware_wall_s;
+        if (wall_clock_now(&pipeline.clock, &time, &firmware_wall_s))
+        {
+            const double error_s      = std::fabs((double)firmware_wall_s - (double)wall_s);
+            report->max_clock_error_s = std::max(report->max_clock_error_s, error_s);
+        }
+
+        // Noise (or the filter) should not switch the compressor before the noiseless reading crossed the threshold
+        if ((APP_CONTROL_HYSTERESIS == app.params.control_mode) && (outputs.events & (APP_EVENT_MOTOR_STARTED | APP_EVENT_MOTOR_STOPPED)))
+        {
+            uint8_t high;
+            uint8_t low;
+            app_get_hysteresis_band(&app, &high, &low);
+            const int32_t setpoint     = app_get_setpoint(&app);
+            const int32_t noiseless_q8 = sensors_temperature_q8_from_adc(&config->sensors, &thermistor_ntc_100k_3950K_data, noiseless_raw);
+            const int32_t start_q8     = (setpoint + high) * 256;
+            const int32_t stop_q8      = (setpoint - low - 1) * 256;
+            if ((outputs.events & APP_EVENT_MOTOR_STARTED) && (noiseless_q8 <= start_q8 - CLOSED_LOOP_PREMATURE_MARGIN_Q8))
+            {
+                premature_starts++;
+            }
+            if ((outputs.events & APP_EVENT_MOTOR_STOPPED) && (noiseless_q8 >= stop_q8 + CLOSED_LOOP_PREMATURE_MARGIN_Q8))
+            {
+                premature_stops++;
+            }
+
+            // The probe reads the cabinet air : a start on a door opening spike does not help the contents
+            const int32_t contents_q8 = sensors_temperature_q8_from_adc(&config->sensors, &thermistor_ntc_100k_3950K_data,
+                                                                        sensor_model_ntc_read(&ntc_model, fridge.cabinet_c));
+            if ((outputs.events & APP_EVENT_MOTOR_STARTED) && (contents_q8 <= start_q8 - CLOSED_LOOP_PREMATURE_MARGIN_Q8))
+            {
+                needless_starts++;
+            }
+        }
+
+        const double band_low  = app.config.target_temperature - (double)app.params.temp_hysteresis_low;
+        const double band_high = app.config.target_temperature + (double)app.params.temp_hysteresis_high;
+        const double excursion = std::max(fridge.cabinet_c - band_high, band_low - fridge.cabinet_c);
+        report->max_excursion_c = std::max(report->max_excursion_c, excursion);
+        out_of_band_steps += excursion > 1.0 ? 1U : 0U;
+        running_steps += fridge.running ? 1U : 0U;
+        report->cabinet_min_c = std::min(report->cabinet_min_c, fridge.cabinet_c);
+        report->cabinet_max_c = std::max(report->cabinet_max_c, fridge.cabinet_c);
+        cabinet_sum += fridge.cabinet_c;
+        error_square_sum += (fridge.cabinet_c - app.config.target_temperature) * (fridge.cabinet_c - app.config.target_temperature);
+        stats_steps++;
+    }
+
+    if (stats_steps == 0)
+    {
+        return;
+    }
+
+    report->simulated_s         = (double)(stats_steps * CLOSED_LOOP_STEP_S);
+    report->starts              = fridge.starts - warm.starts;
+    report->stalls              = fridge.stalls - warm.stalls;
+    report->overload_trips      = fridge.overload_trips - warm.overload_trips;
+    report->stall_detections    = stall_detections;
+    report->door_openings       = environment.door_openings;
+    report->starts_per_hour     = report->starts * 3600.0 / report->simulated_s;
+    report->duty_cycle          = (double)running_steps / (double)stats_steps;
+    report->energy_kwh          = (fridge.energy_j - warm.energy_j) / 3.6e6;
+    report->kwh_per_day         = report->energy_kwh * 86400.0 / report->simulated_s;
+    report->energy_cost         = (peak_energy_j * config->tariff.peak_price + off_peak_energy_j * config->tariff.off_peak_price) / 3.6e6;
+    report->cost_per_day        = report->energy_cost * 86400.0 / report->simulated_s;
+    report->peak_energy_ratio   = (peak_energy_j + off_peak_energy_j > 0.0) ? peak_energy_j / (peak_energy_j + off_peak_energy_j) : 0.0;
+    report->cabinet_mean_c      = cabinet_sum / (double)stats_steps;
+    report->cabinet_rms_error_c = std::sqrt(error_square_sum / (double)stats_steps);
+    report->out_of_band_ratio   = (double)out_of_band_steps / (double)stats_steps;
+    report->premature_starts    = premature_starts;
+    report->premature_stops     = premature_stops;
+    report->needless_starts     = needless_starts;
+    report->temperature_reads   = temperature_reads;
+    report->reads_per_hour      = temperature_reads * 3600.0 / report->simulated_s;
+    report->clock_drift_ppm     = pipeline.clock.drift_ppm;
+    report->starts_held         = (uint16_t)(app.transient.suppressed - warm_transient.suppressed);
+    report->starts_avoided      = (uint16_t)(app.transient.avoided - warm_transient.avoided);
+    report->starts_released     = (uint16_t)(app.transient.released - warm_transient.released);
+    report->current_threshold   = app.config.current_threshold;
+    report->current_sigma       = app.config.current_sigma;
+    report->current_runs        = app.config.current_runs;
+    report->stall_threshold     = app_get_stall_threshold(&app);
+    report->warming_rate        = app.config.warming_rate;
+    report->cooling_rate        = app.config.cooling_rate;
+}
@@ -0,0 +1,107 @@
+#ifndef CLOSED_LOOP_HEADER
+#define CLOSED_LOOP_HEADER
+
+#include <cstdint>
+
+#include "Core/app.h"
+#include "Core/kalman.h"
+#include "Core/persistent_config.h"
+#include "Core/sampling.h"
+#include "Core/sensors.h"
+#include "Core/trace.h"
+#include "environment.h"
+#include "fridge_model.h"
+#include "sensor_models.h"
+
+#define CLOSED_LOOP_STEP_S 1U /**> Control loop period under simulation, matches the firmware temperature read period */
+#define CLOSED_LOOP_EPOCH_S 1735689600UL /**> Local time the simulation starts at, sent by the simulated host (2025-01-01 00:00) */
+
+/**
+ * @brief electricity tariff the energy cost is computed with (local time, the simulation starts at midnight)
+ */
+struct tariff_t
+{
+    double peak_start_h;   /**> Peak hours start (hours since midnight)                    */
+    double peak_end_h;     /**> Peak hours end (hours since midnight, before the start : spans midnight) */
+    double peak_price;     /**> Price during the peak hours (per kWh)                      */
+    double off_peak_price; /**> Price the rest of the time (per kWh)                       */
+};
+
+/**
+ * @brief closed loop simulation setup : plant, environment and firmware configuration
+ */
+struct closed_loop_config_t
+{
+    double duration_s;             /**> Simulated duration (s)                                                   */
+    double warmup_s;               /**> Initial pull-down period, excluded from the report statistics (s)       */
+    uint64_t seed;                 /**> Environment random seed                                                  */
+    fridge_params_t fridge;        /**> Thermal plant and compressor parameters                                  */
+    environment_params_t environment; /**> Ambient, doors and loads                                              */
+    sensors_config_t sensors;      /**> Nominal sensors front-end, the one the firmware assumes                  */
+    sensor_hardware_t hardware;    /**> Actual sensors hardware of the simulated device                          */
+    app_params_t app;              /**> Control law parameters under test                                        */
+    bool temperature_filter;       /**> Temperature readings go through the Core Kalman filter                   */
+    kalman_params_t filter;        /**> Temperature filter tuning                                                */
+    bool adaptive_sampling;        /**> Temperature sampling period follows the signal (Core sampling policy)    */
+    sampling_params_t sampling;    /**> Temperature sampling policy tuning                                       */
+    persistent_config_t config;    /**> Persistent configuration the firmware boots with                         */
+    double clock_drift_ppm;        /**> MCU clock error of the simulated device (ppm, positive : runs fast)      */
+    double clock_sync_period_s;    /**> The host synchronizes the wall clock at boot and that often (s, 0 : no host) */
+    tariff_t tariff;               /**> Electricity tariff                                                        */
+};
+
+/**
+ * @brief closed loop run results, statistics exclude the warmup period
+ */
+struct closed_loop_report_t
+{
+    double simulated_s;          /**> Time covered by the statistics (s)                                      */
+    uint32_t starts;             /**> Compressor starts                                                       */
+    uint32_t stalls;             /**> Starts that locked the rotor                                            */
+    uint32_t overload_trips;     /**> Thermal overload protector trips                                        */
+    uint32_t stall_detections;   /**> Stalls detected by the firmware                                         */
+    uint32_t door_openings;      /**> Door openings                                                           */
+    double starts_per_hour;      /**> Mean compressor start rate                                              */
+    double duty_cycle;           /**> Fraction of time the compressor is energized                            */
+    double energy_kwh;           /**> Electrical energy drawn                                                 */
+    double energy_cost;          /**> Energy cost, with the tariff                                            */
+    double cost_per_day;         /**> Mean daily energy cost                                                  */
+    double peak_energy_ratio;    /**> Fraction of the energy drawn during the peak hours                      */
+    double kwh_per_day;          /**> Mean daily electrical energy                                            */
+    double cabinet_min_c;        /**> Lowest cabinet temperature                                              */
+    double cabinet_max_c;        /**> Highest cabinet temperature                                             */
+    double cabinet_mean_c;       /**> Mean cabinet temperature                                                */
+    double cabinet_rms_error_c;  /**> Root mean square deviation of the cabinet temperature from the target     */
+    double max_excursion_c;      /**> Farthest the cabinet went outside of the hysteresis band (°C)           */
+    double out_of_band_ratio;    /**> Fraction of time the cabinet is more than 1°C outside the hysteresis band */
+    uint32_t premature_starts;   /**> Hysteresis starts decided while the noiseless reading was 0.25°C or more below the threshold */
+    uint32_t premature_stops;    /**> Hysteresis stops decided while the noiseless reading was 0.25°C or more above the threshold  */
+    uint32_t needless_starts;    /**> Starts decided while the noiseless cabinet contents reading was 0.25°C or more below the threshold */
+    uint32_t starts_held;        /**> Starts held by the door openings detection                              */
+    uint32_t starts_avoided;     /**> Held starts that were no longer needed once the door opening was over   */
+    uint32_t starts_released;    /**> Held starts that eventually happened                                    */
+    uint32_t temperature_reads;  /**> NTC readings (ADC conversions)                                          */
+    double reads_per_hour;       /**> Mean NTC reading rate                                                   */
+    double max_clock_error_s;    /**> Largest firmware wall clock error, once synchronized (s)                */
+    int16_t clock_drift_ppm;     /**> MCU clock drift measured by the firmware (ppm)                          */
+    uint16_t current_threshold;  /**> Mean running current learnt by the firmware (mA)                        */
+    uint16_t current_sigma;      /**> Running current standard deviation learnt by the firmware (Q4 mA)       */
+    uint8_t current_runs;        /**> Compressor runs the running current statistics were learnt over         */
+    uint16_t stall_threshold;    /**> Overcurrent (stall) threshold derived from them (mA)                    */
+    uint16_t warming_rate;       /**> Warm-up rate learnt by the firmware (Q8 °C per hour)                    */
+    uint16_t cooling_rate;       /**> Cool-down rate learnt by the firmware (Q8 °C per hour)                  */
+};
+
+/**
+ * @brief default setup : a year of operation, typical fridge in a typical kitchen, firmware defaults
+ */
+void closed_loop_config_default(closed_loop_config_t* config);
+
+/**
+ * @brief runs the firmware control law (Core pipeline : temperature and current conversions, app_step()) against the fridge plant,
+ * under virtual time.
+ * @param[in] trace : when not null, records the raw readings and outputs of the simulated device, like the firmware trace mode does
+ */
+void closed_loop_run(closed_loop_config_t const* config, closed_loop_report_t* report, trace_encoder_t* trace = nullptr);
+
+#endif /* CLOSED_LOOP_HEADER */
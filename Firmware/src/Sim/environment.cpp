@@ -0,0 +1,63 @@
+#include "environment.h"
+
+#include <cmath>
+#include <numbers>
+
+static constexpr double SECONDS_PER_DAY  = 86400.0;
+static constexpr double SECONDS_PER_YEAR = 365.0 * SECONDS_PER_DAY;
+
+void environment_params_default(environment_params_t* params)
+{
+    params->ambient_mean_c               = 21.0;
+    params->ambient_daily_amplitude_c    = 2.0;
+    params->ambient_seasonal_amplitude_c = 4.0;
+    params->door_openings_per_day        = 16.0;
+    params->door_open_mean_s             = 12.0;
+    params->loads_per_day                = 0.5;
+    params->load_energy_j                = 150000.0; // ~3 kg of groceries cooled from 20°C to 5°C
+    params->load_duration_s              = 3600.0;
+}
+
+void environment_init(environment_state_t* state, const uint64_t seed)
+{
+    *state = environment_state_t{};
+    sim_random_seed(&state->random, seed);
+}
+
+void environment_step(environment_params_t const* params, environment_state_t* state, const double time_s, const double dt_s,
+                      environment_sample_t* sample)
+{
+    constexpr double two_pi = 2.0 * std::numbers::pi;
+
+    // Warmest at 15h00 and mid-year. Ambient moves slowly, no need to evaluate it at every step
+    if (time_s >= state->ambient_expiry_s)
+    {
+        const double daily      = std::cos(two_pi * (std::fmod(time_s, SECONDS_PER_DAY) / SECONDS_PER_DAY - 15.0 / 24.0));
+        const double seasonal   = -std::cos(two_pi * std::fmod(time_s, SECONDS_PER_YEAR) / SECONDS_PER_YEAR);
+        state->ambient_c        = params->ambient_mean_c + params->ambient_daily_amplitude_c * daily + params->ambient_seasonal_amplitude_c * seasonal;
+        state->ambient_expiry_s = time_s + ENVIRONMENT_AMBIENT_PERIOD_S;
+    }
+    sample->ambient_c = state->ambient_c;
+
+    if (state->door_remaining_s > 0.0)
+    {
+        state->door_remaining_s -= dt_s;
+    }
+    else if (sim_random_uniform(&state->random) < params->door_openings_per_day * dt_s / SECONDS_PER_DAY)
+    {
+        state->door_remaining_s = -params->door_open_mean_s * std::log(1.0 - sim_random_uniform(&state->random));
+        state->door_openings++;
+    }
+    sample->door_open = state->door_remaining_s > 0.0;
+
+    if (state->load_remaining_s > 0.0)
+    {
+        state->load_remaining_s -= dt_s;
+    }
+    else if (sim_random_uniform(&state->random) < params->loads_per_day * dt_s / SECONDS_PER_DAY)
+    {
+        state->load_remaining_s = params->load_duration_s;
+        state->loads++;
+    }
+    sample->heat_load_w = state->load_remaining_s > 0.0 ? params->load_energy_j / params->load_duration_s : 0.0;
+}
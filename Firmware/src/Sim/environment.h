@@ -0,0 +1,64 @@
+#ifndef ENVIRONMENT_HEADER
+#define ENVIRONMENT_HEADER
+
+#include <cstdint>
+
+#include "sim_random.h"
+
+#define ENVIRONMENT_AMBIENT_PERIOD_S 60.0 /**> Ambient temperature is piecewise constant over this period (s) */
+
+/**
+ * @brief fridge surroundings : ambient air (daily and seasonal cycles), door openings and warm food loads.
+ * Door openings and loads are Poisson processes, drawn from a seeded generator so that runs are reproducible.
+ */
+struct environment_params_t
+{
+    double ambient_mean_c;               /**> Yearly mean ambient temperature (°C)                                  */
+    double ambient_daily_amplitude_c;    /**> Day/night ambient swing amplitude (°C), warmest at 15h00              */
+    double ambient_seasonal_amplitude_c; /**> Summer/winter ambient swing amplitude (°C), warmest mid-year          */
+    double door_openings_per_day;        /**> Mean door opening rate                                                */
+    double door_open_mean_s;             /**> Mean door opening duration (s), exponentially distributed             */
+    double loads_per_day;                /**> Mean rate at which warm food is put in the fridge                     */
+    double load_energy_j;                /**> Heat brought in by a single load (J)                                  */
+    double load_duration_s;              /**> Time over which a load releases its heat (s)                          */
+};
+
+/**
+ * @brief environment state, advanced by environment_step()
+ */
+struct environment_state_t
+{
+    sim_random_t random;       /**> Door openings and loads generator                      */
+    double ambient_c;          /**> Ambient temperature, refreshed every ENVIRONMENT_AMBIENT_PERIOD_S */
+    double ambient_expiry_s;   /**> Time at which the ambient temperature is refreshed (s) */
+    double door_remaining_s;   /**> Time left before the door gets closed again (s)       */
+    double load_remaining_s;   /**> Time left before the current load is cooled down (s)  */
+    uint32_t door_openings;    /**> Door openings count since init                        */
+    uint32_t loads;            /**> Loads count since init                                */
+};
+
+/**
+ * @brief environment conditions for a single step
+ */
+struct environment_sample_t
+{
+    double ambient_c;   /**> Ambient air temperature (°C)          */
+    bool door_open;     /**> Door is opened                        */
+    double heat_load_w; /**> Extra heat flowing into the cabinet (W) */
+};
+
+/**
+ * @brief fills in a typical kitchen with a regular household usage
+ */
+void environment_params_default(environment_params_t* params);
+
+void environment_init(environment_state_t* state, const uint64_t seed);
+
+/**
+ * @brief advances the environment by dt seconds and gives the conditions that apply to this step
+ * @param[in] time_s : absolute time since the beginning of the year (s)
+ */
+void environment_step(environment_params_t const* params, environment_state_t* state, const double time_s, const double dt_s,
+                      environment_sample_t* sample);
+
+#endif /* ENVIRONMENT_HEADER */
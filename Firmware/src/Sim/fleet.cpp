@@ -0,0 +1,153 @@
+#include "fleet.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "sim_random.h"
+#include "thread_pool.h"
+
+void fleet_config_default(fleet_config_t* config)
+{
+    config->devices = 1000U;
+    config->threads = 0U;
+    config->seed    = 1U;
+    closed_loop_config_default(&config->base);
+    config->base.duration_s = 30.0 * 86400.0;
+
+    config->spread.ambient_mean_c             = {16.0, 28.0};
+    config->spread.doors_per_day              = {4.0, 40.0};
+    config->spread.cabinet_capacity_ratio     = {0.6, 2.0};
+    config->spread.wall_conductance_ratio     = {0.8, 1.5};
+    config->spread.cooling_power_ratio        = {0.8, 1.3};
+    config->spread.upper_resistance_tolerance = 0.01;
+    config->spread.ntc_tolerance              = 0.03;
+    config->spread.current_gain_tolerance     = 0.10;
+    config->spread.vcc_tolerance_mv           = 250.0;
+}
+
+static double draw(sim_random_t* random, fleet_range_t const& range)
+{
+    return sim_random_range(random, range.min, range.max);
+}
+
+static double draw_tolerance(sim_random_t* random, const double tolerance)
+{
+    return sim_random_range(random, -tolerance, tolerance);
+}
+
+void fleet_draw_device(fleet_config_t const* config, const uint32_t index, closed_loop_config_t* device)
+{
+    fleet_spread_t const& spread = config->spread;
+    sim_random_t random;
+    sim_random_seed(&random, config->seed * 0x100000001B3ULL + index);
+
+    *device      = config->base;
+    device->seed = config->seed ^ ((uint64_t)index << 32U);
+
+    device->environment.ambient_mean_c        = draw(&random, spread.ambient_mean_c);
+    device->environment.door_openings_per_day = draw(&random, spread.doors_per_day);
+    device->fridge.cabinet_capacity_j_per_k *= draw(&random, spread.cabinet_capacity_ratio);
+    device->fridge.wall_conductance_w_per_k *= draw(&random, spread.wall_conductance_ratio);
+    const double cooling_ratio = draw(&random, spread.cooling_power_ratio);
+    device->fridge.cooling_power_w *= cooling_ratio;
+    device->fridge.running_current_a *= cooling_ratio;
+
+    // Firmware keeps assuming nominal components, only the actual hardware drifts
+    sensor_hardware_t& hardware     = device->hardware;
+    hardware.board.upper_resistance = (uint16_t)(config->base.hardware.board.upper_resistance *
+                                                 (1.0 + draw_tolerance(&random, spread.upper_resistance_tolerance)));
+    hardware.board.vcc_mv      = (uint16_t)(config->base.hardware.board.vcc_mv + draw_tolerance(&random, spread.vcc_tolerance_mv));
+    hardware.ntc_resistance_ratio = 1.0 + draw_tolerance(&random, spread.ntc_tolerance);
+    hardware.current_gain_ratio   = 1.0 + draw_tolerance(&random, spread.current_gain_tolerance);
+}
+
+void fleet_distribution(std::vector<double> values, fleet_distribution_t* distribution)
+{
+    *distribution = fleet_distribution_t{};
+    if (values.empty())
+    {
+        return;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](const double ratio) { return values[(size_t)(ratio * (double)(values.size() - 1U) + 0.5)]; };
+
+    double sum = 0.0;
+    for (double value : values)
+    {
+        sum += value;
+    }
+
+    distribution->min    = values.front();
+    distribution->p10    = percentile(0.1);
+    distribution->median = percentile(0.5);
+    distribution->p90    = percentile(0.9);
+    distribution->max    = values.back();
+    distribution->mean   = sum / (double)values.size();
+}
+
+void fleet_run(fleet_config_t const* config, fleet_report_t* report, std::vector<closed_loop_report_t>* devices)
+{
+    std::vector<closed_loop_report_t> results(config->devices);
+    std::vector<int8_t> targets(config->devices);
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t steals  = 0;
+    unsigned int threads;
+    {
+        thread_pool pool(config->threads);
+        threads = pool.worker_count();
+
+        // One task per device : tasks are small enough for the stealing to balance uneven devices
+        for (uint32_t i = 0; i < config->devices; i++)
+        {
+            pool.submit([config, i, &results, &targets] {
+                closed_loop_config_t device;
+                fleet_draw_device(config, i, &device);
+                targets[i] = device.config.target_temperature;
+                closed_loop_run(&device, &results[i]);
+            });
+        }
+        pool.wait();
+        steals = pool.steal_count();
+    }
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> starts_per_hour;
+    std::vector<double> stalls;
+    std::vector<double> stall_detections;
+    std::vector<double> temperature_error;
+    std::vector<double> max_excursion;
+    std::vector<double> kwh_per_day;
+    double device_s = 0.0;
+    for (uint32_t i = 0; i < config->devices; i++)
+    {
+        closed_loop_report_t const& result = results[i];
+        starts_per_hour.push_back(result.starts_per_hour);
+        stalls.push_back(result.stalls);
+        stall_detections.push_back(result.stall_detections);
+        temperature_error.push_back(result.cabinet_mean_c - targets[i]);
+        max_excursion.push_back(result.max_excursion_c);
+        kwh_per_day.push_back(result.kwh_per_day);
+        device_s += config->base.duration_s;
+    }
+
+    *report                    = fleet_report_t{};
+    report->devices            = config->devices;
+    report->threads            = threads;
+    report->steals             = steals;
+    report->device_hours       = device_s / 3600.0;
+    report->wall_s             = wall_s;
+    report->device_hours_per_s = report->device_hours / wall_s;
+    fleet_distribution(starts_per_hour, &report->starts_per_hour);
+    fleet_distribution(stalls, &report->stalls);
+    fleet_distribution(stall_detections, &report->stall_detections);
+    fleet_distribution(temperature_error, &report->temperature_error_c);
+    fleet_distribution(max_excursion, &report->max_excursion_c);
+    fleet_distribution(kwh_per_day, &report->kwh_per_day);
+
+    if (devices != nullptr)
+    {
+        *devices = std::move(results);
+    }
+}
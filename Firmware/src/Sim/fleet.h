@@ -0,0 +1,99 @@
+#ifndef FLEET_HEADER
+#define FLEET_HEADER
+
+#include <cstdint>
+#include <vector>
+
+#include "closed_loop.h"
+
+/**
+ * @brief uniform distribution bounds of a fleet parameter
+ */
+struct fleet_range_t
+{
+    double min;
+    double max;
+};
+
+/**
+ * @brief how devices of the fleet differ from one another : fridge models, kitchens, usages and components tolerances
+ */
+struct fleet_spread_t
+{
+    fleet_range_t ambient_mean_c;          /**> Yearly mean ambient temperature (°C)                         */
+    fleet_range_t doors_per_day;           /**> Door openings per day                                        */
+    fleet_range_t cabinet_capacity_ratio;  /**> Fridge size and load, relative to the base fridge            */
+    fleet_range_t wall_conductance_ratio;  /**> Insulation quality, relative to the base fridge              */
+    fleet_range_t cooling_power_ratio;     /**> Compressor size, relative to the base fridge                 */
+    double upper_resistance_tolerance;     /**> NTC bridge upper resistor tolerance (relative, +/-)          */
+    double ntc_tolerance;                  /**> NTC resistance tolerance (relative, +/-)                     */
+    double current_gain_tolerance;         /**> Current sense chain gain tolerance (relative, +/-)           */
+    double vcc_tolerance_mv;               /**> USB supply voltage tolerance (+/- millivolts)                */
+};
+
+/**
+ * @brief fleet simulation setup
+ */
+struct fleet_config_t
+{
+    uint32_t devices;          /**> Simulated devices count                                       */
+    unsigned int threads;      /**> Worker threads, 0 uses every hardware thread                  */
+    uint64_t seed;             /**> Fleet seed : a given device always draws the same parameters  */
+    closed_loop_config_t base; /**> Base device, spread applies on top of it                      */
+    fleet_spread_t spread;     /**> Device to device variations                                   */
+};
+
+/**
+ * @brief summary of a metric over the fleet
+ */
+struct fleet_distribution_t
+{
+    double min;
+    double p10;
+    double median;
+    double p90;
+    double max;
+    double mean;
+};
+
+/**
+ * @brief fleet run results : distributions over every device, and runner throughput
+ */
+struct fleet_report_t
+{
+    uint32_t devices;
+    unsigned int threads;
+    uint64_t steals;                          /**> Devices run by another worker than the one they were queued on */
+    double device_hours;                      /**> Simulated time, summed over devices (hours)                  */
+    double wall_s;                            /**> Host time spent (s)                                          */
+    double device_hours_per_s;                /**> Throughput                                                   */
+    fleet_distribution_t starts_per_hour;     /**> Compressor starts per hour                                   */
+    fleet_distribution_t stalls;              /**> Stalled starts per device                                    */
+    fleet_distribution_t stall_detections;    /**> Stalls detected by the firmware, per device                  */
+    fleet_distribution_t temperature_error_c; /**> Mean cabinet temperature minus target (°C)                   */
+    fleet_distribution_t max_excursion_c;     /**> Farthest excursion outside the hysteresis band (°C)          */
+    fleet_distribution_t kwh_per_day;         /**> Mean daily electrical energy                                 */
+};
+
+/**
+ * @brief 1000 devices over 30 days, typical spread of a fleet of small fridges
+ */
+void fleet_config_default(fleet_config_t* config);
+
+/**
+ * @brief draws the closed loop setup of a device of the fleet (reproducible, only depends on the fleet seed and device index)
+ */
+void fleet_draw_device(fleet_config_t const* config, const uint32_t index, closed_loop_config_t* device);
+
+/**
+ * @brief computes percentiles and mean of a set of values
+ */
+void fleet_distribution(std::vector<double> values, fleet_distribution_t* distribution);
+
+/**
+ * @brief runs every device of the fleet on a work-stealing thread pool
+ * @param[out] devices : optional, per device reports (in device index order)
+ */
+void fleet_run(fleet_config_t const* config, fleet_report_t* report, std::vector<closed_loop_report_t>* devices = nullptr);
+
+#endif /* FLEET_HEADER */
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fleet.h"
+
+static void print_usage(const char* program)
+{
+    printf("Usage : %s [options]\n"
+           "  --devices <count>   Simulated devices (default 1000)\n"
+           "  --days <days>       Simulated duration per device (default 30)\n"
+           "  --threads <count>   Worker threads (default : every hardware thread)\n"
+           "  --seed <seed>       Fleet seed (default 1)\n"
+           "  --scaling           Runs the fleet with 1, 2, 4, ... threads up to --threads and reports the speedup\n",
+           program);
+}
+
+static void print_distribution(const char* name, fleet_distribution_t const* distribution)
+{
+    printf("%-22s %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", name, distribution->min, distribution->p10, distribution->median,
+           distribution->p90, distribution->max, distribution->mean);
+}
+
+static void print_report(fleet_report_t const* report)
+{
+    printf("%-22s %9s %9s %9s %9s %9s %9s\n", "", "min", "p10", "median", "p90", "max", "mean");
+    print_distribution("starts / hour", &report->starts_per_hour);
+    print_distribution("stalled starts", &report->stalls);
+    print_distribution("stalls detected", &report->stall_detections);
+    print_distribution("temperature error (C)", &report->temperature_error_c);
+    print_distribution("max excursion (C)", &report->max_excursion_c);
+    print_distribution("energy (kWh / day)", &report->kwh_per_day);
+}
+
+static void print_throughput(fleet_report_t const* report)
+{
+    printf("%u devices, %.0f device-hours on %u threads in %.3f s : %.0f device-hours/s (%llu steals)\n", report->devices,
+           report->device_hours, report->threads, report->wall_s, report->device_hours_per_s, (unsigned long long)report->steals);
+}
+
+int main(int argc, char** argv)
+{
+    fleet_config_t config;
+    fleet_config_default(&config);
+    bool scaling = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const bool        value = (i + 1) < argc;
+        if (arg == "--devices" && value)
+        {
+            config.devices = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--days" && value)
+        {
+            config.base.duration_s = std::strtod(argv[++i], nullptr) * 86400.0;
+        }
+        else if (arg == "--threads" && value)
+        {
+            config.threads = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seed" && value)
+        {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--scaling")
+        {
+            scaling = true;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    fleet_report_t report;
+    if (!scaling)
+    {
+        fleet_run(&config, &report);
+        print_report(&report);
+        print_throughput(&report);
+        return 0;
+    }
+
+    const unsigned int max_threads = (config.threads == 0U) ? std::max(1U, std::thread::hardware_concurrency()) : config.threads;
+    std::vector<unsigned int> thread_counts;
+    for (unsigned int threads = 1U; threads < max_threads; threads *= 2U)
+    {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    double single_thread = 0.0;
+    for (unsigned int threads : thread_counts)
+    {
+        config.threads = threads;
+        fleet_run(&config, &report);
+        single_thread = (threads == 1U) ? report.device_hours_per_s : single_thread;
+        print_throughput(&report);
+        printf("  speedup %.2fx, efficiency %.0f %%\n", report.device_hours_per_s / single_thread,
+               100.0 * report.device_hours_per_s / (single_thread * threads));
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "fridge_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+void fridge_params_default(fridge_params_t* params)
+{
+    params->cabinet_capacity_j_per_k       = 12000.0; // ~100 l of air, shelves and a few kg of food
+    params->evaporator_capacity_j_per_k    = 1500.0;
+    params->wall_conductance_w_per_k       = 0.7;
+    params->door_conductance_w_per_k       = 10.0;
+    params->probe_door_time_constant_s     = 30.0;  // A 12 s opening warms the probe air by 5°C to 6°C
+    params->probe_time_constant_s          = 120.0;
+    params->evaporator_conductance_w_per_k = 6.0;
+    params->cooling_power_w                = 70.0;
+    params->cooling_temp_coeff_per_k       = 0.02;
+    params->mains_voltage_v                = 230.0;
+    params->mains_frequency_hz             = 50.0;
+    params->power_factor                   = 0.7;
+    params->running_current_a              = 0.45;
+    params->inrush_ratio                   = 5.0;
+    params->inrush_time_constant_s         = 0.3;
+    params->locked_rotor_ratio             = 4.0;
+    params->pressure_build_time_constant_s = 30.0;
+    params->pressure_equalization_time_s   = 90.0;
+    params->stall_pressure_threshold       = 0.2;
+    params->overload_trip_s                = 15.0;
+    params->overload_reset_s               = 180.0;
+}
+
+void fridge_model_init(fridge_state_t* state, const double temperature_c)
+{
+    *state              = fridge_state_t{};
+    state->cabinet_c    = temperature_c;
+    state->evaporator_c = temperature_c;
+    state->probe_c      = temperature_c;
+}
+
+double fridge_model_current_rms(fridge_params_t const* params, fridge_state_t const* state, const double offset_s)
+{
+    if (!state->running)
+    {
+        return 0.0;
+    }
+
+    if (state->stalled)
+    {
+        return params->running_current_a * params->locked_rotor_ratio;
+    }
+
+    // Motor load (and current) rises with the head pressure
+    const double steady = params->running_current_a * (0.8 + 0.2 * state->head_pressure);
+    // Inrush is long gone after a few time constants, skip the exponential
+    const double since_start_s = state->run_time_s + offset_s;
+    if (since_start_s > 20.0 * params->inrush_time_constant_s)
+    {
+        return steady;
+    }
+
+    const double inrush = (params->inrush_ratio - 1.0) * std::exp(-since_start_s / params->inrush_time_constant_s);
+    return steady * (1.0 + inrush);
+}
+
+static void update_compressor(fridge_params_t const* params, fridge_state_t* state, const bool motor_cmd, const double dt_s)
+{
+    if (state->overload_open)
+    {
+        state->overload_time_s += dt_s;
+        if (state->overload_time_s >= params->overload_reset_s)
+        {
+            state->overload_open = false;
+        }
+    }
+
+    if (!motor_cmd || state->overload_open)
+    {
+        state->running = false;
+        state->stalled = false;
+        return;
+    }
+
+    if (!state->running)
+    {
+        // Restarting against the head pressure locks the rotor
+        state->running      = true;
+        state->stalled      = state->head_pressure > params->stall_pressure_threshold;
+        state->run_time_s   = 0.0;
+        state->stall_time_s = 0.0;
+        state->starts++;
+        if (state->stalled)
+        {
+            state->stalls++;
+        }
+    }
+}
+
+void fridge_model_step(fridge_params_t const* params, fridge_state_t* state, const bool motor_cmd, const double ambient_c, const bool door_open,
+                       const double heat_load_w, const double dt_s)
+{
+    update_compressor(params, state, motor_cmd, dt_s);
+
+    // Energy is integrated before the step so that the inrush current is accounted for
+    const double current_a = fridge_model_current_rms(params, state, dt_s / 2.0);
+    state->energy_j += params->mains_voltage_v * current_a * params->power_factor * dt_s;
+
+    double cooling_w = 0.0;
+    if (state->running && !state->stalled)
+    {
+        cooling_w = params->cooling_power_w * std::max(0.2, 1.0 + params->cooling_temp_coeff_per_k * state->evaporator_c);
+        state->head_pressure = 1.0 - (1.0 - state->head_pressure) * std::exp(-dt_s / params->pressure_build_time_constant_s);
+    }
+    else
+    {
+        state->head_pressure *= std::exp(-dt_s / params->pressure_equalization_time_s);
+    }
+
+    if (state->running)
+    {
+        state->run_time_s += dt_s;
+        if (state->stalled)
+        {
+            state->stall_time_s += dt_s;
+            if (state->stall_time_s >= params->overload_trip_s)
+            {
+                state->overload_open   = true;
+                state->overload_time_s = 0.0;
+                state->running         = false;
+                state->stalled         = false;
+                state->overload_trips++;
+            }
+        }
+    }
+
+    const double wall_conductance = params->wall_conductance_w_per_k + (door_open ? params->door_conductance_w_per_k : 0.0);
+    const double ambient_w        = wall_conductance * (ambient_c - state->cabinet_c);
+    const double evaporator_w     = params->evaporator_conductance_w_per_k * (state->cabinet_c - state->evaporator_c);
+
+    state->cabinet_c += dt_s * (ambient_w + heat_load_w - evaporator_w) / params->cabinet_capacity_j_per_k;
+    state->evaporator_c += dt_s * (evaporator_w - cooling_w) / params->evaporator_capacity_j_per_k;
+    state->cooling_j += cooling_w * dt_s;
+
+    // Probe air holds no significant heat : it is driven, it does not drive the cabinet
+    const double probe_target = door_open ? ambient_c : state->cabinet_c;
+    const double probe_tau    = door_open ? params->probe_door_time_constant_s : params->probe_time_constant_s;
+    state->probe_c += (probe_target - state->probe_c) * (1.0 - std::exp(-dt_s / probe_tau));
+}
@@ -0,0 +1,90 @@
+#ifndef FRIDGE_MODEL_HEADER
+#define FRIDGE_MODEL_HEADER
+
+#include <cstdint>
+
+/**
+ * @brief lumped parameters of the fridge thermal plant and of its compressor.
+ * Thermal side is a 2 nodes model (cabinet and evaporator) exchanging heat with the ambient air through the walls (and the door when opened).
+ * The NTC probe sits in the cabinet air, which follows the ambient air much faster than the cabinet contents while the door is opened,
+ * then settles back to the cabinet temperature : the probe reading spikes at every door opening.
+ * Electrical side models the compressor current : steady run current, inrush at start and locked rotor when restarted
+ * before the refrigerant pressure had time to equalize.
+ */
+struct fridge_params_t
+{
+    double cabinet_capacity_j_per_k;       /**> Thermal capacity of the cabinet air and its contents (J/K)                       */
+    double evaporator_capacity_j_per_k;    /**> Thermal capacity of the evaporator plate (J/K)                                   */
+    double wall_conductance_w_per_k;       /**> Ambient to cabinet conductance through the insulated walls (W/K)                 */
+    double door_conductance_w_per_k;       /**> Additional ambient to cabinet conductance while the door is opened (W/K)         */
+    double probe_door_time_constant_s;     /**> Probe air time constant toward the ambient while the door is opened (s)          */
+    double probe_time_constant_s;          /**> Probe air time constant toward the cabinet temperature (s)                       */
+    double evaporator_conductance_w_per_k; /**> Cabinet to evaporator conductance (W/K)                                          */
+    double cooling_power_w;                /**> Heat pumped out of the evaporator at 0°C (W)                                     */
+    double cooling_temp_coeff_per_k;       /**> Relative cooling power change per evaporator °C (colder evaporator pumps less)   */
+    double mains_voltage_v;                /**> Mains RMS voltage (V)                                                            */
+    double mains_frequency_hz;             /**> Mains frequency (Hz)                                                             */
+    double power_factor;                   /**> Compressor motor power factor                                                    */
+    double running_current_a;              /**> Steady RMS current at full head pressure (A)                                     */
+    double inrush_ratio;                   /**> Inrush current peak, relative to running current                                 */
+    double inrush_time_constant_s;         /**> Inrush current decay time constant (s)                                           */
+    double locked_rotor_ratio;             /**> Locked rotor (stalled) current, relative to running current                      */
+    double pressure_build_time_constant_s; /**> Head pressure build up time constant while running (s)                           */
+    double pressure_equalization_time_s;   /**> Head pressure equalization time constant once stopped (s)                        */
+    double stall_pressure_threshold;       /**> Normalized head pressure above which a start stalls the motor (0..1)             */
+    double overload_trip_s;                /**> Locked rotor duration before the thermal overload protector opens (s)            */
+    double overload_reset_s;               /**> Time for the overload protector to close again (s)                               */
+};
+
+/**
+ * @brief fridge plant state, integrated by fridge_model_step()
+ */
+struct fridge_state_t
+{
+    double cabinet_c;       /**> Cabinet air and contents temperature (°C)                           */
+    double evaporator_c;    /**> Evaporator temperature (°C)                                         */
+    double probe_c;         /**> Cabinet air temperature around the NTC probe (°C)                   */
+    double head_pressure;   /**> Normalized refrigerant head pressure (0 : equalized, 1 : full)      */
+    double run_time_s;      /**> Time since the last compressor start (s)                            */
+    double stall_time_s;    /**> Time spent with a locked rotor since the last start (s)             */
+    double overload_time_s; /**> Time since the overload protector opened (s)                        */
+    bool running;           /**> Compressor is energized                                             */
+    bool stalled;           /**> Rotor is locked : current is drawn, nothing is pumped               */
+    bool overload_open;     /**> Thermal overload protector cut the compressor off                   */
+
+    double energy_j;        /**> Electrical energy drawn since init (J)                              */
+    double cooling_j;       /**> Heat pumped out of the evaporator since init (J)                    */
+    uint32_t starts;        /**> Compressor start count                                              */
+    uint32_t stalls;        /**> Starts that ended up with a locked rotor                            */
+    uint32_t overload_trips;/**> Overload protector trips                                            */
+};
+
+/**
+ * @brief fills in parameters of a typical 100 liters single door fridge (~80W compressor)
+ */
+void fridge_params_default(fridge_params_t* params);
+
+/**
+ * @brief initializes a stopped fridge, with every node at the given temperature
+ */
+void fridge_model_init(fridge_state_t* state, const double temperature_c);
+
+/**
+ * @brief RMS current drawn by the compressor, at a time offset within the next step (used to sample inrush current)
+ * @param[in] offset_s : time offset since the last fridge_model_step() (s)
+ * @return RMS current (A)
+ */
+double fridge_model_current_rms(fridge_params_t const* params, fridge_state_t const* state, const double offset_s);
+
+/**
+ * @brief integrates the plant over dt seconds
+ * @param[in] motor_cmd  : compressor relay command
+ * @param[in] ambient_c  : ambient air temperature (°C)
+ * @param[in] door_open  : door is opened during this step
+ * @param[in] heat_load_w: extra heat flowing into the cabinet (warm food, ...) (W)
+ * @param[in] dt_s       : integration step (s), must remain well below the evaporator time constant
+ */
+void fridge_model_step(fridge_params_t const* params, fridge_state_t* state, const bool motor_cmd, const double ambient_c, const bool door_open,
+                       const double heat_load_w, const double dt_s);
+
+#endif /* FRIDGE_MODEL_HEADER */
@@ -0,0 +1,237 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Core/pipeline.h"
+#include "closed_loop.h"
+
+static void print_usage(const char* program)
+{
+    printf("Usage : %s [options]\n"
+           "  --days <days>             Simulated duration (default 365)\n"
+           "  --seed <seed>             Environment random seed (default 1)\n"
+           "  --ambient <celsius>       Yearly mean ambient temperature (default 21)\n"
+           "  --doors-per-day <count>   Mean door openings per day (default 16)\n"
+           "  --target <celsius>        Target temperature (default 4)\n"
+           "  --hysteresis-high <c>     TEMP_HYSTERESIS_HIGH (default %u)\n"
+           "  --hysteresis-low <c>      TEMP_HYSTERESIS_LOW (default %u)\n"
+           "  --restart-wait <seconds>  STALLED_MOTOR_WAIT_SECONDS (default %u)\n"
+           "  --adaptive <0|1>          ADAPTIVE_HYSTERESIS (default %u)\n"
+           "  --cycle <minutes>         ADAPTIVE_CYCLE_MINUTES (default %u)\n"
+           "  --control <law>           hysteresis or pid (default %s)\n"
+           "  --kp <permille/C>         PID_KP (default %d)\n"
+           "  --ki <q8 permille/C/s>    PID_KI, per PID sample (default %d)\n"
+           "  --kd <permille/(C/h)>     PID_KD, on the temperature slope (default %d)\n"
+           "  --window <seconds>        PID_WINDOW_SECONDS (default %u)\n"
+           "  --min-runtime <seconds>   MIN_MOTOR_RUNTIME_SECONDS (default %u)\n"
+           "  --min-idle <seconds>      PID_MIN_IDLE_SECONDS, shortest rest in between two runs (default %u)\n"
+           "  --filter <0|1>            PIPELINE_TEMPERATURE_FILTER, Kalman filtered temperature (default %u)\n"
+           "  --adaptive-sampling <0|1> PIPELINE_ADAPTIVE_SAMPLING, NTC read pace follows the signal (default %u)\n"
+           "  --adc-noise <codes>       NTC reading noise, standard deviation in ADC codes (default 0)\n"
+           "  --adc-spikes <per hour>   Spurious NTC readings rate (default 0)\n"
+           "  --spike-size <codes>      Spurious NTC readings amplitude, ADC codes (default 40)\n"
+           "  --door-detection <0|1>    TRANSIENT_DETECTION, starts held during door openings (default %u)\n"
+           "  --scheduling <0|1>        APP_SCHEDULING, pre-cooling and peak hours band (default %u)\n"
+           "  --clock-sync <hours>      Host wall clock synchronization period, 0 : none (default 0)\n"
+           "  --clock-drift <ppm>       MCU clock error (default 0)\n"
+           "  --peak-price <price>      Energy price during the peak hours, per kWh (default 0.40)\n"
+           "  --off-peak-price <price>  Energy price the rest of the time, per kWh (default 0.20)\n"
+           "  --trace <path>            Records the simulated device trace (@see trace_replay)\n",
+           program, TEMP_HYSTERESIS_HIGH, TEMP_HYSTERESIS_LOW, STALLED_MOTOR_WAIT_SECONDS, ADAPTIVE_HYSTERESIS, ADAPTIVE_CYCLE_MINUTES,
+           (APP_CONTROL_MODE == APP_CONTROL_PID) ? "pid" : "hysteresis", PID_KP, PID_KI, PID_KD, PID_WINDOW_SECONDS,
+           MIN_MOTOR_RUNTIME_SECONDS, PID_MIN_IDLE_SECONDS, PIPELINE_TEMPERATURE_FILTER, PIPELINE_ADAPTIVE_SAMPLING, TRANSIENT_DETECTION, APP_SCHEDULING);
+}
+
+static void write_to_file(uint8_t const* data, const uint8_t length, void* context)
+{
+    fwrite(data, 1U, length, static_cast<FILE*>(context));
+}
+
+static void print_report(closed_loop_report_t const* report)
+{
+    printf("Simulated          : %.1f days (after warmup)\n", report->simulated_s / 86400.0);
+    printf("Compressor starts  : %u (%.2f / hour), duty cycle %.1f %%\n", report->starts, report->starts_per_hour, report->duty_cycle * 100.0);
+    printf("Stalled starts     : %u, detected by firmware : %u, overload trips : %u\n", report->stalls, report->stall_detections,
+           report->overload_trips);
+    printf("Energy             : %.1f kWh (%.3f kWh / day)\n", report->energy_kwh, report->kwh_per_day);
+    printf("Energy cost        : %.2f (%.3f / day), %.1f %% of the energy during the peak hours\n", report->energy_cost, report->cost_per_day,
+           report->peak_energy_ratio * 100.0);
+    printf("Cabinet            : min %.2f C, mean %.2f C, max %.2f C, %.2f C RMS from target\n", report->cabinet_min_c, report->cabinet_mean_c,
+           report->cabinet_max_c, report->cabinet_rms_error_c);
+    printf("Excursion          : max %.2f C outside the band, %.2f %% of time more than 1 C outside\n", report->max_excursion_c,
+           report->out_of_band_ratio * 100.0);
+    printf("NTC readings       : %u (%.0f / hour)\n", report->temperature_reads, report->reads_per_hour);
+    printf("Premature switches : %u starts, %u stops\n", report->premature_starts, report->premature_stops);
+    printf("Needless starts    : %u, cabinet contents 0.25 C or more below the threshold\n", report->needless_starts);
+    printf("Door openings      : %u, starts held %u : %u avoided, %u released\n", report->door_openings, report->starts_held,
+           report->starts_avoided, report->starts_released);
+    printf("Running current    : mean %u mA, sigma %.1f mA over %u runs, stall threshold %u mA\n", report->current_threshold,
+           report->current_sigma / 16.0, report->current_runs, report->stall_threshold);
+    printf("Learnt rates       : warm-up %.2f C/h, cool-down %.2f C/h\n", report->warming_rate / 256.0, report->cooling_rate / 256.0);
+    printf("Wall clock         : drift %d ppm, max error %.0f s\n", report->clock_drift_ppm, report->max_clock_error_s);
+}
+
+int main(int argc, char** argv)
+{
+    closed_loop_config_t config;
+    closed_loop_config_default(&config);
+    config.hardware.ntc_spike_lsb = 40.0;
+    const char* trace_path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const bool        value = (i + 1) < argc;
+        if (arg == "--days" && value)
+        {
+            config.duration_s = std::strtod(argv[++i], nullptr) * 86400.0;
+        }
+        else if (arg == "--seed" && value)
+        {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--ambient" && value)
+        {
+            config.environment.ambient_mean_c = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--doors-per-day" && value)
+        {
+            config.environment.door_openings_per_day = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--target" && value)
+        {
+            config.config.target_temperature = (int8_t)std::strtol(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--hysteresis-high" && value)
+        {
+            config.app.temp_hysteresis_high = (uint8_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--hysteresis-low" && value)
+        {
+            config.app.temp_hysteresis_low = (uint8_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--restart-wait" && value)
+        {
+            config.app.stalled_motor_wait_seconds = (uint16_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--adaptive" && value)
+        {
+            config.app.adaptive_hysteresis = (uint8_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--cycle" && value)
+        {
+            config.app.adaptive_cycle_minutes = (uint16_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--control" && value)
+        {
+            const std::string law = argv[++i];
+            config.app.control_mode = (law == "pid") ? APP_CONTROL_PID : APP_CONTROL_HYSTERESIS;
+        }
+        else if (arg == "--kp" && value)
+        {
+            config.app.pid.kp = (int16_t)std::strtol(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--ki" && value)
+        {
+            config.app.pid.ki = (int16_t)std::strtol(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--kd" && value)
+        {
+            config.app.pid.kd = (int16_t)std::strtol(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--window" && value)
+        {
+            config.app.pid_window_seconds = (uint16_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--min-runtime" && value)
+        {
+            config.app.min_motor_runtime_seconds = (uint16_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--min-idle" && value)
+        {
+            config.app.pid_min_idle_seconds = (uint16_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--filter" && value)
+        {
+            config.temperature_filter = std::strtoul(argv[++i], nullptr, 10) != 0U;
+        }
+        else if (arg == "--adaptive-sampling" && value)
+        {
+            config.adaptive_sampling = std::strtoul(argv[++i], nullptr, 10) != 0U;
+        }
+        else if (arg == "--adc-noise" && value)
+        {
+            config.hardware.ntc_noise_lsb = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--adc-spikes" && value)
+        {
+            config.hardware.ntc_spikes_per_hour = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--spike-size" && value)
+        {
+            config.hardware.ntc_spike_lsb = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--door-detection" && value)
+        {
+            config.app.transient_detection = (uint8_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--scheduling" && value)
+        {
+            config.app.scheduling = (uint8_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--clock-sync" && value)
+        {
+            config.clock_sync_period_s = std::strtod(argv[++i], nullptr) * 3600.0;
+        }
+        else if (arg == "--clock-drift" && value)
+        {
+            config.clock_drift_ppm = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--peak-price" && value)
+        {
+            config.tariff.peak_price = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--off-peak-price" && value)
+        {
+            config.tariff.off_peak_price = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--trace" && value)
+        {
+            trace_path = argv[++i];
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    FILE* trace_file = nullptr;
+    trace_encoder_t trace;
+    if (trace_path != nullptr)
+    {
+        trace_file = fopen(trace_path, "wb");
+        if (trace_file == nullptr)
+        {
+            fprintf(stderr, "Could not open %s\n", trace_path);
+            return 1;
+        }
+        trace_encoder_init(&trace, write_to_file, trace_file);
+    }
+
+    closed_loop_report_t report;
+    const auto start = std::chrono::steady_clock::now();
+    closed_loop_run(&config, &report, (trace_file != nullptr) ? &trace : nullptr);
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (trace_file != nullptr)
+    {
+        printf("Trace written to %s (%ld bytes)\n", trace_path, ftell(trace_file));
+        fclose(trace_file);
+    }
+
+    print_report(&report);
+    printf("Ran %.1f days of fridge time in %.3f s (%.0fx real time)\n", config.duration_s / 86400.0, elapsed_s, config.duration_s / elapsed_s);
+    return 0;
+}
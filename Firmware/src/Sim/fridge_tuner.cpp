@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "tuner.h"
+
+static void print_usage(const char* program)
+{
+    printf("Usage : %s [options]\n"
+           "  --method <name>     grid, random, descent or all (default all)\n"
+           "  --devices <count>   Evaluation devices, shared by every candidate (default 4)\n"
+           "  --days <days>       Simulated duration per device (default 10)\n"
+           "  --threads <count>   Worker threads (default : every hardware thread)\n"
+           "  --grid <points>     Values per parameter for the grid search (default 3)\n"
+           "  --samples <count>   Random search candidates (default 64)\n"
+           "  --seed <seed>       Fleet and random search seed (default 1)\n"
+           "  --top <count>       Ranked candidates printed (default 10)\n"
+           "  --header <path>     Generated config header (default app_tuned_params.h)\n",
+           program);
+}
+
+static void print_header_row(void)
+{
+    printf("%4s %4s %4s %5s %5s %7s | %8s %8s %8s %8s %8s %8s\n", "rank", "high", "low", "stall", "wait", "steady", "cost", "kWh/day",
+           "starts/h", "RMS C", "stalls/d", "false/d");
+}
+
+static void print_result(const size_t rank, tuner_result_t const& result)
+{
+    printf("%4zu %4d %4d %5d %5d %7d | %8.4f %8.3f %8.3f %8.3f %8.3f %8.3f\n", rank, result.candidate[TUNER_PARAM_TEMP_HYSTERESIS_HIGH],
+           result.candidate[TUNER_PARAM_TEMP_HYSTERESIS_LOW], result.candidate[TUNER_PARAM_STALLED_CURRENT_MULTIPLIER_PERCENT],
+           result.candidate[TUNER_PARAM_STALLED_MOTOR_WAIT_MINUTES], result.candidate[TUNER_PARAM_STEADY_MOTOR_RUNTIME], result.cost,
+           result.kwh_per_day, result.starts_per_hour, result.temperature_rms_c, result.stalls_per_day, result.false_stalls_per_day);
+}
+
+int main(int argc, char** argv)
+{
+    tuner_config_t config;
+    tuner_config_default(&config);
+    std::string method = "all";
+    std::string header = "app_tuned_params.h";
+    size_t top         = 10U;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const bool        value = (i + 1) < argc;
+        if (arg == "--method" && value)
+        {
+            method = argv[++i];
+        }
+        else if (arg == "--devices" && value)
+        {
+            config.fleet.devices = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--days" && value)
+        {
+            config.fleet.base.duration_s = std::strtod(argv[++i], nullptr) * 86400.0;
+        }
+        else if (arg == "--threads" && value)
+        {
+            config.fleet.threads = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--grid" && value)
+        {
+            config.grid_points = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--samples" && value)
+        {
+            config.random_samples = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seed" && value)
+        {
+            config.seed      = std::strtoull(argv[++i], nullptr, 10);
+            config.fleet.seed = config.seed;
+        }
+        else if (arg == "--top" && value)
+        {
+            top = (size_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--header" && value)
+        {
+            header = argv[++i];
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const bool all = (method == "all");
+    if (!all && method != "grid" && method != "random" && method != "descent")
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    tuner explorer(config);
+    const tuner_result_t baseline = explorer.evaluate({tuner_candidate_default()}).front();
+    if (all || method == "grid")
+    {
+        explorer.grid_search();
+    }
+    if (all || method == "random")
+    {
+        explorer.random_search();
+    }
+    if (all || method == "descent")
+    {
+        // Refines the best candidate found so far (the firmware defaults when running alone)
+        explorer.coordinate_descent(explorer.ranked().front().candidate);
+    }
+
+    const std::vector<tuner_result_t> ranked = explorer.ranked();
+    printf("%zu candidates evaluated on %u devices\n", ranked.size(), config.fleet.devices);
+    print_header_row();
+    for (size_t i = 0; i < ranked.size() && i < top; i++)
+    {
+        print_result(i + 1U, ranked[i]);
+    }
+    printf("firmware defaults :\n");
+    print_result(0U, baseline);
+
+    if (!tuner_write_header(header, ranked.front()))
+    {
+        fprintf(stderr, "Could not write %s\n", header.c_str());
+        return 1;
+    }
+    printf("Best candidate written to %s\n", header.c_str());
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "sensor_models.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Core/current.h"
+
+static uint16_t voltage_to_adc(sensors_config_t const* config, const double voltage_mv)
+{
+    const double raw = std::round(voltage_mv * SENSORS_ADC_RESOLUTION / config->vcc_mv);
+    return (uint16_t)std::clamp(raw, 0.0, (double)(SENSORS_ADC_RESOLUTION - 1U));
+}
+
+static double ntc_resistance(thermistor_data_t const* thermistor, const double temperature_c)
+{
+    // Find the enclosing segment (data is sorted by increasing temperature), boundaries segments are extrapolated
+    uint8_t i = 1U;
+    while ((i < thermistor->sample_count - 1U) && (thermistor->data[i].temperature < temperature_c))
+    {
+        i++;
+    }
+
+    thermistor_temp_res_t const& low  = thermistor->data[i - 1U];
+    thermistor_temp_res_t const& high = thermistor->data[i];
+    const double ratio                = (temperature_c - low.temperature) / (double)(high.temperature - low.temperature);
+    return std::exp(std::log((double)low.resistance) + ratio * (std::log((double)high.resistance) - std::log((double)low.resistance)));
+}
+
+void sensor_hardware_nominal(sensor_hardware_t* hardware, sensors_config_t const* nominal)
+{
+    hardware->board                = *nominal;
+    hardware->ntc_resistance_ratio = 1.0;
+    hardware->current_gain_ratio   = 1.0;
+    hardware->ntc_noise_lsb        = 0.0;
+    hardware->ntc_spikes_per_hour  = 0.0;
+    hardware->ntc_spike_lsb        = 0.0;
+}
+
+uint16_t sensor_model_temperature_adc(sensor_hardware_t const* hardware, thermistor_data_t const* thermistor, const double temperature_c)
+{
+    const double resistance = ntc_resistance(thermistor, temperature_c) * hardware->ntc_resistance_ratio;
+    const double voltage_mv = hardware->board.vcc_mv * resistance / (resistance + hardware->board.upper_resistance);
+    return voltage_to_adc(&hardware->board, voltage_mv);
+}
+
+void sensor_model_ntc_init(sensor_model_ntc_t* model, sensor_hardware_t const* hardware, thermistor_data_t const* thermistor)
+{
+    // Codes decrease as temperature rises : bisect the temperature where each code is reached
+    model->code_threshold_c[0] = std::numeric_limits<double>::max();
+    for (uint16_t code = 1U; code < SENSORS_ADC_RESOLUTION; code++)
+    {
+        double warm = 150.0;
+        double cold = -100.0;
+        for (uint8_t i = 0; i < 48U; i++)
+        {
+            const double middle = (warm + cold) / 2.0;
+            if (sensor_model_temperature_adc(hardware, thermistor, middle) >= code)
+            {
+                cold = middle;
+            }
+            else
+            {
+                warm = middle;
+            }
+        }
+        model->code_threshold_c[code] = warm;
+    }
+    model->last_code = 0U;
+}
+
+uint16_t sensor_model_ntc_read(sensor_model_ntc_t* model, const double temperature_c)
+{
+    uint16_t code = model->last_code;
+    while ((code > 0U) && (temperature_c >= model->code_threshold_c[code]))
+    {
+        code--;
+    }
+    while ((code < SENSORS_ADC_RESOLUTION - 1U) && (temperature_c < model->code_threshold_c[code + 1U]))
+    {
+        code++;
+    }
+    model->last_code = code;
+    return code;
+}
+
+uint16_t sensor_model_ntc_noise(sensor_hardware_t const* hardware, sim_random_t* random, const uint16_t raw, const double period_s)
+{
+    double noisy = raw;
+    if (hardware->ntc_noise_lsb > 0.0)
+    {
+        noisy += hardware->ntc_noise_lsb * sim_random_normal(random);
+    }
+    if ((hardware->ntc_spikes_per_hour > 0.0) && (sim_random_uniform(random) < hardware->ntc_spikes_per_hour * period_s / 3600.0))
+    {
+        noisy += sim_random_range(random, -hardware->ntc_spike_lsb, hardware->ntc_spike_lsb);
+    }
+    return (uint16_t)std::clamp(std::round(noisy), 0.0, (double)(SENSORS_ADC_RESOLUTION - 1U));
+}
+
+uint16_t sensor_model_current_adc(sensor_hardware_t const* hardware, const double current_a)
+{
+    // Current transformer + amplifiers chain, @see current_from_voltage()
+    const double amplified_mv = current_a * 1000.0 * hardware->current_gain_ratio * CURRENT_MEASURE_GAIN / CURRENT_TRANSFORMER_INV_RATIO;
+    return voltage_to_adc(&hardware->board, amplified_mv + hardware->board.current_dc_bias_mv);
+}
@@ -0,0 +1,65 @@
+#ifndef SENSOR_MODELS_HEADER
+#define SENSOR_MODELS_HEADER
+
+#include <cstdint>
+
+#include "Core/sensors.h"
+#include "Core/thermistor.h"
+#include "sim_random.h"
+
+/**
+ * @brief actual sensors hardware of a device, which differs from the nominal values the firmware assumes (components tolerances)
+ */
+struct sensor_hardware_t
+{
+    sensors_config_t board;      /**> Actual front-end values : supply voltage, upper bridge resistor, amplifier DC bias */
+    double ntc_resistance_ratio; /**> Actual NTC resistance, relative to its nominal curve                               */
+    double current_gain_ratio;   /**> Actual current transformer and amplifiers gain, relative to nominal                */
+    double ntc_noise_lsb;        /**> NTC bridge reading noise, standard deviation (ADC codes)                           */
+    double ntc_spikes_per_hour;  /**> Mean rate of spurious NTC bridge readings (compressor and mains interference)      */
+    double ntc_spike_lsb;        /**> Spurious readings amplitude, drawn uniformly in [-ntc_spike_lsb, ntc_spike_lsb]    */
+};
+
+/**
+ * @brief hardware that exactly matches the nominal front-end, noiseless
+ */
+void sensor_hardware_nominal(sensor_hardware_t* hardware, sensors_config_t const* nominal);
+
+/**
+ * @brief inverse of the Core temperature pipeline : raw ADC reading of the NTC bridge for a given temperature.
+ * The NTC curve is interpolated in the log domain (resistance is exponential with temperature) and extrapolated beyond its boundaries.
+ */
+uint16_t sensor_model_temperature_adc(sensor_hardware_t const* hardware, thermistor_data_t const* thermistor, const double temperature_c);
+
+/**
+ * @brief NTC bridge ADC codes boundaries, precomputed so that the NTC curve is not evaluated at every simulation step
+ */
+struct sensor_model_ntc_t
+{
+    double code_threshold_c[SENSORS_ADC_RESOLUTION]; /**> Temperature below which the ADC reads at least this code (°C) */
+    uint16_t last_code;                              /**> Last code read, temperature moves slowly from one read to the next */
+};
+
+/**
+ * @brief precomputes the ADC codes boundaries of a NTC bridge (from sensor_model_temperature_adc())
+ */
+void sensor_model_ntc_init(sensor_model_ntc_t* model, sensor_hardware_t const* hardware, thermistor_data_t const* thermistor);
+
+/**
+ * @brief same as sensor_model_temperature_adc(), using the precomputed boundaries
+ */
+uint16_t sensor_model_ntc_read(sensor_model_ntc_t* model, const double temperature_c);
+
+/**
+ * @brief adds the hardware noise and spurious readings to a noiseless NTC bridge reading (saturates at the ADC boundaries)
+ * @param[in] period_s : time since the previous reading, scales the spurious readings probability
+ */
+uint16_t sensor_model_ntc_noise(sensor_hardware_t const* hardware, sim_random_t* random, const uint16_t raw, const double period_s);
+
+/**
+ * @brief inverse of the Core current pipeline : raw ADC reading of the current sense amplifier for an instantaneous current.
+ * Output saturates at the ADC boundaries, like the real front-end does.
+ */
+uint16_t sensor_model_current_adc(sensor_hardware_t const* hardware, const double current_a);
+
+#endif /* SENSOR_MODELS_HEADER */
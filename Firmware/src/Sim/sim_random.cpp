@@ -0,0 +1,33 @@
+#include "sim_random.h"
+
+#include <cmath>
+#include <numbers>
+
+void sim_random_seed(sim_random_t* random, const uint64_t seed)
+{
+    // Xorshift must not be seeded with 0, splitmix the seed once
+    uint64_t z    = seed + 0x9E3779B97F4A7C15ULL;
+    z             = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z             = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    random->state = (z ^ (z >> 31U)) | 1U;
+}
+
+double sim_random_uniform(sim_random_t* random)
+{
+    random->state ^= random->state >> 12U;
+    random->state ^= random->state << 25U;
+    random->state ^= random->state >> 27U;
+    return (double)((random->state * 0x2545F4914F6CDD1DULL) >> 11U) * 0x1.0p-53;
+}
+
+double sim_random_range(sim_random_t* random, const double min, const double max)
+{
+    return min + (max - min) * sim_random_uniform(random);
+}
+
+double sim_random_normal(sim_random_t* random)
+{
+    // Box-Muller, 1 - uniform keeps the logarithm argument away from 0
+    const double radius = std::sqrt(-2.0 * std::log(1.0 - sim_random_uniform(random)));
+    return radius * std::cos(2.0 * std::numbers::pi * sim_random_uniform(random));
+}
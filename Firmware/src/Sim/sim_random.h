@@ -0,0 +1,34 @@
+#ifndef SIM_RANDOM_HEADER
+#define SIM_RANDOM_HEADER
+
+#include <cstdint>
+
+/**
+ * @brief small, fast and reproducible pseudo random generator (xorshift64*), one per simulated device
+ */
+struct sim_random_t
+{
+    uint64_t state; /**> Generator state, never 0 */
+};
+
+/**
+ * @brief seeds the generator, any seed (0 included) is valid
+ */
+void sim_random_seed(sim_random_t* random, const uint64_t seed);
+
+/**
+ * @brief uniformly distributed number in [0, 1[
+ */
+double sim_random_uniform(sim_random_t* random);
+
+/**
+ * @brief uniformly distributed number in [min, max[
+ */
+double sim_random_range(sim_random_t* random, const double min, const double max);
+
+/**
+ * @brief normally distributed number (mean 0, standard deviation 1)
+ */
+double sim_random_normal(sim_random_t* random);
+
+#endif /* SIM_RANDOM_HEADER */
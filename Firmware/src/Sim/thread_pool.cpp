@@ -0,0 +1,128 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+// Index of the worker running on this thread, used to keep submitted subtasks local
+static thread_local int current_worker = -1;
+
+thread_pool::thread_pool(unsigned int workers)
+{
+    if (workers == 0U)
+    {
+        workers = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < workers; i++)
+    {
+        queues.push_back(std::make_unique<worker_queue>());
+    }
+
+    for (unsigned int i = 0; i < workers; i++)
+    {
+        threads.emplace_back(&thread_pool::worker_loop, this, i);
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    wait();
+    stopping.store(true);
+    available.release((std::ptrdiff_t)threads.size());
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+    unsigned int target = (current_worker >= 0) ? (unsigned int)current_worker : next_queue.fetch_add(1U) % worker_count();
+
+    pending.fetch_add(1U);
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    available.release();
+}
+
+void thread_pool::wait()
+{
+    size_t remaining = pending.load();
+    while (remaining != 0U)
+    {
+        pending.wait(remaining);
+        remaining = pending.load();
+    }
+}
+
+unsigned int thread_pool::worker_count() const
+{
+    return (unsigned int)queues.size();
+}
+
+uint64_t thread_pool::steal_count() const
+{
+    return steals.load();
+}
+
+bool thread_pool::pop_local(const unsigned int worker, std::function<void()>& task)
+{
+    worker_queue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool thread_pool::steal(const unsigned int worker, std::function<void()>& task)
+{
+    for (unsigned int i = 1U; i < worker_count(); i++)
+    {
+        worker_queue& victim = *queues[(worker + i) % worker_count()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals.fetch_add(1U);
+            return true;
+        }
+    }
+    return false;
+}
+
+void thread_pool::worker_loop(const unsigned int worker)
+{
+    current_worker = (int)worker;
+    std::function<void()> task;
+
+    while (true)
+    {
+        // A permit guarantees that a task is waiting in one of the queues, unless the pool is stopping
+        available.acquire();
+
+        while (!pop_local(worker, task) && !steal(worker, task))
+        {
+            if (stopping.load())
+            {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        task();
+        task = nullptr;
+
+        if (pending.fetch_sub(1U) == 1U)
+        {
+            pending.notify_all();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef THREAD_POOL_HEADER
+#define THREAD_POOL_HEADER
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief work-stealing thread pool.
+ * Every worker owns a task queue : it pops its own tasks from the back (most recent first, cache friendly) and steals
+ * from the front of the other queues once its own is empty. Simulated devices have very uneven costs (a device whose compressor
+ * runs more samples more current), stealing keeps every core busy until the very last task.
+ */
+class thread_pool
+{
+public:
+    /**
+     * @param[in] workers : worker threads count, 0 uses every available hardware thread
+     */
+    explicit thread_pool(unsigned int workers = 0U);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&)            = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /**
+     * @brief queues a task. Tasks submitted from a worker go to this worker's queue, others are spread round-robin.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief blocks until every submitted task ran
+     */
+    void wait();
+
+    unsigned int worker_count() const;
+
+    /**
+     * @brief count of tasks that were run by another worker than the one they were queued on
+     */
+    uint64_t steal_count() const;
+
+private:
+    struct worker_queue
+    {
+        std::mutex                        mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool pop_local(const unsigned int worker, std::function<void()>& task);
+    bool steal(const unsigned int worker, std::function<void()>& task);
+    void worker_loop(const unsigned int worker);
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread>                   threads;
+
+    std::counting_semaphore<> available{0}; /**> One permit per queued task (plus one per worker when stopping)   */
+    std::atomic<bool>         stopping{false};
+    std::atomic<size_t>       pending{0};   /**> Submitted tasks that did not complete yet, wait() blocks on it  */
+    std::atomic<uint64_t>     steals{0};
+    std::atomic<unsigned int> next_queue{0};
+};
+
+#endif /* THREAD_POOL_HEADER */
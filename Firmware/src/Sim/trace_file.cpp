@@ -0,0 +1,162 @@
+#include "trace_file.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+uint64_t trace_time_ms(mcu_time_t const& time)
+{
+    return (uint64_t)time.seconds * 1000U + time.milliseconds;
+}
+
+trace_file::~trace_file()
+{
+    close();
+}
+
+bool trace_file::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    mapped = contents.data();
+    length = contents.size();
+#else
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if ((fstat(descriptor, &status) != 0) || (status.st_size == 0))
+    {
+        ::close(descriptor);
+        return false;
+    }
+
+    void* address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (address == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Traces are mostly read front to back : lets the kernel read ahead
+    madvise(address, (size_t)status.st_size, MADV_SEQUENTIAL);
+    mapped = static_cast<uint8_t const*>(address);
+    length = (size_t)status.st_size;
+#endif
+
+    build_index();
+    if (syncs.empty())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void trace_file::close()
+{
+#ifdef _WIN32
+    contents.clear();
+#else
+    if (mapped != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(mapped), length);
+    }
+#endif
+    mapped  = nullptr;
+    length  = 0U;
+    records = 0U;
+    skipped = 0U;
+    last_ms = 0U;
+    syncs.clear();
+}
+
+void trace_file::build_index()
+{
+    trace_decoder_t decoder;
+    trace_decoder_init(&decoder);
+
+    size_t offset = 0U;
+    while (offset < length)
+    {
+        trace_record_t record;
+        const size_t consumed = trace_decode(&decoder, mapped + offset, length - offset, &record);
+        if (consumed == 0U)
+        {
+            // Resynchronizes on the next sync record, which restarts the differential coding
+            const size_t next = offset + 1U + trace_find_sync(mapped + offset + 1U, length - offset - 1U);
+            skipped += std::min(next, length) - offset;
+            offset = next;
+            trace_decoder_init(&decoder);
+            continue;
+        }
+
+        const uint64_t time_ms = trace_time_ms(record.time);
+        if (record.type == TRACE_RECORD_SYNC)
+        {
+            syncs.push_back({time_ms, offset});
+        }
+        last_ms = time_ms;
+        records++;
+        offset += consumed;
+    }
+}
+
+uint8_t const* trace_file::data() const
+{
+    return mapped;
+}
+
+size_t trace_file::size() const
+{
+    return length;
+}
+
+std::vector<trace_sync_entry_t> const& trace_file::index() const
+{
+    return syncs;
+}
+
+size_t trace_file::seek(const uint64_t time_ms) const
+{
+    auto next = std::upper_bound(syncs.begin(), syncs.end(), time_ms,
+                                 [](const uint64_t time, trace_sync_entry_t const& entry) { return time < entry.time_ms; });
+    return (next == syncs.begin()) ? syncs.front().offset : std::prev(next)->offset;
+}
+
+uint64_t trace_file::record_count() const
+{
+    return records;
+}
+
+size_t trace_file::skipped_bytes() const
+{
+    return skipped;
+}
+
+uint64_t trace_file::start_ms() const
+{
+    return syncs.empty() ? 0U : syncs.front().time_ms;
+}
+
+uint64_t trace_file::end_ms() const
+{
+    return last_ms;
+}
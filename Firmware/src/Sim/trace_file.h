@@ -0,0 +1,93 @@
+#ifndef TRACE_FILE_HEADER
+#define TRACE_FILE_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Core/trace.h"
+
+/**
+ * @brief sync record position, used to seek into a trace
+ */
+struct trace_sync_entry_t
+{
+    uint64_t time_ms; /**> Absolute sync time (milliseconds) */
+    size_t offset;    /**> Sync record offset in the trace   */
+};
+
+/**
+ * @brief read-only trace, memory-mapped so that multi-day recordings are neither copied nor fully loaded,
+ * and indexed by the time of its sync records. A file holds a single recording (one boot of the device) : time never goes backwards.
+ */
+class trace_file
+{
+public:
+    trace_file() = default;
+    ~trace_file();
+
+    trace_file(const trace_file&)            = delete;
+    trace_file& operator=(const trace_file&) = delete;
+
+    /**
+     * @brief maps and indexes a trace. Undecodable bytes (corrupted or truncated records, capture started mid-record)
+     * are skipped up to the next sync record.
+     * @return false if the file can't be read or holds no sync record
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief unmaps the trace
+     */
+    void close();
+
+    uint8_t const* data() const;
+    size_t size() const;
+
+    /**
+     * @brief sync records, by increasing time
+     */
+    std::vector<trace_sync_entry_t> const& index() const;
+
+    /**
+     * @brief offset of the last sync record at or before a given time (the first one when time is before the trace start)
+     */
+    size_t seek(const uint64_t time_ms) const;
+
+    /**
+     * @brief decoded records count, sync records included
+     */
+    uint64_t record_count() const;
+
+    /**
+     * @brief bytes skipped while indexing because they could not be decoded
+     */
+    size_t skipped_bytes() const;
+
+    /**
+     * @brief trace time span (milliseconds) : first sync record to last record
+     */
+    uint64_t start_ms() const;
+    uint64_t end_ms() const;
+
+private:
+    void build_index();
+
+    uint8_t const* mapped = nullptr;
+    size_t length         = 0U;
+#ifdef _WIN32
+    std::vector<uint8_t> contents;
+#endif
+    std::vector<trace_sync_entry_t> syncs;
+    uint64_t records = 0U;
+    size_t skipped   = 0U;
+    uint64_t last_ms = 0U;
+};
+
+/**
+ * @brief absolute time in milliseconds
+ */
+uint64_t trace_time_ms(mcu_time_t const& time);
+
+#endif /* TRACE_FILE_HEADER */
@@ -0,0 +1,202 @@
+#include "trace_replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Core/thermistor_ntc_100k_3950K.h"
+
+/**
+ * @brief replay state : outputs of the last step are expected to show up in the trace right after the readings they come from
+ */
+struct replay_state_t
+{
+    pipeline_t pipeline;
+    bool step_pending;           /**> Readings were applied since the last step                 */
+    mcu_time_t step_time;        /**> Time of these readings                                    */
+    bool motor_on;               /**> Last motor command, as recorded                           */
+    bool motor_expected;         /**> Last step changed the motor command, not recorded yet     */
+    uint16_t events_expected;    /**> Events raised by the last step, not recorded yet          */
+};
+
+static void record_mismatch(trace_replay_report_t* report, uint32_t* counter, mcu_time_t const& time)
+{
+    (*counter)++;
+    if (!report->diverged)
+    {
+        report->diverged      = true;
+        report->divergence_ms = trace_time_ms(time);
+    }
+}
+
+/**
+ * @brief outputs the device should have recorded but did not
+ */
+static void flush_expectations(replay_state_t* state, trace_replay_report_t* report)
+{
+    if (state->motor_expected)
+    {
+        record_mismatch(report, &report->motor_mismatches, state->step_time);
+        state->motor_on       = state->pipeline.app.motor_on;
+        state->motor_expected = false;
+    }
+    if (state->events_expected != 0U)
+    {
+        record_mismatch(report, &report->event_mismatches, state->step_time);
+        state->events_expected = 0U;
+    }
+}
+
+static void step(replay_state_t* state, trace_replay_report_t* report, trace_replay_observer_t const& observer)
+{
+    if (!state->step_pending)
+    {
+        return;
+    }
+
+    app_outputs_t outputs;
+    pipeline_step(&state->pipeline, &state->step_time, &outputs);
+    state->step_pending    = false;
+    state->motor_expected  = (outputs.motor_on != state->motor_on);
+    state->events_expected = outputs.events;
+    report->steps++;
+
+    if (observer)
+    {
+        observer(state->step_time, outputs, state->pipeline);
+    }
+}
+
+void trace_replay_run(trace_file const& file, sensors_config_t const& sensors, const uint64_t from_ms, const uint64_t to_ms,
+                      trace_replay_report_t* report, trace_replay_observer_t const& observer)
+{
+    const auto start = std::chrono::steady_clock::now();
+    *report          = trace_replay_report_t{};
+
+    replay_state_t state = {};
+    pipeline_init(&state.pipeline, &sensors, &thermistor_ntc_100k_3950K_data);
+
+    trace_decoder_t decoder;
+    trace_decoder_init(&decoder);
+    uint8_t const* const data = file.data();
+    const size_t size         = file.size();
+    size_t offset             = file.index().empty() ? size : file.seek(from_ms);
+    bool restored             = false;
+
+    while (offset < size)
+    {
+        trace_record_t record;
+        const size_t consumed = trace_decode(&decoder, data + offset, size - offset, &record);
+        if (consumed == 0U)
+        {
+            // Pipeline state is unknown until the next sync record
+            const size_t next = offset + 1U + trace_find_sync(data + offset + 1U, size - offset - 1U);
+            report->skipped_bytes += std::min(next, size) - offset;
+            offset   = next;
+            restored = false;
+            trace_decoder_init(&decoder);
+            continue;
+        }
+        offset += consumed;
+
+        const uint64_t time_ms = trace_time_ms(record.time);
+        if (time_ms > to_ms)
+        {
+            break;
+        }
+        report->records++;
+        report->end_ms = time_ms;
+
+        // A step runs once all the readings sharing a timestamp are applied
+        const bool sample = (record.type == TRACE_RECORD_CURRENT) || (record.type == TRACE_RECORD_TEMPERATURE) ||
+                            (record.type == TRACE_RECORD_BUTTONS);
+        if (!sample || (time_compare(&record.time, &state.step_time) != 0))
+        {
+            step(&state, report, observer);
+        }
+        if (sample || (record.type == TRACE_RECORD_SYNC))
+        {
+            flush_expectations(&state, report);
+        }
+
+        switch (record.type)
+        {
+            case TRACE_RECORD_SYNC:
+            {
+                uint8_t replayed[PIPELINE_SNAPSHOT_SIZE];
+                pipeline_snapshot_write(&state.pipeline, replayed);
+                const bool valid = (record.snapshot_size == PIPELINE_SNAPSHOT_SIZE);
+                if (restored)
+                {
+                    report->syncs++;
+                    if (!valid || (memcmp(replayed, record.snapshot, PIPELINE_SNAPSHOT_SIZE) != 0))
+                    {
+                        record_mismatch(report, &report->snapshot_mismatches, record.time);
+                    }
+                }
+                else
+                {
+                    report->start_ms = (report->records == 1U) ? time_ms : report->start_ms;
+                }
+
+                // Restarts from the recorded state, so that a divergence does not cascade
+                restored = valid && pipeline_snapshot_read(&state.pipeline, record.snapshot);
+                state.motor_on = state.pipeline.app.motor_on;
+                state.step_time = record.time;
+                break;
+            }
+
+            case TRACE_RECORD_CURRENT:
+                report->samples++;
+                pipeline_sample_current(&state.pipeline, (uint16_t)record.value);
+                break;
+
+            case TRACE_RECORD_TEMPERATURE:
+                report->samples++;
+                pipeline_sample_temperature(&state.pipeline, (uint16_t)record.value);
+                break;
+
+            case TRACE_RECORD_BUTTONS:
+                report->samples++;
+                pipeline_sample_buttons(&state.pipeline, (uint8_t)record.value, &record.time);
+                break;
+
+            case TRACE_RECORD_CLOCK:
+                pipeline_sync_clock(&state.pipeline, &record.time, record.value);
+                break;
+
+            case TRACE_RECORD_MOTOR:
+                if (restored && (!state.motor_expected || (time_compare(&record.time, &state.step_time) != 0) ||
+                                 ((record.value != 0U) != state.pipeline.app.motor_on)))
+                {
+                    record_mismatch(report, &report->motor_mismatches, record.time);
+                }
+                state.motor_on       = record.value != 0U;
+                state.motor_expected = false;
+                break;
+
+            case TRACE_RECORD_EVENTS:
+                if (restored && ((record.value != state.events_expected) || (time_compare(&record.time, &state.step_time) != 0)))
+                {
+                    record_mismatch(report, &report->event_mismatches, record.time);
+                }
+                state.events_expected = 0U;
+                break;
+
+            default:
+                break;
+        }
+
+        if (sample)
+        {
+            state.step_pending = restored;
+            state.step_time    = record.time;
+        }
+    }
+
+    step(&state, report, observer);
+    flush_expectations(&state, report);
+
+    report->wall_s        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report->records_per_s = (report->wall_s > 0.0) ? report->records / report->wall_s : 0.0;
+}
@@ -0,0 +1,46 @@
+#ifndef TRACE_REPLAY_HEADER
+#define TRACE_REPLAY_HEADER
+
+#include <cstdint>
+#include <functional>
+
+#include "Core/pipeline.h"
+#include "trace_file.h"
+
+/**
+ * @brief replay outcome. Replayed outputs are checked against the recorded ones : motor commands, events and the pipeline
+ * snapshots of the sync records need to be bit-exact.
+ */
+struct trace_replay_report_t
+{
+    uint64_t records;              /**> Decoded records                                                    */
+    uint64_t samples;              /**> Replayed readings (current, temperature, buttons)                  */
+    uint64_t steps;                /**> Application steps                                                  */
+    uint64_t syncs;                /**> Sync records checked                                               */
+    uint32_t motor_mismatches;     /**> Motor commands that differ from the recorded ones                  */
+    uint32_t event_mismatches;     /**> Events that differ from the recorded ones                          */
+    uint32_t snapshot_mismatches;  /**> Sync records whose pipeline snapshot differs from the replayed one  */
+    size_t skipped_bytes;          /**> Undecodable bytes, skipped up to the next sync record              */
+    bool diverged;                 /**> At least one mismatch                                              */
+    uint64_t divergence_ms;        /**> Time of the first mismatch                                         */
+    uint64_t start_ms;             /**> Replayed time span                                                 */
+    uint64_t end_ms;
+    double wall_s;                 /**> Replay duration                                                    */
+    double records_per_s;          /**> Replay throughput                                                  */
+};
+
+/**
+ * @brief called after every replayed step, with the step time, its outputs and the pipeline state
+ */
+typedef std::function<void(mcu_time_t const&, app_outputs_t const&, pipeline_t const&)> trace_replay_observer_t;
+
+/**
+ * @brief feeds a trace through the Core pipeline under virtual time, from the last sync record at or before from_ms up to to_ms.
+ * The application steps at the time of every group of readings, like the firmware does (@see main.cpp).
+ * @param[in] sensors  : sensors front-end the firmware assumes
+ * @param[in] observer : optional, called after every step
+ */
+void trace_replay_run(trace_file const& file, sensors_config_t const& sensors, const uint64_t from_ms, const uint64_t to_ms,
+                      trace_replay_report_t* report, trace_replay_observer_t const& observer = {});
+
+#endif /* TRACE_REPLAY_HEADER */
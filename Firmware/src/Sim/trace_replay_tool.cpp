@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "trace_replay.h"
+
+static void print_usage(const char* program)
+{
+    printf("Usage : %s <trace> [options]\n"
+           "  --from <seconds>    Replays from the last sync record before this time (default : trace start)\n"
+           "  --to <seconds>      Stops after this time (default : trace end)\n"
+           "  --repeat <count>    Replays the trace several times, to measure the throughput (default 1)\n"
+           "  --steps             Prints every step that raised events or changed the motor command\n",
+           program);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string path = argv[1];
+    uint64_t from_ms       = 0U;
+    uint64_t to_ms         = UINT64_MAX;
+    uint32_t repeat        = 1U;
+    bool steps             = false;
+
+    for (int i = 2; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const bool        value = (i + 1) < argc;
+        if (arg == "--from" && value)
+        {
+            from_ms = (uint64_t)(std::strtod(argv[++i], nullptr) * 1000.0);
+        }
+        else if (arg == "--to" && value)
+        {
+            to_ms = (uint64_t)(std::strtod(argv[++i], nullptr) * 1000.0);
+        }
+        else if (arg == "--repeat" && value)
+        {
+            repeat = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--steps")
+        {
+            steps = true;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    trace_file file;
+    if (!file.open(path))
+    {
+        fprintf(stderr, "Could not read a trace from %s\n", path.c_str());
+        return 1;
+    }
+    printf("%s : %zu bytes, %llu records, %zu sync records, %.1f s to %.1f s, %zu bytes skipped\n", path.c_str(), file.size(),
+           (unsigned long long)file.record_count(), file.index().size(), file.start_ms() / 1000.0, file.end_ms() / 1000.0,
+           file.skipped_bytes());
+
+    // Same front-end as the firmware board (@see main.cpp)
+    const sensors_config_t sensors = {.vcc_mv = 5000U, .upper_resistance = 330U, .current_dc_bias_mv = 2390};
+
+    bool motor_on = false;
+    trace_replay_observer_t observer;
+    if (steps)
+    {
+        observer = [&motor_on](mcu_time_t const& time, app_outputs_t const& outputs, pipeline_t const& pipeline) {
+            if ((outputs.events != 0U) || (outputs.motor_on != motor_on))
+            {
+                printf("%10u.%03u s : motor %s, events 0x%04x, %d C, %d mA RMS\n", time.seconds, time.milliseconds,
+                       outputs.motor_on ? "on " : "off", outputs.events, pipeline.temperature, pipeline.current_rms);
+            }
+            motor_on = outputs.motor_on;
+        };
+    }
+
+    trace_replay_report_t report = {};
+    for (uint32_t i = 0; i < repeat; i++)
+    {
+        trace_replay_run(file, sensors, from_ms, to_ms, &report, observer);
+        printf("Replayed %.1f s to %.1f s : %llu records (%llu readings, %llu steps) in %.3f s, %.2f M records/s\n", report.start_ms / 1000.0,
+               report.end_ms / 1000.0, (unsigned long long)report.records, (unsigned long long)report.samples,
+               (unsigned long long)report.steps, report.wall_s, report.records_per_s / 1e6);
+        observer = nullptr;
+    }
+
+    printf("Checked %llu sync records : %u motor, %u events and %u snapshot mismatches, %zu bytes skipped\n", (unsigned long long)report.syncs,
+           report.motor_mismatches, report.event_mismatches, report.snapshot_mismatches, report.skipped_bytes);
+    if (report.diverged)
+    {
+        printf("Replay diverged from the recording at %.3f s\n", report.divergence_ms / 1000.0);
+        return 2;
+    }
+    printf("Replay is bit-exact\n");
+    return 0;
+}
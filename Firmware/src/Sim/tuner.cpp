@@ -0,0 +1,293 @@
+#include "tuner.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "sim_random.h"
+
+void tuner_config_default(tuner_config_t* config)
+{
+    fleet_config_default(&config->fleet);
+    config->fleet.devices         = 4U;
+    config->fleet.base.duration_s = 10.0 * 86400.0;
+
+    // Evaluate the whole life of the device : learning the motor current is part of it
+    config->fleet.base.config.current_threshold = 0U;
+
+    // Hysteresis bands are part of the search : they must not be overridden by the adaptive ones
+    config->fleet.base.app.adaptive_hysteresis = 0U;
+
+    config->ranges[TUNER_PARAM_TEMP_HYSTERESIS_HIGH]               = {1, 4, 1};
+    config->ranges[TUNER_PARAM_TEMP_HYSTERESIS_LOW]                = {1, 4, 1};
+    config->ranges[TUNER_PARAM_STALLED_CURRENT_MULTIPLIER_PERCENT] = {10, 80, 5};
+    config->ranges[TUNER_PARAM_STALLED_MOTOR_WAIT_MINUTES]         = {1, 8, 1};
+    config->ranges[TUNER_PARAM_STEADY_MOTOR_RUNTIME]               = {1, 30, 1};
+
+    config->weights.energy       = 1.0;
+    config->weights.starts       = 0.5;
+    config->weights.temperature  = 0.5;
+    config->weights.stalls       = 2.0;
+    config->weights.false_stalls = 1.0;
+
+    config->grid_points    = 3U;
+    config->random_samples = 64U;
+    config->max_iterations = 20U;
+    config->seed           = 1U;
+}
+
+tuner_candidate_t tuner_candidate_default(void)
+{
+    tuner_candidate_t candidate;
+    candidate[TUNER_PARAM_TEMP_HYSTERESIS_HIGH]               = TEMP_HYSTERESIS_HIGH;
+    candidate[TUNER_PARAM_TEMP_HYSTERESIS_LOW]                = TEMP_HYSTERESIS_LOW;
+    candidate[TUNER_PARAM_STALLED_CURRENT_MULTIPLIER_PERCENT] = STALLED_CURRENT_MULTIPLIER_PERCENT;
+    candidate[TUNER_PARAM_STALLED_MOTOR_WAIT_MINUTES]         = STALLED_MOTOR_WAIT_MINUTES;
+    candidate[TUNER_PARAM_STEADY_MOTOR_RUNTIME]               = STEADY_MOTOR_RUNTIME;
+    return candidate;
+}
+
+void tuner_apply(tuner_candidate_t const& candidate, app_params_t* params)
+{
+    params->temp_hysteresis_high               = (uint8_t)candidate[TUNER_PARAM_TEMP_HYSTERESIS_HIGH];
+    params->temp_hysteresis_low                = (uint8_t)candidate[TUNER_PARAM_TEMP_HYSTERESIS_LOW];
+    params->stalled_current_multiplier_percent = (uint8_t)candidate[TUNER_PARAM_STALLED_CURRENT_MULTIPLIER_PERCENT];
+    params->stalled_motor_wait_seconds         = (uint16_t)(candidate[TUNER_PARAM_STALLED_MOTOR_WAIT_MINUTES] * 60);
+    params->steady_motor_runtime               = (uint8_t)candidate[TUNER_PARAM_STEADY_MOTOR_RUNTIME];
+}
+
+const char* tuner_param_name(const tuner_param_t param)
+{
+    switch (param)
+    {
+        case TUNER_PARAM_TEMP_HYSTERESIS_HIGH:
+            return "TEMP_HYSTERESIS_HIGH";
+        case TUNER_PARAM_TEMP_HYSTERESIS_LOW:
+            return "TEMP_HYSTERESIS_LOW";
+        case TUNER_PARAM_STALLED_CURRENT_MULTIPLIER_PERCENT:
+            return "STALLED_CURRENT_MULTIPLIER_PERCENT";
+        case TUNER_PARAM_STALLED_MOTOR_WAIT_MINUTES:
+            return "STALLED_MOTOR_WAIT_MINUTES";
+        case TUNER_PARAM_STEADY_MOTOR_RUNTIME:
+            return "STEADY_MOTOR_RUNTIME";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+bool tuner_write_header(const std::string& path, tuner_result_t const& result)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "// Generated by fridge_tuner, do not edit by hand.\n");
+    fprintf(file, "// Cost %.4f : %.3f kWh/day, %.3f starts/hour, %.3f C RMS from target, %.3f stalls/day, %.3f false stalls/day\n",
+            result.cost, result.kwh_per_day, result.starts_per_hour, result.temperature_rms_c, result.stalls_per_day,
+            result.false_stalls_per_day);
+    fprintf(file, "#ifndef APP_TUNED_PARAMS_HEADER\n#define APP_TUNED_PARAMS_HEADER\n\n");
+    for (uint8_t i = 0; i < TUNER_PARAM_COUNT; i++)
+    {
+        fprintf(file, "#define %s %uU\n", tuner_param_name((tuner_param_t)i), (unsigned int)result.candidate[i]);
+    }
+    fprintf(file, "#define ADAPTIVE_HYSTERESIS 0U\n");
+    fprintf(file, "\n#endif /* APP_TUNED_PARAMS_HEADER */\n");
+    return fclose(file) == 0;
+}
+
+tuner::tuner(tuner_config_t const& config) : config(config), pool(config.fleet.threads)
+{
+    // Every candidate runs against the very same devices, so that differences only come from the candidates
+    devices.resize(config.fleet.devices);
+    for (uint32_t i = 0; i < config.fleet.devices; i++)
+    {
+        fleet_draw_device(&config.fleet, i, &devices[i]);
+    }
+}
+
+std::vector<tuner_result_t> tuner::evaluate(std::vector<tuner_candidate_t> const& candidates)
+{
+    std::vector<tuner_candidate_t> pending;
+    for (tuner_candidate_t const& candidate : candidates)
+    {
+        if ((evaluated.find(candidate) == evaluated.end()) && (std::find(pending.begin(), pending.end(), candidate) == pending.end()))
+        {
+            pending.push_back(candidate);
+        }
+    }
+
+    // One task per (candidate, device) couple
+    const size_t device_count = devices.size();
+    std::vector<closed_loop_report_t> reports(pending.size() * device_count);
+    for (size_t c = 0; c < pending.size(); c++)
+    {
+        for (size_t d = 0; d < device_count; d++)
+        {
+            pool.submit([this, &pending, &reports, c, d, device_count] {
+                closed_loop_config_t device = devices[d];
+                tuner_apply(pending[c], &device.app);
+                closed_loop_run(&device, &reports[c * device_count + d]);
+            });
+        }
+    }
+    pool.wait();
+
+    for (size_t c = 0; c < pending.size(); c++)
+    {
+        tuner_result_t result = {};
+        result.candidate      = pending[c];
+        for (size_t d = 0; d < device_count; d++)
+        {
+            closed_loop_report_t const& report = reports[c * device_count + d];
+            const double days                  = report.simulated_s / 86400.0;
+            const uint32_t actual_stalls       = report.stalls + report.overload_trips;
+            const uint32_t false_stalls        = (report.stall_detections > report.stalls) ? report.stall_detections - report.stalls : 0U;
+
+            result.kwh_per_day += report.kwh_per_day / device_count;
+            result.starts_per_hour += report.starts_per_hour / device_count;
+            result.temperature_rms_c += report.cabinet_rms_error_c / device_count;
+            result.stalls_per_day += actual_stalls / days / device_count;
+            result.false_stalls_per_day += false_stalls / days / device_count;
+        }
+
+        tuner_weights_t const& weights = config.weights;
+        result.cost = weights.energy * result.kwh_per_day + weights.starts * result.starts_per_hour +
+                      weights.temperature * result.temperature_rms_c + weights.stalls * result.stalls_per_day +
+                      weights.false_stalls * result.false_stalls_per_day;
+        evaluated[result.candidate] = result;
+    }
+
+    std::vector<tuner_result_t> results;
+    for (tuner_candidate_t const& candidate : candidates)
+    {
+        results.push_back(evaluated[candidate]);
+    }
+    return results;
+}
+
+static tuner_result_t best_of(std::vector<tuner_result_t> const& results)
+{
+    return *std::min_element(results.begin(), results.end(),
+                             [](tuner_result_t const& a, tuner_result_t const& b) { return a.cost < b.cost; });
+}
+
+tuner_result_t tuner::grid_search()
+{
+    std::vector<tuner_candidate_t> candidates(1U, tuner_candidate_t{});
+    for (uint8_t p = 0; p < TUNER_PARAM_COUNT; p++)
+    {
+        tuner_range_t const& range = config.ranges[p];
+        const uint32_t points      = (range.min == range.max) ? 1U : std::max(2U, config.grid_points);
+
+        std::vector<tuner_candidate_t> expanded;
+        for (tuner_candidate_t const& candidate : candidates)
+        {
+            for (uint32_t i = 0; i < points; i++)
+            {
+                tuner_candidate_t next = candidate;
+                next[p] = (points == 1U) ? range.min : range.min + (int32_t)((int64_t)(range.max - range.min) * i / (points - 1U));
+                expanded.push_back(clamp(next));
+            }
+        }
+        candidates = std::move(expanded);
+    }
+    return best_of(evaluate(candidates));
+}
+
+tuner_result_t tuner::random_search()
+{
+    sim_random_t random;
+    sim_random_seed(&random, config.seed);
+
+    std::vector<tuner_candidate_t> candidates;
+    for (uint32_t i = 0; i < config.random_samples; i++)
+    {
+        tuner_candidate_t candidate;
+        for (uint8_t p = 0; p < TUNER_PARAM_COUNT; p++)
+        {
+            tuner_range_t const& range = config.ranges[p];
+            candidate[p]               = (int32_t)sim_random_range(&random, range.min, range.max + 1);
+        }
+        candidates.push_back(clamp(candidate));
+    }
+    return best_of(evaluate(candidates));
+}
+
+tuner_result_t tuner::coordinate_descent(tuner_candidate_t const& start)
+{
+    tuner_result_t best = evaluate({clamp(start)}).front();
+
+    // Starts with large moves (a quarter of the ranges), halved whenever no neighbour improves
+    int32_t moves[TUNER_PARAM_COUNT];
+    for (uint8_t p = 0; p < TUNER_PARAM_COUNT; p++)
+    {
+        tuner_range_t const& range = config.ranges[p];
+        moves[p] = std::max(range.step, ((range.max - range.min) / 4 / range.step) * range.step);
+    }
+
+    for (uint32_t iteration = 0; iteration < config.max_iterations; iteration++)
+    {
+        std::vector<tuner_candidate_t> neighbours;
+        for (uint8_t p = 0; p < TUNER_PARAM_COUNT; p++)
+        {
+            for (int32_t direction : {-1, 1})
+            {
+                tuner_candidate_t neighbour = best.candidate;
+                neighbour[p] += direction * moves[p];
+                neighbour = clamp(neighbour);
+                if (neighbour != best.candidate)
+                {
+                    neighbours.push_back(neighbour);
+                }
+            }
+        }
+
+        const tuner_result_t candidate = neighbours.empty() ? best : best_of(evaluate(neighbours));
+        if (candidate.cost < best.cost)
+        {
+            best = candidate;
+            continue;
+        }
+
+        bool refined = false;
+        for (uint8_t p = 0; p < TUNER_PARAM_COUNT; p++)
+        {
+            const int32_t step = config.ranges[p].step;
+            if (moves[p] > step)
+            {
+                moves[p] = std::max(step, ((moves[p] / 2) / step) * step);
+                refined  = true;
+            }
+        }
+        if (!refined)
+        {
+            break;
+        }
+    }
+    return best;
+}
+
+std::vector<tuner_result_t> tuner::ranked() const
+{
+    std::vector<tuner_result_t> results;
+    for (auto const& entry : evaluated)
+    {
+        results.push_back(entry.second);
+    }
+    std::sort(results.begin(), results.end(), [](tuner_result_t const& a, tuner_result_t const& b) { return a.cost < b.cost; });
+    return results;
+}
+
+tuner_candidate_t tuner::clamp(tuner_candidate_t candidate) const
+{
+    // Snap every value on its range grid
+    for (uint8_t p = 0; p < TUNER_PARAM_COUNT; p++)
+    {
+        tuner_range_t const& range = config.ranges[p];
+        const int32_t value        = std::clamp(candidate[p], range.min, range.max);
+        const int32_t step         = std::max(1, range.step);
+        candidate[p]               = std::min(range.max, range.min + ((value - range.min + step / 2) / step) * step);
+    }
+    return candidate;
+}
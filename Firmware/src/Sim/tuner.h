@@ -0,0 +1,150 @@
+#ifndef TUNER_HEADER
+#define TUNER_HEADER
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "fleet.h"
+#include "thread_pool.h"
+
+/**
+ * @brief control law constants explored by the tuner (@see Core/app.h)
+ */
+enum tuner_param_t
+{
+    TUNER_PARAM_TEMP_HYSTERESIS_HIGH,               /**> TEMP_HYSTERESIS_HIGH (°C)                     */
+    TUNER_PARAM_TEMP_HYSTERESIS_LOW,                /**> TEMP_HYSTERESIS_LOW (°C)                      */
+    TUNER_PARAM_STALLED_CURRENT_MULTIPLIER_PERCENT, /**> STALLED_CURRENT_MULTIPLIER_PERCENT (%)        */
+    TUNER_PARAM_STALLED_MOTOR_WAIT_MINUTES,         /**> STALLED_MOTOR_WAIT_MINUTES (minutes)          */
+    TUNER_PARAM_STEADY_MOTOR_RUNTIME,               /**> STEADY_MOTOR_RUNTIME (seconds)                */
+    TUNER_PARAM_COUNT
+};
+
+/**
+ * @brief explored values of a parameter : min, min + step, ..., max
+ */
+struct tuner_range_t
+{
+    int32_t min;
+    int32_t max;
+    int32_t step;
+};
+
+/**
+ * @brief a set of control law constants
+ */
+typedef std::array<int32_t, TUNER_PARAM_COUNT> tuner_candidate_t;
+
+/**
+ * @brief cost function weights, every metric is averaged over the evaluation devices
+ */
+struct tuner_weights_t
+{
+    double energy;        /**> Per kWh / day                                                         */
+    double starts;        /**> Per compressor start / hour                                           */
+    double temperature;   /**> Per °C of RMS deviation from the target temperature                   */
+    double stalls;        /**> Per stalled start (or overload trip) / day                            */
+    double false_stalls;  /**> Per stall detected by the firmware while the motor was fine / day     */
+};
+
+/**
+ * @brief tuner setup
+ */
+struct tuner_config_t
+{
+    fleet_config_t fleet;                         /**> Evaluation devices, every candidate runs against the same ones */
+    tuner_range_t ranges[TUNER_PARAM_COUNT];      /**> Explored values                                                */
+    tuner_weights_t weights;                      /**> Cost function                                                  */
+    uint32_t grid_points;                         /**> Values per parameter for the grid search (evenly spread)       */
+    uint32_t random_samples;                      /**> Candidates drawn by the random search                          */
+    uint32_t max_iterations;                      /**> Coordinate descent iterations limit                            */
+    uint64_t seed;                                /**> Random search seed                                             */
+};
+
+/**
+ * @brief evaluation of a candidate
+ */
+struct tuner_result_t
+{
+    tuner_candidate_t candidate;
+    double cost;
+    double kwh_per_day;
+    double starts_per_hour;
+    double temperature_rms_c;
+    double stalls_per_day;
+    double false_stalls_per_day;
+};
+
+/**
+ * @brief a few fridges over 10 days each, starting in current learning mode, so that a candidate evaluates in about a second
+ */
+void tuner_config_default(tuner_config_t* config);
+
+/**
+ * @brief current firmware constants
+ */
+tuner_candidate_t tuner_candidate_default(void);
+
+/**
+ * @brief copies a candidate into the firmware runtime parameters
+ */
+void tuner_apply(tuner_candidate_t const& candidate, app_params_t* params);
+
+/**
+ * @brief firmware macro matching a parameter
+ */
+const char* tuner_param_name(const tuner_param_t param);
+
+/**
+ * @brief writes a config header overriding the firmware defaults (@see APP_TUNED_PARAMS in Core/app.h)
+ * @return false when the file could not be written
+ */
+bool tuner_write_header(const std::string& path, tuner_result_t const& result);
+
+/**
+ * @brief explores the parameter space. Candidates are evaluated in parallel and only once : results are cached.
+ */
+class tuner
+{
+public:
+    explicit tuner(tuner_config_t const& config);
+
+    /**
+     * @brief evaluates a batch of candidates (cached ones are not run again)
+     */
+    std::vector<tuner_result_t> evaluate(std::vector<tuner_candidate_t> const& candidates);
+
+    /**
+     * @brief evaluates grid_points values per parameter, every combination
+     */
+    tuner_result_t grid_search();
+
+    /**
+     * @brief evaluates random_samples candidates drawn uniformly from the ranges
+     */
+    tuner_result_t random_search();
+
+    /**
+     * @brief moves one parameter at a time (every neighbour evaluated in parallel) from the start point,
+     * halving the moves when no neighbour improves, until moves are down to the ranges steps
+     */
+    tuner_result_t coordinate_descent(tuner_candidate_t const& start);
+
+    /**
+     * @brief every evaluated candidate, best first
+     */
+    std::vector<tuner_result_t> ranked() const;
+
+private:
+    tuner_candidate_t clamp(tuner_candidate_t candidate) const;
+
+    tuner_config_t                                config;
+    thread_pool                                   pool;
+    std::vector<closed_loop_config_t>             devices;
+    std::map<tuner_candidate_t, tuner_result_t>   evaluated;
+};
+
+#endif /* TUNER_HEADER */
@@ -2,18 +2,30 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#include "Core/bridge.h"
+#include "Core/app.h"
 #include "Core/buffers.h"
 #include "Core/buttons.h"
 #include "Core/current.h"
+#include "Core/flash.h"
+#include "Core/idle.h"
 #include "Core/mcu_time.h"
+#include "Core/pipeline.h"
+#include "Core/profiler.h"
+#include "Core/sensors.h"
 #include "Core/thermistor.h"
 #include "Core/thermistor_ntc_100k_3950K.h"
+#include "Core/trace.h"
 
 #include "Core/led.h"
 
+#include "Hal/cycle_counter.h"
+#include "Hal/gpio.h"
 #include "Hal/persistent_memory.h"
+#include "Hal/pin_change.h"
+#include "Hal/power.h"
+#include "Hal/pwm.h"
 #include "Hal/timebase.h"
+#include "Hal/uart.h"
 
 // clang-format off
 // -> Clang has troubles treating multiline macros comments
@@ -24,27 +36,11 @@
 // ################################################### Read-only data & configs ###################################################################
 // ################################################################################################################################################
 
-// Permanent storage header and footer are used to make sure EEPROM was already
-// used and is valid. These are default constant values which is really
-// unlikely we'll find in the EEPROM straight from factory. They will be used
-// to invalidate cached values and trigger board auto-learning
-#define PERMANENT_STORAGE_HEADER 0xDE
-#define PERMANENT_STORAGE_FOOTER 0xAD
-
+// Control law constants (hysteresis, motor restart timings, ...) are defined in Core/app.h
 
 #define SAMPLES_PER_SINE  20U   /**> How many samples we are using to depict a full sine wave.                           */
                                 /**> Appropriate values might range from 10 to 20                                        */
 
-#define STALLED_CURRENT_MULTIPLIER_PERCENT 20U /**> Used to detect overcurrent conditions.                               */
-                                               /**> Inrush current is several times bigger than normal current           */
-
-#define STEADY_MOTOR_RUNTIME 5U  /**> Minimum time to wait after motor is triggered to consider it in                    */
-                                 /**> it's normal operation mode                                                         */
-
-#define STALLED_MOTOR_WAIT_MINUTES 5U                                  /**> How long we'll need to wait between motor starts when motor is stalled  */
-#define STALLED_MOTOR_WAIT_SECONDS (STALLED_MOTOR_WAIT_MINUTES * 60U)  /**> Same as above in seconds                                                */
-#define STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART 10U                  /**> How long (in seconds) we prevent over current detection after a restart */
-
 #define MAINS_AC_FREQUENCY_HZ 50U           /**> Mains outlet AC frequency (50 Hz in France)                            */
 
 #define CURRENT_SENSOR_CHECK_RATE_HZ uint16_t(SAMPLES_PER_SINE * MAINS_AC_FREQUENCY_HZ)    /**> Current sensor check rate (frequency) - Hz               */
@@ -53,8 +49,11 @@
 #define CURRENT_SENSOR_CHECK_PERIOD_MS uint8_t(1000 / CURRENT_SENSOR_CHECK_RATE)        /**> Current sensor check time period in milliseconds (between 2 sensor reads) */
 #define CURRENT_SENSE_DC_BIAS_MV 2390
 
-#define TEMP_HYSTERESIS_HIGH 2U     /**> Upper limit of the hysteresis window. If temp gets higher than 2°C above the target temp, we start the compressor  */
-#define TEMP_HYSTERESIS_LOW 2U      /**> Lower limit of the hysteresis window. If temp gets lower than 2°C below the target temp, we stop the compressor    */
+#define LOW_POWER_IDLE 1            /**> Puts the MCU to sleep in between deadlines of the timebase users (led, current, temperature, buttons) */
+
+#ifndef LED_HARDWARE_PWM
+#define LED_HARDWARE_PWM 1          /**> Status LED (D3 / OC2B) is dimmed by timer 2 compare output instead of software PWM (@see Hal/pwm.h) */
+#endif
 
 
 // ################################################################################################################################################
@@ -62,7 +61,16 @@
 // ################################################################################################################################################
 
 
-#define DEBUG_SERIAL
+// Trace recorder is enabled through build flags (-DTRACE_ENABLED=1), see platformio.ini.
+// Serial port then streams the binary trace (@see Core/trace.h) instead of the debug logs
+#if TRACE_ENABLED == 1
+    #define TRACE_SERIAL_BAUD 115200UL  /**> 1kHz current samples take about 2.5kB/s */
+    #if UART_TX_RING_SIZE < (TRACE_SYNC_HEADER_SIZE + PIPELINE_SNAPSHOT_SIZE)
+        #error "UART_TX_RING_SIZE can't hold a trace sync record"
+    #endif
+#else
+    #define DEBUG_SERIAL
+#endif
 #define DEBUG_TEMP 0
 //#define DEBUG_CURRENT_RMS
 //#define DEBUG_CURRENT_VOLTAGE
@@ -71,24 +79,43 @@
 #define DEBUG_REPORT_PERIODIC 1
 #if DEBUG_REPORT_PERIODIC == 1
     #define DEBUG_REPORT_PERIOD_SECONDS 1U
-    #define DEBUG_REPORT_PERIOD_SECONDS_MOTOR_RESTART_ETA 10U
+    #define DEBUG_REPORT_IDLE_STATS 1
 #endif
 #define FORCE_OVERWRITE_EEPROM 0
 
+// Profiler is enabled through build flags (-DPROFILER_ENABLED=1), see platformio.ini
+#if PROFILER_ENABLED == 1
+    #define PROFILER_DUMP_COMMAND 'p'   /**> Serial command used to dump profiler histograms */
+    #define PROFILER_RESET_COMMAND 'r'  /**> Serial command used to reset profiler histograms */
+#endif
+
 #ifdef DEBUG_SERIAL
     #define MSG_LENGTH 50U
     char msg[MSG_LENGTH] = {0};
-    #define LOG_INIT() Serial.begin(9600)
-    #define LOG(msg) Serial.print(msg)
-    #define LOG_CUSTOM(format, ...)                     \
-        snprintf(msg, MSG_LENGTH, format, __VA_ARGS__); \
-        LOG(msg);
+    // Logs are queued and sent in the background, and dropped if the line can't keep up (@see Hal/uart.h).
+    // Messages and formats stay in flash : on AVR, string literals would otherwise be copied to RAM at startup
+    #define LOG_INIT() uart_init(9600)
+    #define LOG(text)                             \
+        PROFILER_ENTER(PROFILER_STAGE_LOGGING);   \
+        uart_print_flash(FLASH_STRING(text));     \
+        PROFILER_EXIT(PROFILER_STAGE_LOGGING)
+    #define LOG_CUSTOM(format, ...)                                           \
+        FLASH_SNPRINTF(msg, MSG_LENGTH, FLASH_STRING(format), __VA_ARGS__);   \
+        PROFILER_ENTER(PROFILER_STAGE_LOGGING);                               \
+        uart_print(msg);                                                      \
+        PROFILER_EXIT(PROFILER_STAGE_LOGGING);
 #else
     #define LOG_INIT()
-    #define LOG(msg)
+    #define LOG(text)
     #define LOG_CUSTOM(format, ...)
 #endif
 
+#if TRACE_ENABLED == 1
+    #define TRACE_RECORD(type, time, value) trace_write_record(&trace, type, time, value)
+#else
+    #define TRACE_RECORD(type, time, value)
+#endif
+
 // clang-format on
 
 // ################################################################################################################################################
@@ -101,6 +128,14 @@ const uint8_t status_led_pin    = 3; // D3 -> PORTD3 of the atmega328PB Mcu
 const uint8_t minus_button_pin  = 4; // D4
 const uint8_t plus_button_pin   = 5; // D5
 
+// Pins are resolved at compile time : each access is a single instruction, the motor state is tracked in software and never read back
+using motor_control_gpio = gpio_pin<motor_control_pin>;
+using status_led_gpio    = gpio_pin<status_led_pin>;
+using minus_button_gpio  = gpio_pin<minus_button_pin>;
+using plus_button_gpio   = gpio_pin<plus_button_pin>;
+
+static_assert((minus_button_gpio::port == gpio_port_t::D) && (plus_button_gpio::port == gpio_port_t::D), "Buttons need to sit on PORTD (pin change interrupt 2)");
+
 const uint8_t  temp_sensor_pin    = A0;    /**> NTC thermistor temperature sensor input pin             */
 const uint8_t  current_sensor_pin = A1;    /**> Current sens input pin, sampled @ 500Hz - 1kHz          */
 const uint16_t upper_resistance   = 330U;  /**> 320 kOhms resistor is used as the upper bridge resistor */
@@ -108,82 +143,50 @@ const uint16_t vcc_mv             = 5000U; /**> Board is powered via USB -> 5V
 
 const uint8_t led_driver_index = 0U;
 
-// ################################################################################################################################################
-// ################################################### Application state machine ##################################################################
-// ################################################################################################################################################
-
-/**
- * @brief controls the application state (state machine)
- */
-typedef enum
-{
-    APP_STATE_NORMAL,             /**> Normal fridge operation                                                                                  */
-    APP_STATE_POST_BOOT_WAIT,     /**> Post boot time window waits for 5 seconds without triggering the compressor.
-                                       This allows the user to enter the Learning mode when exiting the boot.                                   */
-    APP_STATE_MOTOR_STALLED,      /**> Motor stalled condition was detected, waiting for 5 minutes before trying again                          */
-    APP_STATE_WAITING_START_MOTOR /**> We are waiting before restarting the motor. This is done before we run into the MOTOR STALLED condition  */
-} app_state_t;
-
-typedef struct
-{
-    app_state_t app_state; /**> Tracks application current state                                               */
-    /**
-     * @brief maps the start time conditions in a union
-     * (because we are only using one value at a time, they are mutually exclusive)
-     */
-    union
-    {
-        uint32_t stalled_cond_time;  /**> Keeps track of the stalled condition start in time */
-        uint32_t motor_start_time;   /**> Keeps track of the time where motor was started    */
-        uint32_t motor_stopped_time; /**> Keeps track of the time where motor was shut off  */
-    } tracking;
-
-    /**
-     * @brief Keeps track of button events (either Pressed, Released, or Hold)
-     */
-    struct
-    {
-        button_state_t plus_event;      /**> Plus button event                                                                                   */
-        button_state_t prev_plus_event; /**> Used to detect the change in button event (detecting from Pressed to Hold and from Hold to Release) */
-
-        // We need to detect transistion from the PRESSED event to the HOLD event exactly once
-        button_state_t minus_event;      /**> Minus button event                                                                                  */
-        button_state_t prev_minus_event; /**> Used to detect the change in button event (detecting from Pressed to Hold and from Hold to Release) */
-    } buttons;
-
-} app_working_mem_t;
-
-typedef struct
-{
-    int8_t   temperature;
-    uint16_t current_ma;
-    uint16_t current_rms;
-} app_sensors_t;
-
-// Default configuration initialisation
-static persistent_config_t config = {
-    .header             = PERMANENT_STORAGE_HEADER,
-    .target_temperature = 4,
-    .current_threshold  = 500,
-    .footer             = PERMANENT_STORAGE_FOOTER,
+static const sensors_config_t sensors_config = {
+    .vcc_mv             = vcc_mv,
+    .upper_resistance   = upper_resistance,
+    .current_dc_bias_mv = CURRENT_SENSE_DC_BIAS_MV,
 };
 
-static led_io_t leds[1U] = {{.port = &PORTD, .pin = status_led_pin}};
+// Sensors conversions and application state : the whole control logic lives in Core, this sketch only feeds it with
+// raw sensors readings and applies its outputs.
+static pipeline_t pipeline;
+
+#if TRACE_ENABLED == 1
+static trace_encoder_t trace;
+#endif
+
+#if LED_HARDWARE_PWM == 1
+static led_io_t leds[1U] = {{.port = status_led_gpio::out_register(), .pin = status_led_gpio::bit, .set_duty = pwm_set_duty}};
+#else
+static led_io_t leds[1U] = {{.port = status_led_gpio::out_register(), .pin = status_led_gpio::bit, .set_duty = NULL}};
+#endif
 
 // ################################################################################################################################################
 // ####################################################### Static declarations ####################################################################
 // ################################################################################################################################################
 
-static void read_buttons_events(button_state_t* const plus_button_event, button_state_t* const minus_button_event, const mcu_time_t* time);
-static void handle_normal_operation_loop(app_working_mem_t* const app_mem, int16_t const* const current_rms, const int8_t temperature,
-                                         const mcu_time_t* time);
+static bool read_buttons(const mcu_time_t* time);
+static void apply_outputs(app_outputs_t const* const outputs);
+static void log_events(app_outputs_t const* const outputs);
 static void set_motor_output(const uint8_t value);
-static bool is_motor_started(void);
-static void read_temperature(const mcu_time_t* time, int8_t* temperature);
+static bool read_temperature(const mcu_time_t* time);
+static void write_config(persistent_config_t const* const config);
+
+#if TRACE_ENABLED == 1
+static void trace_serial_write(uint8_t const* data, const uint8_t length, void* context);
+static void trace_outputs(const mcu_time_t* time, app_outputs_t const* const outputs);
+static void trace_sync(const mcu_time_t* time);
+#endif
+
+static void handle_serial_commands(const mcu_time_t* time);
+#if PROFILER_ENABLED == 1
+static void handle_profiler_command(const int command);
+#endif
 
 #ifndef NO_CURRENT_MONITORING
-static app_state_t handle_motor_stalled_loop(uint32_t const* const start_time, const mcu_time_t* time);
-static void        read_current(const mcu_time_t* time, int16_t* current_ma, int16_t* current_rms_ma);
+static bool read_current(const mcu_time_t* time);
 #endif
 
 #ifdef DEBUG_CURRENT_VOLTAGE
@@ -192,38 +195,68 @@ static circular_buffer_t voltage_buffer;
 
 void setup()
 {
-    pinMode(minus_button_pin, INPUT);
-    pinMode(plus_button_pin, INPUT);
-    pinMode(motor_control_pin, OUTPUT);
-    pinMode(status_led_pin, OUTPUT);
-    pinMode(temp_sensor_pin, INPUT);
-    pinMode(current_sensor_pin, INPUT);
+    minus_button_gpio::set_input();
+    plus_button_gpio::set_input();
+    motor_control_gpio::set_output();
+    status_led_gpio::set_output();
+    gpio_pin<temp_sensor_pin>::set_input();
+    gpio_pin<current_sensor_pin>::set_input();
+
+    // Buttons are read on pin changes only (and when the debouncing needs it), not polled
+    pin_change_init(minus_button_gpio::mask | plus_button_gpio::mask);
 
     timebase_init();
+#if LED_HARDWARE_PWM == 1
+    // Shares timer 2 with the timebase
+    pwm_init();
+#endif
+    timebase_process();
+    idle_init(timebase_get_time());
+    power_init();
 
     LOG_INIT();
+#if TRACE_ENABLED == 1
+    uart_init(TRACE_SERIAL_BAUD);
+    trace_encoder_init(&trace, trace_serial_write, NULL);
+#endif
+
+#if PROFILER_ENABLED == 1
+    cycle_counter_init();
+    profiler_init(cycle_counter_read);
+#endif
+
+    // Default configuration initialisation
+    pipeline_init(&pipeline, &sensors_config, &thermistor_ntc_100k_3950K_data);
 
     if (FORCE_OVERWRITE_EEPROM || persistent_mem_is_first_boot(PERMANENT_STORAGE_HEADER, PERMANENT_STORAGE_FOOTER))
     {
         LOG("Detected first boot condition, writing default config to EEPROM.\n");
         // Writes the default config on first boot so that it's a known starting
         // point for subsequent eeprom references.
-        persistent_mem_write_config(&config);
-        persistent_mem_read_config(&config);
+        write_config(&pipeline.app.config);
+        persistent_mem_read_config(&pipeline.app.config);
     }
     else
     {
         LOG("Reading config from EEPROM.\n");
         // Otherwise, read back config from EEPROM
-        persistent_mem_read_config(&config);
-        LOG_CUSTOM("Read target temp in config : %d°C\n", config.target_temperature)
-        LOG_CUSTOM("Read current threshold in config : %umA\n", (unsigned int)config.current_threshold)
+        persistent_mem_read_config(&pipeline.app.config);
+        LOG_CUSTOM("Read target temp in config : %d°C\n", pipeline.app.config.target_temperature)
+        LOG_CUSTOM("Read current threshold in config : %umA\n", (unsigned int)pipeline.app.config.current_threshold)
+        LOG_CUSTOM("Stall threshold : %u mA, %u runs\n", (unsigned int)app_get_stall_threshold(&pipeline.app),
+                   (unsigned int)pipeline.app.config.current_runs)
     }
 
     led_init(leds, 1U);
     // led_set_blink_pattern(led_driver_index, LED_BLINK_NONE);
     sei();
 
+#if TRACE_ENABLED == 1
+    // Replay starts from this snapshot, which holds the configuration read from EEPROM
+    timebase_process();
+    trace_sync(timebase_get_time());
+#endif
+
 #ifdef DEBUG_CURRENT_VOLTAGE
     circular_buffer_init(&voltage_buffer, 0);
 #endif
@@ -231,120 +264,82 @@ void setup()
 
 void loop()
 {
-    static const mcu_time_t* time        = NULL;
-    static int8_t            temperature = 0;
-    static int16_t           current_ma  = 0;
+    static const mcu_time_t* time = NULL;
 
 #ifdef DEBUG_REPORT_PERIODIC
     static mcu_time_t previous_time;
 #endif
 
-    // Keeps track of the previous time the system was toggled
-    static app_working_mem_t app_mem = {
-        .app_state = APP_STATE_POST_BOOT_WAIT,
-        .tracking  = {.motor_start_time = 0},
-        .buttons =
-            {
-                .plus_event       = BUTTON_STATE_RELEASED,
-                .prev_plus_event  = BUTTON_STATE_RELEASED,
-                .minus_event      = BUTTON_STATE_RELEASED,
-                .prev_minus_event = BUTTON_STATE_RELEASED,
-            }, // Trailing comma is used to work around clang-format issues with struct fields initialization formatting
-    };
+    app_outputs_t outputs;
+    bool          sampled = false;
 
-    int16_t current_rms    = 0;
-    bool    config_changed = false;
+    PROFILER_ENTER(PROFILER_STAGE_LOOP);
 
     // Very important to process the current time as fast as we can (polling mode)
+    PROFILER_ENTER(PROFILER_STAGE_TIMEBASE);
     timebase_process();
     time = timebase_get_time();
+    PROFILER_EXIT(PROFILER_STAGE_TIMEBASE);
+
+    PROFILER_ENTER(PROFILER_STAGE_LED);
     led_process(time);
+    PROFILER_EXIT(PROFILER_STAGE_LED);
 
 #ifndef NO_CURRENT_MONITORING
     // Current is read at around 1kHz
-    read_current(time, &current_ma, &current_rms);
+    PROFILER_ENTER(PROFILER_STAGE_CURRENT);
+    sampled |= read_current(time);
+    PROFILER_EXIT(PROFILER_STAGE_CURRENT);
 #endif
     // Temperature is read once every 2 seconds
-    read_temperature(time, &temperature);
-
-    // Process button events.
-    // Used to trigger
-    read_buttons_events(&app_mem.buttons.plus_event, &app_mem.buttons.minus_event, time);
-
-    // User pressed and release the + button.
-    // Raise temp set point by one degree
-    if (app_mem.buttons.plus_event == BUTTON_STATE_RELEASED && app_mem.buttons.prev_plus_event != app_mem.buttons.plus_event
-        && app_mem.buttons.prev_plus_event != BUTTON_STATE_HOLD)
-    {
-        config.target_temperature++;
-        LOG("Button + Clicked !\n");
-
-        // Clamp max temperature to max of NTC curve
-        if (config.target_temperature > thermistor_ntc_100k_3950K_data.data[thermistor_ntc_100k_3950K_data.sample_count - 1U].temperature)
-        {
-            config.target_temperature = thermistor_ntc_100k_3950K_data.data[thermistor_ntc_100k_3950K_data.sample_count - 1U].temperature;
-        }
-        config_changed = true;
-        LOG_CUSTOM("-> New temp : %hd °C\n", config.target_temperature);
-    }
-
-    // User pressed and release the - button.
-    // Reduce temp set point by one degree
-    if (app_mem.buttons.minus_event == BUTTON_STATE_RELEASED && app_mem.buttons.prev_minus_event != app_mem.buttons.minus_event
-        && app_mem.buttons.prev_minus_event != BUTTON_STATE_HOLD)
-
-    {
-        LOG("Button - Clicked !\n");
-        config.target_temperature--;
+    PROFILER_ENTER(PROFILER_STAGE_TEMPERATURE);
+    sampled |= read_temperature(time);
+    PROFILER_EXIT(PROFILER_STAGE_TEMPERATURE);
 
-        // Clamp max temperature to min of NTC curve
-        if (config.target_temperature < thermistor_ntc_100k_3950K_data.data[0U].temperature)
-        {
-            config.target_temperature = thermistor_ntc_100k_3950K_data.data[0U].temperature;
-        }
-        config_changed = true;
-        LOG_CUSTOM("-> New temp : %hd °C\n", config.target_temperature);
-    }
-
-    // Only update persistent configuration if it has changed (reduces the amount of writes)
-    if (config_changed)
-    {
-        LOG("Writing configuration to EEPROM\n");
-        persistent_mem_write_config(&config);
-    }
+    // Buttons are debounced by the pipeline, the step handles the gestures they make
+    PROFILER_ENTER(PROFILER_STAGE_BUTTONS);
+    sampled |= read_buttons(time);
+    PROFILER_EXIT(PROFILER_STAGE_BUTTONS);
 
-    switch (app_mem.app_state)
+    // The control law only runs on fresh readings, which keeps its evaluation instants reproducible by the trace replay
+    if (sampled)
     {
-#ifndef NO_CURRENT_MONITORING
-        case APP_STATE_MOTOR_STALLED: {
-            app_mem.app_state = handle_motor_stalled_loop(&app_mem.tracking.stalled_cond_time, time);
-            break;
-        }
+        pipeline_step(&pipeline, time, &outputs);
+        apply_outputs(&outputs);
+        log_events(&outputs);
+#if TRACE_ENABLED == 1
+        trace_outputs(time, &outputs);
 #endif
-
-        case APP_STATE_POST_BOOT_WAIT:
-        case APP_STATE_NORMAL:
-        case APP_STATE_WAITING_START_MOTOR:
-        default: {
-            handle_normal_operation_loop(&app_mem, &current_rms, temperature, time);
-            break;
-        }
     }
 
-    // Update previous buttons states
-    app_mem.buttons.prev_minus_event = app_mem.buttons.minus_event;
-    app_mem.buttons.prev_plus_event  = app_mem.buttons.plus_event;
+#if TRACE_ENABLED == 1
+    trace_sync(time);
+#endif
 
 #if DEBUG_REPORT_PERIODIC == 1
     if ((time->seconds - previous_time.seconds) > DEBUG_REPORT_PERIOD_SECONDS)
     {
         // Report few things about current states
         previous_time = *time;
-        LOG_CUSTOM("temperature : %hd °C\n", temperature);
-        LOG_CUSTOM("current : %hd mA\n", current_ma);
-        LOG_CUSTOM("current RMS: %hd mA\n", current_rms);
-        LOG_CUSTOM("config.target_temperature : %hd °C\n", config.target_temperature);
-        LOG_CUSTOM("config.current_threshold : %hu mA\n\n", config.current_threshold);
+
+        // Logs the line could not keep up with (counted since boot), first so that it is not the one dropped
+        static uint16_t reported_drops = 0;
+        uart_stats_t uart_stats;
+        uart_get_stats(&uart_stats);
+        if (uart_stats.tx_dropped_messages != reported_drops)
+        {
+            reported_drops = uart_stats.tx_dropped_messages;
+            LOG_CUSTOM("serial drops : %u msgs, %u bytes\n", (unsigned int)uart_stats.tx_dropped_messages, (unsigned int)uart_stats.tx_dropped_bytes);
+        }
+
+        LOG_CUSTOM("temperature : %hd °C\n", pipeline.temperature);
+        LOG_CUSTOM("temperature slope : %ld cC/h\n", ((int32_t)pipeline.temperature_slope * 100L) / 256L);
+        LOG_CUSTOM("temperature period : %lu ms\n", (unsigned long)pipeline_temperature_period_ms(&pipeline));
+        LOG_CUSTOM("current : %hd mA\n", pipeline.current_ma);
+        LOG_CUSTOM("current RMS: %hd mA\n", pipeline.current_rms);
+        LOG_CUSTOM("config.target_temperature : %hd °C\n", pipeline.app.config.target_temperature);
+        LOG_CUSTOM("config.current_threshold : %hu mA\n", pipeline.app.config.current_threshold);
+        LOG_CUSTOM("time of day : %u min, schedule %u\n\n", (unsigned int)pipeline.time_of_day, (unsigned int)pipeline.app.schedule);
 
 #ifdef DEBUG_RMS_CURRENT
         // DEBUG RMS current calculation
@@ -362,237 +357,355 @@ void loop()
             LOG_CUSTOM("Voltage/current data (mv) [%hu] = %hd\n", i, voltage_buffer.data[i]);
         }
 #endif
+
+#if DEBUG_REPORT_IDLE_STATS == 1
+        idle_stats_t idle_stats;
+        idle_get_stats(time, &idle_stats);
+        idle_reset_stats(time);
+        LOG_CUSTOM("idle : asleep %u/1000, awake %u/1000\n", idle_stats.asleep_permille, 1000U - idle_stats.asleep_permille);
+#endif
+    }
+#endif
+
+    // Host commands (wall clock, profiler) : a clock synchronization applies after the step, as the trace replay does
+    handle_serial_commands(time);
+
+    // Time spent sleeping is not accounted in the loop stage
+    PROFILER_EXIT(PROFILER_STAGE_LOOP);
+
+#if LOW_POWER_IDLE == 1
+    mcu_time_t led_deadline;
+    if (led_get_next_deadline(time, &led_deadline))
+    {
+        idle_set_deadline(IDLE_USER_LED, &led_deadline);
+    }
+    else
+    {
+        idle_clear_deadline(IDLE_USER_LED);
     }
+
+    // Refresh time so that the budget accounts for the time spent processing this loop
+    timebase_process();
+    idle_account_sleep(power_idle(idle_get_sleep_budget_ms(timebase_get_time())));
 #endif
 }
 
-static void read_buttons_events(button_state_t* const plus_button_event, button_state_t* const minus_button_event, const mcu_time_t* time)
+static bool read_buttons(const mcu_time_t* time)
 {
-    static button_local_mem_t plus_button_mem = {
-        .current  = LOW,
-        .previous = LOW,
-        .pressed  = 0,
-        .event    = BUTTON_STATE_RELEASED,
-    };
-    static button_local_mem_t minus_button_mem = {
-        .current  = LOW,
-        .previous = LOW,
-        .pressed  = 0,
-        .event    = BUTTON_STATE_RELEASED,
-    };
-
-    plus_button_mem.current  = digitalRead(plus_button_pin);
-    minus_button_mem.current = digitalRead(minus_button_pin);
-
-    read_single_button_event(&plus_button_mem, &time->seconds);
-    read_single_button_event(&minus_button_mem, &time->seconds);
-
-    *plus_button_event  = plus_button_mem.event;
-    *minus_button_event = minus_button_mem.event;
+    // Levels are only read when a pin changed (pin change interrupt), or when the debouncing or a long press times out
+    mcu_time_t deadline;
+    const bool timed_out = pipeline_buttons_deadline(&pipeline, &deadline) && (time_compare(time, &deadline) >= 0);
+    if (!pin_change_pending() && !timed_out)
+    {
+        return false;
+    }
+
+    const uint8_t levels = (plus_button_gpio::read() ? PIPELINE_BUTTON_PLUS : 0U) | (minus_button_gpio::read() ? PIPELINE_BUTTON_MINUS : 0U);
+    pipeline_sample_buttons(&pipeline, levels, time);
+    TRACE_RECORD(TRACE_RECORD_BUTTONS, time, levels);
+
+    // Idle buttons don't constrain sleep at all, the pin change interrupt wakes the MCU up
+    if (pipeline_buttons_deadline(&pipeline, &deadline))
+    {
+        idle_set_deadline(IDLE_USER_BUTTONS, &deadline);
+    }
+    else
+    {
+        idle_clear_deadline(IDLE_USER_BUTTONS);
+    }
+    return true;
 }
 
-#ifndef NO_CURRENT_MONITORING
-static app_state_t handle_motor_stalled_loop(uint32_t const* const start_time, const mcu_time_t* time)
+static void apply_outputs(app_outputs_t const* const outputs)
 {
-    // Wait for 5 minutes before exiting this state
-    uint32_t elapsed_time = time->seconds - *start_time;
-    if (elapsed_time >= STALLED_MOTOR_WAIT_SECONDS)
+    static bool motor_on = false;
+
+    if (outputs->motor_on != motor_on)
     {
-        LOG("Motor stalled timeout condition reached -> Reverting to normal mode.\n");
-        // Revert to normal operation mode
-        return APP_STATE_NORMAL;
+        motor_on = outputs->motor_on;
+        set_motor_output(motor_on ? HIGH : LOW);
+    }
+
+    if (outputs->led.set_pattern)
+    {
+        led_set_blink_pattern(led_driver_index, outputs->led.pattern);
+    }
+
+    if (outputs->led.set_next_event)
+    {
+        led_set_next_event(led_driver_index, &outputs->led.next_event);
+    }
+
+    if (outputs->led.set_io)
+    {
+        led_blink_none_set_io(led_driver_index, outputs->led.io_state);
+    }
+
+    // Only update persistent configuration if it has changed (reduces the amount of writes)
+    if (outputs->config_changed)
+    {
+        LOG("Writing configuration to EEPROM\n");
+        write_config(&pipeline.app.config);
     }
-    return APP_STATE_MOTOR_STALLED;
 }
-#endif
 
-static void handle_normal_operation_loop(app_working_mem_t* const app_mem, int16_t const* const current_rms, const int8_t temperature,
-                                         const mcu_time_t* time)
+static void log_events(app_outputs_t const* const outputs)
 {
-    // Only trigger this event once, at first detection of the button
-    // HOLD event, not the subsequent ones.
-
-    // clang-format off
-    if ((BUTTON_STATE_HOLD == app_mem->buttons.minus_event)
-    && (app_mem->buttons.prev_minus_event != app_mem->buttons.minus_event))
-    // clang-format on
+    if (outputs->events == 0)
     {
-        LOG("Button - hold condition detected : Reverting current threshold to default.\n");
-        // Reset memory back to default (starts a new "Learning" mode)
-        config.current_threshold = 0;
-        persistent_mem_write_config(&config);
-        led_set_blink_pattern(led_driver_index, LED_BLINK_ACCEPT);
+        return;
+    }
 
-        led_next_event_t event = {.kind = LED_NEXT_EVENT_PATTERN, .data = {.pattern = LED_BLINK_BREATHING}};
-        led_set_next_event(led_driver_index, &event);
+    if (outputs->events & APP_EVENT_TARGET_INCREASED)
+    {
+        LOG("Button + Clicked !\n");
+        LOG_CUSTOM("-> New temp : %hd °C\n", pipeline.app.config.target_temperature);
+    }
 
-        if (is_motor_started())
-        {
-            // Reset the tracker so that we start counting from now on
-            app_mem->tracking.motor_start_time = time->seconds;
-        }
+    if (outputs->events & APP_EVENT_TARGET_DECREASED)
+    {
+        LOG("Button - Clicked !\n");
+        LOG_CUSTOM("-> New temp : %hd °C\n", pipeline.app.config.target_temperature);
     }
 
-    // Just learnt new "normal" motor behavior ! Save it to persistent memory
-    bool motor_run_long_enough = (time->seconds - app_mem->tracking.motor_start_time) > STEADY_MOTOR_RUNTIME;
-    if (is_motor_started() && (config.current_threshold == 0) && (motor_run_long_enough))
+    if (outputs->events & APP_EVENT_RELEARN_REQUESTED)
     {
-        config.current_threshold = *current_rms;
-        led_set_blink_pattern(led_driver_index, LED_BLINK_ACCEPT);
-        led_next_event_t event = {.kind = LED_NEXT_EVENT_IO_STATE, .data = {.io_state = (uint8_t)HIGH}};
-        led_set_next_event(led_driver_index, &event);
+        LOG("Button - hold condition detected : Reverting current threshold to default.\n");
+    }
 
-        persistent_mem_write_config(&config);
+    if (outputs->events & APP_EVENT_CURRENT_LEARNT)
+    {
         LOG("Learnt new basis current for normal operation ; Saving to EEPROM\n");
-        LOG_CUSTOM("Current : %u, threshold : %u\n", *current_rms, config.current_threshold)
+        LOG_CUSTOM("Threshold : %u\n", pipeline.app.config.current_threshold)
     }
 
-#ifndef NO_CURRENT_MONITORING
-    // Detected stalled motor, stop trying to trigger the compressor for now
-    bool overcurrent_detected = *current_rms > (int16_t)(((100 + STALLED_CURRENT_MULTIPLIER_PERCENT) * config.current_threshold) / 100);
+    if (outputs->events & APP_EVENT_CURRENT_REFINED)
+    {
+        // Standard deviation is stored in Q4
+        LOG_CUSTOM("Running current : %u mA, sigma %u mA\n", (unsigned int)pipeline.app.config.current_threshold,
+                   (unsigned int)(pipeline.app.config.current_sigma >> 4U))
+        LOG_CUSTOM("Stall threshold : %u mA, %u runs\n", (unsigned int)app_get_stall_threshold(&pipeline.app),
+                   (unsigned int)pipeline.app.config.current_runs)
+    }
 
-    // Wait for about 10 seconds to allow the motor to get back up to speed
-    // clang-format off
-    if ((config.current_threshold > 0)
-    &&  (overcurrent_detected)
-    &&  (time->seconds - app_mem->tracking.motor_stopped_time >= STALLED_MOTOR_IMMUNE_PERIOD_AFTER_RESTART))
-    // clang-format on
+    if (outputs->events & APP_EVENT_STALL_DETECTED)
     {
         LOG("Overcurrent detected, motor is probably stalled. Waiting for pressure to equalize in heat pump circuit.\n");
-        app_mem->app_state = APP_STATE_MOTOR_STALLED;
-        set_motor_output(LOW);
-        app_mem->tracking.stalled_cond_time = time->seconds;
+    }
 
-        led_set_blink_pattern(led_driver_index, LED_BLINK_WARNING);
-        return;
+    if (outputs->events & APP_EVENT_STALL_TIMEOUT)
+    {
+        LOG("Motor stalled timeout condition reached -> Reverting to normal mode.\n");
     }
-#endif
 
-    // Simple hysteresis to control the compressor based on a target temperature
-    if (!is_motor_started() && (temperature > (int8_t)(config.target_temperature + TEMP_HYSTERESIS_HIGH)))
+    if (outputs->events & APP_EVENT_MOTOR_STARTED)
     {
-        uint32_t elapsed_seconds = (time->seconds - app_mem->tracking.motor_stopped_time);
+        LOG("Starting motor : temperature is high enough.\n");
+    }
 
-        // app_mem->tracking.motor_start_time == 0 -> Checks if we have just booted
-        // That's the only case where we can bypass the "waiting" period as we have no clue
-        // It means that we have just booted for the first time and we'll need to discover whether the motor can be driven or not
-        // Otherwise :
-        // Don't try to restart the motor right after a stop, need to wait for pressure to equalize in the system
-        // Otherwise we might run in the motor stalled condition
-        if (app_mem->tracking.motor_start_time == 0 || elapsed_seconds >= STALLED_MOTOR_WAIT_SECONDS)
-        {
-            // Start the compressor
-            LOG("Starting motor : temperature is high enough.\n");
-            set_motor_output(HIGH);
-            app_mem->tracking.motor_start_time = time->seconds;
-            led_set_blink_pattern(led_driver_index, LED_BLINK_NONE);
-            led_blink_none_set_io(led_driver_index, HIGH);
-        }
-        else
-        {
-            // Only called once when we transition to this new state
-            if (APP_STATE_WAITING_START_MOTOR != app_mem->app_state)
-            {
-                led_set_blink_pattern(led_driver_index, LED_BLINK_BREATHING);
-                app_mem->app_state = APP_STATE_WAITING_START_MOTOR;
-            }
+    if (outputs->events & APP_EVENT_MOTOR_STOPPED)
+    {
+        LOG("Stopping motor : temperature is low enough.\n");
+    }
 
-#ifdef DEBUG_REPORT_PERIODIC
-            // Print periodically the current waiting status
-            static uint32_t last_print_time = 0;
-            if ((time->seconds - last_print_time) >= DEBUG_REPORT_PERIOD_SECONDS_MOTOR_RESTART_ETA)
-            {
-                LOG_CUSTOM("Waiting to restart motor. ETA : %lu seconds.\n", (STALLED_MOTOR_WAIT_SECONDS - elapsed_seconds));
-                last_print_time = time->seconds;
-            }
-#endif
-        }
+    if (outputs->events & APP_EVENT_START_HELD)
+    {
+        LOG_CUSTOM("Start held : door opened ? (%u held)\n", (unsigned int)pipeline.app.transient.suppressed);
     }
-    else if (is_motor_started() && (temperature < (int8_t)(config.target_temperature - TEMP_HYSTERESIS_LOW)))
+
+    if (outputs->events & APP_EVENT_RESTART_PENDING)
     {
-        LOG("Stopping motor : temperature is low enough.\n");
-        // Stop the compressor
-        set_motor_output(LOW);
-        app_mem->tracking.motor_stopped_time = time->seconds;
+        LOG_CUSTOM("Waiting to restart motor. ETA : %u seconds.\n", (unsigned int)outputs->restart_eta_s);
+    }
+
+    if (outputs->events & APP_EVENT_SCHEDULE_CHANGED)
+    {
+        // 0 : regular, 1 : pre-cooling, 2 : peak hours
+        LOG_CUSTOM("Schedule phase : %u, set point %d °C\n", (unsigned int)pipeline.app.schedule, (int)app_get_setpoint(&pipeline.app))
+    }
+
+    if (outputs->events & APP_EVENT_RATE_LEARNT)
+    {
+        // Q8 °C per hour
+        LOG_CUSTOM("Learnt rates : warm-up %u, cool-down %u\n", (unsigned int)pipeline.app.config.warming_rate,
+                   (unsigned int)pipeline.app.config.cooling_rate)
     }
 }
 
-static bool is_motor_started(void)
+static void write_config(persistent_config_t const* const config)
 {
-    return digitalRead(motor_control_pin) == HIGH;
+    PROFILER_ENTER(PROFILER_STAGE_EEPROM);
+    persistent_mem_write_config(config);
+    PROFILER_EXIT(PROFILER_STAGE_EEPROM);
 }
 
-void set_motor_output(const uint8_t value)
+static void handle_serial_commands(const mcu_time_t* time)
 {
-    digitalWrite(motor_control_pin, value);
-    digitalWrite(status_led_pin, value);
+    static wall_clock_parser_t parser = {.value = 0, .digits = 0, .active = false};
+
+    const int command = uart_read();
+    if (command < 0)
+    {
+        return;
+    }
+
+    uint32_t wall_s;
+    if (wall_clock_parse(&parser, (char)command, &wall_s))
+    {
+        pipeline_sync_clock(&pipeline, time, wall_s);
+        TRACE_RECORD(TRACE_RECORD_CLOCK, time, wall_s);
+        LOG_CUSTOM("Wall clock synchronized, drift %d ppm\n", (int)pipeline.clock.drift_ppm);
+        return;
+    }
+
+#if PROFILER_ENABLED == 1
+    handle_profiler_command(command);
+#endif
 }
 
-static void read_temperature(const mcu_time_t* time, int8_t* temperature)
+#if PROFILER_ENABLED == 1
+static void handle_profiler_command(const int command)
 {
-    static uint32_t last_check_s = 0;
+    if (PROFILER_RESET_COMMAND == command)
+    {
+        profiler_reset();
+        return;
+    }
 
-    // Only trigger temperature reading if elapsed time is greater than 1 second.
-    if (time->seconds - last_check_s >= 1U)
+    if (PROFILER_DUMP_COMMAND != command)
     {
-        uint16_t temp_reading_raw = analogRead(temp_sensor_pin);
-        last_check_s              = time->seconds;
+        return;
+    }
 
-        // Using the x10 to lower aliasing but still retain a more accurate
-        // millivolt reading Also, this remains right under the overflow : (5000 x 10 < UINT16_MAX)
-        uint16_t temp_reading_mv = (((vcc_mv * 10U) / 1024) * temp_reading_raw) / 10U;
+    // Dumps one line per non-empty bucket : bucket N counts durations within [2^(N-1), 2^N[ cycles
+    for (uint8_t stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+    {
+        profiler_histogram_t const* histogram = profiler_get_histogram((profiler_stage_t)stage);
+        LOG_CUSTOM("[prof] %s max %lu cycles\n", profiler_stage_name((profiler_stage_t)stage), (unsigned long)histogram->max);
+        for (uint8_t bucket = 0; bucket < PROFILER_BUCKET_COUNT; bucket++)
+        {
+            if (histogram->buckets[bucket] != 0)
+            {
+                LOG_CUSTOM("[prof]   < 2^%u : %u\n", bucket, histogram->buckets[bucket]);
+            }
+        }
+    }
+}
+#endif
+
+void set_motor_output(const uint8_t value)
+{
+    motor_control_gpio::write(value != LOW);
+    // Status LED mirrors the motor when it's not showing a pattern
+    led_blink_none_set_io(led_driver_index, value);
+}
+
+static bool read_temperature(const mcu_time_t* time)
+{
+    static mcu_time_t next_check = {.seconds = 0, .milliseconds = 0};
+
+    // Read once per second, or less often when the temperature is steady and far from the thresholds (@see Core/sampling.h)
+    if (time_compare(time, &next_check) < 0)
+    {
+        return false;
+    }
 
-        uint16_t ntc_resistance = 0;
-        bridge_get_lower_resistance(&upper_resistance, &temp_reading_mv, &vcc_mv, &ntc_resistance);
+    uint16_t temp_reading_raw = analogRead(temp_sensor_pin);
+    next_check                = *time;
+    pipeline_sample_temperature(&pipeline, temp_reading_raw);
+    TRACE_RECORD(TRACE_RECORD_TEMPERATURE, time, temp_reading_raw);
 
-        *temperature = thermistor_read_temperature(&thermistor_ntc_100k_3950K_data, &ntc_resistance);
+    // The pipeline picks the next reading time from the freshly filtered temperature
+    time_add_ms(&next_check, pipeline_temperature_period_ms(&pipeline));
+    idle_set_deadline(IDLE_USER_TEMPERATURE, &next_check);
 
 #if DEBUG_TEMP
-        LOG_CUSTOM("Temp mv : %u mV\n", temp_reading_mv)
-        LOG_CUSTOM("Vcc mv : %u mV\n", vcc_mv)
-        LOG_CUSTOM("Upper resistance : %u k\n", upper_resistance)
-        LOG_CUSTOM("Temperature : %d °C\n\n", (int)*temperature)
-        LOG_CUSTOM("NTC res : %u k\n", ntc_resistance)
-        LOG_CUSTOM("Temp raw : %u /1024\n", temp_reading_raw)
+    LOG_CUSTOM("Temp mv : %u mV\n", sensors_adc_to_mv(&sensors_config, temp_reading_raw))
+    LOG_CUSTOM("Vcc mv : %u mV\n", vcc_mv)
+    LOG_CUSTOM("Upper resistance : %u k\n", upper_resistance)
+    LOG_CUSTOM("Temperature : %d °C\n\n", (int)pipeline.temperature)
+    LOG_CUSTOM("Temp raw : %u /1024\n", temp_reading_raw)
 #endif
-    }
+    return true;
 }
 
 #ifndef NO_CURRENT_MONITORING
-static void read_current(const mcu_time_t* time, int16_t* current_ma, int16_t* current_rms_ma)
+static bool read_current(const mcu_time_t* time)
 {
     static uint16_t last_check_ms = 0;
 
     // Only trigger temperature reading if elapsed time is greater than 20 millisecond (for 50Hz).
-    if (time->milliseconds - last_check_ms >= (1000 / (CURRENT_MEASURE_SAMPLES_PER_SINE * MAINS_AC_FREQUENCY_HZ)))
+    if ((uint16_t)(time->milliseconds - last_check_ms) < (1000 / (CURRENT_MEASURE_SAMPLES_PER_SINE * MAINS_AC_FREQUENCY_HZ)))
     {
-        uint16_t current_raw = analogRead(current_sensor_pin);
-        last_check_ms        = time->milliseconds;
+        return false;
+    }
+
+    uint16_t current_raw = analogRead(current_sensor_pin);
+    last_check_ms        = time->milliseconds;
+
+    mcu_time_t next_check = *time;
+    time_add_ms(&next_check, 1000 / (CURRENT_MEASURE_SAMPLES_PER_SINE * MAINS_AC_FREQUENCY_HZ));
+    idle_set_deadline(IDLE_USER_CURRENT, &next_check);
 #ifdef CURRENT_LED_DEBUG
-        PORTD ^= (1 << PORTD3);
+    PORTD ^= (1 << PORTD3);
 #endif
-        int16_t current_reading_mv = (((vcc_mv * 10U) / 1024) * current_raw) / 10U;
-        // LOG_CUSTOM("Current reading from ADC (mv) : %d\n", current_reading_mv);
-
-        // Remove the DC part of the read current, as the opamp output is still polarized to vcc_mv/2
-        current_reading_mv -= CURRENT_SENSE_DC_BIAS_MV;
 #ifdef DEBUG_CURRENT_VOLTAGE
-        circular_buffer_push_back(&voltage_buffer, current_reading_mv);
-        LOG_CUSTOM("Current reading mv - DC part : %d\n", current_reading_mv);
+    int16_t current_reading_mv = (int16_t)sensors_adc_to_mv(&sensors_config, current_raw) - CURRENT_SENSE_DC_BIAS_MV;
+    circular_buffer_push_back(&voltage_buffer, current_reading_mv);
+    LOG_CUSTOM("Current reading mv - DC part : %d\n", current_reading_mv);
 #endif
 
-        current_from_voltage(&current_reading_mv, current_ma);
-        // LOG_CUSTOM("Current reading from ADC (ma) : %d\n", *current_ma);
+    // Conversion and RMS sliding window live in the pipeline
+    pipeline_sample_current(&pipeline, current_raw);
+    TRACE_RECORD(TRACE_RECORD_CURRENT, time, current_raw);
+    // LOG_CUSTOM("Current RMS reading (ma) : %d\n", pipeline.current_rms);
+    return true;
+}
+#endif /* NO_CURRENT_MONITORING */
 
-#if CURRENT_RMS_ARBITRARY_FCT == 1
-        int16_t dc_offset_current = 300;
-        current_compute_rms_arbitrary(&current_ma, &current_rms, &dc_offset_current);
-#else
-        // Takes care about the remaining DC part, current_ma should still have this DC component otherwise RMS won't work.
-        current_compute_rms_sine(current_ma, current_rms_ma);
-#endif /* CURRENT_RMS_ARBITRARY_FCT */
+#if TRACE_ENABLED == 1
+static void trace_serial_write(uint8_t const* data, const uint8_t length, void* context)
+{
+    (void)context;
+    // A record lost to a full ring would shift the time of the following ones : records are held until the next sync
+    if (!uart_write(data, length))
+    {
+        trace.synced = false;
+    }
+}
+
+static void trace_outputs(const mcu_time_t* time, app_outputs_t const* const outputs)
+{
+    static bool motor_on = false;
 
-        // LOG_CUSTOM("Current RMS reading (ma) : %d\n", *current_rms_ma);
+    if (outputs->motor_on != motor_on)
+    {
+        motor_on = outputs->motor_on;
+        TRACE_RECORD(TRACE_RECORD_MOTOR, time, motor_on ? 1U : 0U);
+    }
+
+    if (outputs->events != 0)
+    {
+        TRACE_RECORD(TRACE_RECORD_EVENTS, time, outputs->events);
     }
 }
-#endif /* NO_CURRENT_MONITORING */
\ No newline at end of file
+
+static void trace_sync(const mcu_time_t* time)
+{
+    static bool       synced = false;
+    static mcu_time_t next_sync;
+
+    if (synced && (time_compare(time, &next_sync) < 0))
+    {
+        return;
+    }
+
+    uint8_t snapshot[PIPELINE_SNAPSHOT_SIZE];
+    pipeline_snapshot_write(&pipeline, snapshot);
+    trace_write_sync(&trace, time, snapshot, PIPELINE_SNAPSHOT_SIZE);
+
+    synced    = true;
+    next_sync = *time;
+    time_add_ms(&next_sync, TRACE_SYNC_PERIOD_S * 1000UL);
+}
+#endif /* TRACE_ENABLED */
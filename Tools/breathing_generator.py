@@ -0,0 +1,97 @@
+#!/usr/bin/python
+
+# Generates the LED breathing waveform table (Core/led_breathing_table.[ch]) : one duty cycle (0 - 100) per breathing step,
+# gamma corrected so that the brightness looks linear to the eye (perceived brightness ~ duty ^ (1 / gamma)).
+# The firmware reads the table once per step (LED_BLINK_BREATHING_RESOLUTION_MS, 20 ms) : the breathing period is
+# steps x 20 ms, 200 steps (4 seconds) by default.
+
+import sys
+import math
+from pathlib import Path
+from argparse import ArgumentParser
+
+C_NAME = "led_breathing_table"
+C_MAX_DUTY = 100
+C_MAX_STEPS = 1000
+
+def shape_triangle(phase : float) -> float :
+    return 1.0 - abs(2.0 * phase - 1.0)
+
+def shape_sine(phase : float) -> float :
+    return (1.0 - math.cos(2.0 * math.pi * phase)) / 2.0
+
+C_SHAPES = {
+    "triangle" : shape_triangle,
+    "sine" : shape_sine,
+}
+
+def generate_data(steps : int, gamma : float, shape : str, max_duty : int) -> list[int] :
+    data : list[int] = []
+    for step in range(steps) :
+        brightness = C_SHAPES[shape](step / steps)
+        data.append(int(round(max_duty * math.pow(brightness, gamma))))
+    return data
+
+def generate_header(filepath : Path, steps : int, gamma : float, shape : str) -> None :
+    header_define = C_NAME.upper() + "_HEADER"
+    with open(filepath, "w") as file :
+        file.write(f"#ifndef {header_define}\n")
+        file.write(f"#define {header_define}\n\n")
+        file.write("#ifdef __cplusplus\n")
+        file.write("extern \"C\" {\n")
+        file.write("#endif\n\n")
+        file.write("#include <stdint.h>\n\n")
+        file.write("#include \"flash.h\"\n\n")
+        file.write("/**\n")
+        file.write(f" * @brief LED breathing waveform, generated by Tools/breathing_generator.py ({shape}, gamma {gamma}).\n")
+        file.write(" * One duty cycle (0 - 100) per breathing step, read with FLASH_READ_U8().\n")
+        file.write(" */\n")
+        file.write(f"#define {C_NAME.upper()}_STEPS {steps}U\n\n")
+        file.write(f"extern const uint8_t {C_NAME}[{C_NAME.upper()}_STEPS] FLASH_STORAGE;\n\n")
+        file.write("#ifdef __cplusplus\n")
+        file.write("}\n")
+        file.write("#endif\n\n")
+        file.write(f"#endif /* {header_define} */\n")
+
+def generate_source_file(filepath : Path, data : list[int]) -> None :
+    per_line = 20
+    with open(filepath, "w") as file :
+        file.write(f"#include \"{C_NAME}.h\"\n\n")
+        file.write(f"const uint8_t {C_NAME}[{C_NAME.upper()}_STEPS] FLASH_STORAGE = {{\n")
+        for start in range(0, len(data), per_line) :
+            line = ", ".join(f"{value:3d}" for value in data[start:start + per_line])
+            separator = "," if start + per_line < len(data) else ""
+            file.write(f"    {line}{separator}\n")
+        file.write("};\n")
+
+def main(args : list[str]) -> int:
+    parser = ArgumentParser()
+    parser.add_argument("--steps", default=200, type=int, help="Steps per breathing cycle (20 ms each)")
+    parser.add_argument("--gamma", default=2.2, type=float, help="Gamma correction exponent (1 : linear duty cycle)")
+    parser.add_argument("--shape", default="triangle", choices=C_SHAPES.keys(), help="Perceived brightness curve over a cycle")
+    parser.add_argument("--max", default=C_MAX_DUTY, type=int, help="Peak duty cycle (0 - 100)")
+    parser.add_argument("--output", default=str(Path(__file__).parent.parent.joinpath("Firmware", "src", "Core")),
+                        help="Output directory (defaults to Firmware/src/Core)")
+    parsed = parser.parse_args(args)
+
+    if (parsed.steps < 2) or (parsed.steps > C_MAX_STEPS) or (parsed.steps % 2 != 0) :
+        print(f"/!\\ Steps count must be an even number, from 2 to {C_MAX_STEPS}")
+        return 1
+    if (parsed.max < 0) or (parsed.max > C_MAX_DUTY) or (parsed.gamma <= 0.0) :
+        print(f"/!\\ Peak duty cycle must range from 0 to {C_MAX_DUTY}, gamma must be positive")
+        return 1
+
+    output_directory = Path(parsed.output)
+    output_directory.mkdir(parents=True, exist_ok=True)
+
+    print("1 - Generating breathing waveform")
+    data = generate_data(parsed.steps, parsed.gamma, parsed.shape, parsed.max)
+    print("2 - Generating header file")
+    generate_header(output_directory.joinpath(C_NAME + ".h"), parsed.steps, parsed.gamma, parsed.shape)
+    print("3 - Generating source file")
+    generate_source_file(output_directory.joinpath(C_NAME + ".c"), data)
+
+    return 0
+
+if __name__ == "__main__" :
+    exit(main(sys.argv[1:]))
@@ -0,0 +1,51 @@
+#!/usr/bin/python
+
+# Synchronizes the thermostat wall clock with the host local time, over the serial port.
+# The firmware parses "T<local time>\n", local time being the seconds since the epoch shifted by the current UTC offset
+# (daylight saving included), so that the time of day is a plain modulo on the device.
+# Meant to be run periodically (cron, systemd timer...) : the firmware learns its clock drift from synchronizations
+# at least 6 hours apart, and stops trusting its clock a week after the last one.
+
+import sys
+import time
+from argparse import ArgumentParser
+from datetime import datetime
+
+C_SYNC_COMMAND = "T"
+
+
+def local_time_s() -> int:
+    now = datetime.now().astimezone()
+    return int(now.timestamp()) + int(now.utcoffset().total_seconds())
+
+
+def main(args : list[str]) -> int:
+    parser = ArgumentParser()
+    parser.add_argument("port", help="Serial port the thermostat is connected to (e.g. /dev/ttyUSB0, COM3)")
+    parser.add_argument("--baud", default=9600, type=int, help="Serial baud rate (9600 with the debug logs, 115200 when the trace is enabled)")
+    parser.add_argument("--dry-run", action="store_true", help="Prints the command instead of sending it")
+    parsed = parser.parse_args(args)
+
+    command = f"{C_SYNC_COMMAND}{local_time_s()}\n"
+    if parsed.dry_run:
+        print(command, end="")
+        return 0
+
+    try:
+        import serial
+    except ImportError:
+        print("pyserial is required : pip install pyserial")
+        return 1
+
+    with serial.Serial(parsed.port, parsed.baud, timeout=1) as port:
+        # Opening the port resets most Arduino boards : leaves the bootloader some time
+        time.sleep(2)
+        port.write(command.encode("ascii"))
+        port.flush()
+
+    print(f"Sent {command.strip()} to {parsed.port}")
+    return 0
+
+
+if __name__ == "__main__" :
+    exit(main(sys.argv[1:]))